@@ -11,6 +11,7 @@ if(SVG_ENABLED)
     set(THORVG_SRCS  
         # common
         "src/common/tvgCompressor.cpp" 
+        "src/common/tvgFile.cpp" 
         "src/common/tvgMath.cpp" 
         "src/common/tvgStr.cpp" 
         # SVG parser
@@ -24,12 +25,18 @@ if(SVG_ENABLED)
         # image loaders
         "src/loaders/jpg/tvgJpgd.cpp" 
         "src/loaders/jpg/tvgJpgLoader.cpp" 
+        "src/loaders/pngd/tvgPngd.cpp" 
+        "src/loaders/pngd/tvgPngLoader.cpp" 
+        "src/loaders/gifd/tvgGifd.cpp" 
+        "src/loaders/gifd/tvgGifLoader.cpp" 
         # renderer common
         "src/renderer/tvgAccessor.cpp" 
         "src/renderer/tvgAnimation.cpp" 
         "src/renderer/tvgCanvas.cpp" 
         "src/renderer/tvgFill.cpp" 
         # "src/renderer/tvgGlCanvas.cpp" 
+        "src/renderer/tvgImageCache.cpp" 
+        "src/renderer/tvgImageFrames.cpp" 
         "src/renderer/tvgInitializer.cpp" 
         "src/renderer/tvgLoader.cpp" 
         "src/renderer/tvgPaint.cpp" 
@@ -41,6 +48,7 @@ if(SVG_ENABLED)
         "src/renderer/tvgSwCanvas.cpp" 
         "src/renderer/tvgTaskScheduler.cpp" 
         "src/renderer/tvgText.cpp" 
+        "src/renderer/tvgTiles.cpp" 
         # "src/renderer/tvgWgCanvas.cpp" 
         # renderer sw_engine
         "src/renderer/sw_engine/tvgSwFill.cpp" 
@@ -60,7 +68,8 @@ if(SVG_ENABLED)
         "src/renderer" 
         "src/renderer/sw_engine" 
         "src/loaders/raw" 
-        "src/loaders/external_png" 
+        "src/loaders/pngd" 
+        "src/loaders/gifd" 
         "src/loaders/jpg")
     list(TRANSFORM THORVG_SRCS PREPEND ${CMAKE_CURRENT_LIST_DIR}/thorvg/)
     list(TRANSFORM THORVG_INCLUDES PREPEND ${CMAKE_CURRENT_LIST_DIR}/thorvg/)
@@ -99,4 +108,8 @@ if(SVG_ENABLED)
         list(APPEND THIRDPARTY_SOURCES ${THORVG_LOTTIE_SRCS})
         list(APPEND THIRDPARTY_INCLUDE_DIRS ${THORVG_LOTTIE_INCLUDES})
     endif()
+
+    if(THORVG_TESTS)
+        include(${CMAKE_CURRENT_LIST_DIR}/thorvg/test/tests.cmake)
+    endif()
 endif()
\ No newline at end of file
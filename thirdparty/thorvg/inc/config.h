@@ -4,6 +4,8 @@
 #define THORVG_SW_RASTER_SUPPORT
 #define THORVG_SVG_LOADER_SUPPORT
 #define THORVG_JPG_LOADER_SUPPORT
+#define THORVG_PNG_LOADER_SUPPORT
+#define THORVG_GIF_LOADER_SUPPORT
 #ifdef LOTTIE_ENABLED
 #define THORVG_LOTTIE_LOADER_SUPPORT
 #endif //LOTTIE_ENABLED
@@ -62,6 +62,7 @@ namespace tvg
 
 class RenderMethod;
 class Animation;
+class Picture;
 
 /**
  * @defgroup ThorVG ThorVG
@@ -220,6 +221,21 @@ enum class SceneEffect : uint8_t
 };
 
 
+/**
+ * @brief Enumeration that defines methods used for sampling the bitmap images drawn at a scale.
+ *
+ * @see Picture::filter()
+ *
+ * @note Experimental API
+ */
+enum class FilterMethod : uint8_t
+{
+    Bilinear = 0,      ///< Interpolates the 2x2 nearest pixels, or averages the pixels when the image is reduced to less than the half. (default)
+    Nearest,           ///< Takes the nearest pixel without the interpolation. Pixel-exact for the pixel arts and the integer scales, and the fastest.
+    Bicubic            ///< Interpolates the 4x4 nearest pixels for the sharper enlargement of the photos, or averages the pixels as Bilinear when reduced. The slowest.
+};
+
+
 /**
  * @brief Enumeration specifying the engine type used for the graphics backend. For multiple backends bitwise operation is allowed.
  */
@@ -249,7 +265,8 @@ enum class Type : uint8_t
     Picture,               ///< Picture class
     Text,                  ///< Text class
     LinearGradient = 10,   ///< LinearGradient class
-    RadialGradient         ///< RadialGradient class
+    RadialGradient,        ///< RadialGradient class
+    ImagePattern           ///< ImagePattern class
 };
 
 
@@ -831,6 +848,62 @@ public:
 };
 
 
+/**
+ * @class ImagePattern
+ *
+ * @brief A class representing the bitmap image fill of the Shape object.
+ *
+ * The image is placed with its top-left corner at the origin, one image pixel per unit, and is positioned by the Fill::transform().
+ * The area outside the image is filled by the spread: the image is repeated, reflected or its edge pixels are extended with FillSpread::Pad.
+ * The default spread of the pattern is FillSpread::Repeat.
+ * A tiled background is drawn as a single shape, without a Picture for each of the tiles.
+ *
+ * @note The color stops are not used.
+ * @note Experimental API
+ */
+class TVG_API ImagePattern final : public Fill
+{
+public:
+    ~ImagePattern();
+
+    /**
+     * @brief Sets the bitmap image of the pattern.
+     *
+     * The image is decoded right away if it's not yet.
+     *
+     * @param[in] picture The Picture object of a bitmap image.
+     *
+     * @retval Result::InsufficientCondition In case the @p picture has no bitmap image, ex. a vector image.
+     */
+    Result picture(std::unique_ptr<Picture> picture) noexcept;
+
+    /**
+     * @brief Gets the bitmap image of the pattern.
+     *
+     * @return The Picture object, @c nullptr if no image is set.
+     */
+    const Picture* picture() const noexcept;
+
+    /**
+     * @brief Creates a new ImagePattern object.
+     *
+     * @return A new ImagePattern object.
+     */
+    static std::unique_ptr<ImagePattern> gen() noexcept;
+
+    /**
+     * @brief Returns the ID value of this class.
+     *
+     * This method can be used to check the current concrete instance type.
+     *
+     * @return The class type ID of the ImagePattern instance.
+     */
+    Type type() const noexcept override;
+
+    _TVG_DECLARE_PRIVATE(ImagePattern);
+};
+
+
 /**
  * @class Shape
  *
@@ -1310,6 +1383,46 @@ public:
      */
     Result size(float* w, float* h) const noexcept;
 
+    /**
+     * @brief Draws the bitmap image as a nine-slice frame of the picture size.
+     *
+     * The image is divided into nine parts by the given insets. The corners keep their size, the top and bottom edges
+     * are stretched horizontally, the left and right edges vertically and the center in both directions,
+     * so the picture fills the size given by size() exactly instead of keeping the aspect ratio.
+     * If the size is smaller than the corners, the corners are shrunk proportionally.
+     *
+     * @param[in] left The width of the left column in the image pixels.
+     * @param[in] top The height of the top row in the image pixels.
+     * @param[in] right The width of the right column in the image pixels.
+     * @param[in] bottom The height of the bottom row in the image pixels.
+     *
+     * @retval Result::InvalidArguments In case an inset is negative.
+     *
+     * @note All the insets of zero turn the nine-slice drawing off.
+     * @note The vector images are not sliced.
+     * @note Experimental API
+     */
+    Result slice(float left, float top, float right, float bottom) noexcept;
+
+    /**
+     * @brief Sets the sampling method of the bitmap image drawn at a scale.
+     *
+     * @param[in] method The filter method, FilterMethod::Bilinear by default.
+     *
+     * @note The rotated or skewed images are always drawn with the bilinear interpolation.
+     * @note Experimental API
+     */
+    Result filter(FilterMethod method) noexcept;
+
+    /**
+     * @brief Gets the sampling method of the bitmap image.
+     *
+     * @return The filter method.
+     *
+     * @note Experimental API
+     */
+    FilterMethod filter() const noexcept;
+
     /**
      * @brief Loads raw data in ARGB8888 format from a memory block of the given size.
      *
@@ -1323,10 +1436,75 @@ public:
      * @param[in] premultiplied If @c true, the given image data is alpha-premultiplied.
      * @param[in] copy If @c true the data are copied into the engine local buffer, otherwise they are not.
      *
+     * @retval Result::InsufficientCondition In case the picture is loaded already.
+     *
      * @since 0.9
      */
     Result load(uint32_t* data, uint32_t w, uint32_t h, bool copy) noexcept;
 
+    /**
+     * @brief Loads raw data of the given layout and colorspace, for instance a part of a larger buffer or a video frame.
+     *
+     * The @p data is never modified. Without the @p copy, it's drawn directly as long as it's alpha-premultiplied
+     * in the channel order of the canvas, otherwise only the visible part is converted in a buffer of the engine on each update.
+     *
+     * Unlike the other load() methods, it can be called again for the next frame of the picture loaded with it,
+     * the picture is updated with the new data without being loaded again. The data of the previous frame is not used any more.
+     * A frame shared by the pictures loading the same data, in ARGB8888 of the @p w stride without the @p copy, is not replaced.
+     *
+     * @param[in] data A pointer to the first pixel of the image.
+     * @param[in] w The width of the image in pixels.
+     * @param[in] h The height of the image in pixels.
+     * @param[in] stride The distance of the rows of the @p data in pixels. It must not be less than the @p w.
+     * @param[in] cs The colorspace of the @p data, one of the SwCanvas::Colorspace.
+     * @param[in] copy If @c true the data are copied into the engine local buffer, otherwise they are not.
+     *
+     * @retval Result::InvalidArguments In case the @p stride is less than the @p w or the @p cs is unknown.
+     * @retval Result::InsufficientCondition In case the picture is loaded from another source already.
+     *
+     * @note The data must stay valid and unchanged while the canvas draws it, without the @p copy.
+     * @note Experimental API
+     */
+    Result load(uint32_t* data, uint32_t w, uint32_t h, uint32_t stride, uint32_t cs, bool copy) noexcept;
+
+    /**
+     * @brief Starts loading a picture progressively from the data delivered in chunks.
+     *
+     * The data is given with feed() as it arrives, for instance from a network stream.
+     * The picture presents the content parsed so far, so a large document shows up partially
+     * without waiting for the whole data.
+     *
+     * @param[in] mimeType Mimetype or extension of the data. Only "svg" and "svg+xml" are supported.
+     * @param[in] func The function called when new content is added to the picture. Update the canvas to draw it.
+     * @param[in] data The user data passed to the @p func.
+     *
+     * @retval Result::InsufficientCondition In case the picture is loaded already.
+     * @retval Result::NonSupport When the @p mimeType doesn't support the progressive loading.
+     *
+     * @note The SVG elements are added in the document order, once they are closed and their references are resolved.
+     *       The size of the picture is known with the viewBox of the document, otherwise the content is presented at the end.
+     * @see Picture::feed()
+     * @note Experimental API
+     */
+    Result stream(const std::string& mimeType, std::function<void(Picture* picture, void* data)> func = nullptr, void* data = nullptr) noexcept;
+
+    /**
+     * @brief Feeds the next chunk of the data of the progressive loading.
+     *
+     * The data is parsed right away in the calling thread. A markup cut off by the end of the chunk waits for the following one.
+     *
+     * @param[in] data A pointer to the chunk of the data. It's copied as needed, so it can be released after the call.
+     * @param[in] size The size in bytes of the @p data.
+     * @param[in] last If @c true, this is the final chunk and the loading is completed.
+     *
+     * @retval Result::InsufficientCondition In case the progressive loading is not started with stream(), or completed already.
+     * @retval Result::InvalidArguments In case the data is invalid.
+     *
+     * @see Picture::stream()
+     * @note Experimental API
+     */
+    Result feed(const char* data, uint32_t size, bool last = false) noexcept;
+
     /**
      * @brief Retrieve a paint object from the Picture scene by its Unique ID.
      *
@@ -1858,6 +2036,79 @@ public:
 };
 
 
+/**
+ * @class ImageCache
+ *
+ * @brief The process-wide cache of the decoded raster images.
+ *
+ * When a Picture of an image is deleted, its decoded bitmap is kept in the cache instead of being freed.
+ * A Picture loaded again from the same source, that is the same path or the same content of the data,
+ * takes the bitmap back without decoding, provided that it's drawn in the same size and colorspace.
+ * The cached bitmaps share a memory budget, the least recently cached ones are freed over it.
+ *
+ * @note Experimental API
+ */
+class TVG_API ImageCache final
+{
+public:
+    /**
+     * @brief Sets the memory budget of the cached bitmaps.
+     *
+     * @param[in] bytes The memory size in bytes. Zero disables the cache. The default is 64MB.
+     *
+     * @note The bitmaps over the new budget are freed right away, except the pinned ones.
+     * @note Experimental API
+     */
+    static Result budget(size_t bytes) noexcept;
+
+    /**
+     * @brief Keeps the bitmaps of the image file in the cache regardless of the budget.
+     *
+     * @param[in] path The path of the image file, as it's given to Picture::load().
+     * @param[in] pinned If @c false, the image is subject to the budget again.
+     *
+     * @retval Result::InvalidArguments In case the @p path is empty.
+     *
+     * @note Experimental API
+     */
+    static Result pin(const std::string& path, bool pinned = true) noexcept;
+
+    /**
+     * @brief Keeps the bitmaps of the image data in the cache regardless of the budget.
+     *
+     * @param[in] data A pointer to the encoded image data. The content identifies the image, not the pointer.
+     * @param[in] size The size in bytes of the @p data.
+     * @param[in] pinned If @c false, the image is subject to the budget again.
+     *
+     * @retval Result::InvalidArguments In case the @p data is @c nullptr or the @p size is zero.
+     *
+     * @note Experimental API
+     */
+    static Result pin(const char* data, uint32_t size, bool pinned = true) noexcept;
+
+    /**
+     * @brief Retrieves the usage of the cache.
+     *
+     * @param[out] hits The number of the images taken from the cache.
+     * @param[out] misses The number of the images decoded since they were not in the cache.
+     * @param[out] bytes The memory size in bytes of the cached bitmaps.
+     *
+     * @note Experimental API
+     */
+    static Result stats(uint64_t* hits, uint64_t* misses, size_t* bytes) noexcept;
+
+    /**
+     * @brief Frees the cached bitmaps, except the pinned ones.
+     *
+     * @note The pictures in use keep their bitmaps.
+     * @note Experimental API
+     */
+    static Result clear() noexcept;
+
+    _TVG_DISABLE_CTOR(ImageCache);
+};
+
+
 /**
  * @class Animation
  *
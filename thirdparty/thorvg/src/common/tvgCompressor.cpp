@@ -59,6 +59,15 @@
 
 #include <string>
 #include <memory.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define B64_SSE2_DECODE
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define B64_NEON_DECODE
+#endif
+
 #include "tvgCompressor.h"
 
 namespace tvg {
@@ -424,6 +433,91 @@ uint8_t* lzwEncode(const uint8_t* uncompressed, uint32_t uncompressedSizeBytes,
 /* B64 Implementation                                                   */
 /************************************************************************/
 
+#if defined(B64_SSE2_DECODE) || defined(B64_NEON_DECODE)
+
+//Writes the 4 sextets of each 32bit lane as 3 bytes.
+static inline void _b64Pack(const uint32_t* lanes, char* output)
+{
+    for (int i = 0; i < 4; ++i) {
+        auto v = lanes[i];
+        auto bits = ((v & 0xff) << 18) | (((v >> 8) & 0xff) << 12) | (((v >> 16) & 0xff) << 6) | (v >> 24);
+        output[0] = char(bits >> 16);
+        output[1] = char(bits >> 8);
+        output[2] = char(bits);
+        output += 3;
+    }
+}
+
+#endif
+
+#ifdef B64_SSE2_DECODE
+
+//Decodes 16 characters to 12 bytes, fails if any of them is out of the alphabet (padding, spaces, etc)
+static inline bool _b64Block(const char* encoded, char* output)
+{
+    auto in = _mm_loadu_si128((const __m128i*)encoded);
+
+    //signed comparison rejects the non-ascii characters as well
+    auto upper = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(in, _mm_set1_epi8('Z' + 1)));
+    auto lower = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('a' - 1)), _mm_cmplt_epi8(in, _mm_set1_epi8('z' + 1)));
+    auto digit = _mm_and_si128(_mm_cmpgt_epi8(in, _mm_set1_epi8('0' - 1)), _mm_cmplt_epi8(in, _mm_set1_epi8('9' + 1)));
+    auto plus = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('+')), _mm_cmpeq_epi8(in, _mm_set1_epi8('-')));
+    auto slash = _mm_or_si128(_mm_cmpeq_epi8(in, _mm_set1_epi8('/')), _mm_cmpeq_epi8(in, _mm_set1_epi8('_')));
+
+    auto valid = _mm_or_si128(_mm_or_si128(upper, lower), _mm_or_si128(_mm_or_si128(digit, plus), slash));
+    if (_mm_movemask_epi8(valid) != 0xffff) return false;
+
+    auto v = _mm_and_si128(upper, _mm_sub_epi8(in, _mm_set1_epi8('A')));
+    v = _mm_or_si128(v, _mm_and_si128(lower, _mm_sub_epi8(in, _mm_set1_epi8('a' - 26))));
+    v = _mm_or_si128(v, _mm_and_si128(digit, _mm_add_epi8(in, _mm_set1_epi8(52 - '0'))));
+    v = _mm_or_si128(v, _mm_and_si128(plus, _mm_set1_epi8(62)));
+    v = _mm_or_si128(v, _mm_and_si128(slash, _mm_set1_epi8(63)));
+
+    uint32_t lanes[4];
+    _mm_storeu_si128((__m128i*)lanes, v);
+    _b64Pack(lanes, output);
+
+    return true;
+}
+
+#elif defined(B64_NEON_DECODE)
+
+static inline bool _b64Block(const char* encoded, char* output)
+{
+    auto in = vld1q_u8((const uint8_t*)encoded);
+
+    auto upper = vandq_u8(vcgeq_u8(in, vdupq_n_u8('A')), vcleq_u8(in, vdupq_n_u8('Z')));
+    auto lower = vandq_u8(vcgeq_u8(in, vdupq_n_u8('a')), vcleq_u8(in, vdupq_n_u8('z')));
+    auto digit = vandq_u8(vcgeq_u8(in, vdupq_n_u8('0')), vcleq_u8(in, vdupq_n_u8('9')));
+    auto plus = vorrq_u8(vceqq_u8(in, vdupq_n_u8('+')), vceqq_u8(in, vdupq_n_u8('-')));
+    auto slash = vorrq_u8(vceqq_u8(in, vdupq_n_u8('/')), vceqq_u8(in, vdupq_n_u8('_')));
+
+    auto valid = vorrq_u8(vorrq_u8(upper, lower), vorrq_u8(vorrq_u8(digit, plus), slash));
+    auto folded = vand_u8(vget_low_u8(valid), vget_high_u8(valid));
+    if (vget_lane_u64(vreinterpret_u64_u8(folded), 0) != UINT64_MAX) return false;
+
+    auto v = vandq_u8(upper, vsubq_u8(in, vdupq_n_u8('A')));
+    v = vorrq_u8(v, vandq_u8(lower, vsubq_u8(in, vdupq_n_u8('a' - 26))));
+    v = vorrq_u8(v, vandq_u8(digit, vaddq_u8(in, vdupq_n_u8(52 - '0'))));
+    v = vorrq_u8(v, vandq_u8(plus, vdupq_n_u8(62)));
+    v = vorrq_u8(v, vandq_u8(slash, vdupq_n_u8(63)));
+
+    uint32_t lanes[4];
+    vst1q_u8((uint8_t*)lanes, v);
+    _b64Pack(lanes, output);
+
+    return true;
+}
+
+#else
+
+static inline bool _b64Block(const char*, char*)
+{
+    return false;
+}
+
+#endif
+
 
 size_t b64Decode(const char* encoded, const size_t len, char** decoded)
 {
@@ -447,6 +541,7 @@ size_t b64Decode(const char* encoded, const size_t len, char** decoded)
     output[reserved - 1] = '\0';
 
     size_t idx = 0;
+    auto end = encoded + len;
 
     while (*encoded && *(encoded + 1)) {
         if (*encoded <= 0x20) {
@@ -454,16 +549,24 @@ size_t b64Decode(const char* encoded, const size_t len, char** decoded)
             continue;
         }
 
-        auto value1 = B64_INDEX[(size_t)encoded[0]];
-        auto value2 = B64_INDEX[(size_t)encoded[1]];
+        //the bulk of the data is a run of the plain characters, decode them 16 at once.
+        while (end - encoded >= 16 && _b64Block(encoded, output + idx)) {
+            encoded += 16;
+            idx += 12;
+        }
+        if (!*encoded || !*(encoded + 1)) break;
+        if (*encoded <= 0x20) continue;
+
+        auto value1 = B64_INDEX[(uint8_t)encoded[0]];
+        auto value2 = B64_INDEX[(uint8_t)encoded[1]];
         output[idx++] = (value1 << 2) + ((value2 & 0x30) >> 4);
 
         if (!encoded[2] || encoded[3] < 0 || encoded[2] == '=' || encoded[2] == '.') break;
-        auto value3 = B64_INDEX[(size_t)encoded[2]];
+        auto value3 = B64_INDEX[(uint8_t)encoded[2]];
         output[idx++] = ((value2 & 0x0f) << 4) + ((value3 & 0x3c) >> 2);
 
         if (!encoded[3] || encoded[3] < 0 || encoded[3] == '=' || encoded[3] == '.') break;
-        auto value4 = B64_INDEX[(size_t)encoded[3]];
+        auto value4 = B64_INDEX[(uint8_t)encoded[3]];
         output[idx++] = ((value3 & 0x03) << 6) + value4;
         encoded += 4;
     }
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifdef _WIN32
+    #ifndef WIN32_LEAN_AND_MEAN
+        #define WIN32_LEAN_AND_MEAN
+    #endif
+    #ifndef NOMINMAX
+        #define NOMINMAX
+    #endif
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <cstdlib>
+#include "tvgFile.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+static uint32_t _pageSize()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    return static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+#endif
+}
+
+
+/* The rest of the last page is filled with zeros, it terminates the content
+   unless the file ends at the page boundary. */
+static char* _map(const char* path, uint32_t& size, bool writable, bool terminated)
+{
+    char* data = nullptr;
+
+#ifdef _WIN32
+    auto file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) return nullptr;
+
+    LARGE_INTEGER len;
+    if (GetFileSizeEx(file, &len) && len.QuadPart > 0 && len.QuadPart < UINT32_MAX && !(terminated && len.QuadPart % _pageSize() == 0)) {
+        if (auto mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr)) {
+            data = static_cast<char*>(MapViewOfFile(mapping, writable ? FILE_MAP_COPY : FILE_MAP_READ, 0, 0, 0));
+            size = static_cast<uint32_t>(len.QuadPart);
+            CloseHandle(mapping);
+        }
+    }
+    CloseHandle(file);
+#else
+    auto fd = ::open(path, O_RDONLY);
+    if (fd < 0) return nullptr;
+
+    struct stat info;
+    if (fstat(fd, &info) == 0 && info.st_size > 0 && info.st_size < UINT32_MAX && !(terminated && info.st_size % _pageSize() == 0)) {
+        auto ptr = mmap(nullptr, info.st_size, writable ? (PROT_READ | PROT_WRITE) : PROT_READ, MAP_PRIVATE, fd, 0);
+        if (ptr != MAP_FAILED) {
+            data = static_cast<char*>(ptr);
+            size = static_cast<uint32_t>(info.st_size);
+        }
+    }
+    close(fd);
+#endif
+
+    return data;
+}
+
+
+static uint64_t _mtime(const char* path)
+{
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA info;
+    if (!GetFileAttributesExA(path, GetFileExInfoStandard, &info)) return 0;
+    return (uint64_t(info.ftLastWriteTime.dwHighDateTime) << 32) | info.ftLastWriteTime.dwLowDateTime;
+#else
+    struct stat info;
+    if (stat(path, &info) != 0) return 0;
+    #ifdef __APPLE__
+        return uint64_t(info.st_mtimespec.tv_sec) * 1000000000ULL + info.st_mtimespec.tv_nsec;
+    #else
+        return uint64_t(info.st_mtim.tv_sec) * 1000000000ULL + info.st_mtim.tv_nsec;
+    #endif
+#endif
+}
+
+
+static void _unmap(char* data, uint32_t size)
+{
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+#else
+    munmap(data, size);
+#endif
+}
+
+
+static char* _read(const char* path, uint32_t& size)
+{
+    auto f = fopen(path, "rb");
+    if (!f) return nullptr;
+
+    fseek(f, 0, SEEK_END);
+    auto len = ftell(f);
+    if (len <= 0 || len >= UINT32_MAX) {
+        fclose(f);
+        return nullptr;
+    }
+
+    auto content = (char*)malloc(len + 1);
+    fseek(f, 0, SEEK_SET);
+    if (!content || fread(content, sizeof(char), len, f) < (size_t)len) {
+        fclose(f);
+        free(content);
+        return nullptr;
+    }
+    content[len] = '\0';
+    size = static_cast<uint32_t>(len);
+
+    fclose(f);
+
+    return content;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+namespace tvg {
+
+bool FileView::open(const char* path, bool writable, bool terminated)
+{
+    close();
+
+    mtime = _mtime(path);
+
+    if ((data = _map(path, size, writable, terminated))) {
+        mapped = true;
+        return true;
+    }
+
+    //the file system doesn't allow the mapping or the file needs a terminator
+    data = _read(path, size);
+    return data != nullptr;
+}
+
+
+void FileView::close()
+{
+    if (!data) return;
+
+    if (mapped) _unmap(data, size);
+    else free(data);
+
+    data = nullptr;
+    size = 0;
+    mtime = 0;
+    mapped = false;
+}
+
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _TVG_FILE_H_
+#define _TVG_FILE_H_
+
+#include <cstdint>
+
+namespace tvg
+{
+
+/* The whole content of a file for the loaders.
+   The file is mapped to the memory if possible, otherwise it's read into a heap buffer. */
+struct FileView
+{
+    char* data = nullptr;
+    uint32_t size = 0;
+    uint64_t mtime = 0;                 //the last modification time of the file in the system unit, zero if unknown
+
+    /* writable: the content may be modified in place (ex. in-situ parsing), the changes are private to this view.
+       terminated: the content must be followed by a null character. */
+    bool open(const char* path, bool writable = false, bool terminated = false);
+    void close();
+
+    ~FileView()
+    {
+        close();
+    }
+
+private:
+    bool mapped = false;
+};
+
+}
+
+#endif //_TVG_FILE_H_
@@ -38,6 +38,79 @@ static inline bool _floatExact(float a, float b)
 }
 
 
+static inline bool _isDigit(char c)
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+
+/* The quotient of the exact operands is correctly rounded in double, narrowing it rounds once more.
+   That second rounding goes wrong only if the double lands on (or next to) a midpoint between two floats,
+   then the side of the exact quotient is decided by the residual m - h * p, computed exactly with fma(). */
+static float _narrowQuotient(double m, double p)
+{
+    constexpr uint64_t LOW = (1ULL << 29) - 1;      //the double bits below the float precision
+    constexpr uint64_t HALF = 1ULL << 28;
+
+    auto d = m / p;
+    uint64_t bits;
+    memcpy(&bits, &d, sizeof(d));
+    auto low = bits & LOW;
+    if (low + 1 < HALF || low > HALF + 1) return static_cast<float>(d);
+
+    //the floats around the midpoint h
+    double h, trunc;
+    auto hbits = (bits & ~LOW) | HALF;
+    auto tbits = bits & ~LOW;
+    memcpy(&h, &hbits, sizeof(h));
+    memcpy(&trunc, &tbits, sizeof(trunc));
+    auto below = static_cast<float>(trunc);
+    auto above = nextafterf(below, INFINITY);
+
+    //h * p == prod + err exactly, m - prod is exact as both are close
+    auto prod = h * p;
+    auto err = fma(h, p, -prod);
+    auto diff = m - prod;
+    if (diff > err) return above;
+    if (diff < err) return below;
+
+    //a tie, to the even one
+    uint32_t fbits;
+    memcpy(&fbits, &below, sizeof(below));
+    return (fbits & 1) ? above : below;
+}
+
+
+/* Plain decimals without an exponent are the most of the inputs (coordinates, lengths, opacities).
+   Their mantissa and the power of ten are exact if the mantissa fits in 53 bits and the scale is up to 10^22,
+   the quotient is correctly rounded to float then: in a single float division for the short ones,
+   in a double division followed by an exact narrowing for the others.
+   Returns false for anything else to take the generic path, which isn't correctly rounded. */
+static bool _strToFloatFast(const char* iter, char** endPtr, int minus, float* val)
+{
+    static constexpr float POW10F[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+    static constexpr double POW10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+    auto p = iter;
+    uint64_t mantissa = 0;
+    int digits = 0, scale = 0;
+
+    for (; _isDigit(*p); ++p, ++digits) mantissa = mantissa * 10 + (*p - '0');
+    if (*p == '.') {
+        for (++p; _isDigit(*p); ++p, ++scale) mantissa = mantissa * 10 + (*p - '0');
+        digits += scale;
+    }
+
+    if (digits == 0 || digits > 19 || scale > 22 || !_isDigit(p[-1]) || *p == 'e' || *p == 'E' || mantissa > (1ULL << 53)) return false;
+
+    //both operands are exact in float up to 2^24 and 10^10
+    if (mantissa <= (1 << 24) && scale <= 10) *val = static_cast<float>(minus) * (static_cast<float>(mantissa) / POW10F[scale]);
+    else *val = static_cast<float>(minus) * _narrowQuotient(static_cast<double>(mantissa), POW10[scale]);
+    if (endPtr) *endPtr = (char *)(p);
+    return true;
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -78,6 +151,8 @@ float strToFloat(const char *nPtr, char **endPtr)
         iter++;
     }
 
+    if (_strToFloatFast(iter, endPtr, minus, &val)) return val;
+
     if (tolower(*iter) == 'i') {
         if ((tolower(*(iter + 1)) == 'n') && (tolower(*(iter + 2)) == 'f')) iter += 3;
         else goto error;
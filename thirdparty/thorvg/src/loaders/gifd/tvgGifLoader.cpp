@@ -0,0 +1,213 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <memory.h>
+#include "tvgGifLoader.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+//the pixels are decoded in the order of the desired colorspace, no conversion is needed afterwards
+static ColorSpace _colorSpace()
+{
+    if (ImageLoader::cs == ColorSpace::ABGR8888 || ImageLoader::cs == ColorSpace::ABGR8888S) return ColorSpace::ABGR8888;
+    return ColorSpace::ARGB8888;
+}
+
+
+bool GifLoader::GifFrames::decode(uint32_t index, uint32_t* dst, uint32_t stride)
+{
+    return gifdDecompress(decoder, index, dst, stride, abgr);
+}
+
+
+bool GifLoader::header(const char* data, uint32_t size)
+{
+    uint32_t width, height, count;
+    frames.decoder = gifdHeader(data, size, &width, &height, &count);
+    if (!frames.decoder) return false;
+
+    frames.frames.reserve(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        auto info = gifdFrame(frames.decoder, i);
+        //the browsers show the frames of no delay for 1/10 seconds, the animations are made for it
+        auto delay = (info->delay < 2) ? 10 : info->delay;
+        //the transparent pixels of a frame show the canvas under it, always blended
+        frames.frames.push({{int32_t(info->x), int32_t(info->y), int32_t(info->w), int32_t(info->h)}, delay, FrameDispose(info->dispose), true});
+    }
+
+    w = static_cast<float>(width);
+    h = static_cast<float>(height);
+
+    //the frame state is of this loader, the other pictures can't share it
+    if (animatable()) exclusive = true;
+
+    return true;
+}
+
+
+void GifLoader::clear()
+{
+    gifdDelete(frames.decoder);
+    if (freeData) free(data);
+    file.close();
+    frames.decoder = nullptr;
+    data = nullptr;
+    freeData = false;
+}
+
+
+//takes the bitmap decoded by a closed loader of the same source instead of decoding it again
+bool GifLoader::recall()
+{
+    if (!source) source = BitmapCache::key(data, size);
+    if (!BitmapCache::take(source, revision, static_cast<uint32_t>(w), static_cast<uint32_t>(h), _colorSpace(), &surface)) return false;
+
+    clear();
+    return true;
+}
+
+
+void GifLoader::run(unsigned tid)
+{
+    auto cs = _colorSpace();
+    frames.abgr = (cs == ColorSpace::ABGR8888);
+
+    if (frames.init(&surface, static_cast<uint32_t>(w), static_cast<uint32_t>(h), cs)) {
+        frames.seek(0.0f);
+    }
+
+    //the animation decodes the next frames from the data
+    if (!animatable()) clear();
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+GifLoader::GifLoader() : FrameModule(FileType::Gif)
+{
+
+}
+
+
+GifLoader::~GifLoader()
+{
+    this->done();
+    auto animated = animatable();
+    clear();
+    if (animated || !BitmapCache::park(source, revision, &surface)) free(surface.buf32);
+}
+
+
+bool GifLoader::open(const string& path)
+{
+    if (!file.open(path.c_str())) return false;
+
+    size = file.size;
+    source = BitmapCache::key(path.c_str());
+    revision = BitmapCache::tag(file.size, file.mtime);
+
+    return header(file.data, file.size);
+}
+
+
+bool GifLoader::open(const char* data, uint32_t size, bool copy)
+{
+    if (copy) {
+        this->data = (char *) malloc(size);
+        if (!this->data) return false;
+        memcpy((char *)this->data, data, size);
+        freeData = true;
+    } else {
+        this->data = (char *) data;
+        freeData = false;
+    }
+
+    this->size = size;
+    revision = size;
+
+    return header(this->data, size);
+}
+
+
+bool GifLoader::read()
+{
+    if (!LoadModule::read()) return true;
+
+    if (!frames.decoder || w == 0 || h == 0) return false;
+
+    if (!animatable() && recall()) return true;
+
+    TaskScheduler::request(this);
+
+    return true;
+}
+
+
+bool GifLoader::close()
+{
+    if (!LoadModule::close()) return false;
+    this->done();
+    return true;
+}
+
+
+RenderSurface* GifLoader::bitmap()
+{
+    this->done();
+    return ImageLoader::bitmap();
+}
+
+
+bool GifLoader::animatable()
+{
+    return frames.frames.count > 1;
+}
+
+
+bool GifLoader::frame(float no)
+{
+    this->done();
+    return frames.seek(no + frames.total() * segmentBegin);
+}
+
+
+float GifLoader::totalFrame()
+{
+    return (segmentEnd - segmentBegin) * frames.total();
+}
+
+
+float GifLoader::curFrame()
+{
+    return frames.current() - frames.total() * segmentBegin;
+}
+
+
+float GifLoader::duration()
+{
+    return frames.total() * (segmentEnd - segmentBegin) / 100.0f;
+}
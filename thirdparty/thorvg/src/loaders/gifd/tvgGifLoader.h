@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef _TVG_GIF_LOADER_H_
+#define _TVG_GIF_LOADER_H_
+
+#include "tvgFrameModule.h"
+#include "tvgTaskScheduler.h"
+#include "tvgImageCache.h"
+#include "tvgImageFrames.h"
+#include "tvgGifd.h"
+#include "tvgFile.h"
+
+class GifLoader : public FrameModule, public Task
+{
+private:
+    struct GifFrames : ImageFrames
+    {
+        gif_decoder* decoder = nullptr;
+        bool abgr = false;
+
+        bool decode(uint32_t index, uint32_t* dst, uint32_t stride) override;
+    } frames;
+
+    char* data = nullptr;
+    uint32_t size = 0;
+    uint64_t source = 0;            //the key of the decoded bitmap in the BitmapCache, a still image only
+    uint64_t revision = 0;          //the tag of the source in the BitmapCache, see BitmapCache::tag()
+    FileView file;
+    bool freeData = false;
+
+    bool header(const char* data, uint32_t size);
+    void clear();
+    bool recall();
+    void run(unsigned tid) override;
+
+public:
+    GifLoader();
+    ~GifLoader();
+
+    bool open(const string& path) override;
+    bool open(const char* data, uint32_t size, bool copy) override;
+    bool read() override;
+    bool close() override;
+
+    RenderSurface* bitmap() override;
+    bool animatable() override;
+
+    bool frame(float no) override;
+    float totalFrame() override;
+    float curFrame() override;
+    float duration() override;
+};
+
+#endif //_TVG_GIF_LOADER_H_
@@ -0,0 +1,358 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <cstring>
+#include <cstdlib>
+#include <algorithm>
+#include "tvgCommon.h"
+#include "tvgArray.h"
+#include "tvgGifd.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+struct GifImage
+{
+    gif_frame frame;                        //clipped to the screen
+    uint32_t w, h;                          //the size of the image descriptor
+    const uint8_t* palette;                 //rgb triples
+    uint32_t paletteSize;
+    int32_t transparent;                    //the transparent index, -1 if none
+    const uint8_t* data;                    //the sub-blocks of the lzw codes
+    uint8_t codeSize;                       //the minimum code size
+    bool interlace;
+};
+
+
+struct gif_decoder
+{
+    uint32_t w, h;
+    const uint8_t* end;
+    Array<GifImage> images;
+};
+
+
+//the pixels of the image in the stream order, only the ones on the screen are written
+struct GifRows
+{
+    uint32_t* dst;
+    uint32_t stride;
+    const uint32_t* lut;
+    uint32_t w, h;                          //the image
+    uint32_t cw, ch;                        //the part on the screen
+    uint32_t x = 0, y = 0;
+    uint8_t pass = 0;                       //of the interlaced rows
+    bool interlace;
+
+    //false if the image is complete
+    bool push(const uint8_t* indices, uint32_t len)
+    {
+        static constexpr uint8_t START[4] = {0, 4, 2, 1};
+        static constexpr uint8_t STEP[4] = {8, 8, 4, 2};
+
+        while (len > 0) {
+            auto cnt = std::min(len, w - x);
+            if (y < ch && x < cw) {
+                auto out = dst + y * size_t(stride);
+                auto last = std::min(x + cnt, cw);
+                for (auto i = x; i < last; ++i) out[i] = lut[indices[i - x]];
+            }
+            indices += cnt;
+            len -= cnt;
+            x += cnt;
+            if (x < w) break;
+            x = 0;
+            if (interlace) {
+                y += STEP[pass];
+                while (y >= h && pass < 3) y = START[++pass];
+            } else {
+                ++y;
+            }
+            if (y >= h) return false;
+        }
+        return true;
+    }
+};
+
+
+//the variable length codes of the image, packed in the sub-blocks of up to 255 bytes, GIF89a Appendix F
+struct Lzw
+{
+    static constexpr uint32_t MAX_CODES = 4096;
+
+    uint16_t prefix[MAX_CODES];
+    uint8_t suffix[MAX_CODES];
+    uint8_t first[MAX_CODES];
+    uint16_t length[MAX_CODES];
+    uint8_t stack[MAX_CODES];               //a string in order
+
+    const uint8_t* p;
+    const uint8_t* end;
+    uint32_t remain = 0;                    //the bytes left in the sub-block
+    uint32_t bits = 0;
+    uint32_t count = 0;                     //the bits in the buffer
+
+    int32_t code(uint32_t size)
+    {
+        while (count < size) {
+            if (remain == 0) {
+                if (p >= end || *p == 0) return -1;
+                remain = *p++;
+            }
+            if (p >= end) return -1;
+            bits |= uint32_t(*p++) << count;
+            count += 8;
+            --remain;
+        }
+        auto ret = bits & ((1 << size) - 1);
+        bits >>= size;
+        count -= size;
+        return int32_t(ret);
+    }
+
+    //the decoded indices over the pixels are dropped, the missing ones are left untouched
+    bool run(const GifImage& image, const uint8_t* end, GifRows& out)
+    {
+        auto minSize = image.codeSize;
+        if (minSize < 2 || minSize > 8) return false;
+
+        p = image.data;
+        this->end = end;
+
+        auto clear = 1u << minSize;
+        auto eoi = clear + 1;
+        for (uint32_t i = 0; i < clear; ++i) {
+            prefix[i] = 0;
+            suffix[i] = first[i] = uint8_t(i);
+            length[i] = 1;
+        }
+        auto size = minSize + 1u;
+        auto next = clear + 2;
+        int32_t prev = -1;
+
+        while (true) {
+            auto c = code(size);
+            if (c < 0 || uint32_t(c) == eoi) break;
+            auto cur = uint32_t(c);
+            if (cur == clear) {
+                size = minSize + 1;
+                next = clear + 2;
+                prev = -1;
+                continue;
+            }
+            if (cur > next || (cur == next && (prev < 0 || next == MAX_CODES)) || (prev < 0 && cur >= clear)) return false;
+
+            //the new string is the previous one and the first byte of this one
+            if (prev >= 0 && next < MAX_CODES) {
+                prefix[next] = uint16_t(prev);
+                suffix[next] = (cur == next) ? first[prev] : first[cur];
+                first[next] = first[prev];
+                length[next] = length[prev] + 1;
+                if (++next == (1u << size) && size < 12) ++size;
+            }
+
+            //the string is made from its last byte by following the prefixes
+            auto len = length[cur];
+            auto i = len;
+            for (auto k = cur; i > 0; k = prefix[k]) stack[--i] = suffix[k];
+            if (!out.push(stack, len)) break;
+            prev = int32_t(cur);
+        }
+        return true;
+    }
+};
+
+
+static inline uint32_t _le16(const uint8_t* p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+
+//skips the sub-blocks, null if the data ends
+static const uint8_t* _skip(const uint8_t* p, const uint8_t* end)
+{
+    while (p < end) {
+        auto size = *p++;
+        if (size == 0) return p;
+        p += size;
+    }
+    return nullptr;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+gif_decoder* gifdHeader(const char* data, uint32_t size, uint32_t* width, uint32_t* height, uint32_t* frames)
+{
+    auto p = reinterpret_cast<const uint8_t*>(data);
+    auto end = p + size;
+    if (size < 13 || (memcmp(p, "GIF87a", 6) && memcmp(p, "GIF89a", 6))) return nullptr;
+
+    auto d = new gif_decoder;
+    d->w = _le16(p + 6);
+    d->h = _le16(p + 8);
+    d->end = end;
+    auto flags = p[10];
+    p += 13;
+
+    const uint8_t* global = nullptr;
+    uint32_t globalSize = 0;
+    if (flags & 0x80) {
+        globalSize = 2u << (flags & 0x07);
+        global = p;
+        p += globalSize * 3;
+    }
+
+    //the graphic control of the next image
+    uint32_t delay = 0;
+    uint8_t dispose = 0;
+    int32_t transparent = -1;
+
+    while (p && p < end) {
+        auto block = *p++;
+        if (block == 0x3b) break;
+        if (block == 0x21) {
+            if (p + 1 >= end) break;
+            auto label = *p++;
+            if (label == 0xf9 && p + 5 < end && p[0] == 4) {
+                auto packed = p[1];
+                delay = _le16(p + 2);
+                transparent = (packed & 0x01) ? p[4] : -1;
+                dispose = (packed >> 2) & 0x07;
+            }
+            p = _skip(p, end);
+        } else if (block == 0x2c) {
+            if (p + 10 > end) break;
+            GifImage image;
+            image.frame = {_le16(p), _le16(p + 2), 0, 0, delay, 0};
+            image.w = _le16(p + 4);
+            image.h = _le16(p + 6);
+            //only the part on the screen is drawn, the browsers do so
+            if (image.frame.x < d->w && image.frame.y < d->h) {
+                image.frame.w = std::min(image.w, d->w - image.frame.x);
+                image.frame.h = std::min(image.h, d->h - image.frame.y);
+            } else {
+                image.frame.x = image.frame.y = 0;
+            }
+            //the disposals 4 to 7 are not defined, they are left as none
+            if (dispose == 2) image.frame.dispose = 1;
+            else if (dispose == 3) image.frame.dispose = 2;
+            auto packed = p[8];
+            p += 9;
+            image.interlace = (packed & 0x40) != 0;
+            image.transparent = transparent;
+            if (packed & 0x80) {
+                image.paletteSize = 2u << (packed & 0x07);
+                image.palette = p;
+                p += image.paletteSize * 3;
+            } else {
+                image.paletteSize = globalSize;
+                image.palette = global;
+            }
+            if (p >= end) break;
+            image.codeSize = *p++;
+            image.data = p;
+            p = _skip(p, end);
+            if (image.w > 0 && image.h > 0 && image.palette) d->images.push(image);
+            delay = 0;
+            dispose = 0;
+            transparent = -1;
+        } else {
+            break;
+        }
+    }
+
+    //the palettes are read on the decoding
+    if (d->w == 0 || d->h == 0 || d->w > (1 << 28) / d->h || d->images.count == 0 || global + globalSize * 3 > end) {
+        delete(d);
+        return nullptr;
+    }
+    for (auto image = d->images.begin(); image < d->images.end(); ++image) {
+        if (image->palette + image->paletteSize * 3 > end) {
+            delete(d);
+            return nullptr;
+        }
+    }
+
+    *width = d->w;
+    *height = d->h;
+    *frames = d->images.count;
+    return d;
+}
+
+
+const gif_frame* gifdFrame(const gif_decoder* d, uint32_t index)
+{
+    if (!d || index >= d->images.count) return nullptr;
+    return &d->images[index].frame;
+}
+
+
+bool gifdDecompress(gif_decoder* d, uint32_t index, uint32_t* dst, uint32_t stride, bool abgr)
+{
+    if (!d || !dst || index >= d->images.count) return false;
+
+    auto& image = d->images[index];
+    if (stride < image.frame.w) return false;
+
+    uint32_t lut[256];
+    for (uint32_t i = 0; i < 256; ++i) {
+        if (i >= image.paletteSize || int32_t(i) == image.transparent) {
+            lut[i] = 0;
+            continue;
+        }
+        auto c = image.palette + i * 3;
+        if (abgr) lut[i] = 0xff000000 | (c[2] << 16) | (c[1] << 8) | c[0];
+        else lut[i] = 0xff000000 | (c[0] << 16) | (c[1] << 8) | c[2];
+    }
+
+    //the pixels missing in the data are transparent
+    for (uint32_t y = 0; y < image.frame.h; ++y) {
+        memset(dst + y * size_t(stride), 0, image.frame.w * sizeof(uint32_t));
+    }
+
+    GifRows rows;
+    rows.dst = dst;
+    rows.stride = stride;
+    rows.lut = lut;
+    rows.w = image.w;
+    rows.h = image.h;
+    rows.cw = image.frame.w;
+    rows.ch = image.frame.h;
+    rows.interlace = image.interlace;
+
+    auto lzw = new Lzw;
+    auto ret = lzw->run(image, d->end, rows);
+    delete(lzw);
+    return ret;
+}
+
+
+void gifdDelete(gif_decoder* decoder)
+{
+    delete(decoder);
+}
@@ -27,22 +27,58 @@
 /* Internal Class Implementation                                        */
 /************************************************************************/
 
+//the images larger than this are decoded in tiles, unless they are progressive
+static constexpr float TILED_SIZE = 4096.0f * 4096.0f;
+
+
+struct JpgTiles : ImageTiles
+{
+    const char* data;
+    uint32_t size;
+
+    //the levels 0 to 3 are decoded at the scales 1, 1/2, 1/4 and 1/8
+    JpgTiles(const char* data, uint32_t size, uint32_t w, uint32_t h) : ImageTiles(w, h, 4), data(data), size(size) {}
+
+    bool decode(const RenderRegion& region, uint32_t level, uint32_t* dst, uint32_t stride) override
+    {
+        auto decoder = jpgdHeader(data, size, nullptr, nullptr);
+        auto ret = jpgdDecompress(decoder, 1 << level, region.x, region.y, region.w, region.h, reinterpret_cast<unsigned char*>(dst), stride * sizeof(uint32_t));
+        jpgdDelete(decoder);
+        return ret;
+    }
+};
+
+
 void JpgLoader::clear()
 {
     jpgdDelete(decoder);
     if (freeData) free(data);
+    file.close();
     decoder = nullptr;
     data = nullptr;
     freeData = false;
 }
 
 
+//takes the bitmap decoded by a closed loader of the same source instead of decoding it again
+bool JpgLoader::recall()
+{
+    if (!source) source = BitmapCache::key(data, size);
+    auto w = (static_cast<uint32_t>(this->w) + scale - 1) / scale;
+    auto h = (static_cast<uint32_t>(this->h) + scale - 1) / scale;
+    if (!BitmapCache::take(source, revision, w, h, ImageLoader::cs, &surface)) return false;
+
+    clear();
+    return true;
+}
+
+
 void JpgLoader::run(unsigned tid)
 {
-    surface.buf8 = jpgdDecompress(decoder);
-    surface.stride = static_cast<uint32_t>(w);
-    surface.w = static_cast<uint32_t>(w);
-    surface.h = static_cast<uint32_t>(h);
+    surface.buf8 = jpgdDecompress(decoder, scale);
+    surface.stride = (static_cast<uint32_t>(w) + scale - 1) / scale;
+    surface.w = surface.stride;
+    surface.h = (static_cast<uint32_t>(h) + scale - 1) / scale;
     surface.cs = ColorSpace::ARGB8888;
     surface.channelSize = sizeof(uint32_t);
     surface.premultiplied = true;
@@ -63,15 +99,22 @@ JpgLoader::JpgLoader() : ImageLoader(FileType::Jpg)
 
 JpgLoader::~JpgLoader()
 {
+    delete(surface.tiles);
     clear();
-    free(surface.buf8);
+    if (!BitmapCache::park(source, revision, &surface)) free(surface.buf8);
 }
 
 
 bool JpgLoader::open(const string& path)
 {
+    //decode the mapped file as a memory stream rather than reading it in chunks.
+    if (!file.open(path.c_str())) return false;
+
     int width, height;
-    decoder = jpgdHeader(path.c_str(), &width, &height);
+    decoder = jpgdHeader(file.data, file.size, &width, &height);
+    size = file.size;
+    source = BitmapCache::key(path.c_str());
+    revision = BitmapCache::tag(file.size, file.mtime);
     if (!decoder) return false;
 
     w = static_cast<float>(width);
@@ -93,6 +136,9 @@ bool JpgLoader::open(const char* data, uint32_t size, bool copy)
         freeData = false;
     }
 
+    this->size = size;
+    revision = size;
+
     int width, height;
     decoder = jpgdHeader(this->data, size, &width, &height);
     if (!decoder) return false;
@@ -111,12 +157,35 @@ bool JpgLoader::read()
 
     if (!decoder || w == 0 || h == 0) return false;
 
-    TaskScheduler::request(this);
+    tiled = (w * h > TILED_SIZE) && !jpgdProgressive(decoder);
+
+    //the decoding waits for the target size, see hint() and bitmap()
 
     return true;
 }
 
 
+void JpgLoader::hint(float w, float h)
+{
+    //a shared image is decoded as it is, and a tiled one at the levels of the scales
+    if (decoding || tiled || !readied || !decoder || sharing > 0) return;
+    if (w <= 0.0f || h <= 0.0f) return;
+
+    //the largest 1/2, 1/4 or 1/8 reduction not smaller than the target size
+    auto sx = w / this->w;
+    auto sy = h / this->h;
+    auto s = sx < sy ? sx : sy;
+    while (scale < 8 && s * scale * 2 <= 1.0f) scale <<= 1;
+
+    //the reduced bitmap can't serve the others any more
+    if (scale > 1) exclusive = true;
+
+    decoding = true;
+    if (recall()) return;
+    TaskScheduler::request(this);
+}
+
+
 bool JpgLoader::close()
 {
     if (!LoadModule::close()) return false;
@@ -127,6 +196,25 @@ bool JpgLoader::close()
 
 RenderSurface* JpgLoader::bitmap()
 {
+    if (tiled) {
+        if (!surface.tiles && decoder) {
+            jpgdDelete(decoder);
+            decoder = nullptr;
+            surface.tiles = new JpgTiles(data ? data : file.data, size, static_cast<uint32_t>(w), static_cast<uint32_t>(h));
+            surface.stride = surface.w = static_cast<uint32_t>(w);
+            surface.h = static_cast<uint32_t>(h);
+            surface.cs = ColorSpace::ARGB8888;
+            surface.channelSize = sizeof(uint32_t);
+            surface.premultiplied = true;
+        }
+        return ImageLoader::bitmap();
+    }
+
+    //no target size is given, decode it at the full size
+    if (!decoding && decoder) {
+        decoding = true;
+        if (!recall()) run(0);
+    }
     this->done();
     return ImageLoader::bitmap();
 }
\ No newline at end of file
@@ -25,16 +25,27 @@
 
 #include "tvgLoader.h"
 #include "tvgTaskScheduler.h"
+#include "tvgTiles.h"
+#include "tvgImageCache.h"
 #include "tvgJpgd.h"
+#include "tvgFile.h"
 
 class JpgLoader : public ImageLoader, public Task
 {
 private:
     jpeg_decoder* decoder = nullptr;
     char* data = nullptr;
+    uint32_t size = 0;
+    uint64_t source = 0;            //the key of the decoded bitmap in the BitmapCache
+    uint64_t revision = 0;          //the tag of the source in the BitmapCache, see BitmapCache::tag()
+    FileView file;
+    int scale = 1;                  //decoding reduction, 1, 2, 4 or 8
     bool freeData = false;
+    bool decoding = false;          //the decoding has been requested
+    bool tiled = false;             //decoded in the tiles of the visible regions, see JpgTiles
 
     void clear();
+    bool recall();
     void run(unsigned tid) override;
 
 public:
@@ -45,6 +56,7 @@ public:
     bool open(const char* data, uint32_t size, bool copy) override;
     bool read() override;
     bool close() override;
+    void hint(float w, float h) override;
 
     RenderSurface* bitmap() override;
 };
@@ -32,12 +32,15 @@
 // http://vision.ai.uiuc.edu/~dugad/research/dct/index.html
 
 #include <memory.h>
+#include <math.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <setjmp.h>
 #include <stdint.h>
+#include <atomic>
 
 #include "tvgCommon.h"
+#include "tvgTaskScheduler.h"
 #include "tvgJpgd.h"
 
 #ifdef _MSC_VER
@@ -49,6 +52,14 @@
   #define JPGD_NORETURN
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define JPGD_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define JPGD_NEON
+#endif
+
 /************************************************************************/
 /* Internal Class Implementation                                        */
 /************************************************************************/
@@ -82,7 +93,7 @@ enum jpgd_status
 enum
 {
     JPGD_IN_BUF_SIZE = 8192, JPGD_MAX_BLOCKS_PER_MCU = 10, JPGD_MAX_HUFF_TABLES = 8, JPGD_MAX_QUANT_TABLES = 4,
-    JPGD_MAX_COMPONENTS = 4, JPGD_MAX_COMPS_IN_SCAN = 4, JPGD_MAX_BLOCKS_PER_ROW = 8192, JPGD_MAX_HEIGHT = 16384, JPGD_MAX_WIDTH = 16384
+    JPGD_MAX_COMPONENTS = 4, JPGD_MAX_COMPS_IN_SCAN = 4, JPGD_MAX_BLOCKS_PER_ROW = 24576, JPGD_MAX_HEIGHT = 65535, JPGD_MAX_WIDTH = 65535
 };
 
 // Input stream interface.
@@ -103,6 +114,9 @@ struct jpeg_decoder_stream
     // Returns -1 on error, otherwise return the number of bytes actually written to the buffer (which may be 0).
     // Notes: This method will be called in a loop until you set *pEOF_flag to true or the internal buffer is full.
     virtual int read(uint8_t *pBuf, int max_bytes_to_read, bool *pEOF_flag) = 0;
+
+    // Returns the whole stream if it stays in memory, the decoder jumps to the restart markers with it.
+    virtual const uint8_t* get_data(uint32_t *) { return nullptr; }
 };
 
 
@@ -138,6 +152,7 @@ public:
     bool open(const uint8_t *pSrc_data, uint32_t size);
     void close() { m_pSrc_data = nullptr; m_ofs = 0; m_size = 0; }
     virtual int read(uint8_t *pBuf, int max_bytes_to_read, bool *pEOF_flag);
+    virtual const uint8_t* get_data(uint32_t *pSize) { *pSize = m_size; return m_pSrc_data; }
 };
 
 
@@ -151,10 +166,10 @@ public:
 
     // Call this method after constructing the object to begin decompression.
     // If JPGD_SUCCESS is returned you may then call decode() on each scanline.
-    int begin_decoding();
+    int begin_decoding(int scale = 1);
     // Returns the next scan line.
     // For grayscale images, pScan_line will point to a buffer containing 8-bit pixels (get_bytes_per_pixel() will return 1).
-    // Otherwise, it will always point to a buffer containing 32-bit RGBA pixels (A will always be 255, and get_bytes_per_pixel() will return 4).
+    // Otherwise, it will always point to a buffer containing 32-bit BGRA pixels (A will always be 255, and get_bytes_per_pixel() will return 4).
     // Returns JPGD_SUCCESS if a scan line has been returned.
     // Returns JPGD_DONE if all scan lines have been returned.
     // Returns JPGD_FAILED if an error occurred. Call get_error_code() for a more info.
@@ -162,15 +177,29 @@ public:
     inline jpgd_status get_error_code() const { return m_error_code; }
     inline int get_width() const { return m_image_x_size; }
     inline int get_height() const { return m_image_y_size; }
+    // The size of the decoded image, reduced by the scale given to begin_decoding().
+    inline int get_scaled_width() const { return (m_image_x_size + m_scale - 1) / m_scale; }
+    inline int get_scaled_height() const { return (m_image_y_size + m_scale - 1) / m_scale; }
     inline int get_num_components() const { return m_comps_in_frame; }
+    inline bool is_progressive() const { return m_progressive_flag != 0; }
     inline int get_bytes_per_pixel() const { return m_dest_bytes_per_pixel; }
     inline int get_bytes_per_scan_line() const { return m_image_x_size * get_bytes_per_pixel(); }
     // Returns the total number of bytes actually consumed by the decoder (which should equal the actual size of the JPEG file).
     inline int get_total_bytes_read() const { return m_total_bytes_read; }
+    // Decodes the whole image to pImage with the worker threads, instead of decode() on each scanline.
+    // Call can_decode_parallel() after begin_decoding() to check if it's worth it.
+    bool can_decode_parallel() const;
+    int decode_parallel(uint8_t* pImage, int req_comps);
+    // Decodes the pixels (x, y, w, h) of the scaled image to pDst, instead of decode() on each scanline. Baseline images only.
+    // The MCUs out of the region are not transformed, and the decoding begins at the restart interval of the region if any.
+    int decode_region(uint8_t* pDst, int stride, int x, int y, int w, int h, int req_comps);
 
 private:
     jpeg_decoder(const jpeg_decoder &);
-    jpeg_decoder &operator =(const jpeg_decoder &);
+    jpeg_decoder &operator =(const jpeg_decoder &) = default;
+    jpeg_decoder(const jpeg_decoder &parent, const uint8_t *pData, uint32_t size);
+
+    struct parallel_ctx;
 
     typedef void (*pDecode_block_func)(jpeg_decoder *, int, int, int);
 
@@ -227,6 +256,9 @@ private:
     int m_successive_high;                        // successive approximation high
     int m_max_mcu_x_size;                         // MCU's max. X size in pixels
     int m_max_mcu_y_size;                         // MCU's max. Y size in pixels
+    int m_scale;                                  // 1, 2, 4 or 8: the image is reduced in the DCT domain
+    int m_mcu_lines;                              // # of the output lines of a MCU row
+    int m_mcu_x0, m_mcu_x1;                       // the MCU columns transformed and converted, all of them unless a region is decoded
     int m_blocks_per_mcu;
     int m_max_blocks_per_row;
     int m_mcus_per_row, m_mcus_per_col;
@@ -273,6 +305,7 @@ private:
     jpgd_status m_error_code;
     bool m_ready_flag;
     int m_total_bytes_read;
+    uint32_t m_scan_ofs;                          // stream offset of the entropy coded data of the scan
 
     void free_all_blocks();
     JPGD_NORETURN void stop_decoding(jpgd_status status);
@@ -293,12 +326,21 @@ private:
     void init(jpeg_decoder_stream * pStream);
     void create_look_ups();
     void fix_in_buffer();
-    void transform_mcu(int mcu_row);
-    void transform_mcu_expand(int mcu_row);
+    void init_buffers();
+    void transform_mcu(int mcu_row, const jpgd_block_t* pSrc_ptr, const int* pMax_zag);
+    void transform_mcu_expand(int mcu_row, const jpgd_block_t* pSrc_ptr, const int* pMax_zag);
+    void transform_row(const jpgd_block_t* pSrc_ptr, const int* pMax_zag);
     coeff_buf* coeff_buf_open(int block_num_x, int block_num_y, int block_len_x, int block_len_y);
     inline jpgd_block_t *coeff_buf_getp(coeff_buf *cb, int block_x, int block_y);
     void load_next_row();
+    void decode_next_mcu(jpgd_block_t* p, int* pMax_zag);
     void decode_next_row();
+    int decode_coeffs(jpgd_block_t* p, int* pMax_zag, int rows);
+    int decode_band(const parallel_ctx* ctx, int row, int rows);
+    void output_row(int row, uint8_t* pImage, int req_comps);
+    int decode_rows(uint8_t* pDst, int stride, int x, int y, int w, int h, int req_comps, int skip, int next_restart_num);
+    static void decode_band_job(void* data, uint32_t idx);
+    static void decode_pipe_job(void* data, uint32_t idx);
     void make_huff_table(int index, huff_tables *pH);
     void check_quant_tables();
     void check_huff_tables();
@@ -306,6 +348,7 @@ private:
     int init_scan();
     void init_frame();
     void process_restart();
+    void reset_interval(int next_restart_num);
     void decode_scan(pDecode_block_func decode_block_func);
     void init_progressive();
     void init_sequential();
@@ -317,6 +360,9 @@ private:
     void H1V1Convert();
     void gray_convert();
     void expanded_convert();
+    void scaled_convert();
+    const uint8_t* convert_line();
+    template<bool HALF> inline void ycc_to_bgra(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* d);
     void find_eoi();
     inline uint32_t get_char();
     inline uint32_t get_char(bool *pPadding_flag);
@@ -544,6 +590,208 @@ static const uint8_t s_idct_row_table[] = {
 static const uint8_t s_idct_col_table[] = { 1, 1, 2, 3, 3, 3, 3, 3, 3, 4, 5, 5, 5, 5, 5, 5, 5, 5, 5, 5, 6, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8, 8 };
 
 
+// The vectorized IDCT computes the same integer math as Row<8> and Col<8>, on the 8 lanes at once.
+// The constant products are grouped by the inputs, e.g. the even part tmp3 = z2 * (FIX_0_541196100 + FIX_0_765366865) + z6 * FIX_0_541196100.
+// The intermediate values of the pass 1 are stored in 16 bits, they fit in for any valid 8-bit JPEG.
+#define IDCT_C0  (FIX_0_541196100 + FIX_0_765366865)
+#define IDCT_C1  (FIX_0_541196100 - FIX_1_847759065)
+#define IDCT_C2  (FIX_0_298631336 - FIX_0_899976223 + FIX_1_175875602 - FIX_1_961570560)
+#define IDCT_C3  (FIX_1_175875602 - FIX_0_899976223)
+#define IDCT_C4  (FIX_1_175875602 - FIX_1_961570560)
+#define IDCT_C5  (FIX_2_053119869 - FIX_2_562915447 + FIX_1_175875602 - FIX_0_390180644)
+#define IDCT_C6  (FIX_1_175875602 - FIX_2_562915447)
+#define IDCT_C7  (FIX_1_175875602 - FIX_0_390180644)
+#define IDCT_C8  (FIX_3_072711026 - FIX_2_562915447 + FIX_1_175875602 - FIX_1_961570560)
+#define IDCT_C9  (FIX_1_501321110 - FIX_0_899976223 + FIX_1_175875602 - FIX_0_390180644)
+
+#define IDCT_PASS1_BIAS (SCALEDONE << (CONST_BITS-PASS1_BITS-1))
+#define IDCT_PASS2_BIAS ((128 << (CONST_BITS+PASS1_BITS+3)) + (SCALEDONE << (CONST_BITS+PASS1_BITS+2)))
+
+#if defined(JPGD_SSE2)
+
+static inline __m128i idct_pair(int16_t a, int16_t b)
+{
+    return _mm_set_epi16(b, a, b, a, b, a, b, a);
+}
+
+
+static inline void idct_transpose(__m128i* r)
+{
+    const __m128i a0 = _mm_unpacklo_epi16(r[0], r[1]);
+    const __m128i a1 = _mm_unpackhi_epi16(r[0], r[1]);
+    const __m128i a2 = _mm_unpacklo_epi16(r[2], r[3]);
+    const __m128i a3 = _mm_unpackhi_epi16(r[2], r[3]);
+    const __m128i a4 = _mm_unpacklo_epi16(r[4], r[5]);
+    const __m128i a5 = _mm_unpackhi_epi16(r[4], r[5]);
+    const __m128i a6 = _mm_unpacklo_epi16(r[6], r[7]);
+    const __m128i a7 = _mm_unpackhi_epi16(r[6], r[7]);
+
+    const __m128i b0 = _mm_unpacklo_epi32(a0, a2);
+    const __m128i b1 = _mm_unpackhi_epi32(a0, a2);
+    const __m128i b2 = _mm_unpacklo_epi32(a1, a3);
+    const __m128i b3 = _mm_unpackhi_epi32(a1, a3);
+    const __m128i b4 = _mm_unpacklo_epi32(a4, a6);
+    const __m128i b5 = _mm_unpackhi_epi32(a4, a6);
+    const __m128i b6 = _mm_unpacklo_epi32(a5, a7);
+    const __m128i b7 = _mm_unpackhi_epi32(a5, a7);
+
+    r[0] = _mm_unpacklo_epi64(b0, b4);
+    r[1] = _mm_unpackhi_epi64(b0, b4);
+    r[2] = _mm_unpacklo_epi64(b1, b5);
+    r[3] = _mm_unpackhi_epi64(b1, b5);
+    r[4] = _mm_unpacklo_epi64(b2, b6);
+    r[5] = _mm_unpackhi_epi64(b2, b6);
+    r[6] = _mm_unpacklo_epi64(b3, b7);
+    r[7] = _mm_unpackhi_epi64(b3, b7);
+}
+
+
+// 1D IDCT of the 4 lanes, the inputs are interleaved in pairs: z04 = (z0, z4), z26 = (z2, z6), z71 = (z7, z1), z35 = (z3, z5).
+template<int SHIFT>
+static inline void idct_half(__m128i z04, __m128i z26, __m128i z71, __m128i z35, __m128i bias, __m128i* out)
+{
+    const __m128i tmp0 = _mm_add_epi32(_mm_madd_epi16(z04, idct_pair(1 << CONST_BITS, 1 << CONST_BITS)), bias);
+    const __m128i tmp1 = _mm_add_epi32(_mm_madd_epi16(z04, idct_pair(1 << CONST_BITS, -(1 << CONST_BITS))), bias);
+    const __m128i tmp2 = _mm_madd_epi16(z26, idct_pair(FIX_0_541196100, IDCT_C1));
+    const __m128i tmp3 = _mm_madd_epi16(z26, idct_pair(IDCT_C0, FIX_0_541196100));
+
+    const __m128i tmp10 = _mm_add_epi32(tmp0, tmp3);
+    const __m128i tmp13 = _mm_sub_epi32(tmp0, tmp3);
+    const __m128i tmp11 = _mm_add_epi32(tmp1, tmp2);
+    const __m128i tmp12 = _mm_sub_epi32(tmp1, tmp2);
+
+    const __m128i btmp0 = _mm_add_epi32(_mm_madd_epi16(z71, idct_pair(IDCT_C2, IDCT_C3)), _mm_madd_epi16(z35, idct_pair(IDCT_C4, FIX_1_175875602)));
+    const __m128i btmp1 = _mm_add_epi32(_mm_madd_epi16(z71, idct_pair(FIX_1_175875602, IDCT_C7)), _mm_madd_epi16(z35, idct_pair(IDCT_C6, IDCT_C5)));
+    const __m128i btmp2 = _mm_add_epi32(_mm_madd_epi16(z71, idct_pair(IDCT_C4, FIX_1_175875602)), _mm_madd_epi16(z35, idct_pair(IDCT_C8, IDCT_C6)));
+    const __m128i btmp3 = _mm_add_epi32(_mm_madd_epi16(z71, idct_pair(IDCT_C3, IDCT_C9)), _mm_madd_epi16(z35, idct_pair(FIX_1_175875602, IDCT_C7)));
+
+    out[0] = _mm_srai_epi32(_mm_add_epi32(tmp10, btmp3), SHIFT);
+    out[7] = _mm_srai_epi32(_mm_sub_epi32(tmp10, btmp3), SHIFT);
+    out[1] = _mm_srai_epi32(_mm_add_epi32(tmp11, btmp2), SHIFT);
+    out[6] = _mm_srai_epi32(_mm_sub_epi32(tmp11, btmp2), SHIFT);
+    out[2] = _mm_srai_epi32(_mm_add_epi32(tmp12, btmp1), SHIFT);
+    out[5] = _mm_srai_epi32(_mm_sub_epi32(tmp12, btmp1), SHIFT);
+    out[3] = _mm_srai_epi32(_mm_add_epi32(tmp13, btmp0), SHIFT);
+    out[4] = _mm_srai_epi32(_mm_sub_epi32(tmp13, btmp0), SHIFT);
+}
+
+
+// 1D IDCT across the 8 registers, each lane is an independent row (or column).
+template<int SHIFT>
+static inline void idct_pass(__m128i* z, __m128i bias)
+{
+    __m128i lo[8], hi[8];
+    idct_half<SHIFT>(_mm_unpacklo_epi16(z[0], z[4]), _mm_unpacklo_epi16(z[2], z[6]), _mm_unpacklo_epi16(z[7], z[1]), _mm_unpacklo_epi16(z[3], z[5]), bias, lo);
+    idct_half<SHIFT>(_mm_unpackhi_epi16(z[0], z[4]), _mm_unpackhi_epi16(z[2], z[6]), _mm_unpackhi_epi16(z[7], z[1]), _mm_unpackhi_epi16(z[3], z[5]), bias, hi);
+    for (int i = 0; i < 8; i++) z[i] = _mm_packs_epi32(lo[i], hi[i]);
+}
+
+
+static void idct_simd(const jpgd_block_t* pSrc_ptr, uint8_t* pDst_ptr)
+{
+    __m128i r[8];
+    for (int i = 0; i < 8; i++) r[i] = _mm_loadu_si128((const __m128i*)(pSrc_ptr + i * 8));
+
+    //rows
+    idct_transpose(r);
+    idct_pass<CONST_BITS-PASS1_BITS>(r, _mm_set1_epi32(IDCT_PASS1_BIAS));
+
+    //columns
+    idct_transpose(r);
+    idct_pass<CONST_BITS+PASS1_BITS+3>(r, _mm_set1_epi32(IDCT_PASS2_BIAS));
+
+    for (int i = 0; i < 8; i += 2) {
+        _mm_storeu_si128((__m128i*)(pDst_ptr + i * 8), _mm_packus_epi16(r[i], r[i + 1]));
+    }
+}
+
+#elif defined(JPGD_NEON)
+
+static inline void idct_transpose(int16x8_t* r)
+{
+    const int16x8x2_t t0 = vtrnq_s16(r[0], r[1]);
+    const int16x8x2_t t1 = vtrnq_s16(r[2], r[3]);
+    const int16x8x2_t t2 = vtrnq_s16(r[4], r[5]);
+    const int16x8x2_t t3 = vtrnq_s16(r[6], r[7]);
+
+    const int32x4x2_t u0 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[0]), vreinterpretq_s32_s16(t1.val[0]));
+    const int32x4x2_t u1 = vtrnq_s32(vreinterpretq_s32_s16(t0.val[1]), vreinterpretq_s32_s16(t1.val[1]));
+    const int32x4x2_t u2 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[0]), vreinterpretq_s32_s16(t3.val[0]));
+    const int32x4x2_t u3 = vtrnq_s32(vreinterpretq_s32_s16(t2.val[1]), vreinterpretq_s32_s16(t3.val[1]));
+
+    r[0] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[0]), vget_low_s32(u2.val[0])));
+    r[1] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[0]), vget_low_s32(u3.val[0])));
+    r[2] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u0.val[1]), vget_low_s32(u2.val[1])));
+    r[3] = vreinterpretq_s16_s32(vcombine_s32(vget_low_s32(u1.val[1]), vget_low_s32(u3.val[1])));
+    r[4] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[0]), vget_high_s32(u2.val[0])));
+    r[5] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[0]), vget_high_s32(u3.val[0])));
+    r[6] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u0.val[1]), vget_high_s32(u2.val[1])));
+    r[7] = vreinterpretq_s16_s32(vcombine_s32(vget_high_s32(u1.val[1]), vget_high_s32(u3.val[1])));
+}
+
+
+// 1D IDCT of the 4 lanes.
+template<int SHIFT>
+static inline void idct_half(const int16x4_t* z, int32x4_t bias, int16x4_t* out)
+{
+    const int32x4_t tmp0 = vaddq_s32(vshlq_n_s32(vaddl_s16(z[0], z[4]), CONST_BITS), bias);
+    const int32x4_t tmp1 = vaddq_s32(vshlq_n_s32(vsubl_s16(z[0], z[4]), CONST_BITS), bias);
+    const int32x4_t tmp2 = vmlal_n_s16(vmull_n_s16(z[2], FIX_0_541196100), z[6], IDCT_C1);
+    const int32x4_t tmp3 = vmlal_n_s16(vmull_n_s16(z[2], IDCT_C0), z[6], FIX_0_541196100);
+
+    const int32x4_t tmp10 = vaddq_s32(tmp0, tmp3);
+    const int32x4_t tmp13 = vsubq_s32(tmp0, tmp3);
+    const int32x4_t tmp11 = vaddq_s32(tmp1, tmp2);
+    const int32x4_t tmp12 = vsubq_s32(tmp1, tmp2);
+
+    const int32x4_t btmp0 = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vmull_n_s16(z[7], IDCT_C2), z[1], IDCT_C3), z[3], IDCT_C4), z[5], FIX_1_175875602);
+    const int32x4_t btmp1 = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vmull_n_s16(z[7], FIX_1_175875602), z[1], IDCT_C7), z[3], IDCT_C6), z[5], IDCT_C5);
+    const int32x4_t btmp2 = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vmull_n_s16(z[7], IDCT_C4), z[1], FIX_1_175875602), z[3], IDCT_C8), z[5], IDCT_C6);
+    const int32x4_t btmp3 = vmlal_n_s16(vmlal_n_s16(vmlal_n_s16(vmull_n_s16(z[7], IDCT_C3), z[1], IDCT_C9), z[3], FIX_1_175875602), z[5], IDCT_C7);
+
+    out[0] = vqmovn_s32(vshrq_n_s32(vaddq_s32(tmp10, btmp3), SHIFT));
+    out[7] = vqmovn_s32(vshrq_n_s32(vsubq_s32(tmp10, btmp3), SHIFT));
+    out[1] = vqmovn_s32(vshrq_n_s32(vaddq_s32(tmp11, btmp2), SHIFT));
+    out[6] = vqmovn_s32(vshrq_n_s32(vsubq_s32(tmp11, btmp2), SHIFT));
+    out[2] = vqmovn_s32(vshrq_n_s32(vaddq_s32(tmp12, btmp1), SHIFT));
+    out[5] = vqmovn_s32(vshrq_n_s32(vsubq_s32(tmp12, btmp1), SHIFT));
+    out[3] = vqmovn_s32(vshrq_n_s32(vaddq_s32(tmp13, btmp0), SHIFT));
+    out[4] = vqmovn_s32(vshrq_n_s32(vsubq_s32(tmp13, btmp0), SHIFT));
+}
+
+
+// 1D IDCT across the 8 registers, each lane is an independent row (or column).
+template<int SHIFT>
+static inline void idct_pass(int16x8_t* z, int32x4_t bias)
+{
+    int16x4_t in[8], lo[8], hi[8];
+    for (int i = 0; i < 8; i++) in[i] = vget_low_s16(z[i]);
+    idct_half<SHIFT>(in, bias, lo);
+    for (int i = 0; i < 8; i++) in[i] = vget_high_s16(z[i]);
+    idct_half<SHIFT>(in, bias, hi);
+    for (int i = 0; i < 8; i++) z[i] = vcombine_s16(lo[i], hi[i]);
+}
+
+
+static void idct_simd(const jpgd_block_t* pSrc_ptr, uint8_t* pDst_ptr)
+{
+    int16x8_t r[8];
+    for (int i = 0; i < 8; i++) r[i] = vld1q_s16(pSrc_ptr + i * 8);
+
+    //rows
+    idct_transpose(r);
+    idct_pass<CONST_BITS-PASS1_BITS>(r, vdupq_n_s32(IDCT_PASS1_BIAS));
+
+    //columns
+    idct_transpose(r);
+    idct_pass<CONST_BITS+PASS1_BITS+3>(r, vdupq_n_s32(IDCT_PASS2_BIAS));
+
+    for (int i = 0; i < 8; i++) vst1_u8(pDst_ptr + i * 8, vqmovun_s16(r[i]));
+}
+
+#endif
+
+
 void idct(const jpgd_block_t* pSrc_ptr, uint8_t* pDst_ptr, int block_max_zag)
 {
     JPGD_ASSERT(block_max_zag >= 1);
@@ -562,6 +810,11 @@ void idct(const jpgd_block_t* pSrc_ptr, uint8_t* pDst_ptr, int block_max_zag)
       return;
     }
 
+#if defined(JPGD_SSE2) || defined(JPGD_NEON)
+    idct_simd(pSrc_ptr, pDst_ptr);
+    return;
+#endif
+
     int temp[64];
     const jpgd_block_t* pSrc = pSrc_ptr;
     int* pTemp = temp;
@@ -605,6 +858,12 @@ void idct(const jpgd_block_t* pSrc_ptr, uint8_t* pDst_ptr, int block_max_zag)
 
 void idct_4x4(const jpgd_block_t* pSrc_ptr, uint8_t* pDst_ptr)
 {
+    // The rest of the block must be zero.
+#if defined(JPGD_SSE2) || defined(JPGD_NEON)
+    idct_simd(pSrc_ptr, pDst_ptr);
+    return;
+#endif
+
     int temp[64];
     int* pTemp = temp;
     const jpgd_block_t* pSrc = pSrc_ptr;
@@ -625,6 +884,71 @@ void idct_4x4(const jpgd_block_t* pSrc_ptr, uint8_t* pDst_ptr)
 }
 
 
+// The 1D IDCT basis averaged over the groups of 2, 4 or 8 pixels, [scale][pixel][frequency].
+// Filtering the full IDCT with a box is linear, so it's applied to the coefficients directly.
+struct ScaledBasis
+{
+    float k[4][4][8];
+
+    ScaledBasis()
+    {
+        for (int i = 1; i < 4; i++) {
+            const int scale = 1 << i;
+            for (int x = 0; x < 8 / scale; x++) {
+                for (int u = 0; u < 8; u++) {
+                    const double c = (u == 0) ? 0.35355339059327373 : 0.5;
+                    double sum = 0;
+                    for (int n = x * scale; n < (x + 1) * scale; n++) sum += cos((2 * n + 1) * u * 3.14159265358979323846 / 16);
+                    k[i][x][u] = static_cast<float>(c * sum / scale);
+                }
+            }
+        }
+    }
+};
+
+
+// Reduced IDCT to (8/scale)x(8/scale) pixels, each one is the average of the scale x scale pixels of the full IDCT.
+// The output keeps the stride of the 8x8 block.
+void idct_scaled(const jpgd_block_t* pSrc_ptr, uint8_t* pDst_ptr, int block_max_zag, int shift)
+{
+    const int size = 8 >> shift;
+
+    if (block_max_zag <= 1 || shift == 3) {
+        int k = ((pSrc_ptr[0] + 4) >> 3) + 128;
+        k = CLAMP(k);
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) pDst_ptr[y * 8 + x] = static_cast<uint8_t>(k);
+        }
+        return;
+    }
+
+    static const ScaledBasis basis;
+    const auto k = basis.k[shift];
+    const uint8_t* pRow_tab = &s_idct_row_table[(block_max_zag - 1) * 8];
+    const int nonzero_rows = s_idct_col_table[block_max_zag - 1];
+
+    float temp[8 * 4];
+    for (int v = 0; v < nonzero_rows; v++) {
+        const jpgd_block_t* pSrc = pSrc_ptr + v * 8;
+        const int cols = pRow_tab[v];
+        for (int x = 0; x < size; x++) {
+            float sum = 0.0f;
+            for (int u = 0; u < cols; u++) sum += pSrc[u] * k[x][u];
+            temp[v * 4 + x] = sum;
+        }
+    }
+
+    for (int y = 0; y < size; y++) {
+        for (int x = 0; x < size; x++) {
+            float sum = 0.0f;
+            for (int v = 0; v < nonzero_rows; v++) sum += temp[v * 4 + x] * k[y][v];
+            int i = static_cast<int>(sum + 128.5f);
+            pDst_ptr[y * 8 + x] = static_cast<uint8_t>(CLAMP(i));
+        }
+    }
+}
+
+
 // Retrieve one character from the input stream.
 inline uint32_t jpeg_decoder::get_char()
 {
@@ -1106,7 +1430,8 @@ JPGD_NORETURN void jpeg_decoder::stop_decoding(jpgd_status status)
 
 void *jpeg_decoder::alloc(size_t nSize, bool zero)
 {
-    nSize = (JPGD_MAX(nSize, 1) + 3) & ~3;
+    // 8 bytes aligned for the pointers in the allocated structures, ex. coeff_buf.
+    nSize = (JPGD_MAX(nSize, 1) + 7) & ~7;
     char *rv = nullptr;
     for (mem_block *b = m_pMem_blocks; b; b = b->m_pNext) {
         if ((b->m_used_count + nSize) <= b->m_size) {
@@ -1116,7 +1441,7 @@ void *jpeg_decoder::alloc(size_t nSize, bool zero)
         }
     }
     if (!rv) {
-        int capacity = JPGD_MAX(32768 - 256, (nSize + 2047) & ~2047);
+        size_t capacity = JPGD_MAX(32768 - 256, (nSize + 2047) & ~2047);
         mem_block *b = (mem_block*)malloc(sizeof(mem_block) + capacity);
         if (!b) stop_decoding(JPGD_NOTENOUGHMEM);
         b->m_pNext = m_pMem_blocks; m_pMem_blocks = b;
@@ -1527,6 +1852,8 @@ void jpeg_decoder::init(jpeg_decoder_stream *pStream)
     m_successive_high = 0;
     m_max_mcu_x_size = 0;
     m_max_mcu_y_size = 0;
+    m_scale = 1;
+    m_mcu_lines = 0;
     m_blocks_per_mcu = 0;
     m_max_blocks_per_row = 0;
     m_mcus_per_row = 0;
@@ -1576,6 +1903,7 @@ void jpeg_decoder::init(jpeg_decoder_stream *pStream)
     m_pSample_buf = nullptr;
 
     m_total_bytes_read = 0;
+    m_scan_ofs = 0;
 
     m_pScan_line_0 = nullptr;
     m_pScan_line_1 = nullptr;
@@ -1613,6 +1941,92 @@ void jpeg_decoder::create_look_ups()
 }
 
 
+// Converts 8 pixels of YCbCr to BGRA, the pixels share the chroma samples in pairs if HALF.
+// The vectorized code computes the same fixed point math of the look up tables.
+template<bool HALF>
+inline void jpeg_decoder::ycc_to_bgra(const uint8_t* y, const uint8_t* cb, const uint8_t* cr, uint8_t* d)
+{
+#if defined(JPGD_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i k128 = _mm_set1_epi16(128);
+    __m128i b8 = HALF ? _mm_cvtsi32_si128(*(const int*)cb) : _mm_loadl_epi64((const __m128i*)cb);
+    __m128i r8 = HALF ? _mm_cvtsi32_si128(*(const int*)cr) : _mm_loadl_epi64((const __m128i*)cr);
+    if (HALF) {
+        b8 = _mm_unpacklo_epi8(b8, b8);
+        r8 = _mm_unpacklo_epi8(r8, r8);
+    }
+    const __m128i yy = _mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i*)y), zero);
+    const __m128i kb = _mm_sub_epi16(_mm_unpacklo_epi8(b8, zero), k128);
+    const __m128i kr = _mm_sub_epi16(_mm_unpacklo_epi8(r8, zero), k128);
+
+    // FIX(1.402) = 65536 + a, FIX(1.772) = 131072 + b, -FIX(0.71414) = -65536 + c, the rounding 32768 is given by 2 * 16384.
+    const __m128i two = _mm_set1_epi16(2);
+    const __m128i half = _mm_set1_epi32(ONE_HALF);
+    const __m128i cr_r = _mm_set_epi16(16384, FIX(1.40200f) - 65536, 16384, FIX(1.40200f) - 65536, 16384, FIX(1.40200f) - 65536, 16384, FIX(1.40200f) - 65536);
+    const __m128i cb_b = _mm_set_epi16(16384, FIX(1.77200f) - 131072, 16384, FIX(1.77200f) - 131072, 16384, FIX(1.77200f) - 131072, 16384, FIX(1.77200f) - 131072);
+    const __m128i crcb_g = _mm_set_epi16(-FIX(0.34414f), 65536 - FIX(0.71414f), -FIX(0.34414f), 65536 - FIX(0.71414f), -FIX(0.34414f), 65536 - FIX(0.71414f), -FIX(0.34414f), 65536 - FIX(0.71414f));
+
+    __m128i lo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(kr, two), cr_r), SCALEBITS);
+    __m128i hi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(kr, two), cr_r), SCALEBITS);
+    const __m128i r = _mm_add_epi16(_mm_add_epi16(yy, kr), _mm_packs_epi32(lo, hi));
+
+    lo = _mm_srai_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(kb, two), cb_b), SCALEBITS);
+    hi = _mm_srai_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(kb, two), cb_b), SCALEBITS);
+    const __m128i b = _mm_add_epi16(_mm_add_epi16(yy, _mm_add_epi16(kb, kb)), _mm_packs_epi32(lo, hi));
+
+    lo = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpacklo_epi16(kr, kb), crcb_g), half), SCALEBITS);
+    hi = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(_mm_unpackhi_epi16(kr, kb), crcb_g), half), SCALEBITS);
+    const __m128i g = _mm_add_epi16(_mm_sub_epi16(yy, kr), _mm_packs_epi32(lo, hi));
+
+    const __m128i bg = _mm_unpacklo_epi8(_mm_packus_epi16(b, b), _mm_packus_epi16(g, g));
+    const __m128i ra = _mm_unpacklo_epi8(_mm_packus_epi16(r, r), _mm_set1_epi8(-1));
+    _mm_storeu_si128((__m128i*)d, _mm_unpacklo_epi16(bg, ra));
+    _mm_storeu_si128((__m128i*)(d + 16), _mm_unpackhi_epi16(bg, ra));
+#elif defined(JPGD_NEON)
+    uint8x8_t b8 = vld1_u8(cb);
+    uint8x8_t r8 = vld1_u8(cr);
+    if (HALF) {
+        b8 = vzip_u8(b8, b8).val[0];
+        r8 = vzip_u8(r8, r8).val[0];
+    }
+    const int16x8_t yy = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(y)));
+    const int16x8_t kb = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(b8)), vdupq_n_s16(128));
+    const int16x8_t kr = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(r8)), vdupq_n_s16(128));
+    const int32x4_t half = vdupq_n_s32(ONE_HALF);
+
+    // FIX(1.402) = 65536 + a, FIX(1.772) = 131072 + b, -FIX(0.71414) = -65536 + c
+    int32x4_t lo = vshrq_n_s32(vmlal_n_s16(half, vget_low_s16(kr), FIX(1.40200f) - 65536), SCALEBITS);
+    int32x4_t hi = vshrq_n_s32(vmlal_n_s16(half, vget_high_s16(kr), FIX(1.40200f) - 65536), SCALEBITS);
+    const int16x8_t r = vaddq_s16(vaddq_s16(yy, kr), vcombine_s16(vmovn_s32(lo), vmovn_s32(hi)));
+
+    lo = vshrq_n_s32(vmlal_n_s16(half, vget_low_s16(kb), FIX(1.77200f) - 131072), SCALEBITS);
+    hi = vshrq_n_s32(vmlal_n_s16(half, vget_high_s16(kb), FIX(1.77200f) - 131072), SCALEBITS);
+    const int16x8_t b = vaddq_s16(vaddq_s16(yy, vaddq_s16(kb, kb)), vcombine_s16(vmovn_s32(lo), vmovn_s32(hi)));
+
+    lo = vshrq_n_s32(vmlal_n_s16(vmlal_n_s16(half, vget_low_s16(kr), 65536 - FIX(0.71414f)), vget_low_s16(kb), -FIX(0.34414f)), SCALEBITS);
+    hi = vshrq_n_s32(vmlal_n_s16(vmlal_n_s16(half, vget_high_s16(kr), 65536 - FIX(0.71414f)), vget_high_s16(kb), -FIX(0.34414f)), SCALEBITS);
+    const int16x8_t g = vaddq_s16(vsubq_s16(yy, kr), vcombine_s16(vmovn_s32(lo), vmovn_s32(hi)));
+
+    uint8x8x4_t px;
+    px.val[0] = vqmovun_s16(b);
+    px.val[1] = vqmovun_s16(g);
+    px.val[2] = vqmovun_s16(r);
+    px.val[3] = vdup_n_u8(255);
+    vst4_u8(d, px);
+#else
+    for (int j = 0; j < 8; j++) {
+        const int c = HALF ? (j >> 1) : j;
+        const int yy = y[j];
+        d[0] = clamp(yy + m_cbb[cb[c]]);
+        d[1] = clamp(yy + ((m_crg[cr[c]] + m_cbg[cb[c]]) >> 16));
+        d[2] = clamp(yy + m_crr[cr[c]]);
+        d[3] = 255;
+        d += 4;
+    }
+#endif
+}
+
+
 // This method throws back into the stream any bytes that where read
 // into the bit buffer during initial marker scanning.
 void jpeg_decoder::fix_in_buffer()
@@ -1626,19 +2040,30 @@ void jpeg_decoder::fix_in_buffer()
     stuff_char((uint8_t)((m_bit_buf >> 16) & 0xFF));
     stuff_char((uint8_t)((m_bit_buf >> 24) & 0xFF));
 
+    m_scan_ofs = m_total_bytes_read - m_in_buf_left;
+
     m_bits_left = 16;
     get_bits_no_markers(16);
     get_bits_no_markers(16);
 }
 
 
-void jpeg_decoder::transform_mcu(int mcu_row)
+void jpeg_decoder::transform_mcu(int mcu_row, const jpgd_block_t* pSrc_ptr, const int* pMax_zag)
 {
-    jpgd_block_t* pSrc_ptr = m_pMCU_coefficients;
     uint8_t* pDst_ptr = m_pSample_buf + mcu_row * m_blocks_per_mcu * 64;
 
+    if (m_scale > 1) {
+        const int shift = (m_scale == 2) ? 1 : ((m_scale == 4) ? 2 : 3);
+        for (int mcu_block = 0; mcu_block < m_blocks_per_mcu; mcu_block++) {
+            idct_scaled(pSrc_ptr, pDst_ptr, pMax_zag[mcu_block], shift);
+            pSrc_ptr += 64;
+            pDst_ptr += 64;
+        }
+        return;
+    }
+
     for (int mcu_block = 0; mcu_block < m_blocks_per_mcu; mcu_block++) {
-        idct(pSrc_ptr, pDst_ptr, m_mcu_block_max_zag[mcu_block]);
+        idct(pSrc_ptr, pDst_ptr, pMax_zag[mcu_block]);
         pSrc_ptr += 64;
         pDst_ptr += 64;
     }
@@ -1654,28 +2079,27 @@ static const uint8_t s_max_rc[64] =
 };
 
 
-void jpeg_decoder::transform_mcu_expand(int mcu_row)
+void jpeg_decoder::transform_mcu_expand(int mcu_row, const jpgd_block_t* pSrc_ptr, const int* pMax_zag)
 {
-    jpgd_block_t* pSrc_ptr = m_pMCU_coefficients;
     uint8_t* pDst_ptr = m_pSample_buf + mcu_row * m_expanded_blocks_per_mcu * 64;
 
     // Y IDCT
     int mcu_block;
     for (mcu_block = 0; mcu_block < m_expanded_blocks_per_component; mcu_block++) {
-        idct(pSrc_ptr, pDst_ptr, m_mcu_block_max_zag[mcu_block]);
+        idct(pSrc_ptr, pDst_ptr, pMax_zag[mcu_block]);
         pSrc_ptr += 64;
         pDst_ptr += 64;
     }
 
     // Chroma IDCT, with upsampling
-    jpgd_block_t temp_block[64];
+    jpgd_block_t temp_block[64] = {};
 
     for (int i = 0; i < 2; i++) {
         DCT_Upsample::Matrix44 P, Q, R, S;
-        JPGD_ASSERT(m_mcu_block_max_zag[mcu_block] >= 1);
-        JPGD_ASSERT(m_mcu_block_max_zag[mcu_block] <= 64);
+        JPGD_ASSERT(pMax_zag[mcu_block] >= 1);
+        JPGD_ASSERT(pMax_zag[mcu_block] <= 64);
 
-        int max_zag = m_mcu_block_max_zag[mcu_block++] - 1;
+        int max_zag = pMax_zag[mcu_block++] - 1;
         if (max_zag <= 0) max_zag = 0; // should never happen, only here to shut up static analysis
 
         switch (s_max_rc[max_zag]) {
@@ -1768,6 +2192,21 @@ void jpeg_decoder::transform_mcu_expand(int mcu_row)
 }
 
 
+// Transforms a row of MCU's decoded by decode_coeffs() to the sample buffer.
+void jpeg_decoder::transform_row(const jpgd_block_t* pSrc_ptr, const int* pMax_zag)
+{
+    pSrc_ptr += m_mcu_x0 * m_blocks_per_mcu * 64;
+    pMax_zag += m_mcu_x0 * m_blocks_per_mcu;
+
+    for (int mcu_row = m_mcu_x0; mcu_row < m_mcu_x1; mcu_row++) {
+        if (m_freq_domain_chroma_upsample) transform_mcu_expand(mcu_row, pSrc_ptr, pMax_zag);
+        else transform_mcu(mcu_row, pSrc_ptr, pMax_zag);
+        pSrc_ptr += m_blocks_per_mcu * 64;
+        pMax_zag += m_blocks_per_mcu;
+    }
+}
+
+
 // Loads and dequantizes the next row of (already decoded) coefficients.
 // Progressive images only.
 void jpeg_decoder::load_next_row()
@@ -1808,15 +2247,17 @@ void jpeg_decoder::load_next_row()
 
             if (m_comps_in_scan == 1) block_x_mcu[component_id]++;
             else {
-                if (++block_x_mcu_ofs == m_comp_h_samp[component_id]) block_x_mcu_ofs = 0;
-                if (++block_y_mcu_ofs == m_comp_v_samp[component_id]) {
-                    block_y_mcu_ofs = 0;
-                    block_x_mcu[component_id] += m_comp_h_samp[component_id];
+                if (++block_x_mcu_ofs == m_comp_h_samp[component_id]) {
+                    block_x_mcu_ofs = 0;
+                    if (++block_y_mcu_ofs == m_comp_v_samp[component_id]) {
+                        block_y_mcu_ofs = 0;
+                        block_x_mcu[component_id] += m_comp_h_samp[component_id];
+                    }
                 }
             }
         }
-        if (m_freq_domain_chroma_upsample) transform_mcu_expand(mcu_row);
-        else transform_mcu(mcu_row);
+        if (m_freq_domain_chroma_upsample) transform_mcu_expand(mcu_row, m_pMCU_coefficients, m_mcu_block_max_zag);
+        else transform_mcu(mcu_row, m_pMCU_coefficients, m_mcu_block_max_zag);
     }
     if (m_comps_in_scan == 1) m_block_y_mcu[m_comp_list[0]]++;
     else {
@@ -1853,12 +2294,19 @@ void jpeg_decoder::process_restart()
     // Is it the expected marker? If not, something bad happened.
     if (c != (m_next_restart_num + M_RST0)) stop_decoding(JPGD_BAD_RESTART_MARKER);
 
+    reset_interval((m_next_restart_num + 1) & 7);
+}
+
+
+// Starts a restart interval, the input buffer must be at the beginning of its data.
+void jpeg_decoder::reset_interval(int next_restart_num)
+{
     // Reset each component's DC prediction values.
     memset(&m_last_dc_val, 0, m_comps_in_frame * sizeof(uint32_t));
 
     m_eob_run = 0;
     m_restarts_left = m_restart_interval;
-    m_next_restart_num = (m_next_restart_num + 1) & 7;
+    m_next_restart_num = next_restart_num;
 
     // Get the bit buffer going again...
     m_bits_left = 16;
@@ -1873,241 +2321,181 @@ static inline int dequantize_ac(int c, int q)
     return c;
 }
 
-// Decodes and dequantizes the next row of coefficients.
-void jpeg_decoder::decode_next_row()
+// Decodes and dequantizes the coefficients of the next MCU.
+// The blocks of p must hold the previous coefficients decoded there, pMax_zag tells how many of them to clear.
+void jpeg_decoder::decode_next_mcu(jpgd_block_t* p, int* pMax_zag)
 {
-    for (int mcu_row = 0; mcu_row < m_mcus_per_row; mcu_row++) {
-        if ((m_restart_interval) && (m_restarts_left == 0)) process_restart();
+    for (int mcu_block = 0; mcu_block < m_blocks_per_mcu; mcu_block++, p += 64) {
+        int component_id = m_mcu_org[mcu_block];
+        jpgd_quant_t* q = m_quant[m_comp_quant[component_id]];
 
-        jpgd_block_t* p = m_pMCU_coefficients;
+        int r, s;
+        s = huff_decode(m_pHuff_tabs[m_comp_dc_tab[component_id]], r);
+        s = JPGD_HUFF_EXTEND(r, s);
 
-        for (int mcu_block = 0; mcu_block < m_blocks_per_mcu; mcu_block++, p += 64) {
-            int component_id = m_mcu_org[mcu_block];
-            jpgd_quant_t* q = m_quant[m_comp_quant[component_id]];
+        m_last_dc_val[component_id] = (s += m_last_dc_val[component_id]);
 
-            int r, s;
-            s = huff_decode(m_pHuff_tabs[m_comp_dc_tab[component_id]], r);
-            s = JPGD_HUFF_EXTEND(r, s);
+        p[0] = static_cast<jpgd_block_t>(s * q[0]);
 
-            m_last_dc_val[component_id] = (s += m_last_dc_val[component_id]);
-
-            p[0] = static_cast<jpgd_block_t>(s * q[0]);
-
-            int prev_num_set = m_mcu_block_max_zag[mcu_block];
-            huff_tables *pH = m_pHuff_tabs[m_comp_ac_tab[component_id]];
-            int k;
-            for (k = 1; k < 64; k++) {
-                int extra_bits;
-                s = huff_decode(pH, extra_bits);
-                r = s >> 4;
-                s &= 15;
-
-                if (s) {
-                    if (r) {
-                        if ((k + r) > 63) stop_decoding(JPGD_DECODE_ERROR);
-                        if (k < prev_num_set) {
-                            int n = JPGD_MIN(r, prev_num_set - k);
-                            int kt = k;
-                            while (n--) p[g_ZAG[kt++]] = 0;
-                        }
-                        k += r;
+        int prev_num_set = pMax_zag[mcu_block];
+        huff_tables *pH = m_pHuff_tabs[m_comp_ac_tab[component_id]];
+        int k;
+        for (k = 1; k < 64; k++) {
+            int extra_bits;
+            s = huff_decode(pH, extra_bits);
+            r = s >> 4;
+            s &= 15;
+
+            if (s) {
+                if (r) {
+                    if ((k + r) > 63) stop_decoding(JPGD_DECODE_ERROR);
+                    if (k < prev_num_set) {
+                        int n = JPGD_MIN(r, prev_num_set - k);
+                        int kt = k;
+                        while (n--) p[g_ZAG[kt++]] = 0;
                     }
-                    s = JPGD_HUFF_EXTEND(extra_bits, s);
-                    JPGD_ASSERT(k < 64);
-                    p[g_ZAG[k]] = static_cast<jpgd_block_t>(dequantize_ac(s, q[k])); //s * q[k];
-                } else {
-                    if (r == 15) {
-                        if ((k + 16) > 64) stop_decoding(JPGD_DECODE_ERROR);
-                        if (k < prev_num_set) {
-                            int n = JPGD_MIN(16, prev_num_set - k);
-                            int kt = k;
-                            while (n--) {
-                                JPGD_ASSERT(kt <= 63);
-                                p[g_ZAG[kt++]] = 0;
-                            }
-                        }
-                        k += 16 - 1; // - 1 because the loop counter is k
-                        JPGD_ASSERT(p[g_ZAG[k]] == 0);
-                    } else  break;
+                    k += r;
                 }
+                s = JPGD_HUFF_EXTEND(extra_bits, s);
+                JPGD_ASSERT(k < 64);
+                p[g_ZAG[k]] = static_cast<jpgd_block_t>(dequantize_ac(s, q[k])); //s * q[k];
+            } else {
+                if (r == 15) {
+                    if ((k + 16) > 64) stop_decoding(JPGD_DECODE_ERROR);
+                    if (k < prev_num_set) {
+                        int n = JPGD_MIN(16, prev_num_set - k);
+                        int kt = k;
+                        while (n--) {
+                            JPGD_ASSERT(kt <= 63);
+                            p[g_ZAG[kt++]] = 0;
+                        }
+                    }
+                    k += 16 - 1; // - 1 because the loop counter is k
+                    JPGD_ASSERT(p[g_ZAG[k]] == 0);
+                } else  break;
             }
+        }
 
-            if (k < prev_num_set) {
-                int kt = k;
-                while (kt < prev_num_set) p[g_ZAG[kt++]] = 0;
-            }
-
-            m_mcu_block_max_zag[mcu_block] = k;
+        if (k < prev_num_set) {
+            int kt = k;
+            while (kt < prev_num_set) p[g_ZAG[kt++]] = 0;
         }
-        if (m_freq_domain_chroma_upsample) transform_mcu_expand(mcu_row);
-        else transform_mcu(mcu_row);
+
+        pMax_zag[mcu_block] = k;
+    }
+}
+
+
+// Decodes and dequantizes the next row of coefficients.
+void jpeg_decoder::decode_next_row()
+{
+    for (int mcu_row = 0; mcu_row < m_mcus_per_row; mcu_row++) {
+        if ((m_restart_interval) && (m_restarts_left == 0)) process_restart();
+        decode_next_mcu(m_pMCU_coefficients, m_mcu_block_max_zag);
         m_restarts_left--;
+        if ((mcu_row < m_mcu_x0) || (mcu_row >= m_mcu_x1)) continue;
+        if (m_freq_domain_chroma_upsample) transform_mcu_expand(mcu_row, m_pMCU_coefficients, m_mcu_block_max_zag);
+        else transform_mcu(mcu_row, m_pMCU_coefficients, m_mcu_block_max_zag);
     }
 }
 
 
-// YCbCr H1V1 (1x1:1:1, 3 m_blocks per MCU) to RGB
+// Decodes the coefficients of the next rows without transforming them, each MCU is stored apart.
+int jpeg_decoder::decode_coeffs(jpgd_block_t* p, int* pMax_zag, int rows)
+{
+    if (setjmp(m_jmp_state)) return JPGD_FAILED;
+
+    for (int mcu = 0; mcu < rows * m_mcus_per_row; mcu++) {
+        if ((m_restart_interval) && (m_restarts_left == 0)) process_restart();
+        decode_next_mcu(p + mcu * m_blocks_per_mcu * 64, pMax_zag + mcu * m_blocks_per_mcu);
+        m_restarts_left--;
+    }
+    return JPGD_SUCCESS;
+}
+
+
+// YCbCr H1V1 (1x1:1:1, 3 m_blocks per MCU) to BGRA
 void jpeg_decoder::H1V1Convert()
 {
     int row = m_max_mcu_y_size - m_mcu_lines_left;
-    uint8_t *d = m_pScan_line_0;
-    uint8_t *s = m_pSample_buf + row * 8;
+    uint8_t *d = m_pScan_line_0 + m_mcu_x0 * 32;
+    uint8_t *s = m_pSample_buf + m_mcu_x0 * 64*3 + row * 8;
 
-    for (int i = m_max_mcus_per_row; i > 0; i--) {
-        for (int j = 0; j < 8; j++) {
-            int y = s[j];
-            int cb = s[64+j];
-            int cr = s[128+j];
-
-            d[0] = clamp(y + m_crr[cr]);
-            d[1] = clamp(y + ((m_crg[cr] + m_cbg[cb]) >> 16));
-            d[2] = clamp(y + m_cbb[cb]);
-            d[3] = 255;
-            d += 4;
-        }
+    for (int i = m_mcu_x1 - m_mcu_x0; i > 0; i--) {
+        ycc_to_bgra<false>(s, s + 64, s + 128, d);
+        d += 32;
         s += 64*3;
     }
 }
 
 
-// YCbCr H2V1 (2x1:1:1, 4 m_blocks per MCU) to RGB
+// YCbCr H2V1 (2x1:1:1, 4 m_blocks per MCU) to BGRA
 void jpeg_decoder::H2V1Convert()
 {
     int row = m_max_mcu_y_size - m_mcu_lines_left;
-    uint8_t *d0 = m_pScan_line_0;
-    uint8_t *y = m_pSample_buf + row * 8;
-    uint8_t *c = m_pSample_buf + 2*64 + row * 8;
-
-    for (int i = m_max_mcus_per_row; i > 0; i--) {
-        for (int l = 0; l < 2; l++) {
-            for (int j = 0; j < 4; j++) {
-                int cb = c[0];
-                int cr = c[64];
-
-                int rc = m_crr[cr];
-                int gc = ((m_crg[cr] + m_cbg[cb]) >> 16);
-                int bc = m_cbb[cb];
-
-                int yy = y[j<<1];
-                d0[0] = clamp(yy+rc);
-                d0[1] = clamp(yy+gc);
-                d0[2] = clamp(yy+bc);
-                d0[3] = 255;
-
-                yy = y[(j<<1)+1];
-                d0[4] = clamp(yy+rc);
-                d0[5] = clamp(yy+gc);
-                d0[6] = clamp(yy+bc);
-                d0[7] = 255;
-                d0 += 8;
-                c++;
-            }
-            y += 64;
-        }
-        y += 64*4 - 64*2;
-        c += 64*4 - 8;
+    uint8_t *d0 = m_pScan_line_0 + m_mcu_x0 * 64;
+    uint8_t *y = m_pSample_buf + m_mcu_x0 * 64*4 + row * 8;
+    uint8_t *c = m_pSample_buf + m_mcu_x0 * 64*4 + 2*64 + row * 8;
+
+    for (int i = m_mcu_x1 - m_mcu_x0; i > 0; i--) {
+        ycc_to_bgra<true>(y, c, c + 64, d0);
+        ycc_to_bgra<true>(y + 64, c + 4, c + 64 + 4, d0 + 32);
+        d0 += 64;
+        y += 64*4;
+        c += 64*4;
     }
 }
 
 
-// YCbCr H2V1 (1x2:1:1, 4 m_blocks per MCU) to RGB
+// YCbCr H2V1 (1x2:1:1, 4 m_blocks per MCU) to BGRA
 void jpeg_decoder::H1V2Convert()
 {
     int row = m_max_mcu_y_size - m_mcu_lines_left;
-    uint8_t *d0 = m_pScan_line_0;
-    uint8_t *d1 = m_pScan_line_1;
+    uint8_t *d0 = m_pScan_line_0 + m_mcu_x0 * 32;
+    uint8_t *d1 = m_pScan_line_1 + m_mcu_x0 * 32;
+    uint8_t *s = m_pSample_buf + m_mcu_x0 * 64*4;
     uint8_t *y;
     uint8_t *c;
 
-    if (row < 8) y = m_pSample_buf + row * 8;
-    else y = m_pSample_buf + 64*1 + (row & 7) * 8;
-
-    c = m_pSample_buf + 64*2 + (row >> 1) * 8;
-
-    for (int i = m_max_mcus_per_row; i > 0; i--) {
-        for (int j = 0; j < 8; j++) {
-            int cb = c[0+j];
-            int cr = c[64+j];
-
-            int rc = m_crr[cr];
-            int gc = ((m_crg[cr] + m_cbg[cb]) >> 16);
-            int bc = m_cbb[cb];
-
-            int yy = y[j];
-            d0[0] = clamp(yy+rc);
-            d0[1] = clamp(yy+gc);
-            d0[2] = clamp(yy+bc);
-            d0[3] = 255;
+    if (row < 8) y = s + row * 8;
+    else y = s + 64*1 + (row & 7) * 8;
 
-            yy = y[8+j];
-            d1[0] = clamp(yy+rc);
-            d1[1] = clamp(yy+gc);
-            d1[2] = clamp(yy+bc);
-            d1[3] = 255;
+    c = s + 64*2 + (row >> 1) * 8;
 
-            d0 += 4;
-            d1 += 4;
-        }
+    for (int i = m_mcu_x1 - m_mcu_x0; i > 0; i--) {
+        ycc_to_bgra<false>(y, c, c + 64, d0);
+        ycc_to_bgra<false>(y + 8, c, c + 64, d1);
+        d0 += 32;
+        d1 += 32;
         y += 64*4;
         c += 64*4;
     }
 }
 
 
-// YCbCr H2V2 (2x2:1:1, 6 m_blocks per MCU) to RGB
+// YCbCr H2V2 (2x2:1:1, 6 m_blocks per MCU) to BGRA
 void jpeg_decoder::H2V2Convert()
 {
     int row = m_max_mcu_y_size - m_mcu_lines_left;
-    uint8_t *d0 = m_pScan_line_0;
-    uint8_t *d1 = m_pScan_line_1;
+    uint8_t *d0 = m_pScan_line_0 + m_mcu_x0 * 64;
+    uint8_t *d1 = m_pScan_line_1 + m_mcu_x0 * 64;
+    uint8_t *s = m_pSample_buf + m_mcu_x0 * 64*6;
     uint8_t *y;
     uint8_t *c;
 
-    if (row < 8) y = m_pSample_buf + row * 8;
-    else y = m_pSample_buf + 64*2 + (row & 7) * 8;
+    if (row < 8) y = s + row * 8;
+    else y = s + 64*2 + (row & 7) * 8;
 
-    c = m_pSample_buf + 64*4 + (row >> 1) * 8;
+    c = s + 64*4 + (row >> 1) * 8;
 
-    for (int i = m_max_mcus_per_row; i > 0; i--) {
+    for (int i = m_mcu_x1 - m_mcu_x0; i > 0; i--) {
         for (int l = 0; l < 2; l++) {
-            for (int j = 0; j < 8; j += 2) {
-                int cb = c[0];
-                int cr = c[64];
-
-                int rc = m_crr[cr];
-                int gc = ((m_crg[cr] + m_cbg[cb]) >> 16);
-                int bc = m_cbb[cb];
-
-                int yy = y[j];
-                d0[0] = clamp(yy+rc);
-                d0[1] = clamp(yy+gc);
-                d0[2] = clamp(yy+bc);
-                d0[3] = 255;
-
-                yy = y[j+1];
-                d0[4] = clamp(yy+rc);
-                d0[5] = clamp(yy+gc);
-                d0[6] = clamp(yy+bc);
-                d0[7] = 255;
-
-                yy = y[j+8];
-                d1[0] = clamp(yy+rc);
-                d1[1] = clamp(yy+gc);
-                d1[2] = clamp(yy+bc);
-                d1[3] = 255;
-
-                yy = y[j+8+1];
-                d1[4] = clamp(yy+rc);
-                d1[5] = clamp(yy+gc);
-                d1[6] = clamp(yy+bc);
-                d1[7] = 255;
-
-                d0 += 8;
-                d1 += 8;
-
-                c++;
-            }
+            ycc_to_bgra<true>(y, c, c + 64, d0);
+            ycc_to_bgra<true>(y + 8, c, c + 64, d1);
+            d0 += 32;
+            d1 += 32;
             y += 64;
+            c += 4;
         }
         y += 64*6 - 64*2;
         c += 64*6 - 8;
@@ -2119,10 +2507,10 @@ void jpeg_decoder::H2V2Convert()
 void jpeg_decoder::gray_convert()
 {
     int row = m_max_mcu_y_size - m_mcu_lines_left;
-    uint8_t *d = m_pScan_line_0;
-    uint8_t *s = m_pSample_buf + row * 8;
+    uint8_t *d = m_pScan_line_0 + m_mcu_x0 * 8;
+    uint8_t *s = m_pSample_buf + m_mcu_x0 * 64 + row * 8;
 
-    for (int i = m_max_mcus_per_row; i > 0; i--) {
+    for (int i = m_mcu_x1 - m_mcu_x0; i > 0; i--) {
         *(uint32_t *)d = *(uint32_t *)s;
         *(uint32_t *)(&d[4]) = *(uint32_t *)(&s[4]);
         s += 64;
@@ -2134,28 +2522,51 @@ void jpeg_decoder::gray_convert()
 void jpeg_decoder::expanded_convert()
 {
     int row = m_max_mcu_y_size - m_mcu_lines_left;
-    uint8_t* Py = m_pSample_buf + (row / 8) * 64 * m_comp_h_samp[0] + (row & 7) * 8;
-    uint8_t* d = m_pScan_line_0;
+    uint8_t* Py = m_pSample_buf + m_mcu_x0 * 64 * m_expanded_blocks_per_mcu + (row / 8) * 64 * m_comp_h_samp[0] + (row & 7) * 8;
+    uint8_t* d = m_pScan_line_0 + m_mcu_x0 * m_max_mcu_x_size * 4;
 
-    for (int i = m_max_mcus_per_row; i > 0; i--) {
+    for (int i = m_mcu_x1 - m_mcu_x0; i > 0; i--) {
         for (int k = 0; k < m_max_mcu_x_size; k += 8) {
             const int Y_ofs = k * 8;
             const int Cb_ofs = Y_ofs + 64 * m_expanded_blocks_per_component;
             const int Cr_ofs = Y_ofs + 64 * m_expanded_blocks_per_component * 2;
-            for (int j = 0; j < 8; j++) {
-                int y = Py[Y_ofs + j];
-                int cb = Py[Cb_ofs + j];
-                int cr = Py[Cr_ofs + j];
+            ycc_to_bgra<false>(Py + Y_ofs, Py + Cb_ofs, Py + Cr_ofs, d);
+            d += 32;
+        }
+        Py += 64 * m_expanded_blocks_per_mcu;
+    }
+}
 
-                d[0] = clamp(y + m_crr[cr]);
-                d[1] = clamp(y + ((m_crg[cr] + m_cbg[cb]) >> 16));
-                d[2] = clamp(y + m_cbb[cb]);
-                d[3] = 255;
 
-                d += 4;
+// Any subsampling at a reduced scale, the blocks of the sample buffer hold (8/scale)x(8/scale) pixels.
+void jpeg_decoder::scaled_convert()
+{
+    const int size = 8 / m_scale;
+    const int h_samp = m_comp_h_samp[0];
+    const int v_samp = m_comp_v_samp[0];
+    const int row = m_mcu_lines - m_mcu_lines_left;
+    const int y_ofs = (row / size) * h_samp * 64 + (row % size) * 8;
+    const int c_ofs = h_samp * v_samp * 64 + (row / v_samp) * 8;
+    uint8_t *d = m_pScan_line_0 + m_mcu_x0 * h_samp * size * m_dest_bytes_per_pixel;
+    uint8_t *s = m_pSample_buf + m_mcu_x0 * 64 * m_max_blocks_per_mcu;
+
+    for (int i = m_mcu_x1 - m_mcu_x0; i > 0; i--) {
+        for (int x = 0; x < h_samp * size; x++) {
+            int y = s[y_ofs + (x / size) * 64 + (x % size)];
+            if (m_scan_type == JPGD_GRAYSCALE) {
+                *d++ = static_cast<uint8_t>(y);
+                continue;
             }
+            int cb = s[c_ofs + x / h_samp];
+            int cr = s[c_ofs + 64 + x / h_samp];
+
+            d[0] = clamp(y + m_cbb[cb]);
+            d[1] = clamp(y + ((m_crg[cr] + m_cbg[cb]) >> 16));
+            d[2] = clamp(y + m_crr[cr]);
+            d[3] = 255;
+            d += 4;
         }
-        Py += 64 * m_expanded_blocks_per_mcu;
+        s += 64 * m_max_blocks_per_mcu;
     }
 }
 
@@ -2179,6 +2590,48 @@ void jpeg_decoder::find_eoi()
 }
 
 
+// Converts the next line of the current MCU row, the lines of a MCU row are converted in order.
+const uint8_t* jpeg_decoder::convert_line()
+{
+    if (m_scale > 1) {
+        scaled_convert();
+        return m_pScan_line_0;
+    }
+    if (m_freq_domain_chroma_upsample) {
+        expanded_convert();
+        return m_pScan_line_0;
+    }
+    switch (m_scan_type) {
+        case JPGD_YH2V2: {
+            if ((m_mcu_lines_left & 1) == 0) {
+                H2V2Convert();
+                return m_pScan_line_0;
+            }
+            return m_pScan_line_1;
+        }
+        case JPGD_YH2V1: {
+            H2V1Convert();
+            return m_pScan_line_0;
+        }
+        case JPGD_YH1V2: {
+            if ((m_mcu_lines_left & 1) == 0) {
+                H1V2Convert();
+                return m_pScan_line_0;
+            }
+            return m_pScan_line_1;
+        }
+        case JPGD_YH1V1: {
+            H1V1Convert();
+            return m_pScan_line_0;
+        }
+        default: {
+            gray_convert();
+            return m_pScan_line_0;
+        }
+    }
+}
+
+
 int jpeg_decoder::decode(const void** pScan_line, uint32_t* pScan_line_len)
 {
     if ((m_error_code) || (!m_ready_flag)) return JPGD_FAILED;
@@ -2188,48 +2641,11 @@ int jpeg_decoder::decode(const void** pScan_line, uint32_t* pScan_line_len)
         if (m_progressive_flag) load_next_row();
         else decode_next_row();
         // Find the EOI marker if that was the last row.
-        if (m_total_lines_left <= m_max_mcu_y_size) find_eoi();
-        m_mcu_lines_left = m_max_mcu_y_size;
-    }
-
-    if (m_freq_domain_chroma_upsample) {
-        expanded_convert();
-        *pScan_line = m_pScan_line_0;
-    } else {
-        switch (m_scan_type) {
-            case JPGD_YH2V2: {
-                if ((m_mcu_lines_left & 1) == 0) {
-                    H2V2Convert();
-                    *pScan_line = m_pScan_line_0;
-                }
-              else *pScan_line = m_pScan_line_1;
-              break;
-            }
-            case JPGD_YH2V1: {
-                H2V1Convert();
-                *pScan_line = m_pScan_line_0;
-                break;
-            }
-            case JPGD_YH1V2: {
-                if ((m_mcu_lines_left & 1) == 0) {
-                    H1V2Convert();
-                    *pScan_line = m_pScan_line_0;
-                } else *pScan_line = m_pScan_line_1;
-                break;
-            }
-            case JPGD_YH1V1: {
-                H1V1Convert();
-                *pScan_line = m_pScan_line_0;
-                break;
-            }
-            case JPGD_GRAYSCALE: {
-                gray_convert();
-                *pScan_line = m_pScan_line_0;
-                break;
-            }
-        }
+        if (m_total_lines_left <= m_mcu_lines) find_eoi();
+        m_mcu_lines_left = m_mcu_lines;
     }
 
+    *pScan_line = convert_line();
     *pScan_line_len = m_real_dest_bytes_per_scan_line;
     m_mcu_lines_left--;
     m_total_lines_left--;
@@ -2438,8 +2854,6 @@ int jpeg_decoder::init_scan()
 // are supported.
 void jpeg_decoder::init_frame()
 {
-    int i;
-
     if (m_comps_in_frame == 1) {
         if ((m_comp_h_samp[0] != 1) || (m_comp_v_samp[0] != 1)) stop_decoding(JPGD_UNSUPPORTED_SAMP_FACTORS);
         m_scan_type = JPGD_GRAYSCALE;
@@ -2475,49 +2889,59 @@ void jpeg_decoder::init_frame()
 
     m_max_mcus_per_row = (m_image_x_size + (m_max_mcu_x_size - 1)) / m_max_mcu_x_size;
     m_max_mcus_per_col = (m_image_y_size + (m_max_mcu_y_size - 1)) / m_max_mcu_y_size;
+    m_mcu_x0 = 0;
+    m_mcu_x1 = m_max_mcus_per_row;
 
     // These values are for the *destination* pixels: after conversion.
     if (m_scan_type == JPGD_GRAYSCALE) m_dest_bytes_per_pixel = 1;
     else m_dest_bytes_per_pixel = 4;
 
     m_dest_bytes_per_scan_line = ((m_image_x_size + 15) & 0xFFF0) * m_dest_bytes_per_pixel;
-    m_real_dest_bytes_per_scan_line = (m_image_x_size * m_dest_bytes_per_pixel);
-
-    // Initialize two scan line buffers.
-    m_pScan_line_0 = (uint8_t *)alloc(m_dest_bytes_per_scan_line, true);
-    if ((m_scan_type == JPGD_YH1V2) || (m_scan_type == JPGD_YH2V2)) {
-        m_pScan_line_1 = (uint8_t *)alloc(m_dest_bytes_per_scan_line, true);
-    }
+    m_real_dest_bytes_per_scan_line = (get_scaled_width() * m_dest_bytes_per_pixel);
+    m_mcu_lines = m_max_mcu_y_size / m_scale;
 
     m_max_blocks_per_row = m_max_mcus_per_row * m_max_blocks_per_mcu;
 
     // Should never happen
     if (m_max_blocks_per_row > JPGD_MAX_BLOCKS_PER_ROW) stop_decoding(JPGD_ASSERTION_ERROR);
 
-    // Allocate the coefficient buffer, enough for one MCU
-    m_pMCU_coefficients = (jpgd_block_t*)alloc(m_max_blocks_per_mcu * 64 * sizeof(jpgd_block_t));
-
-    for (i = 0; i < m_max_blocks_per_mcu; i++) {
-        m_mcu_block_max_zag[i] = 64;
-    }
-
     m_expanded_blocks_per_component = m_comp_h_samp[0] * m_comp_v_samp[0];
     m_expanded_blocks_per_mcu = m_expanded_blocks_per_component * m_comps_in_frame;
     m_expanded_blocks_per_row = m_max_mcus_per_row * m_expanded_blocks_per_mcu;
     // Freq. domain chroma upsampling is only supported for H2V2 subsampling factor (the most common one I've seen).
     m_freq_domain_chroma_upsample = false;
 #if JPGD_SUPPORT_FREQ_DOMAIN_UPSAMPLING
-    m_freq_domain_chroma_upsample = (m_expanded_blocks_per_mcu == 4*3);
+    m_freq_domain_chroma_upsample = (m_expanded_blocks_per_mcu == 4*3) && (m_scale == 1);
 #endif
 
+    init_buffers();
+
+    m_total_lines_left = get_scaled_height();
+    m_mcu_lines_left = 0;
+    create_look_ups();
+}
+
+
+// Allocates the working buffers of a MCU row.
+void jpeg_decoder::init_buffers()
+{
+    // Initialize two scan line buffers.
+    m_pScan_line_0 = (uint8_t *)alloc(m_dest_bytes_per_scan_line, true);
+    if ((m_scan_type == JPGD_YH1V2) || (m_scan_type == JPGD_YH2V2)) {
+        m_pScan_line_1 = (uint8_t *)alloc(m_dest_bytes_per_scan_line, true);
+    }
+
+    // Allocate the coefficient buffer, enough for one MCU
+    m_pMCU_coefficients = (jpgd_block_t*)alloc(m_max_blocks_per_mcu * 64 * sizeof(jpgd_block_t));
+
+    for (int i = 0; i < m_max_blocks_per_mcu; i++) {
+        m_mcu_block_max_zag[i] = 64;
+    }
+
     if (m_freq_domain_chroma_upsample)
         m_pSample_buf = (uint8_t *)alloc(m_expanded_blocks_per_row * 64);
     else
         m_pSample_buf = (uint8_t *)alloc(m_max_blocks_per_row * 64);
-
-    m_total_lines_left = m_image_y_size;
-    m_mcu_lines_left = 0;
-    create_look_ups();
 }
 
 
@@ -2533,7 +2957,7 @@ jpeg_decoder::coeff_buf* jpeg_decoder::coeff_buf_open(int block_num_x, int block
     cb->block_len_x = block_len_x;
     cb->block_len_y = block_len_y;
     cb->block_size = (block_len_x * block_len_y) * sizeof(jpgd_block_t);
-    cb->pData = (uint8_t *)alloc(cb->block_size * block_num_x * block_num_y, true);
+    cb->pData = (uint8_t *)alloc(size_t(cb->block_size) * block_num_x * block_num_y, true);
     return cb;
 }
 
@@ -2541,7 +2965,7 @@ jpeg_decoder::coeff_buf* jpeg_decoder::coeff_buf_open(int block_num_x, int block
 inline jpgd_block_t *jpeg_decoder::coeff_buf_getp(coeff_buf *cb, int block_x, int block_y)
 {
     JPGD_ASSERT((block_x < cb->block_num_x) && (block_y < cb->block_num_y));
-    return (jpgd_block_t *)(cb->pData + block_x * cb->block_size + block_y * (cb->block_size * cb->block_num_x));
+    return (jpgd_block_t *)(cb->pData + block_x * cb->block_size + block_y * (size_t(cb->block_size) * cb->block_num_x));
 }
 
 
@@ -2801,12 +3225,32 @@ jpeg_decoder::jpeg_decoder(jpeg_decoder_stream *pStream)
 }
 
 
-int jpeg_decoder::begin_decoding()
+// A worker of the parallel decoding. It decodes the scan of the parent from pData, or only transforms the coefficients without it.
+// The tables of the parent are shared, the parent must outlive it.
+jpeg_decoder::jpeg_decoder(const jpeg_decoder &parent, const uint8_t *pData, uint32_t size)
+{
+    *this = parent;
+    m_pMem_blocks = nullptr;
+    m_pStream = pData ? new jpeg_decoder_mem_stream(pData, size) : nullptr;
+    m_pIn_buf_ofs = m_in_buf;
+    m_in_buf_left = 0;
+    m_eof_flag = false;
+    m_tem_flag = 0;
+    m_total_bytes_read = 0;
+
+    if (setjmp(m_jmp_state)) return;
+    init_buffers();
+}
+
+
+int jpeg_decoder::begin_decoding(int scale)
 {
     if (m_ready_flag) return JPGD_SUCCESS;
     if (m_error_code) return JPGD_FAILED;
     if (setjmp(m_jmp_state)) return JPGD_FAILED;
 
+    if (scale == 2 || scale == 4 || scale == 8) m_scale = scale;
+
     decode_start();
     m_ready_flag = true;
 
@@ -2905,6 +3349,369 @@ int jpeg_decoder_mem_stream::read(uint8_t *pBuf, int max_bytes_to_read, bool *pE
 }
 
 
+// Expands the 8-bit grayscale pixels to BGRA.
+static void gray_to_bgra(const uint8_t* s, uint8_t* d, int n)
+{
+    int x = 0;
+#if defined(JPGD_SSE2)
+    const __m128i alpha = _mm_set1_epi8(-1);
+    for (; x + 16 <= n; x += 16, d += 64) {
+        const __m128i g = _mm_loadu_si128((const __m128i*)(s + x));
+        const __m128i gg = _mm_unpacklo_epi8(g, g);
+        const __m128i ga = _mm_unpacklo_epi8(g, alpha);
+        const __m128i gg2 = _mm_unpackhi_epi8(g, g);
+        const __m128i ga2 = _mm_unpackhi_epi8(g, alpha);
+        _mm_storeu_si128((__m128i*)d, _mm_unpacklo_epi16(gg, ga));
+        _mm_storeu_si128((__m128i*)(d + 16), _mm_unpackhi_epi16(gg, ga));
+        _mm_storeu_si128((__m128i*)(d + 32), _mm_unpacklo_epi16(gg2, ga2));
+        _mm_storeu_si128((__m128i*)(d + 48), _mm_unpackhi_epi16(gg2, ga2));
+    }
+#elif defined(JPGD_NEON)
+    for (; x + 16 <= n; x += 16, d += 64) {
+        uint8x16x4_t px;
+        px.val[0] = px.val[1] = px.val[2] = vld1q_u8(s + x);
+        px.val[3] = vdupq_n_u8(255);
+        vst4q_u8(d, px);
+    }
+#endif
+    for (; x < n; x++, d += 4) {
+        d[0] = d[1] = d[2] = s[x];
+        d[3] = 255;
+    }
+}
+
+
+// Writes a scan line to the image in the requested number of components.
+static void write_line(const uint8_t* pScan_line, uint8_t* pDst, int width, int comps, int req_comps)
+{
+    //The color scan lines are converted to BGRA already
+    if (((req_comps == 1) && (comps == 1)) || ((req_comps == 4) && (comps == 3))) {
+        memcpy(pDst, pScan_line, width * req_comps);
+    } else if (comps == 1) {
+        if (req_comps == 3) {
+            for (int x = 0; x < width; x++) {
+                uint8_t luma = pScan_line[x];
+                pDst[0] = luma;
+                pDst[1] = luma;
+                pDst[2] = luma;
+                pDst += 3;
+            }
+        } else gray_to_bgra(pScan_line, pDst, width);
+    } else if (comps == 3) {
+        if (req_comps == 1) {
+            const int YR = 19595, YG = 38470, YB = 7471;
+            for (int x = 0; x < width; x++) {
+                int r = pScan_line[x*4+2];
+                int g = pScan_line[x*4+1];
+                int b = pScan_line[x*4+0];
+                *pDst++ = static_cast<uint8_t>((r * YR + g * YG + b * YB + 32768) >> 16);
+            }
+        } else {
+            for (int x = 0; x < width; x++) {
+                pDst[0] = pScan_line[x*4+2];
+                pDst[1] = pScan_line[x*4+1];
+                pDst[2] = pScan_line[x*4+0];
+                pDst += 3;
+            }
+        }
+    }
+}
+
+
+// Finds where the bands of the scan begin, a band begins after every band_intervals restart markers.
+static bool locate_restarts(const uint8_t* pScan, uint32_t size, int band_intervals, int bands, uint32_t* pBand_ofs)
+{
+    if (size < 2) return false;
+
+    const uint8_t* p = pScan;
+    const uint8_t* pEnd = pScan + size - 1;
+    int band = 1, intervals = 0;
+
+    pBand_ofs[0] = 0;
+
+    while ((band < bands) && (p = (const uint8_t*)memchr(p, 0xFF, pEnd - p))) {
+        int c = p[1];
+        if ((c >= M_RST0) && (c <= M_RST7)) {
+            if (++intervals % band_intervals == 0) pBand_ofs[band++] = static_cast<uint32_t>(p + 2 - pScan);
+        // Any other marker ends the scan, 0xFF00 is a stuffed byte and 0xFFFF is a fill byte.
+        } else if ((c != 0) && (c != 0xFF)) break;
+        p += (c == 0xFF) ? 1 : 2;
+    }
+    return band == bands;
+}
+
+
+struct jpeg_decoder::parallel_ctx
+{
+    jpeg_decoder* pParent;
+    uint8_t* pImage;
+    int req_comps;
+
+    // The bands of MCU rows, decoded independently from each other.
+    int band_rows;
+    const uint8_t* pScan;                         // entropy coded data of the scan, null if the coefficients are decoded already
+    uint32_t scan_size;
+    uint32_t* pBand_ofs;                          // offset of each band in pScan
+
+    // The pipeline, a thread decodes the coefficients of the next rows while the workers transform the current ones.
+    jpeg_decoder** pWorkers;
+    jpgd_block_t* pCoeffs[2];
+    int* pMax_zag[2];
+    int buf;                                      // the buffer of the rows in transformation
+    int row, rows;                                // the rows in transformation
+    int ahead;                                    // the rows decoded into the other buffer
+    std::atomic<int> next;
+
+    std::atomic<bool> failed;
+};
+
+
+// Converts the decoded MCU row to the lines of the image.
+void jpeg_decoder::output_row(int row, uint8_t* pImage, int req_comps)
+{
+    const int width = get_scaled_width();
+    int y = row * m_mcu_lines;
+    int lines = JPGD_MIN(m_mcu_lines, get_scaled_height() - y);
+
+    for (m_mcu_lines_left = m_mcu_lines; lines > 0; lines--, y++, m_mcu_lines_left--) {
+        write_line(convert_line(), pImage + size_t(y) * width * req_comps, width, m_comps_in_frame, req_comps);
+    }
+}
+
+
+// Decodes a band of the image, on a worker decoder.
+int jpeg_decoder::decode_band(const parallel_ctx* ctx, int row, int rows)
+{
+    if (setjmp(m_jmp_state)) return JPGD_FAILED;
+
+    if (m_progressive_flag) {
+        // Skip to the coefficients of the band.
+        if (m_comps_in_scan == 1) m_block_y_mcu[m_comp_list[0]] = row;
+        else {
+            for (int i = 0; i < m_comps_in_scan; i++) {
+                m_block_y_mcu[m_comp_list[i]] = row * m_comp_v_samp[m_comp_list[i]];
+            }
+        }
+    } else reset_interval((row * m_mcus_per_row / m_restart_interval) & 7);
+
+    for (int i = 0; i < rows; i++) {
+        if (m_progressive_flag) load_next_row();
+        else decode_next_row();
+        output_row(row + i, ctx->pImage, ctx->req_comps);
+    }
+    return JPGD_SUCCESS;
+}
+
+
+void jpeg_decoder::decode_band_job(void* data, uint32_t idx)
+{
+    auto ctx = static_cast<parallel_ctx*>(data);
+    auto parent = ctx->pParent;
+    const int row = idx * ctx->band_rows;
+    const int rows = JPGD_MIN(ctx->band_rows, parent->m_max_mcus_per_col - row);
+
+    const uint8_t* pData = nullptr;
+    uint32_t size = 0;
+    if (ctx->pScan) {
+        pData = ctx->pScan + ctx->pBand_ofs[idx];
+        size = ctx->scan_size - ctx->pBand_ofs[idx];
+    }
+
+    auto decoder = new jpeg_decoder(*parent, pData, size);
+    if ((decoder->get_error_code() != JPGD_SUCCESS) || (decoder->decode_band(ctx, row, rows) != JPGD_SUCCESS)) ctx->failed = true;
+    delete(decoder);
+}
+
+
+void jpeg_decoder::decode_pipe_job(void* data, uint32_t idx)
+{
+    auto ctx = static_cast<parallel_ctx*>(data);
+    auto parent = ctx->pParent;
+
+    // The first job decodes the next rows in the meantime.
+    if (idx == 0) {
+        const int next = ctx->buf ^ 1;
+        if ((ctx->ahead > 0) && (parent->decode_coeffs(ctx->pCoeffs[next], ctx->pMax_zag[next], ctx->ahead) != JPGD_SUCCESS)) ctx->failed = true;
+        return;
+    }
+
+    auto worker = ctx->pWorkers[idx - 1];
+    const int row_blocks = parent->m_mcus_per_row * parent->m_blocks_per_mcu;
+
+    for (int i = ctx->next++; i < ctx->rows; i = ctx->next++) {
+        worker->transform_row(ctx->pCoeffs[ctx->buf] + i * row_blocks * 64, ctx->pMax_zag[ctx->buf] + i * row_blocks);
+        worker->output_row(ctx->row + i, ctx->pImage, ctx->req_comps);
+    }
+}
+
+
+bool jpeg_decoder::can_decode_parallel() const
+{
+    if ((m_error_code) || (!m_ready_flag) || (m_total_lines_left != get_scaled_height())) return false;
+
+    // Not worth it for the small images.
+    return (TaskScheduler::threads() > 0) && (m_max_mcus_per_col >= 4) && (m_image_x_size * m_image_y_size >= 256 * 256);
+}
+
+
+int jpeg_decoder::decode_parallel(uint8_t* pImage, int req_comps)
+{
+    if ((m_error_code) || (!m_ready_flag)) return JPGD_FAILED;
+
+    const int threads = TaskScheduler::threads();
+    const int rows = m_max_mcus_per_col;
+
+    parallel_ctx ctx;
+    ctx.pParent = this;
+    ctx.pImage = pImage;
+    ctx.req_comps = req_comps;
+    ctx.pScan = nullptr;
+    ctx.scan_size = 0;
+    ctx.pBand_ofs = nullptr;
+    ctx.failed = false;
+
+    // A few bands per thread to balance the load.
+    int bands = (threads + 1) * 4;
+    ctx.band_rows = JPGD_MAX(1, (rows + bands - 1) / bands);
+
+    // Progressive images have all the coefficients decoded already, any band can be transformed separately.
+    if (m_progressive_flag) {
+        bands = (rows + ctx.band_rows - 1) / ctx.band_rows;
+        TaskScheduler::parallel(bands, decode_band_job, &ctx);
+        m_total_lines_left = 0;
+        return ctx.failed ? JPGD_FAILED : JPGD_SUCCESS;
+    }
+
+    // The restart markers split the scan into the pieces decodable separately. A band begins at a MCU row which begins a restart interval as well.
+    uint32_t size;
+    auto pData = m_pStream ? m_pStream->get_data(&size) : nullptr;
+
+    if (m_restart_interval && pData && (m_scan_ofs < size)) {
+        int a = m_restart_interval, b = m_mcus_per_row;
+        while (b) { int t = a % b; a = b; b = t; }
+        const int step = m_restart_interval / a;
+        ctx.band_rows = ((ctx.band_rows + step - 1) / step) * step;
+        bands = (rows + ctx.band_rows - 1) / ctx.band_rows;
+
+        if (bands > 1) {
+            ctx.pScan = pData + m_scan_ofs;
+            ctx.scan_size = size - m_scan_ofs;
+            ctx.pBand_ofs = (uint32_t*)malloc(bands * sizeof(uint32_t));
+            if (ctx.pBand_ofs && locate_restarts(ctx.pScan, ctx.scan_size, ctx.band_rows * m_mcus_per_row / m_restart_interval, bands, ctx.pBand_ofs)) {
+                TaskScheduler::parallel(bands, decode_band_job, &ctx);
+                free(ctx.pBand_ofs);
+                m_total_lines_left = 0;
+                return ctx.failed ? JPGD_FAILED : JPGD_SUCCESS;
+            }
+            // Broken markers, let the pipeline report it.
+            free(ctx.pBand_ofs);
+        }
+    }
+
+    // Pipeline the entropy decoding with the rest.
+    const int batch = (threads + 1) * 2;
+    const int row_blocks = m_mcus_per_row * m_blocks_per_mcu;
+
+    ctx.pWorkers = (jpeg_decoder**)calloc(threads, sizeof(jpeg_decoder*));
+    ctx.pCoeffs[0] = (jpgd_block_t*)calloc(2 * batch * row_blocks * 64, sizeof(jpgd_block_t));
+    ctx.pMax_zag[0] = (int*)malloc(2 * batch * row_blocks * sizeof(int));
+    ctx.pCoeffs[1] = ctx.pCoeffs[0] ? ctx.pCoeffs[0] + batch * row_blocks * 64 : nullptr;
+    ctx.pMax_zag[1] = ctx.pMax_zag[0] ? ctx.pMax_zag[0] + batch * row_blocks : nullptr;
+
+    if (ctx.pWorkers && ctx.pCoeffs[0] && ctx.pMax_zag[0]) {
+        for (int i = 0; i < 2 * batch * row_blocks; i++) ctx.pMax_zag[0][i] = 64;
+        for (int i = 0; i < threads; i++) {
+            ctx.pWorkers[i] = new jpeg_decoder(*this, nullptr, 0);
+            if (ctx.pWorkers[i]->get_error_code() != JPGD_SUCCESS) ctx.failed = true;
+        }
+    } else ctx.failed = true;
+
+    ctx.buf = 0;
+    if (!ctx.failed && (decode_coeffs(ctx.pCoeffs[0], ctx.pMax_zag[0], JPGD_MIN(batch, rows)) != JPGD_SUCCESS)) ctx.failed = true;
+
+    for (int row = 0; (row < rows) && !ctx.failed; row += batch) {
+        ctx.row = row;
+        ctx.rows = JPGD_MIN(batch, rows - row);
+        ctx.ahead = JPGD_MIN(batch, rows - row - ctx.rows);
+        ctx.next = 0;
+        TaskScheduler::parallel(threads + 1, decode_pipe_job, &ctx);
+        ctx.buf ^= 1;
+    }
+
+    if (ctx.pWorkers) {
+        for (int i = 0; i < threads; i++) delete(ctx.pWorkers[i]);
+        free(ctx.pWorkers);
+    }
+    free(ctx.pCoeffs[0]);
+    free(ctx.pMax_zag[0]);
+
+    m_total_lines_left = 0;
+    return ctx.failed ? JPGD_FAILED : JPGD_SUCCESS;
+}
+
+
+// Decodes the MCU rows of the region after skipping the given MCUs, on this decoder or on a clone placed at a restart interval.
+int jpeg_decoder::decode_rows(uint8_t* pDst, int stride, int x, int y, int w, int h, int req_comps, int skip, int next_restart_num)
+{
+    if (setjmp(m_jmp_state)) return JPGD_FAILED;
+
+    if (next_restart_num >= 0) reset_interval(next_restart_num);
+
+    // Nothing tells where a MCU begins, the ones before the region are entropy decoded only.
+    // The count is a local of the loop, the argument itself isn't modified after setjmp().
+    for (int mcus = skip; mcus > 0; mcus--) {
+        if ((m_restart_interval) && (m_restarts_left == 0)) process_restart();
+        decode_next_mcu(m_pMCU_coefficients, m_mcu_block_max_zag);
+        m_restarts_left--;
+    }
+
+    const int offset = x * m_dest_bytes_per_pixel;
+    const int bottom = y + h;
+
+    for (int line = (y / m_mcu_lines) * m_mcu_lines; line < bottom; ) {
+        decode_next_row();
+        for (m_mcu_lines_left = m_mcu_lines; (m_mcu_lines_left > 0) && (line < bottom); m_mcu_lines_left--, line++) {
+            const uint8_t* pScan_line = convert_line();
+            if (line >= y) write_line(pScan_line + offset, pDst + size_t(line - y) * stride, w, m_comps_in_frame, req_comps);
+        }
+    }
+    return JPGD_SUCCESS;
+}
+
+
+int jpeg_decoder::decode_region(uint8_t* pDst, int stride, int x, int y, int w, int h, int req_comps)
+{
+    if ((m_error_code) || (!m_ready_flag) || (m_progressive_flag) || (m_total_lines_left != get_scaled_height())) return JPGD_FAILED;
+    if ((x < 0) || (y < 0) || (w <= 0) || (h <= 0) || (x + w > get_scaled_width()) || (y + h > get_scaled_height())) return JPGD_FAILED;
+
+    const int mcu_width = m_max_mcu_x_size / m_scale;
+    m_mcu_x0 = x / mcu_width;
+    m_mcu_x1 = (x + w - 1) / mcu_width + 1;
+    m_total_lines_left = 0;
+
+    const int skip = (y / m_mcu_lines) * m_mcus_per_row;
+
+    // Begin at the restart interval of the first row rather than decoding all the rows above.
+    uint32_t size;
+    auto pData = m_pStream ? m_pStream->get_data(&size) : nullptr;
+    const int interval = m_restart_interval ? skip / m_restart_interval : 0;
+
+    if ((interval > 0) && pData && (m_scan_ofs < size)) {
+        uint32_t ofs[2];
+        if (locate_restarts(pData + m_scan_ofs, size - m_scan_ofs, interval, 2, ofs)) {
+            auto decoder = new jpeg_decoder(*this, pData + m_scan_ofs + ofs[1], size - m_scan_ofs - ofs[1]);
+            int ret = JPGD_FAILED;
+            if (decoder->get_error_code() == JPGD_SUCCESS) {
+                ret = decoder->decode_rows(pDst, stride, x, y, w, h, req_comps, skip - interval * m_restart_interval, interval & 7);
+            }
+            delete(decoder);
+            return ret;
+        }
+    }
+    return decode_rows(pDst, stride, x, y, w, h, req_comps, skip, -1);
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -2953,23 +3760,31 @@ void jpgdDelete(jpeg_decoder* decoder)
 }
 
 
-unsigned char* jpgdDecompress(jpeg_decoder* decoder)
+unsigned char* jpgdDecompress(jpeg_decoder* decoder, int scale)
 {
     if (!decoder) return nullptr;
 
     int req_comps = 4;  //TODO: fixed 4 channel components now?
     if ((req_comps != 1) && (req_comps != 3) && (req_comps != 4)) return nullptr;
 
-    auto image_width = decoder->get_width();
-    auto image_height = decoder->get_height();
     //auto actual_comps = decoder->get_num_components();
 
-    if (decoder->begin_decoding() != JPGD_SUCCESS) return nullptr;
+    if (decoder->begin_decoding(scale) != JPGD_SUCCESS) return nullptr;
+
+    auto image_width = decoder->get_scaled_width();
+    auto image_height = decoder->get_scaled_height();
 
     const int dst_bpl = image_width * req_comps;
-    uint8_t *pImage_data = (uint8_t*)malloc(dst_bpl * image_height);
+    uint8_t *pImage_data = (uint8_t*)malloc(size_t(dst_bpl) * image_height);
     if (!pImage_data) return nullptr;
 
+    //the large images are decoded by the worker threads
+    if (decoder->can_decode_parallel()) {
+        if (decoder->decode_parallel(pImage_data, req_comps) == JPGD_SUCCESS) return pImage_data;
+        free(pImage_data);
+        return nullptr;
+    }
+
     for (int y = 0; y < image_height; y++) {
         const uint8_t* pScan_line;
         uint32_t scan_line_len;
@@ -2977,57 +3792,21 @@ unsigned char* jpgdDecompress(jpeg_decoder* decoder)
             free(pImage_data);
             return nullptr;
         }
-
-        uint8_t *pDst = pImage_data + y * dst_bpl;
-
-        //Return as BGRA
-        if ((req_comps == 4) && (decoder->get_num_components() == 3)) {
-            for (int x = 0; x < image_width; x++) {
-                pDst[0] = pScan_line[x*4+2];
-                pDst[1] = pScan_line[x*4+1];
-                pDst[2] = pScan_line[x*4+0];
-                pDst[3] = 255;
-                pDst += 4;
-            }
-        } else if (((req_comps == 1) && (decoder->get_num_components() == 1)) || ((req_comps == 4) && (decoder->get_num_components() == 3))) {
-            memcpy(pDst, pScan_line, dst_bpl);
-        } else if (decoder->get_num_components() == 1) {
-            if (req_comps == 3) {
-                for (int x = 0; x < image_width; x++) {
-                    uint8_t luma = pScan_line[x];
-                    pDst[0] = luma;
-                    pDst[1] = luma;
-                    pDst[2] = luma;
-                    pDst += 3;
-                }
-            } else {
-                for (int x = 0; x < image_width; x++) {
-                    uint8_t luma = pScan_line[x];
-                    pDst[0] = luma;
-                    pDst[1] = luma;
-                    pDst[2] = luma;
-                    pDst[3] = 255;
-                    pDst += 4;
-                }
-            }
-        } else if (decoder->get_num_components() == 3) {
-            if (req_comps == 1) {
-                const int YR = 19595, YG = 38470, YB = 7471;
-                for (int x = 0; x < image_width; x++) {
-                    int r = pScan_line[x*4+0];
-                    int g = pScan_line[x*4+1];
-                    int b = pScan_line[x*4+2];
-                    *pDst++ = static_cast<uint8_t>((r * YR + g * YG + b * YB + 32768) >> 16);
-                }
-            } else {
-                for (int x = 0; x < image_width; x++) {
-                    pDst[0] = pScan_line[x*4+0];
-                    pDst[1] = pScan_line[x*4+1];
-                    pDst[2] = pScan_line[x*4+2];
-                    pDst += 3;
-                }
-            }
-        }
+        write_line(pScan_line, pImage_data + size_t(y) * dst_bpl, image_width, decoder->get_num_components(), req_comps);
     }
     return pImage_data;
 }
+
+
+bool jpgdProgressive(jpeg_decoder* decoder)
+{
+    return decoder && decoder->is_progressive();
+}
+
+
+bool jpgdDecompress(jpeg_decoder* decoder, int scale, int x, int y, int w, int h, unsigned char* dst, int stride)
+{
+    if (!decoder) return false;
+    if (decoder->begin_decoding(scale) != JPGD_SUCCESS) return false;
+    return decoder->decode_region(dst, stride, x, y, w, h, 4) == JPGD_SUCCESS;
+}
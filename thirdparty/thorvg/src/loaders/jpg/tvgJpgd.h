@@ -29,7 +29,9 @@ class jpeg_decoder;
 
 jpeg_decoder* jpgdHeader(const char* data, int size, int* width, int* height);
 jpeg_decoder* jpgdHeader(const char* filename, int* width, int* height);
-unsigned char* jpgdDecompress(jpeg_decoder* decoder);
+unsigned char* jpgdDecompress(jpeg_decoder* decoder, int scale = 1);  //reduces the image by 1/scale (2, 4 or 8) while decoding
+bool jpgdDecompress(jpeg_decoder* decoder, int scale, int x, int y, int w, int h, unsigned char* dst, int stride);  //decodes the region of the reduced image only, not for the progressive images
+bool jpgdProgressive(jpeg_decoder* decoder);
 void jpgdDelete(jpeg_decoder* decoder);
 
 #endif //_TVG_JPGD_H_
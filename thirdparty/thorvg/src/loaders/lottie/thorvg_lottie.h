@@ -79,6 +79,42 @@ public:
      */
     const char* marker(uint32_t idx) noexcept;
 
+    /**
+     * @brief Specifies the rendering quality of the Lottie effects.
+     *
+     * Lowering the quality reduces the cost of the effects, such as the Gaussian blur, at the expense of their accuracy.
+     * At the lowest level, the effects are skipped.
+     *
+     * @param[in] value The quality level, in the range of 0 to 100. The default value is 100.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InsufficientCondition In case the animation is not loaded.
+     * @retval Result::InvalidArguments When the given @p value is out of the range.
+     *
+     * @note The change is applied when the canvas is updated next time.
+     * @see LottiePlayer
+     * @note Experimental API
+     */
+    Result quality(uint8_t value) noexcept;
+
+    /**
+     * @brief Converts a Lottie file into the precompiled binary format.
+     *
+     * The precompiled binary keeps the parsed animation data with the decoded embedded images,
+     * so it can be loaded with no parsing cost by Picture::load(). Use the "tvl" file extension for it.
+     *
+     * @param[in] path The path of the Lottie (json) file to convert.
+     * @param[in] target The path of the binary file to write.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InvalidArguments When the given parameter is invalid.
+     * @retval Result::Unknown When the Lottie file can't be parsed or the binary file can't be written.
+     *
+     * @note The binary is bound to the ThorVG version and the machine architecture which generated it.
+     * @note Experimental API
+     */
+    static Result compile(const char* path, const char* target) noexcept;
+
     /**
      * @brief Creates a new LottieAnimation object.
      *
@@ -89,6 +125,92 @@ public:
     static std::unique_ptr<LottieAnimation> gen() noexcept;
 };
 
+
+/**
+ * @class LottiePlayer
+ *
+ * @brief The LottiePlayer class drives the playback of a LottieAnimation within a time budget.
+ *
+ * The player presents the frame of the given playback time, so the animation keeps its speed
+ * by dropping the intermediate frames when the update and the rasterization can't catch up the target frame rate.
+ * It measures the cost of every presented frame and, if adaptive quality is enabled, lowers the rendering quality
+ * while the cost exceeds the frame budget and restores it once there is enough headroom again.
+ *
+ * @note Experimental API
+ */
+class TVG_API LottiePlayer final
+{
+public:
+    ~LottiePlayer();
+
+    /**
+     * @brief Sets the canvas and the animation to play.
+     *
+     * The canvas must contain the picture of the @p animation. The player doesn't take the ownership
+     * of both, they must be alive during the playback. The statistics are reset.
+     *
+     * @param[in] canvas The canvas to update and draw the frames.
+     * @param[in] animation The animation to play.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InvalidArguments When the given parameter is invalid.
+     */
+    Result target(Canvas* canvas, LottieAnimation* animation) noexcept;
+
+    /**
+     * @brief Sets the target frame rate of the playback.
+     *
+     * @param[in] fps The frames per second to present. The frame rate of the animation is used if @c 0.
+     *
+     * @retval Result::Success When succeed.
+     * @retval Result::InvalidArguments When the given @p fps is negative.
+     */
+    Result fps(float fps) noexcept;
+
+    /**
+     * @brief Allows the player to lower the rendering quality under pressure.
+     *
+     * @param[in] on @c true to enable the adaptive quality, @c false to keep the full quality. The default is @c true.
+     *
+     * @retval Result::Success When succeed.
+     */
+    Result adaptive(bool on) noexcept;
+
+    /**
+     * @brief Presents the frame of the given playback time.
+     *
+     * The player updates the animation and the canvas, then draws and synchronizes the canvas.
+     * Call this at every display refresh. The animation loops over its duration.
+     *
+     * @param[in] time The elapsed playback time in seconds.
+     *
+     * @retval Result::Success When a new frame was presented.
+     * @retval Result::InsufficientCondition When the frame of the target rate at @p time was presented already, or no target is set.
+     */
+    Result play(float time) noexcept;
+
+    /**
+     * @brief Retrieves the playback statistics since the target was set.
+     *
+     * @param[out] presented The number of the presented frames.
+     * @param[out] dropped The number of the frames skipped to keep up with the playback time.
+     * @param[out] cost The average cost of a presented frame in milliseconds.
+     * @param[out] quality The current rendering quality level, in the range of 0 to 100.
+     *
+     * @retval Result::Success When succeed.
+     */
+    Result stats(uint32_t* presented, uint32_t* dropped, float* cost, uint8_t* quality) const noexcept;
+
+    /**
+     * @brief Creates a new LottiePlayer object.
+     *
+     * @return A new LottiePlayer object.
+     */
+    static std::unique_ptr<LottiePlayer> gen() noexcept;
+
+    _TVG_DECLARE_PRIVATE(LottiePlayer);
+};
+
 } //namespace
 
 #endif //_THORVG_LOTTIE_H_
@@ -82,6 +82,29 @@ const char* LottieAnimation::marker(uint32_t idx) noexcept
 }
 
 
+Result LottieAnimation::quality(uint8_t value) noexcept
+{
+    if (value > 100) return Result::InvalidArguments;
+
+    auto loader = pImpl->picture->pImpl->loader;
+    if (!loader) return Result::InsufficientCondition;
+
+    if (static_cast<LottieLoader*>(loader)->quality(value)) return Result::Success;
+
+    return Result::InsufficientCondition;
+}
+
+
+Result LottieAnimation::compile(const char* path, const char* target) noexcept
+{
+    if (!path || !target) return Result::InvalidArguments;
+
+    if (LottieLoader::compile(path, target)) return Result::Success;
+
+    return Result::Unknown;
+}
+
+
 unique_ptr<LottieAnimation> LottieAnimation::gen() noexcept
 {
     return unique_ptr<LottieAnimation>(new LottieAnimation);
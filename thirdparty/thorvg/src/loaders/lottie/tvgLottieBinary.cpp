@@ -0,0 +1,1560 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "tvgStr.h"
+#include "tvgCompressor.h"
+#include "tvgLottieBinary.h"
+
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+enum LayerFlag : uint8_t
+{
+    Hidden = 0x01,
+    AutoOrient = 0x02,
+    MatteSource = 0x04,
+    Container = 0x08,          //precomposition which owns the layers
+    CompRoot = 0x10,           //the precompositor is the root
+    Transform = 0x20,
+    SolidColor = 0x40
+};
+
+
+enum GroupFlag : uint8_t
+{
+    ReqFragment = 0x01,
+    Trimpath = 0x02,
+    Visible = 0x04,
+    AllowMerge = 0x08
+};
+
+
+enum AssetType : uint8_t
+{
+    Precomp = 0,
+    Image
+};
+
+
+static uint8_t _groupFlags(LottieGroup* group)
+{
+    uint8_t flags = 0;
+    if (group->reqFragment) flags |= GroupFlag::ReqFragment;
+    if (group->trimpath) flags |= GroupFlag::Trimpath;
+    if (group->visible) flags |= GroupFlag::Visible;
+    if (group->allowMerge) flags |= GroupFlag::AllowMerge;
+    return flags;
+}
+
+
+static void _groupFlags(LottieGroup* group, uint8_t flags)
+{
+    group->reqFragment = flags & GroupFlag::ReqFragment;
+    group->trimpath = flags & GroupFlag::Trimpath;
+    group->visible = flags & GroupFlag::Visible;
+    group->allowMerge = flags & GroupFlag::AllowMerge;
+}
+
+
+static uint32_t _hash(const void* ptr)
+{
+    auto key = uint64_t(uintptr_t(ptr)) * 0x9e3779b97f4a7c15ULL;
+    return uint32_t(key >> 32);
+}
+
+
+//indexes the pointers by open addressing, the buckets keep index + 1
+template<typename T>
+static void _indexPointers(Array<uint32_t>& buckets, const Array<T*>& ptrs)
+{
+    uint32_t cnt = 16;
+    while (cnt < ptrs.count * 2) cnt <<= 1;
+    buckets.reset();
+    buckets.reserve(cnt);
+    buckets.count = cnt;
+    memset(buckets.data, 0x00, sizeof(uint32_t) * cnt);
+    for (uint32_t i = 0; i < ptrs.count; ++i) {
+        auto b = _hash(ptrs[i]) & (cnt - 1);
+        while (buckets[b]) b = (b + 1) & (cnt - 1);
+        buckets[b] = i + 1;
+    }
+}
+
+
+template<typename T>
+static uint32_t _findPointer(const Array<uint32_t>& buckets, const Array<T*>& ptrs, const T* ptr)
+{
+    auto mask = buckets.count - 1;
+    for (auto b = _hash(ptr) & mask; buckets[b]; b = (b + 1) & mask) {
+        if (ptrs[buckets[b] - 1] == ptr) return buckets[b] - 1;
+    }
+    return LOTTIE_BINARY_NONE;
+}
+
+
+/************************************************************************/
+/* LottieBinaryWriter Implementation                                    */
+/************************************************************************/
+
+LottieBinaryWriter::~LottieBinaryWriter()
+{
+    for (auto s = strings.begin(); s < strings.end(); ++s) free(*s);
+}
+
+
+void LottieBinaryWriter::write(const void* data, uint32_t size)
+{
+    if (size == 0) return;
+    if (body.count + size > body.reserved) body.reserve((body.count + size) * 2);
+    memcpy(body.data + body.count, data, size);
+    body.count += size;
+}
+
+
+void LottieBinaryWriter::writeString(const char* str)
+{
+    if (!str) {
+        write<uint32_t>(LOTTIE_BINARY_NONE);
+        return;
+    }
+
+    //rehash the table when it's half full
+    if (strings.count * 2 >= buckets.count) {
+        auto cnt = buckets.count > 0 ? buckets.count * 2 : 256;
+        buckets.reset();
+        buckets.reserve(cnt);
+        buckets.count = cnt;
+        memset(buckets.data, 0x00, sizeof(uint32_t) * cnt);
+        for (uint32_t i = 0; i < strings.count; ++i) {
+            auto b = djb2Encode(strings[i]) & (cnt - 1);
+            while (buckets[b]) b = (b + 1) & (cnt - 1);
+            buckets[b] = i + 1;
+        }
+    }
+
+    auto mask = buckets.count - 1;
+    auto b = djb2Encode(str) & mask;
+    while (buckets[b]) {
+        if (!strcmp(strings[buckets[b] - 1], str)) {
+            write<uint32_t>(buckets[b] - 1);
+            return;
+        }
+        b = (b + 1) & mask;
+    }
+    strings.push(strdup(str));
+    buckets[b] = strings.count;
+    write<uint32_t>(strings.count - 1);
+}
+
+
+void LottieBinaryWriter::writeInterpolator(LottieInterpolator* interpolator)
+{
+    write(interpolator ? _findPointer(interpolatorBuckets, comp->interpolators, interpolator) : LOTTIE_BINARY_NONE);
+}
+
+
+void LottieBinaryWriter::writeExpression(LottieProperty& prop)
+{
+    write(prop.type);
+    write(prop.ix);
+    writeString(prop.exp ? prop.exp->code : nullptr);
+}
+
+
+template<typename T>
+void LottieBinaryWriter::writeProperty(LottieGenericProperty<T>& prop)
+{
+    writeExpression(prop);
+    write(prop.value);
+    write<uint32_t>(prop.frames ? prop.frames->count : 0);
+    if (!prop.frames) return;
+    for (auto f = prop.frames->begin(); f < prop.frames->end(); ++f) {
+        write(f->value);
+        write(f->no);
+        writeInterpolator(f->interpolator);
+        write(f->hold);
+    }
+}
+
+
+void LottieBinaryWriter::writeProperty(LottiePosition& prop)
+{
+    writeExpression(prop);
+    write(prop.value);
+    write<uint32_t>(prop.frames ? prop.frames->count : 0);
+    if (!prop.frames) return;
+    for (auto f = prop.frames->begin(); f < prop.frames->end(); ++f) {
+        write(f->value);
+        write(f->no);
+        writeInterpolator(f->interpolator);
+        write(f->outTangent);
+        write(f->inTangent);
+        write(f->length);
+        write(f->hasTangent);
+        write(f->hold);
+    }
+}
+
+
+void LottieBinaryWriter::writeValue(const PathSet& path)
+{
+    write(path.ptsCnt);
+    write(path.cmdsCnt);
+    write(path.pts, sizeof(Point) * path.ptsCnt);
+    write(path.cmds, sizeof(PathCommand) * path.cmdsCnt);
+}
+
+
+void LottieBinaryWriter::writeProperty(LottiePathSet& prop)
+{
+    writeExpression(prop);
+    writeValue(prop.value);
+    write<uint32_t>(prop.frames ? prop.frames->count : 0);
+    if (!prop.frames) return;
+    for (auto f = prop.frames->begin(); f < prop.frames->end(); ++f) {
+        writeValue(f->value);
+        write(f->no);
+        writeInterpolator(f->interpolator);
+        write(f->hold);
+    }
+}
+
+
+void LottieBinaryWriter::writeValue(const ColorStop& color, uint16_t count)
+{
+    //only the populated color stops are stored
+    if (!color.data) count = 0;
+    write(count);
+    write(color.data, sizeof(Fill::ColorStop) * count);
+}
+
+
+void LottieBinaryWriter::writeProperty(LottieColorStop& prop)
+{
+    writeExpression(prop);
+    write(prop.count);
+    write(prop.populated);
+    writeValue(prop.value, prop.count);
+    write<uint32_t>(prop.frames ? prop.frames->count : 0);
+    if (!prop.frames) return;
+    for (auto f = prop.frames->begin(); f < prop.frames->end(); ++f) {
+        writeValue(f->value, prop.count);
+        write(f->no);
+        writeInterpolator(f->interpolator);
+        write(f->hold);
+    }
+}
+
+
+void LottieBinaryWriter::writeValue(const TextDocument& doc)
+{
+    writeString(doc.text);
+    write(doc.height);
+    write(doc.shift);
+    write(doc.color);
+    write(doc.bbox.pos);
+    write(doc.bbox.size);
+    write(doc.stroke.color);
+    write(doc.stroke.width);
+    write(doc.stroke.render);
+    writeString(doc.name);
+    write(doc.size);
+    write(doc.tracking);
+    write(doc.justify);
+}
+
+
+void LottieBinaryWriter::writeProperty(LottieTextDoc& prop)
+{
+    writeExpression(prop);
+    writeValue(prop.value);
+    write<uint32_t>(prop.frames ? prop.frames->count : 0);
+    if (!prop.frames) return;
+    for (auto f = prop.frames->begin(); f < prop.frames->end(); ++f) {
+        writeValue(f->value);
+        write(f->no);
+        writeInterpolator(f->interpolator);
+        write(f->hold);
+    }
+}
+
+
+void LottieBinaryWriter::writeStroke(LottieStroke* stroke)
+{
+    writeProperty(stroke->width);
+    write<uint8_t>(stroke->dashattr ? 1 : 0);
+    if (stroke->dashattr) {
+        for (int i = 0; i < 3; ++i) writeProperty(stroke->dashattr->value[i]);
+    }
+    write(stroke->miterLimit);
+    write(stroke->cap);
+    write(stroke->join);
+}
+
+
+void LottieBinaryWriter::writeGradient(LottieGradient* gradient)
+{
+    writeProperty(gradient->start);
+    writeProperty(gradient->end);
+    writeProperty(gradient->height);
+    writeProperty(gradient->angle);
+    writeProperty(gradient->opacity);
+    writeProperty(gradient->colorStops);
+    write(gradient->id);
+}
+
+
+void LottieBinaryWriter::writeImage(LottieImage* image)
+{
+    TaskScheduler::join(image);
+
+    write(image->size);
+    write(image->width);
+    write(image->height);
+    writeString(image->mimeType);
+
+    //embedded image data, already decoded from base64
+    if (image->size > 0) {
+        write(image->b64Data, image->size);
+        return;
+    }
+
+    //external image, relative to the resource directory if possible
+    auto len = dirName ? strlen(dirName) : 0;
+    auto relative = (len > 0 && !strncmp(image->path, dirName, len));
+    write<uint8_t>(relative ? 1 : 0);
+    writeString(relative ? image->path + len : image->path);
+}
+
+
+void LottieBinaryWriter::writeText(LottieText* text)
+{
+    writeProperty(text->doc);
+    write(text->ranges.count);
+    for (auto r = text->ranges.begin(); r < text->ranges.end(); ++r) {
+        auto range = *r;
+        auto& style = range->style;
+        writeProperty(style.fillColor);
+        writeProperty(style.strokeColor);
+        writeProperty(style.position);
+        writeProperty(style.scale);
+        writeProperty(style.letterSpacing);
+        writeProperty(style.lineSpacing);
+        writeProperty(style.strokeWidth);
+        writeProperty(style.rotation);
+        writeProperty(style.fillOpacity);
+        writeProperty(style.strokeOpacity);
+        writeProperty(style.opacity);
+        writeProperty(range->offset);
+        writeProperty(range->maxEase);
+        writeProperty(range->minEase);
+        writeProperty(range->maxAmount);
+        writeProperty(range->smoothness);
+        writeProperty(range->start);
+        writeProperty(range->end);
+        write(range->based);
+        write(range->shape);
+        write(range->rangeUnit);
+        write(range->random);
+        write(range->expressible);
+    }
+}
+
+
+void LottieBinaryWriter::writeChildren(Array<LottieObject*>& children)
+{
+    write(children.count);
+    for (auto c = children.begin(); c < children.end(); ++c) writeObject(*c);
+}
+
+
+void LottieBinaryWriter::writeGroup(LottieGroup* group)
+{
+    write(_groupFlags(group));
+    writeChildren(group->children);
+}
+
+
+void LottieBinaryWriter::writeObject(LottieObject* obj)
+{
+    objects.push(obj);
+
+    write(obj->type);
+    write<uint64_t>(obj->id);
+    write(obj->hidden);
+
+    switch (obj->type) {
+        case LottieObject::Group: {
+            writeGroup(static_cast<LottieGroup*>(obj));
+            break;
+        }
+        case LottieObject::Transform: {
+            auto transform = static_cast<LottieTransform*>(obj);
+            writeProperty(transform->position);
+            writeProperty(transform->rotation);
+            writeProperty(transform->scale);
+            writeProperty(transform->anchor);
+            writeProperty(transform->opacity);
+            writeProperty(transform->skewAngle);
+            writeProperty(transform->skewAxis);
+            write<uint8_t>(transform->coords ? 1 : 0);
+            if (transform->coords) {
+                writeProperty(transform->coords->x);
+                writeProperty(transform->coords->y);
+            }
+            write<uint8_t>(transform->rotationEx ? 1 : 0);
+            if (transform->rotationEx) {
+                writeProperty(transform->rotationEx->x);
+                writeProperty(transform->rotationEx->y);
+            }
+            break;
+        }
+        case LottieObject::SolidFill: {
+            auto fill = static_cast<LottieSolidFill*>(obj);
+            writeProperty(fill->color);
+            writeProperty(fill->opacity);
+            write(fill->rule);
+            break;
+        }
+        case LottieObject::SolidStroke: {
+            auto stroke = static_cast<LottieSolidStroke*>(obj);
+            writeProperty(stroke->color);
+            writeProperty(stroke->opacity);
+            writeStroke(stroke);
+            break;
+        }
+        case LottieObject::GradientFill: {
+            auto fill = static_cast<LottieGradientFill*>(obj);
+            writeGradient(fill);
+            write(fill->rule);
+            break;
+        }
+        case LottieObject::GradientStroke: {
+            auto stroke = static_cast<LottieGradientStroke*>(obj);
+            writeGradient(stroke);
+            writeStroke(stroke);
+            break;
+        }
+        case LottieObject::Rect: {
+            auto rect = static_cast<LottieRect*>(obj);
+            write(rect->clockwise);
+            writeProperty(rect->position);
+            writeProperty(rect->size);
+            writeProperty(rect->radius);
+            break;
+        }
+        case LottieObject::Ellipse: {
+            auto ellipse = static_cast<LottieEllipse*>(obj);
+            write(ellipse->clockwise);
+            writeProperty(ellipse->position);
+            writeProperty(ellipse->size);
+            break;
+        }
+        case LottieObject::Path: {
+            auto path = static_cast<LottiePath*>(obj);
+            write(path->clockwise);
+            writeProperty(path->pathset);
+            break;
+        }
+        case LottieObject::Polystar: {
+            auto star = static_cast<LottiePolyStar*>(obj);
+            write(star->clockwise);
+            writeProperty(star->position);
+            writeProperty(star->innerRadius);
+            writeProperty(star->outerRadius);
+            writeProperty(star->innerRoundness);
+            writeProperty(star->outerRoundness);
+            writeProperty(star->rotation);
+            writeProperty(star->ptsCnt);
+            write(star->type);
+            break;
+        }
+        case LottieObject::Image: {
+            writeImage(static_cast<LottieImage*>(obj));
+            break;
+        }
+        case LottieObject::Trimpath: {
+            auto trim = static_cast<LottieTrimpath*>(obj);
+            writeProperty(trim->start);
+            writeProperty(trim->end);
+            writeProperty(trim->offset);
+            write(trim->type);
+            break;
+        }
+        case LottieObject::Text: {
+            writeText(static_cast<LottieText*>(obj));
+            break;
+        }
+        case LottieObject::Repeater: {
+            auto repeater = static_cast<LottieRepeater*>(obj);
+            writeProperty(repeater->copies);
+            writeProperty(repeater->offset);
+            writeProperty(repeater->position);
+            writeProperty(repeater->rotation);
+            writeProperty(repeater->scale);
+            writeProperty(repeater->anchor);
+            writeProperty(repeater->startOpacity);
+            writeProperty(repeater->endOpacity);
+            write(repeater->inorder);
+            break;
+        }
+        case LottieObject::RoundedCorner: {
+            writeProperty(static_cast<LottieRoundedCorner*>(obj)->radius);
+            break;
+        }
+        case LottieObject::OffsetPath: {
+            auto offset = static_cast<LottieOffsetPath*>(obj);
+            writeProperty(offset->offset);
+            writeProperty(offset->miterLimit);
+            write(offset->join);
+            break;
+        }
+        default: {
+            TVGERR("LOTTIE", "Unsupported object type = %d", (int)obj->type);
+            break;
+        }
+    }
+}
+
+
+void LottieBinaryWriter::writeMask(LottieMask* mask)
+{
+    writeProperty(mask->pathset);
+    writeProperty(mask->expand);
+    writeProperty(mask->opacity);
+    write(mask->method);
+    write(mask->inverse);
+}
+
+
+void LottieBinaryWriter::writeEffect(LottieEffect* effect)
+{
+    write(effect->type);
+    write(effect->enable);
+
+    switch (effect->type) {
+        case LottieEffect::GaussianBlur: {
+            auto blur = static_cast<LottieGaussianBlur*>(effect);
+            writeProperty(blur->blurness);
+            writeProperty(blur->direction);
+            writeProperty(blur->wrap);
+            break;
+        }
+        default: break;
+    }
+}
+
+
+void LottieBinaryWriter::writeLayer(LottieLayer* layer, bool container)
+{
+    objects.push(layer);
+
+    uint8_t flags = 0;
+    if (layer->hidden) flags |= LayerFlag::Hidden;
+    if (layer->autoOrient) flags |= LayerFlag::AutoOrient;
+    if (layer->matteSrc) flags |= LayerFlag::MatteSource;
+    if (container) flags |= LayerFlag::Container;
+    if (container && layer->comp && layer->comp == comp->root) flags |= LayerFlag::CompRoot;
+    if (layer->transform) flags |= LayerFlag::Transform;
+    if (layer->type == LottieLayer::Solid && layer->statical.pooler.count > 0) flags |= LayerFlag::SolidColor;
+
+    //the object type of a hidden layer is not figured out, keep it as it is.
+    write(layer->LottieObject::type);
+    write<uint64_t>(layer->id);
+    write(flags);
+    write(_groupFlags(layer));
+    writeString(layer->name);
+    write(layer->type);
+    write(layer->timeStretch);
+    write(layer->w);
+    write(layer->h);
+    write(layer->inFrame);
+    write(layer->outFrame);
+    write(layer->startFrame);
+    write<uint64_t>(layer->rid);
+    write(layer->mid);
+    write(layer->pidx);
+    write(layer->idx);
+    write(layer->matteType);
+    write(layer->blendMethod);
+
+    if (flags & LayerFlag::SolidColor) {
+        uint8_t r, g, b;
+        layer->statical.pooler[0]->fillColor(&r, &g, &b);
+        write(RGB24{r, g, b});
+    }
+
+    if (layer->transform) writeObject(layer->transform);
+    writeProperty(layer->timeRemap);
+
+    write(layer->masks.count);
+    for (auto m = layer->masks.begin(); m < layer->masks.end(); ++m) writeMask(*m);
+
+    write(layer->effects.count);
+    for (auto e = layer->effects.begin(); e < layer->effects.end(); ++e) writeEffect(*e);
+
+    //a precomposition owns the layers, otherwise contents
+    if (container) {
+        write(layer->children.count);
+        for (auto c = layer->children.begin(); c < layer->children.end(); ++c) {
+            writeLayer(static_cast<LottieLayer*>(*c), false);
+        }
+    } else writeChildren(layer->children);
+}
+
+
+void LottieBinaryWriter::writeFont(LottieFont* font)
+{
+    writeString(font->name);
+    writeString(font->family);
+    writeString(font->style);
+    write(font->ascent);
+    write(font->origin);
+    write(font->chars.count);
+    for (auto c = font->chars.begin(); c < font->chars.end(); ++c) {
+        auto glyph = *c;
+        writeString(glyph->code);
+        write(glyph->width);
+        write(glyph->size);
+        writeChildren(glyph->children);
+    }
+}
+
+
+void LottieBinaryWriter::writeSlot(LottieSlot* slot)
+{
+    writeString(slot->sid);
+    write(slot->type);
+    write(slot->pairs.count);
+    for (auto p = slot->pairs.begin(); p < slot->pairs.end(); ++p) {
+        write(_findPointer(objectBuckets, objects, p->obj));
+    }
+}
+
+
+bool LottieBinaryWriter::write(LottieComposition* comp, const char* path)
+{
+    if (!comp || !comp->root || !path) return false;
+
+    this->comp = comp;
+
+    writeString(comp->version);
+    writeString(comp->name);
+    write(comp->expressions);
+
+    _indexPointers(interpolatorBuckets, comp->interpolators);
+    write(comp->interpolators.count);
+    for (auto i = comp->interpolators.begin(); i < comp->interpolators.end(); ++i) {
+        writeString((*i)->key);
+        write((*i)->inTangent);
+        write((*i)->outTangent);
+    }
+
+    writeLayer(comp->root, true);
+
+    write(comp->assets.count);
+    for (auto a = comp->assets.begin(); a < comp->assets.end(); ++a) {
+        if ((*a)->type == LottieObject::Image) {
+            write(AssetType::Image);
+            writeObject(*a);
+        } else {
+            write(AssetType::Precomp);
+            writeLayer(static_cast<LottieLayer*>(*a), true);
+        }
+    }
+
+    write(comp->fonts.count);
+    for (auto f = comp->fonts.begin(); f < comp->fonts.end(); ++f) writeFont(*f);
+
+    //all the objects are written, the slots refer them by the written order
+    _indexPointers(objectBuckets, objects);
+    write(comp->slots.count);
+    for (auto s = comp->slots.begin(); s < comp->slots.end(); ++s) writeSlot(*s);
+
+    write(comp->markers.count);
+    for (auto m = comp->markers.begin(); m < comp->markers.end(); ++m) {
+        writeString((*m)->name);
+        write((*m)->time);
+        write((*m)->duration);
+    }
+
+    LottieBinaryHeader header;
+    memcpy(header.signature, LOTTIE_BINARY_SIGNATURE, LOTTIE_BINARY_SIGNATURE_LENGTH);
+    header.version = LOTTIE_BINARY_VERSION;
+    header.w = comp->w;
+    header.h = comp->h;
+    header.frameRate = comp->frameRate;
+    header.inFrame = comp->root->inFrame;
+    header.outFrame = comp->root->outFrame;
+    header.strCnt = strings.count;
+
+    auto f = fopen(path, "wb");
+    if (!f) {
+        TVGERR("LOTTIE", "Failed to open the file = %s", path);
+        return false;
+    }
+
+    auto ret = (fwrite(&header, sizeof(LottieBinaryHeader), 1, f) == 1);
+
+    for (auto s = strings.begin(); ret && s < strings.end(); ++s) {
+        uint32_t len = strlen(*s);
+        ret = (fwrite(&len, sizeof(uint32_t), 1, f) == 1) && (fwrite(*s, len + 1, 1, f) == 1);
+    }
+
+    if (ret) ret = (fwrite(body.data, body.count, 1, f) == 1);
+
+    fclose(f);
+
+    return ret;
+}
+
+
+/************************************************************************/
+/* LottieBinaryReader Implementation                                    */
+/************************************************************************/
+
+bool LottieBinaryReader::read(void* out, uint32_t size)
+{
+    if (invalid || size > uint32_t(end - data)) {
+        invalid = true;
+        memset(out, 0x00, size);
+        return false;
+    }
+    memcpy(out, data, size);
+    data += size;
+    return true;
+}
+
+
+const char* LottieBinaryReader::readString()
+{
+    auto idx = read<uint32_t>();
+    if (idx == LOTTIE_BINARY_NONE) return nullptr;
+    if (idx >= strings.count) {
+        invalid = true;
+        return nullptr;
+    }
+    return strings[idx];
+}
+
+
+char* LottieBinaryReader::readStringCopy()
+{
+    auto str = readString();
+    return str ? strdup(str) : nullptr;
+}
+
+
+LottieInterpolator* LottieBinaryReader::readInterpolator()
+{
+    auto idx = read<uint32_t>();
+    if (idx == LOTTIE_BINARY_NONE) return nullptr;
+    if (idx >= comp->interpolators.count) {
+        invalid = true;
+        return nullptr;
+    }
+    return comp->interpolators[idx];
+}
+
+
+void LottieBinaryReader::readExpression(LottieProperty& prop, LottieObject* obj)
+{
+    prop.type = read<LottieProperty::Type>();  //meaningful with an expression only, it may be left uninitialized
+    prop.ix = read<uint8_t>();
+
+    auto code = readStringCopy();
+    if (!code) return;
+
+    auto exp = new LottieExpression;
+    exp->code = code;
+    exp->comp = comp;
+    exp->layer = layer;
+    exp->object = obj;
+    exp->property = &prop;
+    prop.exp = exp;
+}
+
+
+template<typename T>
+void LottieBinaryReader::readProperty(LottieGenericProperty<T>& prop, LottieObject* obj)
+{
+    readExpression(prop, obj);
+    read(&prop.value, sizeof(T));
+
+    auto cnt = read<uint32_t>();
+    if (cnt == 0 || invalid) return;
+    if (cnt > uint32_t(end - data)) {
+        invalid = true;
+        return;
+    }
+
+    prop.frames = new Array<LottieScalarFrame<T>>(cnt);
+    prop.frames->count = cnt;
+    for (auto f = prop.frames->begin(); f < prop.frames->end(); ++f) {
+        read(&f->value, sizeof(T));
+        f->no = read<float>();
+        f->interpolator = readInterpolator();
+        f->hold = read<bool>();
+    }
+}
+
+
+void LottieBinaryReader::readProperty(LottiePosition& prop, LottieObject* obj)
+{
+    readExpression(prop, obj);
+    prop.value = read<Point>();
+
+    auto cnt = read<uint32_t>();
+    if (cnt == 0 || invalid) return;
+    if (cnt > uint32_t(end - data)) {
+        invalid = true;
+        return;
+    }
+
+    prop.frames = new Array<LottieVectorFrame<Point>>(cnt);
+    prop.frames->count = cnt;
+    for (auto f = prop.frames->begin(); f < prop.frames->end(); ++f) {
+        f->value = read<Point>();
+        f->no = read<float>();
+        f->interpolator = readInterpolator();
+        f->outTangent = read<Point>();
+        f->inTangent = read<Point>();
+        f->length = read<float>();
+        f->hasTangent = read<bool>();
+        f->hold = read<bool>();
+    }
+}
+
+
+void LottieBinaryReader::readValue(PathSet& path)
+{
+    path.ptsCnt = read<uint16_t>();
+    path.cmdsCnt = read<uint16_t>();
+
+    if (path.ptsCnt > 0) {
+        path.pts = static_cast<Point*>(malloc(sizeof(Point) * path.ptsCnt));
+        read(path.pts, sizeof(Point) * path.ptsCnt);
+    }
+    if (path.cmdsCnt > 0) {
+        path.cmds = static_cast<PathCommand*>(malloc(sizeof(PathCommand) * path.cmdsCnt));
+        for (uint16_t i = 0; i < path.cmdsCnt; ++i) path.cmds[i] = read(PathCommand::CubicTo);
+    }
+
+    //the commands must not consume more points than the path has
+    uint32_t ptsCnt = 0;
+    for (uint16_t i = 0; i < path.cmdsCnt; ++i) {
+        if (path.cmds[i] == PathCommand::CubicTo) ptsCnt += 3;
+        else if (path.cmds[i] != PathCommand::Close) ++ptsCnt;
+    }
+    if (ptsCnt > path.ptsCnt) invalid = true;
+}
+
+
+void LottieBinaryReader::readProperty(LottiePathSet& prop, LottieObject* obj)
+{
+    readExpression(prop, obj);
+    readValue(prop.value);
+
+    auto cnt = read<uint32_t>();
+    if (cnt == 0 || invalid) return;
+    if (cnt > uint32_t(end - data)) {
+        invalid = true;
+        return;
+    }
+
+    prop.frames = static_cast<Array<LottieScalarFrame<PathSet>>*>(calloc(1, sizeof(Array<LottieScalarFrame<PathSet>>)));
+    prop.frames->reserve(cnt);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        auto& f = prop.frames->data[prop.frames->count++];
+        f.value = {};
+        readValue(f.value);
+        f.no = read<float>();
+        f.interpolator = readInterpolator();
+        f.hold = read<bool>();
+    }
+}
+
+
+//the builder reads the color stops by the count of the property, a value must have all of them
+void LottieBinaryReader::readValue(ColorStop& color, uint16_t count)
+{
+    auto cnt = read<uint16_t>();
+    if (cnt == 0) return;
+    if (cnt != count) {
+        invalid = true;
+        return;
+    }
+    color.data = static_cast<Fill::ColorStop*>(malloc(sizeof(Fill::ColorStop) * cnt));
+    read(color.data, sizeof(Fill::ColorStop) * cnt);
+}
+
+
+void LottieBinaryReader::readProperty(LottieColorStop& prop, LottieObject* obj)
+{
+    readExpression(prop, obj);
+    prop.count = read<uint16_t>();
+    prop.populated = read<bool>();
+    readValue(prop.value, prop.count);
+
+    auto cnt = read<uint32_t>();
+    if (cnt == 0 || invalid) return;
+    if (cnt > uint32_t(end - data)) {
+        invalid = true;
+        return;
+    }
+
+    prop.frames = static_cast<Array<LottieScalarFrame<ColorStop>>*>(calloc(1, sizeof(Array<LottieScalarFrame<ColorStop>>)));
+    prop.frames->reserve(cnt);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        auto& f = prop.frames->data[prop.frames->count++];
+        f.value = {};
+        readValue(f.value, prop.count);
+        //the keyframes are interpolated stop by stop
+        if (!f.value.data && prop.count > 0) invalid = true;
+        f.no = read<float>();
+        f.interpolator = readInterpolator();
+        f.hold = read<bool>();
+    }
+}
+
+
+void LottieBinaryReader::readValue(TextDocument& doc)
+{
+    doc.text = readStringCopy();
+    doc.height = read<float>();
+    doc.shift = read<float>();
+    doc.color = read<RGB24>();
+    doc.bbox.pos = read<Point>();
+    doc.bbox.size = read<Point>();
+    doc.stroke.color = read<RGB24>();
+    doc.stroke.width = read<float>();
+    doc.stroke.render = read<bool>();
+    doc.name = readStringCopy();
+    doc.size = read<float>();
+    doc.tracking = read<float>();
+    doc.justify = read<uint8_t>();
+}
+
+
+void LottieBinaryReader::readProperty(LottieTextDoc& prop, LottieObject* obj)
+{
+    readExpression(prop, obj);
+    readValue(prop.value);
+
+    auto cnt = read<uint32_t>();
+    if (cnt == 0 || invalid) return;
+    if (cnt > uint32_t(end - data)) {
+        invalid = true;
+        return;
+    }
+
+    prop.frames = new Array<LottieScalarFrame<TextDocument>>(cnt);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        auto& f = prop.frames->data[prop.frames->count++];
+        f.value = {};
+        readValue(f.value);
+        f.no = read<float>();
+        f.interpolator = readInterpolator();
+        f.hold = read<bool>();
+    }
+}
+
+
+void LottieBinaryReader::readStroke(LottieStroke* stroke, LottieObject* obj)
+{
+    readProperty(stroke->width, obj);
+    if (read<uint8_t>()) {
+        for (int i = 0; i < 3; ++i) readProperty(stroke->dash(i), obj);
+    }
+    stroke->miterLimit = read<float>();
+    stroke->cap = read(StrokeCap::Butt);
+    stroke->join = read(StrokeJoin::Miter);
+}
+
+
+void LottieBinaryReader::readGradient(LottieGradient* gradient)
+{
+    readProperty(gradient->start, gradient);
+    readProperty(gradient->end, gradient);
+    readProperty(gradient->height, gradient);
+    readProperty(gradient->angle, gradient);
+    readProperty(gradient->opacity, gradient);
+    readProperty(gradient->colorStops, gradient);
+    gradient->id = read<uint8_t>();
+}
+
+
+void LottieBinaryReader::readImage(LottieImage* image)
+{
+    image->size = read<uint32_t>();
+    image->width = read<float>();
+    image->height = read<float>();
+    image->mimeType = readStringCopy();
+
+    if (image->size > 0) {
+        if (image->size > uint32_t(end - data)) {
+            image->size = 0;
+            invalid = true;
+            return;
+        }
+        image->b64Data = static_cast<char*>(malloc(image->size));
+        read(image->b64Data, image->size);
+    } else {
+        auto relative = read<uint8_t>();
+        auto path = readString();
+        if (!path) {
+            invalid = true;
+            return;
+        }
+        if (relative && dirName) {
+            auto len = strlen(dirName) + strlen(path) + 1;
+            image->path = static_cast<char*>(malloc(len));
+            snprintf(image->path, len, "%s%s", dirName, path);
+        } else image->path = strdup(path);
+    }
+
+    if (!invalid) image->prepare();
+}
+
+
+void LottieBinaryReader::readText(LottieText* text)
+{
+    text->font = nullptr;
+    readProperty(text->doc, text);
+
+    auto cnt = read<uint32_t>();
+    for (uint32_t i = 0; i < cnt && !invalid; ++i) {
+        auto range = new LottieTextRange;
+        auto& style = range->style;
+        readProperty(style.fillColor, text);
+        readProperty(style.strokeColor, text);
+        readProperty(style.position, text);
+        readProperty(style.scale, text);
+        readProperty(style.letterSpacing, text);
+        readProperty(style.lineSpacing, text);
+        readProperty(style.strokeWidth, text);
+        readProperty(style.rotation, text);
+        readProperty(style.fillOpacity, text);
+        readProperty(style.strokeOpacity, text);
+        readProperty(style.opacity, text);
+        readProperty(range->offset, text);
+        readProperty(range->maxEase, text);
+        readProperty(range->minEase, text);
+        readProperty(range->maxAmount, text);
+        readProperty(range->smoothness, text);
+        readProperty(range->start, text);
+        readProperty(range->end, text);
+        range->based = read(LottieTextRange::Lines);
+        range->shape = read(LottieTextRange::Smooth);
+        range->rangeUnit = read(LottieTextRange::Index);
+        range->random = read<uint8_t>();
+        range->expressible = read<bool>();
+        text->ranges.push(range);
+    }
+}
+
+
+void LottieBinaryReader::readChildren(Array<LottieObject*>& children)
+{
+    auto cnt = read<uint32_t>();
+    if (invalid || cnt > uint32_t(end - data)) {
+        invalid = true;
+        return;
+    }
+    children.reserve(cnt);
+    for (uint32_t i = 0; i < cnt; ++i) {
+        auto child = readObject();
+        if (!child) return;
+        children.push(child);
+    }
+}
+
+
+void LottieBinaryReader::readGroup(LottieGroup* group)
+{
+    _groupFlags(group, read<uint8_t>());
+    readChildren(group->children);
+}
+
+
+LottieObject* LottieBinaryReader::readObject()
+{
+    auto type = read<LottieObject::Type>();
+    auto id = read<uint64_t>();
+    auto hidden = read<bool>();
+    if (invalid) return nullptr;
+
+    LottieObject* obj = nullptr;
+
+    switch (type) {
+        case LottieObject::Group: {
+            obj = new LottieGroup;
+            objects.push(obj);
+            readGroup(static_cast<LottieGroup*>(obj));
+            break;
+        }
+        case LottieObject::Transform: {
+            auto transform = new LottieTransform;
+            objects.push(obj = transform);
+            readProperty(transform->position, transform);
+            readProperty(transform->rotation, transform);
+            readProperty(transform->scale, transform);
+            readProperty(transform->anchor, transform);
+            readProperty(transform->opacity, transform);
+            readProperty(transform->skewAngle, transform);
+            readProperty(transform->skewAxis, transform);
+            if (read<uint8_t>()) {
+                transform->coords = new LottieTransform::SeparateCoord;
+                readProperty(transform->coords->x, transform);
+                readProperty(transform->coords->y, transform);
+            }
+            if (read<uint8_t>()) {
+                transform->rotationEx = new LottieTransform::RotationEx;
+                readProperty(transform->rotationEx->x, transform);
+                readProperty(transform->rotationEx->y, transform);
+            }
+            transform->prepare();
+            break;
+        }
+        case LottieObject::SolidFill: {
+            auto fill = new LottieSolidFill;
+            objects.push(obj = fill);
+            readProperty(fill->color, fill);
+            readProperty(fill->opacity, fill);
+            fill->rule = read(FillRule::EvenOdd);
+            fill->prepare();
+            break;
+        }
+        case LottieObject::SolidStroke: {
+            auto stroke = new LottieSolidStroke;
+            objects.push(obj = stroke);
+            readProperty(stroke->color, stroke);
+            readProperty(stroke->opacity, stroke);
+            readStroke(stroke, stroke);
+            stroke->prepare();
+            break;
+        }
+        case LottieObject::GradientFill: {
+            auto fill = new LottieGradientFill;
+            objects.push(obj = fill);
+            readGradient(fill);
+            fill->rule = read(FillRule::EvenOdd);
+            fill->prepare();
+            break;
+        }
+        case LottieObject::GradientStroke: {
+            auto stroke = new LottieGradientStroke;
+            objects.push(obj = stroke);
+            readGradient(stroke);
+            readStroke(stroke, stroke);
+            stroke->prepare();
+            break;
+        }
+        case LottieObject::Rect: {
+            auto rect = new LottieRect;
+            objects.push(obj = rect);
+            rect->clockwise = read<bool>();
+            readProperty(rect->position, rect);
+            readProperty(rect->size, rect);
+            readProperty(rect->radius, rect);
+            rect->prepare();
+            break;
+        }
+        case LottieObject::Ellipse: {
+            auto ellipse = new LottieEllipse;
+            objects.push(obj = ellipse);
+            ellipse->clockwise = read<bool>();
+            readProperty(ellipse->position, ellipse);
+            readProperty(ellipse->size, ellipse);
+            ellipse->prepare();
+            break;
+        }
+        case LottieObject::Path: {
+            auto path = new LottiePath;
+            objects.push(obj = path);
+            path->clockwise = read<bool>();
+            readProperty(path->pathset, path);
+            path->prepare();
+            break;
+        }
+        case LottieObject::Polystar: {
+            auto star = new LottiePolyStar;
+            objects.push(obj = star);
+            star->clockwise = read<bool>();
+            readProperty(star->position, star);
+            readProperty(star->innerRadius, star);
+            readProperty(star->outerRadius, star);
+            readProperty(star->innerRoundness, star);
+            readProperty(star->outerRoundness, star);
+            readProperty(star->rotation, star);
+            readProperty(star->ptsCnt, star);
+            star->type = read(LottiePolyStar::Polygon);
+            star->prepare();
+            break;
+        }
+        case LottieObject::Image: {
+            auto image = new LottieImage;
+            objects.push(obj = image);
+            readImage(image);
+            break;
+        }
+        case LottieObject::Trimpath: {
+            auto trim = new LottieTrimpath;
+            objects.push(obj = trim);
+            readProperty(trim->start, trim);
+            readProperty(trim->end, trim);
+            readProperty(trim->offset, trim);
+            trim->type = read(LottieTrimpath::Individual);
+            trim->prepare();
+            break;
+        }
+        case LottieObject::Text: {
+            auto text = new LottieText;
+            objects.push(obj = text);
+            readText(text);
+            text->prepare();
+            break;
+        }
+        case LottieObject::Repeater: {
+            auto repeater = new LottieRepeater;
+            objects.push(obj = repeater);
+            readProperty(repeater->copies, repeater);
+            readProperty(repeater->offset, repeater);
+            readProperty(repeater->position, repeater);
+            readProperty(repeater->rotation, repeater);
+            readProperty(repeater->scale, repeater);
+            readProperty(repeater->anchor, repeater);
+            readProperty(repeater->startOpacity, repeater);
+            readProperty(repeater->endOpacity, repeater);
+            repeater->inorder = read<bool>();
+            repeater->prepare();
+            break;
+        }
+        case LottieObject::RoundedCorner: {
+            auto corner = new LottieRoundedCorner;
+            objects.push(obj = corner);
+            readProperty(corner->radius, corner);
+            corner->prepare();
+            break;
+        }
+        case LottieObject::OffsetPath: {
+            auto offset = new LottieOffsetPath;
+            objects.push(obj = offset);
+            readProperty(offset->offset, offset);
+            readProperty(offset->miterLimit, offset);
+            offset->join = read(StrokeJoin::Miter);
+            offset->prepare();
+            break;
+        }
+        default: {
+            TVGERR("LOTTIE", "Unsupported object type = %d", (int)type);
+            invalid = true;
+            return nullptr;
+        }
+    }
+
+    obj->type = type;
+    obj->id = (unsigned long)id;
+    obj->hidden = hidden;
+
+    return obj;
+}
+
+
+LottieMask* LottieBinaryReader::readMask()
+{
+    auto mask = new LottieMask;
+    readProperty(mask->pathset, layer);
+    readProperty(mask->expand, layer);
+    readProperty(mask->opacity, layer);
+    mask->method = read(CompositeMethod::DarkenMask);
+    mask->inverse = read<bool>();
+    return mask;
+}
+
+
+LottieEffect* LottieBinaryReader::readEffect()
+{
+    auto type = read<LottieEffect::Type>();
+    auto enable = read<bool>();
+
+    LottieEffect* effect = nullptr;
+
+    switch (type) {
+        case LottieEffect::GaussianBlur: {
+            auto blur = new LottieGaussianBlur;
+            readProperty(blur->blurness, layer);
+            readProperty(blur->direction, layer);
+            readProperty(blur->wrap, layer);
+            effect = blur;
+            break;
+        }
+        default: {
+            invalid = true;
+            return nullptr;
+        }
+    }
+
+    effect->enable = enable;
+    return effect;
+}
+
+
+void LottieBinaryReader::readLayer(LottieLayer* layer)
+{
+    objects.push(layer);
+
+    //the current context for the expressions
+    auto parent = this->layer;
+    this->layer = layer;
+
+    layer->LottieObject::type = read<LottieObject::Type>();
+    layer->id = (unsigned long)read<uint64_t>();
+    auto flags = read<uint8_t>();
+    _groupFlags(layer, read<uint8_t>());
+    layer->name = readStringCopy();
+    layer->type = read(LottieLayer::Text);
+    layer->timeStretch = read<float>();
+    layer->w = read<float>();
+    layer->h = read<float>();
+    layer->inFrame = read<float>();
+    layer->outFrame = read<float>();
+    layer->startFrame = read<float>();
+    layer->rid = (unsigned long)read<uint64_t>();
+    layer->mid = read<int16_t>();
+    layer->pidx = read<int16_t>();
+    layer->idx = read<int16_t>();
+    layer->matteType = read(CompositeMethod::DarkenMask);
+    layer->blendMethod = read(BlendMethod::HardMix);
+
+    layer->hidden = flags & LayerFlag::Hidden;
+    layer->autoOrient = flags & LayerFlag::AutoOrient;
+    layer->matteSrc = flags & LayerFlag::MatteSource;
+
+    RGB24 color;
+    if (flags & LayerFlag::SolidColor) color = read<RGB24>();
+
+    if (flags & LayerFlag::Transform) {
+        auto transform = readObject();
+        if (transform && transform->type == LottieObject::Transform) layer->transform = static_cast<LottieTransform*>(transform);
+        else {
+            delete(transform);
+            invalid = true;
+        }
+    }
+    readProperty(layer->timeRemap, layer);
+
+    auto cnt = read<uint32_t>();
+    for (uint32_t i = 0; i < cnt && !invalid; ++i) layer->masks.push(readMask());
+
+    cnt = read<uint32_t>();
+    for (uint32_t i = 0; i < cnt && !invalid; ++i) {
+        if (auto effect = readEffect()) layer->effects.push(effect);
+    }
+
+    //a precomposition owns the layers, otherwise contents
+    if (flags & LayerFlag::Container) {
+        cnt = read<uint32_t>();
+        for (uint32_t i = 0; i < cnt && !invalid; ++i) {
+            auto child = new LottieLayer;
+            child->comp = layer;
+            layer->children.push(child);
+            readLayer(child);
+        }
+        if (flags & LayerFlag::CompRoot) layer->comp = comp->root;
+    } else readChildren(layer->children);
+
+    //the builder resolves the children of a reference, the layer doesn't own them.
+    if (layer->rid && !layer->children.empty()) {
+        for (auto c = layer->children.begin(); c < layer->children.end(); ++c) delete(*c);
+        layer->children.clear();
+        invalid = true;
+    }
+
+    //the group contents are already prepared, only the statical paints are required.
+    if (!layer->hidden) layer->prepareStatical((flags & LayerFlag::SolidColor) ? &color : nullptr);
+    //the builder draws the precompositions and the solids with the statical paints
+    if ((layer->type == LottieLayer::Precomp || layer->type == LottieLayer::Solid) && layer->statical.pooler.empty()) invalid = true;
+
+    this->layer = parent;
+}
+
+
+LottieFont* LottieBinaryReader::readFont()
+{
+    auto font = new LottieFont;
+    font->name = readStringCopy();
+    font->family = readStringCopy();
+    font->style = readStringCopy();
+    font->ascent = read<float>();
+    font->origin = read(LottieFont::Embedded);
+
+    auto cnt = read<uint32_t>();
+    for (uint32_t i = 0; i < cnt && !invalid; ++i) {
+        auto glyph = new LottieGlyph;
+        glyph->code = readStringCopy();
+        glyph->width = read<float>();
+        glyph->size = read<uint16_t>();
+        font->chars.push(glyph);
+        if (!glyph->code) {
+            invalid = true;
+            break;
+        }
+        glyph->prepare();
+        readChildren(glyph->children);
+    }
+    return font;
+}
+
+
+LottieSlot* LottieBinaryReader::readSlot()
+{
+    auto sid = readStringCopy();
+    auto type = read(LottieProperty::Type::Invalid);
+    auto cnt = read<uint32_t>();
+
+    LottieSlot* slot = nullptr;
+
+    for (uint32_t i = 0; i < cnt; ++i) {
+        auto idx = read<uint32_t>();
+        if (invalid || idx >= objects.count) {
+            invalid = true;
+            break;
+        }
+        if (slot) slot->pairs.push({objects[idx], nullptr});
+        else slot = new LottieSlot(sid, objects[idx], type);
+    }
+
+    if (!slot) {
+        free(sid);
+        invalid = true;
+    }
+    return slot;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+//the data may not be aligned, the header is copied out
+bool LottieBinaryReader::header(const char* data, uint32_t size, LottieBinaryHeader* header)
+{
+    if (!data || size < sizeof(LottieBinaryHeader)) return false;
+    if (memcmp(data, LOTTIE_BINARY_SIGNATURE, LOTTIE_BINARY_SIGNATURE_LENGTH)) return false;
+
+    LottieBinaryHeader tmp;
+    if (!header) header = &tmp;
+    memcpy(header, data, sizeof(LottieBinaryHeader));
+    if (header->version != LOTTIE_BINARY_VERSION) {
+        TVGERR("LOTTIE", "Unsupported binary version = %d", (int)header->version);
+        return false;
+    }
+    return true;
+}
+
+
+LottieComposition* LottieBinaryReader::read()
+{
+    LottieBinaryHeader header;
+    if (!LottieBinaryReader::header(data, uint32_t(end - data), &header)) return nullptr;
+
+    data += sizeof(LottieBinaryHeader);
+
+    //strings are referred in place, the model copies them on demand.
+    //each one has its length and the terminator at least, a corrupted count is rejected before the allocation.
+    if (header.strCnt > uint32_t(end - data) / (sizeof(uint32_t) + 1)) return nullptr;
+    strings.reserve(header.strCnt);
+    for (uint32_t i = 0; i < header.strCnt; ++i) {
+        auto len = read<uint32_t>();
+        if (invalid || len >= uint32_t(end - data) || data[len] != '\0') return nullptr;
+        strings.push(data);
+        data += len + 1;
+    }
+
+    comp = new LottieComposition;
+    comp->w = header.w;
+    comp->h = header.h;
+    comp->frameRate = header.frameRate;
+    comp->version = readStringCopy();
+    comp->name = readStringCopy();
+    comp->expressions = read<bool>();
+
+    auto cnt = read<uint32_t>();
+    for (uint32_t i = 0; i < cnt && !invalid; ++i) {
+        auto key = readString();
+        auto inTangent = read<Point>();
+        auto outTangent = read<Point>();
+        if (!key) {
+            invalid = true;
+            break;
+        }
+        auto interpolator = static_cast<LottieInterpolator*>(malloc(sizeof(LottieInterpolator)));
+        interpolator->set(key, inTangent, outTangent);
+        comp->interpolators.push(interpolator);
+    }
+
+    if (!invalid) {
+        comp->root = new LottieLayer;
+        readLayer(comp->root);
+        comp->root->inFrame = header.inFrame;
+        comp->root->outFrame = header.outFrame;
+    }
+
+    cnt = read<uint32_t>();
+    for (uint32_t i = 0; i < cnt && !invalid; ++i) {
+        if (read<uint8_t>() == AssetType::Image) {
+            if (auto asset = readObject()) comp->assets.push(asset);
+        } else {
+            auto asset = new LottieLayer;
+            comp->assets.push(asset);
+            readLayer(asset);
+        }
+    }
+
+    cnt = read<uint32_t>();
+    for (uint32_t i = 0; i < cnt && !invalid; ++i) comp->fonts.push(readFont());
+
+    cnt = read<uint32_t>();
+    for (uint32_t i = 0; i < cnt && !invalid; ++i) {
+        if (auto slot = readSlot()) comp->slots.push(slot);
+    }
+
+    cnt = read<uint32_t>();
+    for (uint32_t i = 0; i < cnt && !invalid; ++i) {
+        auto marker = new LottieMarker;
+        marker->name = readStringCopy();
+        marker->time = read<float>();
+        marker->duration = read<float>();
+        comp->markers.push(marker);
+    }
+
+    if (invalid) {
+        TVGERR("LOTTIE", "Corrupted Lottie binary!");
+        delete(comp);
+        return nullptr;
+    }
+
+    return comp;
+}
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _TVG_LOTTIE_BINARY_H_
+#define _TVG_LOTTIE_BINARY_H_
+
+#include <type_traits>
+#include "tvgCommon.h"
+#include "tvgArray.h"
+#include "tvgLottieModel.h"
+
+/* Precompiled Lottie binary format.
+
+   The file begins with LottieBinaryHeader, followed by the interned string table
+   and the composition body. The body is a flat stream of the parsed model in
+   the LottieParser construction order: interpolators, root layer, assets,
+   fonts, slots and markers. Strings are referred by their index of the table,
+   keyframes are stored in sequence per property and embedded images are kept
+   in their decoded (not base64) form. All values are in the host byte order. */
+
+#define LOTTIE_BINARY_SIGNATURE "TVGLOT"
+#define LOTTIE_BINARY_SIGNATURE_LENGTH 6
+#define LOTTIE_BINARY_VERSION 1
+#define LOTTIE_BINARY_NONE 0xffffffff       //null string or interpolator index
+
+struct LottieBinaryHeader
+{
+    char signature[LOTTIE_BINARY_SIGNATURE_LENGTH];
+    uint16_t version;
+    float w, h;
+    float frameRate;
+    float inFrame, outFrame;
+    uint32_t strCnt;                        //interned string count
+};
+
+
+struct LottieBinaryWriter
+{
+public:
+    LottieBinaryWriter(const char* dirName) : dirName(dirName) {}
+    ~LottieBinaryWriter();
+
+    bool write(LottieComposition* comp, const char* path);
+
+private:
+    const char* dirName;                    //base resource directory of the source
+    LottieComposition* comp = nullptr;
+    Array<char> body;
+    Array<char*> strings;                   //interned strings
+    Array<uint32_t> buckets;                //string hash table, index + 1
+    Array<LottieObject*> objects;           //written objects in order, referred by slots
+    Array<uint32_t> objectBuckets;          //object hash table, index + 1
+    Array<uint32_t> interpolatorBuckets;    //interpolator hash table, index + 1
+
+    void write(const void* data, uint32_t size);
+    template<typename T> void write(const T& val) { write(&val, sizeof(T)); }
+    void writeString(const char* str);
+    void writeInterpolator(LottieInterpolator* interpolator);
+    void writeExpression(LottieProperty& prop);
+
+    template<typename T> void writeProperty(LottieGenericProperty<T>& prop);
+    void writeProperty(LottiePosition& prop);
+    void writeProperty(LottiePathSet& prop);
+    void writeProperty(LottieColorStop& prop);
+    void writeProperty(LottieTextDoc& prop);
+    void writeValue(const PathSet& path);
+    void writeValue(const ColorStop& color, uint16_t count);
+    void writeValue(const TextDocument& doc);
+
+    void writeObject(LottieObject* obj);
+    void writeChildren(Array<LottieObject*>& children);
+    void writeGroup(LottieGroup* group);
+    void writeLayer(LottieLayer* layer, bool container);
+    void writeStroke(LottieStroke* stroke);
+    void writeGradient(LottieGradient* gradient);
+    void writeImage(LottieImage* image);
+    void writeText(LottieText* text);
+    void writeMask(LottieMask* mask);
+    void writeEffect(LottieEffect* effect);
+    void writeFont(LottieFont* font);
+    void writeSlot(LottieSlot* slot);
+};
+
+
+struct LottieBinaryReader
+{
+public:
+    LottieBinaryReader(const char* data, uint32_t size, const char* dirName) : data(data), end(data + size), dirName(dirName) {}
+
+    static bool header(const char* data, uint32_t size, LottieBinaryHeader* header = nullptr);
+
+    LottieComposition* read();
+
+private:
+    const char* data;
+    const char* end;
+    const char* dirName;                    //base resource directory
+    LottieComposition* comp = nullptr;
+    LottieLayer* layer = nullptr;           //current layer
+    Array<const char*> strings;             //points the string table in place
+    Array<LottieObject*> objects;           //read objects in order, referred by slots
+    bool invalid = false;
+
+    bool read(void* data, uint32_t size);
+    template<typename T> T read() { T val{}; read(&val, sizeof(T)); return val; }
+    template<typename T> T read(T last);
+    const char* readString();
+    char* readStringCopy();
+    LottieInterpolator* readInterpolator();
+    void readExpression(LottieProperty& prop, LottieObject* obj);
+
+    template<typename T> void readProperty(LottieGenericProperty<T>& prop, LottieObject* obj);
+    void readProperty(LottiePosition& prop, LottieObject* obj);
+    void readProperty(LottiePathSet& prop, LottieObject* obj);
+    void readProperty(LottieColorStop& prop, LottieObject* obj);
+    void readProperty(LottieTextDoc& prop, LottieObject* obj);
+    void readValue(PathSet& path);
+    void readValue(ColorStop& color, uint16_t count);
+    void readValue(TextDocument& doc);
+
+    LottieObject* readObject();
+    void readChildren(Array<LottieObject*>& children);
+    void readGroup(LottieGroup* group);
+    void readLayer(LottieLayer* layer);
+    void readStroke(LottieStroke* stroke, LottieObject* obj);
+    void readGradient(LottieGradient* gradient);
+    void readImage(LottieImage* image);
+    void readText(LottieText* text);
+    LottieMask* readMask();
+    LottieEffect* readEffect();
+    LottieFont* readFont();
+    LottieSlot* readSlot();
+};
+
+
+//a corrupted byte is not a valid bool
+template<> inline bool LottieBinaryReader::read<bool>()
+{
+    return read<uint8_t>() != 0;
+}
+
+
+//the builder switches on the enumerators, the ones out of the range mark the file invalid
+template<typename T> T LottieBinaryReader::read(T last)
+{
+    auto val = read<typename std::underlying_type<T>::type>();
+    if (uint32_t(val) > uint32_t(last)) {
+        invalid = true;
+        return T(0);
+    }
+    return T(val);
+}
+
+#endif //_TVG_LOTTIE_BINARY_H_
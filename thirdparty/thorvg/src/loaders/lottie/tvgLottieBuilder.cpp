@@ -25,6 +25,7 @@
 
 #include "tvgCommon.h"
 #include "tvgMath.h"
+#include "tvgTaskScheduler.h"
 #include "tvgLottieModel.h"
 #include "tvgLottieBuilder.h"
 #include "tvgLottieExpressions.h"
@@ -982,29 +983,142 @@ void LottieBuilder::updateImage(LottieGroup* layer)
 }
 
 
+static void _appendGlyph(LottieGlyph* glyph, Shape* shape, float frameNo)
+{
+    for (auto g = glyph->children.begin(); g < glyph->children.end(); ++g) {
+        auto group = static_cast<LottieGroup*>(*g);
+        for (auto p = group->children.begin(); p < group->children.end(); ++p) {
+            if (static_cast<LottiePath*>(*p)->pathset(frameNo, P(shape)->rs.path.cmds, P(shape)->rs.path.pts, nullptr, nullptr, nullptr)) {
+                P(shape)->update(RenderUpdateFlag::Path);
+            }
+        }
+    }
+}
+
+
+//range selector values of the frame, shared by all the glyphs
+struct TextRangeFrame
+{
+    LottieTextRange::Based based;
+    float start, end;
+    Point position;
+    Point scale;
+    float rotation;
+    float letterSpacing;
+    float lineSpacing;
+    float strokeWidth;
+    RGB24 fillColor;
+    RGB24 strokeColor;
+    uint8_t opacity;
+    uint8_t fillOpacity;
+    uint8_t strokeOpacity;
+};
+
+
+static void _buildGlyphRun(LottieText* text, TextDocument& doc, float frameNo)
+{
+    auto& run = text->run;
+    run.reset();
+    run.doc = &doc;
+    run.font = text->font;
+    run.animated = false;
+
+    auto p = doc.text;
+    run.length = strlen(p);
+
+    int idx = 0;
+    int line = 0;
+    int space = 0;
+
+    while (true) {
+        //end of text, new line of the cursor position
+        if (*p == 13 || *p == 3 || *p == '\0') {
+            run.glyphs.push({nullptr, nullptr, idx, space, line});
+            if (*p == '\0') break;
+            ++p;
+            ++line;
+            continue;
+        }
+
+        if (*p == ' ') ++space;
+
+        //find the glyph
+        bool found = false;
+        for (auto g = text->font->chars.begin(); g < text->font->chars.end(); ++g) {
+            auto glyph = *g;
+            if (!strncmp(glyph->code, p, glyph->len)) {
+                auto shape = Shape::gen().release();
+                PP(shape)->ref();
+                _appendGlyph(glyph, shape, frameNo);
+                run.glyphs.push({glyph, shape, idx, space, line});
+
+                for (auto c = glyph->children.begin(); c < glyph->children.end() && !run.animated; ++c) {
+                    auto group = static_cast<LottieGroup*>(*c);
+                    for (auto o = group->children.begin(); o < group->children.end(); ++o) {
+                        if (static_cast<LottiePath*>(*o)->pathset.frames) {
+                            run.animated = true;
+                            break;
+                        }
+                    }
+                }
+
+                p += glyph->len;
+                idx += glyph->len;
+                found = true;
+                break;
+            }
+        }
+
+        if (!found) {
+            ++p;
+            ++idx;
+        }
+    }
+}
+
+
 void LottieBuilder::updateText(LottieLayer* layer, float frameNo)
 {
     auto text = static_cast<LottieText*>(layer->children.first());
     auto& doc = text->doc(frameNo);
-    auto p = doc.text;
 
-    if (!p || !text->font) return;
+    if (!doc.text || !text->font) return;
 
+    //the glyph lookup and the outlines are reused while the document stays the same
+    if (text->run.doc != &doc || text->run.font != text->font) _buildGlyphRun(text, doc, frameNo);
+
+    auto& run = text->run;
     auto scale = doc.size;
     Point cursor = {0.0f, 0.0f};
     auto scene = Scene::gen();
-    int line = 0;
-    int space = 0;
     auto lineSpacing = 0.0f;
     auto totalLineSpacing = 0.0f;
 
-    //text string
-    int idx = 0;
-    auto totalChars = strlen(p);
-    while (true) {
+    //the range selectors don't vary per glyph, evaluate them once
+    Array<TextRangeFrame> ranges(text->ranges.count);
+    for (auto s = text->ranges.begin(); s < text->ranges.end(); ++s) {
+        auto& style = (*s)->style;
+        TextRangeFrame range;
+        range.based = (*s)->based;
+        (*s)->range(frameNo, float(run.length), range.start, range.end);
+        range.position = style.position(frameNo);
+        range.scale = style.scale(frameNo);
+        range.rotation = style.rotation(frameNo);
+        range.letterSpacing = style.letterSpacing(frameNo);
+        range.lineSpacing = style.lineSpacing(frameNo);
+        range.strokeWidth = style.strokeWidth(frameNo);
+        range.fillColor = style.fillColor(frameNo);
+        range.strokeColor = style.strokeColor(frameNo);
+        range.opacity = style.opacity(frameNo);
+        range.fillOpacity = style.fillOpacity(frameNo);
+        range.strokeOpacity = style.strokeOpacity(frameNo);
+        ranges.push(range);
+    }
+
+    for (auto g = run.glyphs.begin(); g < run.glyphs.end(); ++g) {
         //TODO: remove nested scenes.
         //end of text, new line of the cursor position
-        if (*p == 13 || *p == 3 || *p == '\0') {
+        if (!g->glyph) {
             //text layout position
             auto ascent = text->font->ascent * scale;
             if (ascent > doc.bbox.size.y) ascent = doc.bbox.size.y;
@@ -1019,8 +1133,7 @@ void LottieBuilder::updateText(LottieLayer* layer, float frameNo)
 
             layer->scene->push(std::move(scene));
 
-            if (*p == '\0') break;
-            ++p;
+            if (g + 1 == run.glyphs.end()) break;
 
             totalLineSpacing += lineSpacing;
             lineSpacing = 0.0f;
@@ -1028,101 +1141,74 @@ void LottieBuilder::updateText(LottieLayer* layer, float frameNo)
             //new text group, single scene for each line
             scene = Scene::gen();
             cursor.x = 0.0f;
-            cursor.y = (++line * doc.height + totalLineSpacing) / scale;
+            cursor.y = ((g->line + 1) * doc.height + totalLineSpacing) / scale;
             continue;
         }
 
-        if (*p == ' ') ++space;
+        auto shape = g->shape;
 
-        //find the glyph
-        bool found = false;
-        for (auto g = text->font->chars.begin(); g < text->font->chars.end(); ++g) {
-            auto glyph = *g;
-            //draw matched glyphs
-            if (!strncmp(glyph->code, p, glyph->len)) {
-                auto shape = text->pooling();
-                shape->reset();
-                for (auto g = glyph->children.begin(); g < glyph->children.end(); ++g) {
-                    auto group = static_cast<LottieGroup*>(*g);
-                    for (auto p = group->children.begin(); p < group->children.end(); ++p) {
-                        if (static_cast<LottiePath*>(*p)->pathset(frameNo, P(shape)->rs.path.cmds, P(shape)->rs.path.pts, nullptr, nullptr, nullptr)) {
-                            P(shape)->update(RenderUpdateFlag::Path);
-                        }
-                    }
-                }
-                shape->fill(doc.color.rgb[0], doc.color.rgb[1], doc.color.rgb[2]);
-                shape->translate(cursor.x, cursor.y);
-                shape->opacity(255);
-
-                if (doc.stroke.render) {
-                    shape->stroke(StrokeJoin::Round);
-                    shape->stroke(doc.stroke.width / scale);
-                    shape->stroke(doc.stroke.color.rgb[0], doc.stroke.color.rgb[1], doc.stroke.color.rgb[2]);
-                }
-
-                if (!text->ranges.empty()) {
-                    Point scaling = {1.0f, 1.0f};
-                    auto rotation = 0.0f;
-                    Point translation = {0.0f, 0.0f};
+        //the glyph is taken by another instance of the layer in this frame
+        if (PP(shape)->refCnt > 1) {
+            shape = text->pooling();
+            shape->reset();
+            _appendGlyph(g->glyph, shape, frameNo);
+        } else if (run.animated) {
+            shape->reset();
+            _appendGlyph(g->glyph, shape, frameNo);
+        }
 
-                    //text range process
-                    for (auto s = text->ranges.begin(); s < text->ranges.end(); ++s) {
-                        float start, end;
-                        (*s)->range(frameNo, float(totalChars), start, end);
+        shape->fill(doc.color.rgb[0], doc.color.rgb[1], doc.color.rgb[2]);
+        shape->translate(cursor.x, cursor.y);
+        shape->opacity(255);
 
-                        auto basedIdx = idx;
-                        if ((*s)->based == LottieTextRange::Based::CharsExcludingSpaces) basedIdx = idx - space;
-                        else if ((*s)->based == LottieTextRange::Based::Words) basedIdx = line + space;
-                        else if ((*s)->based == LottieTextRange::Based::Lines) basedIdx = line;
+        if (doc.stroke.render) {
+            shape->stroke(StrokeJoin::Round);
+            shape->stroke(doc.stroke.width / scale);
+            shape->stroke(doc.stroke.color.rgb[0], doc.stroke.color.rgb[1], doc.stroke.color.rgb[2]);
+        }
 
-                        if (basedIdx < start || basedIdx >= end) continue;
+        if (!ranges.empty()) {
+            Point scaling = {1.0f, 1.0f};
+            auto rotation = 0.0f;
+            Point translation = {0.0f, 0.0f};
 
-                        translation = translation + (*s)->style.position(frameNo);
-                        auto temp = (*s)->style.scale(frameNo);
-                        scaling.x *= temp.x * 0.01f;
-                        scaling.y *= temp.y * 0.01f;
-                        rotation += (*s)->style.rotation(frameNo);
+            //text range process
+            for (auto s = ranges.begin(); s < ranges.end(); ++s) {
+                auto basedIdx = g->idx;
+                if (s->based == LottieTextRange::Based::CharsExcludingSpaces) basedIdx = g->idx - g->space;
+                else if (s->based == LottieTextRange::Based::Words) basedIdx = g->line + g->space;
+                else if (s->based == LottieTextRange::Based::Lines) basedIdx = g->line;
 
-                        shape->opacity((*s)->style.opacity(frameNo));
+                if (basedIdx < s->start || basedIdx >= s->end) continue;
 
-                        auto color = (*s)->style.fillColor(frameNo);
-                        shape->fill(color.rgb[0], color.rgb[1], color.rgb[2], (*s)->style.fillOpacity(frameNo));
+                translation = translation + s->position;
+                scaling.x *= s->scale.x * 0.01f;
+                scaling.y *= s->scale.y * 0.01f;
+                rotation += s->rotation;
 
-                        if (doc.stroke.render) {
-                            auto strokeColor = (*s)->style.strokeColor(frameNo);
-                            shape->stroke((*s)->style.strokeWidth(frameNo) / scale);
-                            shape->stroke(strokeColor.rgb[0], strokeColor.rgb[1], strokeColor.rgb[2], (*s)->style.strokeOpacity(frameNo));
-                        }
-                        cursor.x += (*s)->style.letterSpacing(frameNo);
+                shape->opacity(s->opacity);
+                shape->fill(s->fillColor.rgb[0], s->fillColor.rgb[1], s->fillColor.rgb[2], s->fillOpacity);
 
-                        auto spacing = (*s)->style.lineSpacing(frameNo);
-                        if (spacing > lineSpacing) lineSpacing = spacing;
-                    }
-                    Matrix matrix;
-                    identity(&matrix);
-                    translate(&matrix, translation.x / scale + cursor.x, translation.y / scale + cursor.y);
-                    tvg::scale(&matrix, scaling.x, scaling.y);
-                    rotate(&matrix, rotation);
-                    shape->transform(matrix);
+                if (doc.stroke.render) {
+                    shape->stroke(s->strokeWidth / scale);
+                    shape->stroke(s->strokeColor.rgb[0], s->strokeColor.rgb[1], s->strokeColor.rgb[2], s->strokeOpacity);
                 }
+                cursor.x += s->letterSpacing;
 
-                scene->push(cast(shape));
-
-                p += glyph->len;
-                idx += glyph->len;
-
-                //advance the cursor position horizontally
-                cursor.x += glyph->width + doc.tracking;
-
-                found = true;
-                break;
+                if (s->lineSpacing > lineSpacing) lineSpacing = s->lineSpacing;
             }
+            Matrix matrix;
+            identity(&matrix);
+            translate(&matrix, translation.x / scale + cursor.x, translation.y / scale + cursor.y);
+            tvg::scale(&matrix, scaling.x, scaling.y);
+            rotate(&matrix, rotation);
+            shape->transform(matrix);
         }
 
-        if (!found) {
-            ++p;
-            ++idx;
-        }
+        scene->push(cast(shape));
+
+        //advance the cursor position horizontally
+        cursor.x += g->glyph->width + doc.tracking;
     }
 }
 
@@ -1213,14 +1299,18 @@ bool LottieBuilder::updateMatte(LottieComposition* comp, float frameNo, Scene* s
 
 void LottieBuilder::updateEffect(LottieLayer* layer, float frameNo)
 {
-    if (layer->effects.count == 0) return;
+    if (layer->effects.count == 0 || quality == 0) return;
+
+    //the designed blur quality(25) is lowered along with the requested quality
+    auto blurQuality = 25 * quality / 100;
+    if (blurQuality < 1) blurQuality = 1;
 
     for (auto ef = layer->effects.begin(); ef < layer->effects.end(); ++ef) {
         if (!(*ef)->enable) continue;
         switch ((*ef)->type) {
             case LottieEffect::GaussianBlur: {
                 auto effect = static_cast<LottieGaussianBlur*>(*ef);
-                layer->scene->push(SceneEffect::GaussianBlur, sqrt(effect->blurness(frameNo)), effect->direction(frameNo) - 1, effect->wrap(frameNo), 25);
+                layer->scene->push(SceneEffect::GaussianBlur, sqrt(effect->blurness(frameNo)), effect->direction(frameNo) - 1, effect->wrap(frameNo), blurQuality);
                 break;
             }
             default: break;
@@ -1287,7 +1377,8 @@ void LottieBuilder::updateLayer(LottieComposition* comp, Scene* scene, LottieLay
     updateEffect(layer, frameNo);
 
     //the given matte source was composited by the target earlier.
-    if (!layer->matteSrc) scene->push(cast(layer->scene));
+    //scene is null if the layer is being updated in parallel, the caller will push it later in order.
+    if (!layer->matteSrc && scene) scene->push(cast(layer->scene));
 }
 
 
@@ -1353,6 +1444,47 @@ static void _attachFont(LottieComposition* comp, LottieLayer* parent)
 }
 
 
+static void _collectAssets(LottieLayer* layer, Array<unsigned long>& rids)
+{
+    if (!layer->rid) return;
+
+    for (auto rid = rids.begin(); rid < rids.end(); ++rid) {
+        if (*rid == layer->rid) return;
+    }
+    rids.push(layer->rid);
+
+    //precomp assets could reference other assets in turn.
+    if (layer->type != LottieLayer::Precomp) return;
+
+    for (auto c = layer->children.begin(); c < layer->children.end(); ++c) {
+        _collectAssets(static_cast<LottieLayer*>(*c), rids);
+    }
+}
+
+
+static int32_t _layerIndex(LottieLayer* parent, LottieLayer* layer)
+{
+    for (uint32_t i = 0; i < parent->children.count; ++i) {
+        if (parent->children[i] == layer) return int32_t(i);
+    }
+    return -1;
+}
+
+
+static uint32_t _cluster(Array<uint32_t>& links, uint32_t idx)
+{
+    while (links[idx] != idx) idx = links[idx] = links[links[idx]];
+    return idx;
+}
+
+
+static void _merge(Array<uint32_t>& links, int32_t idx1, int32_t idx2)
+{
+    if (idx1 < 0 || idx2 < 0) return;
+    links[_cluster(links, idx1)] = _cluster(links, idx2);
+}
+
+
 static bool _buildComposition(LottieComposition* comp, LottieLayer* parent)
 {
     if (parent->children.count == 0) return false;
@@ -1394,6 +1526,99 @@ static bool _buildComposition(LottieComposition* comp, LottieLayer* parent)
 /* External Class Implementation                                        */
 /************************************************************************/
 
+struct ClusterJob
+{
+    LottieBuilder* builder;
+    LottieComposition* comp;
+    float frameNo;
+};
+
+
+void LottieBuilder::updateCluster(void* data, uint32_t idx)
+{
+    auto job = static_cast<ClusterJob*>(data);
+    auto builder = job->builder;
+    auto begin = (idx == 0) ? 0 : builder->clusters[idx - 1];
+
+    for (auto i = begin; i < builder->clusters[idx]; ++i) {
+        builder->updateLayer(job->comp, nullptr, builder->layers[i], job->frameNo);
+    }
+}
+
+
+void LottieBuilder::buildClusters(LottieComposition* comp)
+{
+    layers.clear();
+    clusters.clear();
+
+    auto root = comp->root;
+    auto cnt = root->children.count;
+    if (cnt < 2) return;
+
+    //union-find of the layers which share any states during the update
+    Array<uint32_t> links(cnt);
+    for (uint32_t i = 0; i < cnt; ++i) links.push(i);
+
+    struct Asset {
+        unsigned long rid;
+        uint32_t idx;
+    };
+    Array<Asset> owners;
+    Array<unsigned long> rids;
+    auto text = -1;
+
+    for (uint32_t i = 0; i < cnt; ++i) {
+        auto layer = static_cast<LottieLayer*>(root->children[i]);
+
+        //text layers share the glyphs (and their keyframe cursors) of the fonts
+        if (layer->type == LottieLayer::Text) {
+            if (text < 0) text = i;
+            else _merge(links, i, text);
+        }
+
+        //the parent transform is updated along with the child
+        for (auto parent = layer->parent; parent; parent = parent->parent) {
+            _merge(links, i, _layerIndex(root, parent));
+        }
+
+        //the matte source is updated by the target
+        if (layer->matteTarget) _merge(links, i, _layerIndex(root, layer->matteTarget));
+
+        //precomp layers and images share the render data of the assets
+        rids.clear();
+        _collectAssets(layer, rids);
+        for (auto rid = rids.begin(); rid < rids.end(); ++rid) {
+            auto found = false;
+            for (auto owner = owners.begin(); owner < owners.end(); ++owner) {
+                if (owner->rid != *rid) continue;
+                _merge(links, i, owner->idx);
+                found = true;
+                break;
+            }
+            if (!found) owners.push({*rid, i});
+        }
+    }
+
+    //sort the layers by the clusters keeping the z-order (back to front) in each.
+    Array<bool> visited(cnt);
+    for (uint32_t i = 0; i < cnt; ++i) visited.push(false);
+
+    for (auto i = int32_t(cnt) - 1; i >= 0; --i) {
+        auto cluster = _cluster(links, i);
+        if (visited[cluster]) continue;
+        visited[cluster] = true;
+        for (auto j = i; j >= 0; --j) {
+            auto layer = static_cast<LottieLayer*>(root->children[j]);
+            if (layer->matteSrc || _cluster(links, j) != cluster) continue;
+            layers.push(layer);
+        }
+        if (clusters.empty() || clusters.last() < layers.count) clusters.push(layers.count);
+    }
+
+    TVGLOG("LOTTIE", "%d root layers are grouped into %d clusters", cnt, clusters.count);
+}
+
+
 bool LottieBuilder::update(LottieComposition* comp, float frameNo)
 {
     if (comp->root->children.empty()) return false;
@@ -1408,6 +1633,19 @@ bool LottieBuilder::update(LottieComposition* comp, float frameNo)
 
     if (exps && comp->expressions) exps->update(comp->timeAtFrame(frameNo));
 
+    //the expressions engine is not thread-safe and could refer any layers.
+    if (clusters.count > 1 && TaskScheduler::threads() > 0 && !(exps && comp->expressions)) {
+        ClusterJob job = {this, comp, frameNo};
+        TaskScheduler::parallel(clusters.count, updateCluster, &job);
+
+        //assemble the layers in z-order
+        for (auto child = root->children.end() - 1; child >= root->children.begin(); --child) {
+            auto layer = static_cast<LottieLayer*>(*child);
+            if (!layer->matteSrc && layer->scene) root->scene->push(cast(layer->scene));
+        }
+        return true;
+    }
+
     for (auto child = root->children.end() - 1; child >= root->children.begin(); --child) {
         auto layer = static_cast<LottieLayer*>(*child);
         if (!layer->matteSrc) updateLayer(comp, root->scene, layer, frameNo);
@@ -1424,6 +1662,7 @@ void LottieBuilder::build(LottieComposition* comp)
     comp->root->scene = Scene::gen().release();
 
     _buildComposition(comp, comp->root);
+    buildClusters(comp);
 
     if (!update(comp, 0)) return;
 
@@ -102,7 +102,11 @@ struct LottieBuilder
     bool update(LottieComposition* comp, float progress);
     void build(LottieComposition* comp);
 
+    uint8_t quality = 100;  //effects quality, 0 ~ 100. effects are skipped at 0.
+
 private:
+    static void updateCluster(void* data, uint32_t idx);
+    void buildClusters(LottieComposition* comp);
     void updateEffect(LottieLayer* layer, float frameNo);
     void updateLayer(LottieComposition* comp, Scene* scene, LottieLayer* layer, float frameNo);
     bool updateMatte(LottieComposition* comp, float frameNo, Scene* scene, LottieLayer* layer);
@@ -129,6 +133,11 @@ private:
     void updateOffsetPath(LottieGroup* parent, LottieObject** child, float frameNo, Inlist<RenderContext>& contexts, RenderContext* ctx);
 
     LottieExpressions* exps;
+
+    //Root layers grouped by their dependencies (parenting, matting and shared assets).
+    //Each cluster is updated in sequence, while the clusters are independent of each other.
+    Array<LottieLayer*> layers;  //root layers in z-order, sorted by clusters
+    Array<uint32_t> clusters;    //end offsets of each cluster in the layers
 };
 
 #endif //_TVG_LOTTIE_BUILDER_H
\ No newline at end of file
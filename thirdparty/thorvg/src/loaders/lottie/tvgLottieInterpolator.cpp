@@ -119,6 +119,21 @@ float LottieInterpolator::NewtonRaphsonIterate(float aX, float aGuessT)
 /************************************************************************/
 
 float LottieInterpolator::progress(float t)
+{
+#if EASING_TABLE_SIZE > 0
+    if (baked && t >= 0.0f && t <= 1.0f) {
+        auto pos = t * EASING_TABLE_SIZE;
+        auto idx = static_cast<int>(pos);
+        if (idx >= EASING_TABLE_SIZE) return easing[EASING_TABLE_SIZE];
+        return lerp(easing[idx], easing[idx + 1], pos - float(idx));
+    }
+#endif
+
+    return solve(t);
+}
+
+
+float LottieInterpolator::solve(float t)
 {
     if (outTangent.x == outTangent.y && inTangent.x == inTangent.y) return t;
     return _calcBezier(getTForX(t), outTangent.y, inTangent.y);
@@ -130,6 +145,9 @@ void LottieInterpolator::set(const char* key, Point& inTangent, Point& outTangen
     this->key = strdup(key);
     this->inTangent = inTangent;
     this->outTangent = outTangent;
+#if EASING_TABLE_SIZE > 0
+    baked = false;
+#endif
 
     if (outTangent.x == outTangent.y && inTangent.x == inTangent.y) return;
 
@@ -137,4 +155,22 @@ void LottieInterpolator::set(const char* key, Point& inTangent, Point& outTangen
     for (int i = 0; i < SPLINE_TABLE_SIZE; ++i) {
         samples[i] = _calcBezier(float(i) * SAMPLE_STEP_SIZE, outTangent.x, inTangent.x);
     }
+
+#if EASING_TABLE_SIZE > 0
+    //bake the easing curve
+    for (int i = 0; i <= EASING_TABLE_SIZE; ++i) {
+        easing[i] = solve(float(i) / float(EASING_TABLE_SIZE));
+    }
+    //the lerp error is the largest between the steps
+    baked = true;
+    for (int i = 0; i < EASING_TABLE_SIZE && baked; ++i) {
+        for (int j = 1; j < 4; ++j) {
+            auto d = float(j) * 0.25f;
+            if (fabsf(lerp(easing[i], easing[i + 1], d) - solve((float(i) + d) / float(EASING_TABLE_SIZE))) > EASING_TABLE_TOLERANCE) {
+                baked = false;
+                break;
+            }
+        }
+    }
+#endif
 }
\ No newline at end of file
@@ -25,17 +25,29 @@
 
 #define SPLINE_TABLE_SIZE 11
 
+//The easing curve is baked in this precision, 0 (default) solves the curve on every evaluation instead.
+//A baked curve is kept only if it's within the tolerance of the solved one, the steep curves are solved anyway.
+#ifndef EASING_TABLE_SIZE
+    #define EASING_TABLE_SIZE 0
+#endif
+#define EASING_TABLE_TOLERANCE (0.5f / 255.0f)
+
 struct LottieInterpolator
 {
     char* key;
     Point outTangent, inTangent;
 
     float progress(float t);
+    float solve(float t);                   //the exact progress, regardless of the baked table
     void set(const char* key, Point& inTangent, Point& outTangent);
 
 private:
     static constexpr float SAMPLE_STEP_SIZE = 1.0f / float(SPLINE_TABLE_SIZE - 1);
     float samples[SPLINE_TABLE_SIZE];
+#if EASING_TABLE_SIZE > 0
+    float easing[EASING_TABLE_SIZE + 1];    //progress values of the uniform steps
+    bool baked;                             //the table is within the tolerance
+#endif
 
     float getTForX(float aX);
     float binarySubdivide(float aX, float aA, float aB);
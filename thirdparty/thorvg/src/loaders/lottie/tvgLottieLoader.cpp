@@ -24,6 +24,7 @@
 #include "tvgLottieModel.h"
 #include "tvgLottieParser.h"
 #include "tvgLottieBuilder.h"
+#include "tvgLottieBinary.h"
 #include "tvgStr.h"
 
 /************************************************************************/
@@ -37,11 +38,22 @@ void LottieLoader::run(unsigned tid)
         builder->update(comp, frameNo);
     //initial loading
     } else {
-        LottieParser parser(content, dirName);
-        if (!parser.parse()) return;
+        LottieComposition* comp = nullptr;
+        if (binary) {
+            LottieBinaryReader reader(content, size, dirName);
+            comp = reader.read();
+        } else {
+            LottieParser parser(content, dirName);
+            if (parser.parse()) comp = parser.comp;
+        }
+        if (!comp) return;
         {
             ScopedLock lock(key);
-            comp = parser.comp;
+            this->comp = comp;
+        }
+        //the embedded images have been decoded in parallel with the parsing.
+        for (auto a = comp->assets.begin(); a < comp->assets.end(); ++a) {
+            if ((*a)->type == LottieObject::Image) TaskScheduler::join(static_cast<LottieImage*>(*a));
         }
         builder->build(comp);
 
@@ -56,6 +68,9 @@ void LottieLoader::release()
     if (copy) {
         free((char*)content);
         content = nullptr;
+    } else if (file.data) {
+        file.close();
+        content = nullptr;
     }
     free(dirName);
     dirName = nullptr;
@@ -86,6 +101,18 @@ LottieLoader::~LottieLoader()
 
 bool LottieLoader::header()
 {
+    //The precompiled binary has the animation info in its header.
+    if (binary) {
+        LottieBinaryHeader header;
+        LottieBinaryReader::header(content, size, &header);
+        w = header.w;
+        h = header.h;
+        frameRate = header.frameRate;
+        frameCnt = header.outFrame - header.inFrame;
+        frameDuration = frameCnt / frameRate;
+        return true;
+    }
+
     //A single thread doesn't need to perform intensive tasks.
     if (TaskScheduler::threads() == 0) {
         LoadModule::read();
@@ -208,6 +235,7 @@ bool LottieLoader::open(const char* data, uint32_t size, bool copy)
 
     this->size = size;
     this->copy = copy;
+    this->binary = LottieBinaryReader::header(data, size);
 
     return header();
 }
@@ -215,31 +243,13 @@ bool LottieLoader::open(const char* data, uint32_t size, bool copy)
 
 bool LottieLoader::open(const string& path)
 {
-    auto f = fopen(path.c_str(), "r");
-    if (!f) return false;
-
-    fseek(f, 0, SEEK_END);
-
-    size = ftell(f);
-    if (size == 0) {
-        fclose(f);
-        return false;
-    }
-
-    auto content = (char*)(malloc(sizeof(char) * size + 1));
-    fseek(f, 0, SEEK_SET);
-    auto ret = fread(content, sizeof(char), size, f);
-    if (ret < size) {
-        fclose(f);
-        return false;
-    }
-    content[size] = '\0';
-
-    fclose(f);
+    //the json is parsed in situ, the mapping is private to this loader.
+    if (!file.open(path.c_str(), true, true)) return false;
 
     this->dirName = strDirname(path.c_str());
-    this->content = content;
-    this->copy = true;
+    this->content = file.data;
+    this->size = file.size;
+    this->binary = LottieBinaryReader::header(file.data, file.size);
 
     return header();
 }
@@ -326,6 +336,21 @@ bool LottieLoader::override(const char* slot)
 }
 
 
+bool LottieLoader::quality(uint8_t value)
+{
+    if (!ready()) return false;
+
+    //the builder might be updating the frame on a worker
+    done();
+
+    if (builder->quality != value) {
+        builder->quality = value;
+        rebuild = true;
+    }
+    return true;
+}
+
+
 bool LottieLoader::frame(float no)
 {
     auto frameNo = no + startFrame();
@@ -381,6 +406,27 @@ void LottieLoader::sync()
 }
 
 
+bool LottieLoader::compile(const char* path, const char* target)
+{
+    FileView file;
+    if (!file.open(path, true, true)) return false;
+
+    auto dirName = strDirname(path);
+    auto ret = false;
+
+    LottieParser parser(file.data, dirName);
+    if (parser.parse()) {
+        LottieBinaryWriter writer(dirName);
+        ret = writer.write(parser.comp, target);
+        delete(parser.comp);
+    }
+
+    free(dirName);
+
+    return ret;
+}
+
+
 uint32_t LottieLoader::markersCnt()
 {
     return ready() ? comp->markers.count : 0;
@@ -26,6 +26,7 @@
 #include "tvgCommon.h"
 #include "tvgFrameModule.h"
 #include "tvgTaskScheduler.h"
+#include "tvgFile.h"
 
 struct LottieComposition;
 struct LottieBuilder;
@@ -45,7 +46,9 @@ public:
 
     Key key;
     char* dirName = nullptr;            //base resource directory
+    FileView file;                      //"content" is viewed from the file
     bool copy = false;                  //"content" is owned by this loader
+    bool binary = false;                //"content" is the precompiled binary format
     bool overridden = false;             //overridden properties with slots
     bool rebuild = false;               //require building the lottie scene
 
@@ -58,6 +61,10 @@ public:
     bool read() override;
     Paint* paint() override;
     bool override(const char* slot);
+    bool quality(uint8_t value);
+
+    //Converter to the precompiled binary format
+    static bool compile(const char* path, const char* target);
 
     //Frame Controls
     bool frame(float no) override;
@@ -24,6 +24,7 @@
 #include "tvgPaint.h"
 #include "tvgFill.h"
 #include "tvgTaskScheduler.h"
+#include "tvgCompressor.h"
 #include "tvgLottieModel.h"
 
 
@@ -58,6 +59,7 @@ void LottieSlot::reset()
             case LottieProperty::Type::TextDoc: {
                 static_cast<LottieText*>(pair->obj)->doc.release();
                 static_cast<LottieText*>(pair->obj)->doc = *static_cast<LottieTextDoc*>(pair->prop);
+                static_cast<LottieText*>(pair->obj)->run.reset();
                 static_cast<LottieTextDoc*>(pair->prop)->frames = nullptr;
                 break;
             }
@@ -130,14 +132,18 @@ void LottieTextRange::range(float frameNo, float totalLen, float& start, float&
 
 LottieImage::~LottieImage()
 {
+    TaskScheduler::join(this);
     free(b64Data);
     free(mimeType);
 }
 
 
-void LottieImage::prepare()
+void LottieImage::run(TVG_UNUSED unsigned tid)
 {
-    LottieObject::type = LottieObject::Image;
+    if (encoded) {
+        size = b64Decode(encoded, strlen(encoded), &b64Data);
+        encoded = nullptr;
+    }
 
     auto picture = Picture::gen().release();
 
@@ -145,17 +151,27 @@ void LottieImage::prepare()
     TaskScheduler::async(false);
 
     if (size > 0) picture->load((const char*)b64Data, size, mimeType, false);
-    else picture->load(path);
+    else if (path) picture->load(path);
+
+    //the image is decoded for the size of the asset
+    picture->size(width, height);
 
     TaskScheduler::async(true);
 
-    picture->size(width, height);
     PP(picture)->ref();
 
     pooler.push(picture);
 }
 
 
+void LottieImage::prepare()
+{
+    LottieObject::type = LottieObject::Image;
+
+    TaskScheduler::request(this);
+}
+
+
 void LottieTrimpath::segment(float frameNo, float& start, float& end, LottieExpressions* exps)
 {
     start = this->start(frameNo, exps) * 0.01f;
@@ -435,6 +451,14 @@ void LottieLayer::prepare(RGB24* color)
         return;
     }
 
+    prepareStatical(color);
+
+    LottieGroup::prepare(LottieObject::Layer);
+}
+
+
+void LottieLayer::prepareStatical(RGB24* color)
+{
     //prepare the viewport clipper
     if (type == LottieLayer::Precomp) {
         auto clipper = Shape::gen().release();
@@ -449,8 +473,6 @@ void LottieLayer::prepare(RGB24* color)
         PP(solidFill)->ref();
         statical.pooler.push(solidFill);
     }
-
-    LottieGroup::prepare(LottieObject::Layer);
 }
 
 
@@ -27,6 +27,7 @@
 
 #include "tvgCommon.h"
 #include "tvgRender.h"
+#include "tvgTaskScheduler.h"
 #include "tvgLottieProperty.h"
 #include "tvgLottieRenderPooler.h"
 
@@ -253,6 +254,41 @@ struct LottieMarker
 
 struct LottieText : LottieObject, LottieRenderPooler<tvg::Shape>
 {
+    //a laid-out glyph of the text document, or a line break if glyph is null
+    struct Glyph
+    {
+        LottieGlyph* glyph;
+        tvg::Shape* shape;
+        int idx;
+        int space;
+        int line;
+    };
+
+    //glyph run cached per text document and font, reused until either of them changes
+    struct Run
+    {
+        Array<Glyph> glyphs;
+        TextDocument* doc = nullptr;
+        LottieFont* font = nullptr;
+        uint32_t length = 0;
+        bool animated = false;     //glyph outlines have keyframes
+
+        ~Run()
+        {
+            reset();
+        }
+
+        void reset()
+        {
+            for (auto g = glyphs.begin(); g < glyphs.end(); ++g) {
+                if (g->shape && PP(g->shape)->unref() == 0) delete(g->shape);
+            }
+            glyphs.clear();
+            doc = nullptr;
+            font = nullptr;
+        }
+    };
+
     void prepare()
     {
         LottieObject::type = LottieObject::Text;
@@ -261,6 +297,7 @@ struct LottieText : LottieObject, LottieRenderPooler<tvg::Shape>
     void override(LottieProperty* prop) override
     {
         this->doc = *static_cast<LottieTextDoc*>(prop);
+        this->run.reset();
         this->prepare();
     }
 
@@ -273,6 +310,7 @@ struct LottieText : LottieObject, LottieRenderPooler<tvg::Shape>
     LottieTextDoc doc;
     LottieFont* font;
     Array<LottieTextRange*> ranges;
+    Run run;
 
     ~LottieText()
     {
@@ -643,12 +681,14 @@ struct LottieGradientStroke : LottieGradient, LottieStroke
 };
 
 
-struct LottieImage : LottieObject, LottieRenderPooler<tvg::Picture>
+//the picture is loaded in a task overlapping the rest of the parsing, the loader joins it.
+struct LottieImage : LottieObject, LottieRenderPooler<tvg::Picture>, Task
 {
     union {
         char* b64Data = nullptr;
         char* path;
     };
+    const char* encoded = nullptr;      //base64 data in the json, decoded by the task
     char* mimeType = nullptr;
     uint32_t size = 0;
     float width = 0.0f;
@@ -656,6 +696,9 @@ struct LottieImage : LottieObject, LottieRenderPooler<tvg::Picture>
 
     ~LottieImage();
     void prepare();
+
+protected:
+    void run(unsigned tid) override;
 };
 
 
@@ -759,6 +802,7 @@ struct LottieLayer : LottieGroup
     bool mergeable() override { return false; }
 
     void prepare(RGB24* color = nullptr);
+    void prepareStatical(RGB24* color = nullptr);
     float remap(LottieComposition* comp, float frameNo, LottieExpressions* exp);
 
     char* name = nullptr;
@@ -828,7 +872,7 @@ struct LottieSlot
 
     LottieSlot(char* sid, LottieObject* obj, LottieProperty::Type type) : sid(sid), type(type)
     {
-        pairs.push({obj});
+        pairs.push({obj, nullptr});
     }
 
     ~LottieSlot()
@@ -496,7 +496,7 @@ void LottieParser::parseProperty(T& prop, LottieObject* obj)
             //append object if the slot already exists.
             for (auto slot = comp->slots.begin(); slot < comp->slots.end(); ++slot) {
                 if (strcmp((*slot)->sid, sid)) continue;
-                (*slot)->pairs.push({obj});
+                (*slot)->pairs.push({obj, nullptr});
                 break;
             }
             comp->slots.push(new LottieSlot(sid, obj, type));
@@ -934,10 +934,8 @@ LottieImage* LottieParser::parseImage(const char* data, const char* subPath, boo
         auto mimeType = data + 11;
         auto needle = strstr(mimeType, ";");
         image->mimeType = strDuplicate(mimeType, needle - mimeType);
-        //b64 data
-        auto b64Data = strstr(data, ",") + 1;
-        size_t length = strlen(data) - (b64Data - data);
-        image->size = b64Decode(b64Data, length, &image->b64Data);
+        //b64 data, decoded by the image task in parallel with the parsing
+        image->encoded = strstr(data, ",") + 1;
     //external image resource
     } else {
         auto len = strlen(dirName) + strlen(subPath) + strlen(data) + 1;
@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include "tvgCommon.h"
+#include "tvgMath.h"
+#include "thorvg_lottie.h"
+
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+//quality levels of the adaptive playback, from the full quality
+static constexpr uint8_t QUALITY_LEVELS[] = {100, 50, 25, 0};
+static constexpr uint32_t QUALITY_LEVEL_CNT = sizeof(QUALITY_LEVELS) / sizeof(QUALITY_LEVELS[0]);
+
+//frames to settle down the cost after a quality change
+static constexpr uint32_t SETTLE_FRAMES = 8;
+
+//seconds of the consecutive frames with the enough headroom to restore a quality level
+static constexpr float RESTORE_TIME = 1.0f;
+
+
+struct LottiePlayer::Impl
+{
+    Canvas* canvas = nullptr;
+    LottieAnimation* animation = nullptr;
+    float fps = 0.0f;              //target frame rate, 0 for the animation frame rate
+    float cost = 0.0f;             //smoothed cost of a presented frame in seconds
+    double spent = 0.0;            //accumulated cost of the presented frames in seconds
+    int64_t slot = -1;             //last presented frame slot of the target frame rate
+    uint32_t presented = 0;
+    uint32_t dropped = 0;
+    uint32_t settle = 0;
+    uint32_t calm = 0;
+    uint8_t level = 0;             //index of the QUALITY_LEVELS
+    bool adaptive = true;
+    bool dirty = true;             //the frame must be presented even if it's not changed
+
+    void reset()
+    {
+        cost = 0.0f;
+        spent = 0.0;
+        slot = -1;
+        presented = dropped = settle = calm = 0;
+        quality(0);
+    }
+
+    void quality(uint8_t level)
+    {
+        this->level = level;
+        settle = SETTLE_FRAMES;
+        calm = 0;
+        dirty = true;
+        if (animation) animation->quality(QUALITY_LEVELS[level]);
+    }
+
+    //rate: the frames presented per second
+    void adapt(float rate)
+    {
+        auto budget = 1.0f / rate;
+
+        if (settle > 0) {
+            --settle;
+            return;
+        }
+
+        //the frame doesn't fit into the budget, lower the quality
+        if (cost > budget) {
+            if (level + 1u < QUALITY_LEVEL_CNT) quality(level + 1);
+            calm = 0;
+        //enough headroom for a while, bring the quality back
+        } else if (level > 0 && cost < budget * 0.5f) {
+            if (++calm >= std::max(1u, static_cast<uint32_t>(ceilf(RESTORE_TIME * rate)))) quality(level - 1);
+        } else {
+            calm = 0;
+        }
+    }
+
+    Result play(float time)
+    {
+        if (!canvas || !animation) return Result::InsufficientCondition;
+
+        auto duration = animation->duration();
+        auto totalFrame = animation->totalFrame();
+        if (duration <= 0.0f || totalFrame <= 0.0f) return Result::InsufficientCondition;
+
+        auto rate = (fps > 0.0f) ? fps : (totalFrame / duration);
+        auto slot = static_cast<int64_t>(floor(double(time) * rate));
+
+        if (slot == this->slot) return Result::InsufficientCondition;
+
+        //the frames of the skipped slots are never presented
+        if (this->slot >= 0 && slot > this->slot + 1) dropped += static_cast<uint32_t>(slot - this->slot - 1);
+        this->slot = slot;
+
+        //the frame of the slot, looping over the duration
+        auto no = static_cast<float>(fmod(slot / double(rate), double(duration)) / duration * totalFrame);
+
+        //no tweening between the frames while the quality is lowered
+        if (level > 0) no = floorf(no);
+
+        auto begin = std::chrono::steady_clock::now();
+
+        if (animation->frame(no) != Result::Success && !dirty) return Result::InsufficientCondition;
+        dirty = false;
+
+        canvas->update();
+        canvas->draw();
+        canvas->sync();
+
+        auto cost = std::chrono::duration<float>(std::chrono::steady_clock::now() - begin).count();
+
+        spent += cost;
+        this->cost = (presented++ == 0) ? cost : (this->cost * 0.8f + cost * 0.2f);
+
+        if (adaptive) adapt(rate);
+
+        return Result::Success;
+    }
+};
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+LottiePlayer::LottiePlayer() : pImpl(new Impl)
+{
+}
+
+
+LottiePlayer::~LottiePlayer()
+{
+    delete(pImpl);
+}
+
+
+Result LottiePlayer::target(Canvas* canvas, LottieAnimation* animation) noexcept
+{
+    if (!canvas || !animation) return Result::InvalidArguments;
+
+    pImpl->canvas = canvas;
+    pImpl->animation = animation;
+    pImpl->reset();
+
+    return Result::Success;
+}
+
+
+Result LottiePlayer::fps(float fps) noexcept
+{
+    if (fps < 0.0f) return Result::InvalidArguments;
+
+    pImpl->fps = fps;
+    pImpl->slot = -1;
+
+    return Result::Success;
+}
+
+
+Result LottiePlayer::adaptive(bool on) noexcept
+{
+    pImpl->adaptive = on;
+    if (!on && pImpl->level > 0) pImpl->quality(0);
+
+    return Result::Success;
+}
+
+
+Result LottiePlayer::play(float time) noexcept
+{
+    return pImpl->play(time);
+}
+
+
+Result LottiePlayer::stats(uint32_t* presented, uint32_t* dropped, float* cost, uint8_t* quality) const noexcept
+{
+    if (presented) *presented = pImpl->presented;
+    if (dropped) *dropped = pImpl->dropped;
+    if (cost) *cost = (pImpl->presented > 0) ? float(pImpl->spent * 1000.0 / pImpl->presented) : 0.0f;
+    if (quality) *quality = QUALITY_LEVELS[pImpl->level];
+
+    return Result::Success;
+}
+
+
+unique_ptr<LottiePlayer> LottiePlayer::gen() noexcept
+{
+    return unique_ptr<LottiePlayer>(new LottiePlayer);
+}
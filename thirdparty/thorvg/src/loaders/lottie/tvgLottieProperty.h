@@ -115,6 +115,7 @@ struct LottieProperty
     enum class Type : uint8_t { Point = 0, Float, Opacity, Color, PathSet, ColorStop, Position, TextDoc, Invalid };
 
     LottieExpression* exp = nullptr;
+    uint32_t cursor = 0;  //keyframe index of the last evaluation
     Type type;
     uint8_t ix;  //property index
 
@@ -197,6 +198,19 @@ uint32_t _bsearch(T* frames, float frameNo)
 }
 
 
+//Mostly the frames are played forward, try the last found keyframe and its next one first.
+template<typename T>
+uint32_t _bsearch(T* frames, float frameNo, uint32_t& cursor)
+{
+    auto key = cursor;
+    if (key + 1 < frames->count && frameNo >= frames->data[key].no) {
+        if (frameNo < frames->data[key + 1].no) return key;
+        if (key + 2 < frames->count && frameNo < frames->data[key + 2].no) return (cursor = key + 1);
+    }
+    return (cursor = _bsearch(frames, frameNo));
+}
+
+
 template<typename T>
 uint32_t _nearest(T* frames, float frameNo)
 {
@@ -314,7 +328,7 @@ struct LottieGenericProperty : LottieProperty
         if (frames->count == 1 || frameNo <= frames->first().no) return frames->first().value;
         if (frameNo >= frames->last().no) return frames->last().value;
 
-        auto frame = frames->data + _bsearch(frames, frameNo);
+        auto frame = frames->data + _bsearch(frames, frameNo, cursor);
         if (tvg::equal(frame->no, frameNo)) return frame->value;
         return frame->interpolate(frame + 1, frameNo);
     }
@@ -419,7 +433,7 @@ struct LottiePathSet : LottieProperty
         else if (frames->count == 1 || frameNo <= frames->first().no) path = &frames->first().value;
         else if (frameNo >= frames->last().no) path = &frames->last().value;
         else {
-            frame = frames->data + _bsearch(frames, frameNo);
+            frame = frames->data + _bsearch(frames, frameNo, cursor);
             if (tvg::equal(frame->no, frameNo)) path = &frame->value;
             else if (frame->value.ptsCnt != (frame + 1)->value.ptsCnt) {
                 path = &frame->value;
@@ -582,7 +596,7 @@ struct LottieColorStop : LottieProperty
             return fill->colorStops(frames->last().value.data, count);
         }
 
-        auto frame = frames->data + _bsearch(frames, frameNo);
+        auto frame = frames->data + _bsearch(frames, frameNo, cursor);
         if (tvg::equal(frame->no, frameNo)) return fill->colorStops(frame->value.data, count);
 
         //interpolate
@@ -693,7 +707,7 @@ struct LottiePosition : LottieProperty
         if (frames->count == 1 || frameNo <= frames->first().no) return frames->first().value;
         if (frameNo >= frames->last().no) return frames->last().value;
 
-        auto frame = frames->data + _bsearch(frames, frameNo);
+        auto frame = frames->data + _bsearch(frames, frameNo, cursor);
         if (tvg::equal(frame->no, frameNo)) return frame->value;
         return frame->interpolate(frame + 1, frameNo);
     }
@@ -718,7 +732,7 @@ struct LottiePosition : LottieProperty
             return frame->angle(frame + 1, frames->last().no);
         }
 
-        auto frame = frames->data + _bsearch(frames, frameNo);
+        auto frame = frames->data + _bsearch(frames, frameNo, cursor);
         return frame->angle(frame + 1, frameNo);
     }
 
@@ -806,7 +820,7 @@ struct LottieTextDoc : LottieProperty
         if (frames->count == 1 || frameNo <= frames->first().no) return frames->first().value;
         if (frameNo >= frames->last().no) return frames->last().value;
 
-        auto frame = frames->data + _bsearch(frames, frameNo);
+        auto frame = frames->data + _bsearch(frames, frameNo, cursor);
         return frame->value;
     }
 
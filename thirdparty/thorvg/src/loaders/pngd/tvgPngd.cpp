@@ -0,0 +1,1013 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <algorithm>
+#include "tvgCommon.h"
+#include "tvgArray.h"
+#include "tvgPngd.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define PNGD_SSE2
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define PNGD_NEON
+#endif
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+struct PngChunk
+{
+    const uint8_t* data;
+    uint32_t size;
+};
+
+
+//the frame of an animated png, its image data is the IDAT chunks or its fdAT chunks in png_decoder::fdat
+struct PngFrame
+{
+    png_frame info;
+    uint32_t first, count;                  //the fdAT chunks
+    bool idat;
+};
+
+
+struct png_decoder
+{
+    uint32_t w, h;
+    uint8_t depth;                          //bits per sample
+    uint8_t type;                           //0: gray, 2: rgb, 3: palette, 4: gray & alpha, 6: rgba
+    uint8_t interlace;                      //0: none, 1: adam7
+    uint8_t palette[256][4];                //straight rgba
+    uint32_t paletteSize = 0;
+    uint16_t key[3];                        //the transparent color of the gray or rgb image, see tRNS
+    bool keyed = false;
+    Array<PngChunk> idat;
+    Array<PngChunk> fdat;                   //without the sequence numbers
+    Array<PngFrame> frames;
+    bool animated = false;                  //see acTL
+};
+
+
+//the deflate stream of the image data, RFC 1950 & 1951
+struct Inflater
+{
+    static constexpr uint32_t FAST_BITS = 10;                           //the codes up to this length are looked up at once
+    static constexpr uint32_t SUBTABLE = 0x80000000;                    //the entry refers to a subtable of the longer codes
+    static constexpr uint32_t LITERALS = (1 << FAST_BITS) + 288 * 32;
+    static constexpr uint32_t DISTANCES = (1 << FAST_BITS) + 30 * 32;
+
+    const uint8_t* in;
+    const uint8_t* end;
+    uint64_t bits = 0;
+    uint32_t count = 0;                     //the valid bits of the buffer
+    uint32_t overrun = 0;                   //the zero bytes read beyond the end
+    uint8_t* begin;
+    uint8_t* out;
+    uint8_t* last;
+
+    //entry: symbol (16 bits), code length (5 bits), or the subtable offset with the SUBTABLE flag
+    uint32_t literals[LITERALS];
+    uint32_t distances[DISTANCES];
+    uint32_t literalMask, distanceMask;     //the subtable index of the bits after the fast ones
+
+    void refill()
+    {
+        if (end - in >= 8) {
+            uint64_t v;
+            memcpy(&v, in, 8);
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+            v = __builtin_bswap64(v);
+#endif
+            bits |= v << count;
+            in += (63 - count) >> 3;
+            count |= 56;
+        } else {
+            while (count <= 56) {
+                if (in < end) bits |= uint64_t(*in++) << count;
+                else ++overrun;
+                count += 8;
+            }
+        }
+    }
+
+    uint32_t take(uint32_t n)
+    {
+        auto v = static_cast<uint32_t>(bits & ((uint64_t(1) << n) - 1));
+        bits >>= n;
+        count -= n;
+        return v;
+    }
+
+    //the input is broken if the zero bytes beyond the end were consumed
+    bool valid()
+    {
+        return overrun * 8 <= count;
+    }
+
+    static bool build(uint32_t* table, uint32_t* mask, const uint8_t* lengths, uint32_t cnt)
+    {
+        uint32_t counts[16] = {0};
+        for (uint32_t i = 0; i < cnt; ++i) ++counts[lengths[i]];
+        counts[0] = 0;
+
+        int32_t left = 1;
+        uint32_t maxLength = 0;
+        for (uint32_t len = 1; len < 16; ++len) {
+            left = (left << 1) - counts[len];
+            if (left < 0) return false;         //over-subscribed
+            if (counts[len]) maxLength = len;
+        }
+
+        uint32_t next[16];
+        uint32_t code = 0;
+        for (uint32_t len = 1; len < 16; ++len) {
+            code = (code + counts[len - 1]) << 1;
+            next[len] = code;
+        }
+
+        auto subBits = maxLength > FAST_BITS ? maxLength - FAST_BITS : 0;
+        *mask = (1 << subBits) - 1;
+        memset(table, 0, (1 << FAST_BITS) * sizeof(uint32_t));
+        auto used = uint32_t(1 << FAST_BITS);
+
+        for (uint32_t sym = 0; sym < cnt; ++sym) {
+            auto len = lengths[sym];
+            if (len == 0) continue;
+            //the codes are packed from the least significant bit
+            auto c = next[len]++;
+            uint32_t rev = 0;
+            for (uint32_t i = 0; i < len; ++i, c >>= 1) rev = (rev << 1) | (c & 1);
+            auto entry = sym | (uint32_t(len) << 16);
+            if (len <= FAST_BITS) {
+                for (auto i = rev; i < (1u << FAST_BITS); i += (1 << len)) table[i] = entry;
+            } else {
+                auto& prefix = table[rev & ((1 << FAST_BITS) - 1)];
+                if (!(prefix & SUBTABLE)) {
+                    prefix = SUBTABLE | used;
+                    memset(table + used, 0, (1 << subBits) * sizeof(uint32_t));
+                    used += (1 << subBits);
+                }
+                auto sub = table + (prefix & 0xffff);
+                for (auto i = rev >> FAST_BITS; i < (1u << subBits); i += (1 << (len - FAST_BITS))) sub[i] = entry;
+            }
+        }
+        return true;
+    }
+
+    //the buffer has 48 bits at least, that is enough for a length and a distance with their extra bits
+    static bool decode(const uint32_t* table, uint32_t mask, uint64_t& bits, uint32_t& count, uint32_t& sym)
+    {
+        auto entry = table[bits & ((1 << FAST_BITS) - 1)];
+        if (entry & SUBTABLE) entry = table[(entry & 0xffff) + ((bits >> FAST_BITS) & mask)];
+        auto len = (entry >> 16) & 31;
+        if (len == 0) return false;
+        bits >>= len;
+        count -= len;
+        sym = entry & 0xffff;
+        return true;
+    }
+
+    bool stored()
+    {
+        //the rest of the bytes in the buffer are given back to the input
+        take(count & 7);
+        auto back = count >> 3;
+        if (back < overrun) return false;
+        in -= (back - overrun);
+        bits = 0;
+        count = overrun = 0;
+
+        if (end - in < 4) return false;
+        auto len = uint32_t(in[0]) | (uint32_t(in[1]) << 8);
+        auto nlen = uint32_t(in[2]) | (uint32_t(in[3]) << 8);
+        in += 4;
+        if ((len ^ 0xffff) != nlen) return false;
+        if (uint32_t(end - in) < len || uint32_t(last - out) < len) return false;
+        memcpy(out, in, len);
+        in += len;
+        out += len;
+        return true;
+    }
+
+    bool fixed()
+    {
+        uint8_t lengths[288 + 32];
+        memset(lengths, 8, 144);
+        memset(lengths + 144, 9, 112);
+        memset(lengths + 256, 7, 24);
+        memset(lengths + 280, 8, 8);
+        memset(lengths + 288, 5, 32);
+        return build(literals, &literalMask, lengths, 288) && build(distances, &distanceMask, lengths + 288, 32);
+    }
+
+    bool dynamic()
+    {
+        static constexpr uint8_t ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+        refill();
+        auto hlit = take(5) + 257;
+        auto hdist = take(5) + 1;
+        auto hclen = take(4) + 4;
+        if (hlit > 286 || hdist > 30) return false;
+
+        uint8_t lengths[288 + 32] = {0};
+        for (uint32_t i = 0; i < hclen; ++i) {
+            if (count < 3) refill();
+            lengths[ORDER[i]] = take(3);
+        }
+        uint32_t codes[(1 << FAST_BITS)];
+        uint32_t codeMask;
+        if (!build(codes, &codeMask, lengths, 19)) return false;
+
+        memset(lengths, 0, 19);
+        uint32_t n = 0;
+        while (n < hlit + hdist) {
+            if (count < 16) refill();
+            uint32_t sym;
+            if (!decode(codes, codeMask, bits, count, sym)) return false;
+            if (sym < 16) {
+                lengths[n++] = sym;
+                continue;
+            }
+            uint8_t len = 0;
+            uint32_t repeat;
+            if (sym == 16) {
+                if (n == 0) return false;
+                len = lengths[n - 1];
+                repeat = 3 + take(2);
+            } else if (sym == 17) repeat = 3 + take(3);
+            else repeat = 11 + take(7);
+            if (n + repeat > hlit + hdist) return false;
+            memset(lengths + n, len, repeat);
+            n += repeat;
+        }
+        if (!valid() || lengths[256] == 0) return false;
+
+        //the distance lengths follow the literal ones
+        uint8_t dlengths[32] = {0};
+        memcpy(dlengths, lengths + hlit, hdist);
+        memset(lengths + hlit, 0, hdist);
+        return build(literals, &literalMask, lengths, 288) && build(distances, &distanceMask, dlengths, 32);
+    }
+
+    bool block()
+    {
+        static constexpr uint16_t LBASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+        static constexpr uint8_t LEXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+        static constexpr uint16_t DBASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+        static constexpr uint8_t DEXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+        //local copies let the compiler keep them in the registers
+        auto bits = this->bits;
+        auto count = this->count;
+        auto out = this->out;
+        auto ret = false;
+
+        while (true) {
+            if (count < 48) {
+                this->bits = bits;
+                this->count = count;
+                refill();
+                bits = this->bits;
+                count = this->count;
+            }
+            uint32_t sym;
+            if (!decode(literals, literalMask, bits, count, sym)) break;
+            if (sym < 256) {
+                if (out >= last) break;
+                *out++ = uint8_t(sym);
+                continue;
+            }
+            if (sym == 256) {
+                ret = true;
+                break;
+            }
+            sym -= 257;
+            if (sym >= 29) break;
+            auto len = LBASE[sym] + uint32_t(bits & ((1 << LEXTRA[sym]) - 1));
+            bits >>= LEXTRA[sym];
+            count -= LEXTRA[sym];
+
+            if (!decode(distances, distanceMask, bits, count, sym) || sym >= 30) break;
+            auto dist = DBASE[sym] + uint32_t(bits & ((1 << DEXTRA[sym]) - 1));
+            bits >>= DEXTRA[sym];
+            count -= DEXTRA[sym];
+
+            if (dist > uint32_t(out - begin) || len > uint32_t(last - out)) break;
+
+            //the output has a room of 16 bytes after the last, the copy may run over the length
+            auto src = out - dist;
+            if (dist >= 8) {
+                auto dst = out;
+                auto stop = out + len;
+                do {
+                    memcpy(dst, src, 8);
+                    dst += 8;
+                    src += 8;
+                } while (dst < stop);
+            } else if (dist == 1) {
+                memset(out, *src, len);
+            } else {
+                for (uint32_t i = 0; i < len; ++i) out[i] = src[i];
+            }
+            out += len;
+        }
+
+        this->bits = bits;
+        this->count = count;
+        this->out = out;
+        return ret && valid();
+    }
+
+    bool run(const uint8_t* data, uint32_t size, uint8_t* dst, size_t dstSize)
+    {
+        in = data;
+        end = data + size;
+        begin = out = dst;
+        last = dst + dstSize;
+
+        //zlib header: deflate with the window up to 32K and no preset dictionary
+        if (size < 2) return false;
+        if ((in[0] & 0x0f) != 8 || (in[0] >> 4) > 7 || (in[1] & 0x20) || ((in[0] << 8) | in[1]) % 31) return false;
+        in += 2;
+
+        //the adler-32 checksum is not verified, the image data is verified by its size
+        uint32_t final;
+        do {
+            refill();
+            final = take(1);
+            auto type = take(2);
+            if (type == 0) {
+                if (!stored()) return false;
+            } else if (type == 1) {
+                if (!fixed() || !block()) return false;
+            } else if (type == 2) {
+                if (!dynamic() || !block()) return false;
+            } else return false;
+        } while (!final);
+
+        return out == last;
+    }
+};
+
+
+static uint32_t _be32(const uint8_t* p)
+{
+    return (uint32_t(p[0]) << 24) | (uint32_t(p[1]) << 16) | (uint32_t(p[2]) << 8) | p[3];
+}
+
+
+static uint8_t _predict(uint8_t a, uint8_t b, uint8_t c)
+{
+    auto p = int32_t(a) + b - c;
+    auto pa = abs(p - a);
+    auto pb = abs(p - b);
+    auto pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+
+//round(c * a / 255)
+static inline uint32_t _premultiply(uint32_t c, uint32_t a)
+{
+    auto t = c * a + 128;
+    return (t + (t >> 8)) >> 8;
+}
+
+
+static inline uint32_t _pixel(uint32_t r, uint32_t g, uint32_t b, uint32_t a, bool abgr)
+{
+    if (a < 255) {
+        r = _premultiply(r, a);
+        g = _premultiply(g, a);
+        b = _premultiply(b, a);
+    }
+    if (abgr) return (a << 24) | (b << 16) | (g << 8) | r;
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+
+#if defined(PNGD_SSE2) || defined(PNGD_NEON)
+
+//the filters of 3 or 4 bytes per pixel are applied a pixel at a time, the previous pixel is kept in a register
+#ifdef PNGD_SSE2
+
+static inline __m128i _load(const uint8_t* p, uint32_t bpp)
+{
+    uint32_t v = 0;
+    memcpy(&v, p, bpp);
+    return _mm_cvtsi32_si128(int32_t(v));
+}
+
+
+static inline void _store(uint8_t* p, __m128i v, uint32_t bpp)
+{
+    auto u = uint32_t(_mm_cvtsi128_si32(v));
+    memcpy(p, &u, bpp);
+}
+
+
+static void _sub(uint8_t* row, uint32_t size, uint32_t bpp)
+{
+    auto a = _mm_setzero_si128();
+    for (uint32_t i = 0; i < size; i += bpp) {
+        a = _mm_add_epi8(a, _load(row + i, bpp));
+        _store(row + i, a, bpp);
+    }
+}
+
+
+static void _avg(uint8_t* row, const uint8_t* prev, uint32_t size, uint32_t bpp)
+{
+    auto a = _mm_setzero_si128();
+    auto one = _mm_set1_epi8(1);
+    for (uint32_t i = 0; i < size; i += bpp) {
+        auto b = _load(prev + i, bpp);
+        //the rounding of pavgb is taken back to floor((a + b) / 2)
+        auto avg = _mm_sub_epi8(_mm_avg_epu8(a, b), _mm_and_si128(_mm_xor_si128(a, b), one));
+        a = _mm_add_epi8(avg, _load(row + i, bpp));
+        _store(row + i, a, bpp);
+    }
+}
+
+
+static inline __m128i _abs16(__m128i x)
+{
+    auto neg = _mm_cmplt_epi16(x, _mm_setzero_si128());
+    return _mm_add_epi16(_mm_xor_si128(x, neg), _mm_srli_epi16(neg, 15));
+}
+
+
+static inline __m128i _select(__m128i mask, __m128i t, __m128i e)
+{
+    return _mm_or_si128(_mm_and_si128(mask, t), _mm_andnot_si128(mask, e));
+}
+
+
+static void _paeth(uint8_t* row, const uint8_t* prev, uint32_t size, uint32_t bpp)
+{
+    auto zero = _mm_setzero_si128();
+    auto a = zero, c = zero;
+    for (uint32_t i = 0; i < size; i += bpp) {
+        auto b = _mm_unpacklo_epi8(_load(prev + i, bpp), zero);
+        auto pa = _mm_sub_epi16(b, c);
+        auto pb = _mm_sub_epi16(a, c);
+        auto pc = _abs16(_mm_add_epi16(pa, pb));
+        pa = _abs16(pa);
+        pb = _abs16(pb);
+        auto smallest = _mm_min_epi16(pc, _mm_min_epi16(pa, pb));
+        auto nearest = _select(_mm_cmpeq_epi16(pa, smallest), a, _select(_mm_cmpeq_epi16(pb, smallest), b, c));
+        //the high bytes stay zero by the byte-wise addition
+        a = _mm_add_epi8(nearest, _mm_unpacklo_epi8(_load(row + i, bpp), zero));
+        _store(row + i, _mm_packus_epi16(a, a), bpp);
+        c = b;
+    }
+}
+
+
+static void _up(uint8_t* row, const uint8_t* prev, uint32_t size)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        auto v = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(row + i)), _mm_loadu_si128((const __m128i*)(prev + i)));
+        _mm_storeu_si128((__m128i*)(row + i), v);
+    }
+    for (; i < size; ++i) row[i] += prev[i];
+}
+
+#else
+
+static inline uint8x8_t _load(const uint8_t* p, uint32_t bpp)
+{
+    uint32_t v = 0;
+    memcpy(&v, p, bpp);
+    return vreinterpret_u8_u32(vdup_n_u32(v));
+}
+
+
+static inline void _store(uint8_t* p, uint8x8_t v, uint32_t bpp)
+{
+    auto u = vget_lane_u32(vreinterpret_u32_u8(v), 0);
+    memcpy(p, &u, bpp);
+}
+
+
+static void _sub(uint8_t* row, uint32_t size, uint32_t bpp)
+{
+    auto a = vdup_n_u8(0);
+    for (uint32_t i = 0; i < size; i += bpp) {
+        a = vadd_u8(a, _load(row + i, bpp));
+        _store(row + i, a, bpp);
+    }
+}
+
+
+static void _avg(uint8_t* row, const uint8_t* prev, uint32_t size, uint32_t bpp)
+{
+    auto a = vdup_n_u8(0);
+    for (uint32_t i = 0; i < size; i += bpp) {
+        a = vadd_u8(vhadd_u8(a, _load(prev + i, bpp)), _load(row + i, bpp));
+        _store(row + i, a, bpp);
+    }
+}
+
+
+static void _paeth(uint8_t* row, const uint8_t* prev, uint32_t size, uint32_t bpp)
+{
+    auto a = vdup_n_u8(0), c = vdup_n_u8(0);
+    for (uint32_t i = 0; i < size; i += bpp) {
+        auto b = _load(prev + i, bpp);
+        auto pa = vabdl_u8(b, c);
+        auto pb = vabdl_u8(a, c);
+        auto pc = vabdq_u16(vaddl_u8(a, b), vaddl_u8(c, c));
+        auto useA = vmovn_u16(vandq_u16(vcleq_u16(pa, pb), vcleq_u16(pa, pc)));
+        auto useB = vmovn_u16(vcleq_u16(pb, pc));
+        auto nearest = vbsl_u8(useA, a, vbsl_u8(useB, b, c));
+        a = vadd_u8(nearest, _load(row + i, bpp));
+        _store(row + i, a, bpp);
+        c = b;
+    }
+}
+
+
+static void _up(uint8_t* row, const uint8_t* prev, uint32_t size)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= size; i += 16) {
+        vst1q_u8(row + i, vaddq_u8(vld1q_u8(row + i), vld1q_u8(prev + i)));
+    }
+    for (; i < size; ++i) row[i] += prev[i];
+}
+
+#endif
+
+#endif
+
+
+//reverses the filter of a row in place, prev is the unfiltered row above
+static bool _unfilter(uint8_t filter, uint8_t* row, const uint8_t* prev, uint32_t size, uint32_t bpp)
+{
+    switch (filter) {
+        case 0: break;
+        case 1: {
+#if defined(PNGD_SSE2) || defined(PNGD_NEON)
+            if (bpp == 3 || bpp == 4) {
+                _sub(row, size, bpp);
+                break;
+            }
+#endif
+            for (auto i = bpp; i < size; ++i) row[i] += row[i - bpp];
+            break;
+        }
+        case 2: {
+#if defined(PNGD_SSE2) || defined(PNGD_NEON)
+            _up(row, prev, size);
+#else
+            for (uint32_t i = 0; i < size; ++i) row[i] += prev[i];
+#endif
+            break;
+        }
+        case 3: {
+#if defined(PNGD_SSE2) || defined(PNGD_NEON)
+            if (bpp == 3 || bpp == 4) {
+                _avg(row, prev, size, bpp);
+                break;
+            }
+#endif
+            for (uint32_t i = 0; i < bpp; ++i) row[i] += prev[i] >> 1;
+            for (auto i = bpp; i < size; ++i) row[i] += (uint32_t(row[i - bpp]) + prev[i]) >> 1;
+            break;
+        }
+        case 4: {
+#if defined(PNGD_SSE2) || defined(PNGD_NEON)
+            if (bpp == 3 || bpp == 4) {
+                _paeth(row, prev, size, bpp);
+                break;
+            }
+#endif
+            for (uint32_t i = 0; i < bpp; ++i) row[i] += prev[i];
+            for (auto i = bpp; i < size; ++i) row[i] += _predict(row[i - bpp], prev[i], prev[i - bpp]);
+            break;
+        }
+        default: return false;
+    }
+    return true;
+}
+
+
+//the rgba samples of 8 bits, the most common one
+static void _rgba(const uint8_t* row, uint32_t* dst, uint32_t w, bool abgr)
+{
+    uint32_t x = 0;
+#if defined(PNGD_SSE2)
+    auto zero = _mm_setzero_si128();
+    auto half = _mm_set1_epi16(128);
+    auto alpha = _mm_set_epi16(-1, 0, 0, 0, -1, 0, 0, 0);
+    for (; x + 4 <= w; x += 4) {
+        auto v = _mm_loadu_si128((const __m128i*)(row + x * 4));
+        __m128i halves[2] = {_mm_unpacklo_epi8(v, zero), _mm_unpackhi_epi8(v, zero)};
+        for (auto& c : halves) {
+            auto a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+            auto t = _mm_add_epi16(_mm_mullo_epi16(c, a), half);
+            t = _mm_srli_epi16(_mm_add_epi16(t, _mm_srli_epi16(t, 8)), 8);
+            c = _select(alpha, c, t);
+            if (!abgr) c = _mm_shufflehi_epi16(_mm_shufflelo_epi16(c, _MM_SHUFFLE(3, 0, 1, 2)), _MM_SHUFFLE(3, 0, 1, 2));
+        }
+        _mm_storeu_si128((__m128i*)(dst + x), _mm_packus_epi16(halves[0], halves[1]));
+    }
+#elif defined(PNGD_NEON)
+    for (; x + 8 <= w; x += 8) {
+        auto v = vld4_u8(row + x * 4);
+        //(t + ((t + 128) >> 8) + 128) >> 8, that is round(c * a / 255)
+        uint8x8x4_t o;
+        auto r = vmull_u8(v.val[0], v.val[3]);
+        auto g = vmull_u8(v.val[1], v.val[3]);
+        auto b = vmull_u8(v.val[2], v.val[3]);
+        o.val[abgr ? 0 : 2] = vraddhn_u16(r, vrshrq_n_u16(r, 8));
+        o.val[1] = vraddhn_u16(g, vrshrq_n_u16(g, 8));
+        o.val[abgr ? 2 : 0] = vraddhn_u16(b, vrshrq_n_u16(b, 8));
+        o.val[3] = v.val[3];
+        vst4_u8(reinterpret_cast<uint8_t*>(dst + x), o);
+    }
+#endif
+    for (auto p = row + x * 4; x < w; ++x, p += 4) {
+        dst[x] = _pixel(p[0], p[1], p[2], p[3], abgr);
+    }
+}
+
+
+//converts the unfiltered row of w pixels, the samples of 16 bits are reduced to their high bytes
+static void _convert(const png_decoder* d, const uint8_t* row, uint32_t* dst, uint32_t w, const uint32_t* lut, bool abgr)
+{
+    auto step = d->depth >> 3;      //the bytes of a sample
+    switch (d->type) {
+        case 6: {
+            if (step == 1) _rgba(row, dst, w, abgr);
+            else {
+                for (uint32_t x = 0; x < w; ++x, row += 8) dst[x] = _pixel(row[0], row[2], row[4], row[6], abgr);
+            }
+            break;
+        }
+        case 2: {
+            for (uint32_t x = 0; x < w; ++x, row += step * 3) {
+                if (d->keyed) {
+                    uint32_t r = row[0], g = row[step], b = row[step * 2];
+                    if (step == 2) {
+                        r = (r << 8) | row[1];
+                        g = (g << 8) | row[3];
+                        b = (b << 8) | row[5];
+                    }
+                    if (r == d->key[0] && g == d->key[1] && b == d->key[2]) {
+                        dst[x] = 0;
+                        continue;
+                    }
+                }
+                dst[x] = _pixel(row[0], row[step], row[step * 2], 255, abgr);
+            }
+            break;
+        }
+        case 4: {
+            for (uint32_t x = 0; x < w; ++x, row += step * 2) dst[x] = _pixel(row[0], row[0], row[0], row[step], abgr);
+            break;
+        }
+        case 0: {
+            if (d->depth == 16) {
+                for (uint32_t x = 0; x < w; ++x, row += 2) {
+                    if (d->keyed && ((uint32_t(row[0]) << 8) | row[1]) == d->key[0]) dst[x] = 0;
+                    else dst[x] = _pixel(row[0], row[0], row[0], 255, abgr);
+                }
+                break;
+            }
+            //the gray samples up to 8 bits are looked up like the palette indices
+            TVG_FALLTHROUGH
+        }
+        case 3: {
+            if (d->depth == 8) {
+                for (uint32_t x = 0; x < w; ++x) dst[x] = lut[row[x]];
+            } else {
+                auto depth = d->depth;
+                auto mask = (1 << depth) - 1;
+                for (uint32_t x = 0; x < w; ++x) {
+                    auto bit = x * depth;
+                    dst[x] = lut[(row[bit >> 3] >> (8 - depth - (bit & 7))) & mask];
+                }
+            }
+            break;
+        }
+    }
+}
+
+
+static uint32_t _channels(uint8_t type)
+{
+    static constexpr uint8_t CHANNELS[7] = {1, 0, 3, 1, 2, 0, 4};
+    return CHANNELS[type];
+}
+
+
+static size_t _rowSize(const png_decoder* d, uint32_t w)
+{
+    return (size_t(w) * _channels(d->type) * d->depth + 7) / 8;
+}
+
+
+static bool _valid(uint8_t type, uint8_t depth)
+{
+    switch (type) {
+        case 0: return depth == 1 || depth == 2 || depth == 4 || depth == 8 || depth == 16;
+        case 3: return depth == 1 || depth == 2 || depth == 4 || depth == 8;
+        case 2:
+        case 4:
+        case 6: return depth == 8 || depth == 16;
+    }
+    return false;
+}
+
+
+//decodes the image of the size w x h from the zlib stream of the chunks
+static bool _decompress(const png_decoder* d, const PngChunk* chunks, uint32_t count, uint32_t w, uint32_t h, uint32_t* dst, uint32_t stride, bool abgr)
+{
+    static constexpr uint8_t XS[7] = {0, 4, 0, 2, 0, 1, 0};
+    static constexpr uint8_t YS[7] = {0, 0, 4, 0, 2, 0, 1};
+    static constexpr uint8_t DX[7] = {8, 8, 4, 4, 2, 2, 1};
+    static constexpr uint8_t DY[7] = {8, 8, 8, 4, 4, 2, 2};
+
+    if (count == 0) return false;
+
+    //the sub images of the passes, the whole image without the interlace
+    uint32_t pw[7], ph[7];
+    auto passes = d->interlace ? 7 : 1;
+    size_t total = 0;
+    for (int i = 0; i < passes; ++i) {
+        if (d->interlace) {
+            pw[i] = w > XS[i] ? (w - XS[i] + DX[i] - 1) / DX[i] : 0;
+            ph[i] = h > YS[i] ? (h - YS[i] + DY[i] - 1) / DY[i] : 0;
+        } else {
+            pw[i] = w;
+            ph[i] = h;
+        }
+        if (pw[i] && ph[i]) total += (_rowSize(d, pw[i]) + 1) * ph[i];
+    }
+
+    //the image data of several chunks is joined into a stream
+    auto in = chunks[0].data;
+    auto inSize = chunks[0].size;
+    uint8_t* joined = nullptr;
+    if (count > 1) {
+        size_t sum = 0;
+        for (auto chunk = chunks; chunk < chunks + count; ++chunk) sum += chunk->size;
+        if (sum > UINT32_MAX) return false;
+        joined = static_cast<uint8_t*>(malloc(sum));
+        if (!joined) return false;
+        inSize = 0;
+        for (auto chunk = chunks; chunk < chunks + count; ++chunk) {
+            memcpy(joined + inSize, chunk->data, chunk->size);
+            inSize += chunk->size;
+        }
+        in = joined;
+    }
+
+    //the match copies may run over the end by 16 bytes
+    auto buffer = static_cast<uint8_t*>(malloc(total + 16));
+    auto inflater = static_cast<Inflater*>(malloc(sizeof(Inflater)));
+    auto ret = buffer && inflater;
+    if (ret) {
+        new (inflater) Inflater;
+        ret = inflater->run(in, inSize, buffer, total);
+    }
+    free(inflater);
+    free(joined);
+    if (!ret) {
+        free(buffer);
+        return false;
+    }
+
+    //the palette and the gray samples up to 8 bits
+    uint32_t lut[256];
+    if (d->type == 3) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            if (i < d->paletteSize) lut[i] = _pixel(d->palette[i][0], d->palette[i][1], d->palette[i][2], d->palette[i][3], abgr);
+            else lut[i] = _pixel(0, 0, 0, 255, abgr);
+        }
+    } else if (d->type == 0 && d->depth <= 8) {
+        auto max = (1u << d->depth) - 1;
+        for (uint32_t i = 0; i <= max; ++i) {
+            auto v = i * 255 / max;
+            lut[i] = (d->keyed && i == d->key[0]) ? 0 : _pixel(v, v, v, 255, abgr);
+        }
+    }
+
+    auto bpp = std::max(uint32_t(1), _channels(d->type) * d->depth / 8);
+    auto row = buffer;
+    uint8_t* zero = nullptr;
+    uint32_t* line = nullptr;
+
+    for (int i = 0; i < passes && ret; ++i) {
+        if (pw[i] == 0 || ph[i] == 0) continue;
+        auto size = uint32_t(_rowSize(d, pw[i]));
+        //the first row refers to the zero row above
+        zero = static_cast<uint8_t*>(realloc(zero, size));
+        memset(zero, 0, size);
+        if (d->interlace && !line) line = static_cast<uint32_t*>(malloc(w * sizeof(uint32_t)));
+        const uint8_t* prev = zero;
+        for (uint32_t y = 0; y < ph[i]; ++y) {
+            if (!_unfilter(row[0], row + 1, prev, size, bpp)) {
+                ret = false;
+                break;
+            }
+            if (!d->interlace) {
+                _convert(d, row + 1, dst + y * size_t(stride), pw[i], lut, abgr);
+            } else {
+                _convert(d, row + 1, line, pw[i], lut, abgr);
+                auto out = dst + (YS[i] + y * DY[i]) * size_t(stride) + XS[i];
+                for (uint32_t x = 0; x < pw[i]; ++x) out[x * DX[i]] = line[x];
+            }
+            prev = row + 1;
+            row += size + 1;
+        }
+    }
+
+    free(line);
+    free(zero);
+    free(buffer);
+    return ret;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+png_decoder* pngdHeader(const char* data, uint32_t size, uint32_t* width, uint32_t* height)
+{
+    static constexpr uint8_t SIGNATURE[8] = {137, 80, 78, 71, 13, 10, 26, 10};
+
+    auto p = reinterpret_cast<const uint8_t*>(data);
+    auto end = p + size;
+    if (size < 8 + 25 || memcmp(p, SIGNATURE, 8)) return nullptr;
+    p += 8;
+
+    //the chunk crcs are not verified
+    if (_be32(p) != 13 || memcmp(p + 4, "IHDR", 4)) return nullptr;
+    auto d = new png_decoder;
+    d->w = _be32(p + 8);
+    d->h = _be32(p + 12);
+    d->depth = p[16];
+    d->type = p[17];
+    d->interlace = p[20];
+    p += 25;
+
+    if (d->w == 0 || d->h == 0 || d->w > (1 << 28) / d->h || !_valid(d->type, d->depth) || p[-7] != 0 || p[-6] != 0 || d->interlace > 1) {
+        delete(d);
+        return nullptr;
+    }
+
+    while (end - p >= 12) {
+        auto len = _be32(p);
+        auto type = p + 4;
+        auto chunk = p + 8;
+        if (len > uint32_t(end - chunk) - 4) break;
+        p = chunk + len + 4;
+
+        if (!memcmp(type, "IDAT", 4)) {
+            d->idat.push({chunk, len});
+            //the image data is the first frame after its frame control
+            if (d->frames.count == 1 && d->idat.count == 1) d->frames.last().idat = true;
+        } else if (!memcmp(type, "acTL", 4)) {
+            d->animated = (d->idat.count == 0);
+        } else if (!memcmp(type, "fcTL", 4)) {
+            if (len < 26) break;
+            PngFrame frame;
+            frame.info.w = _be32(chunk + 4);
+            frame.info.h = _be32(chunk + 8);
+            frame.info.x = _be32(chunk + 12);
+            frame.info.y = _be32(chunk + 16);
+            //the delay is a fraction of seconds, the denominator zero means 1/100
+            uint32_t num = (chunk[20] << 8) | chunk[21];
+            uint32_t den = (chunk[22] << 8) | chunk[23];
+            frame.info.delay = den ? (num * 100 + den / 2) / den : num;
+            frame.info.dispose = chunk[24] <= 2 ? chunk[24] : 0;
+            frame.info.blend = (chunk[25] == 1);
+            frame.first = d->fdat.count;
+            frame.count = 0;
+            frame.idat = false;
+            //the frames must be in the image, the animation stops at a broken one
+            if (frame.info.w == 0 || frame.info.h == 0 || frame.info.x > d->w || frame.info.w > d->w - frame.info.x ||
+                frame.info.y > d->h || frame.info.h > d->h - frame.info.y) {
+                d->animated = false;
+            }
+            d->frames.push(frame);
+        } else if (!memcmp(type, "fdAT", 4)) {
+            //skips the sequence number
+            if (len > 4 && d->frames.count > 0 && !d->frames.last().idat) {
+                d->fdat.push({chunk + 4, len - 4});
+                ++d->frames.last().count;
+            }
+        } else if (!memcmp(type, "PLTE", 4)) {
+            if (len % 3 || len > 768) break;
+            d->paletteSize = len / 3;
+            for (uint32_t i = 0; i < d->paletteSize; ++i) {
+                d->palette[i][0] = chunk[i * 3];
+                d->palette[i][1] = chunk[i * 3 + 1];
+                d->palette[i][2] = chunk[i * 3 + 2];
+                d->palette[i][3] = 255;
+            }
+        } else if (!memcmp(type, "tRNS", 4)) {
+            if (d->type == 3) {
+                for (uint32_t i = 0; i < len && i < 256; ++i) d->palette[i][3] = chunk[i];
+            } else if (d->type == 0 && len >= 2) {
+                d->key[0] = (chunk[0] << 8) | chunk[1];
+                d->keyed = true;
+            } else if (d->type == 2 && len >= 6) {
+                for (int i = 0; i < 3; ++i) d->key[i] = (chunk[i * 2] << 8) | chunk[i * 2 + 1];
+                d->keyed = true;
+            }
+        } else if (!memcmp(type, "IEND", 4)) {
+            break;
+        } else if (!(type[0] & 0x20) && d->idat.count == 0) {
+            //an unknown critical chunk before the image data
+            break;
+        }
+    }
+
+    if (d->idat.count == 0 || (d->type == 3 && d->paletteSize == 0)) {
+        delete(d);
+        return nullptr;
+    }
+
+    //shown as a still image without any frames of the data
+    for (auto frame = d->frames.begin(); frame < d->frames.end(); ++frame) {
+        if (!frame->idat && frame->count == 0) d->animated = false;
+        if (frame->idat && (frame->info.w != d->w || frame->info.h != d->h)) d->animated = false;
+    }
+    if (d->frames.count == 0) d->animated = false;
+
+    *width = d->w;
+    *height = d->h;
+    return d;
+}
+
+
+bool pngdDecompress(png_decoder* d, uint32_t* dst, uint32_t stride, bool abgr)
+{
+    if (!d || !dst || stride < d->w) return false;
+    return _decompress(d, d->idat.data, d->idat.count, d->w, d->h, dst, stride, abgr);
+}
+
+
+uint32_t pngdFrames(const png_decoder* d)
+{
+    if (!d || !d->animated) return 0;
+    return d->frames.count;
+}
+
+
+const png_frame* pngdFrame(const png_decoder* d, uint32_t index)
+{
+    if (index >= pngdFrames(d)) return nullptr;
+    return &d->frames[index].info;
+}
+
+
+bool pngdDecompress(png_decoder* d, uint32_t index, uint32_t* dst, uint32_t stride, bool abgr)
+{
+    if (!dst || index >= pngdFrames(d)) return false;
+
+    auto& frame = d->frames[index];
+    if (stride < frame.info.w) return false;
+    if (frame.idat) return _decompress(d, d->idat.data, d->idat.count, frame.info.w, frame.info.h, dst, stride, abgr);
+    return _decompress(d, d->fdat.data + frame.first, frame.count, frame.info.w, frame.info.h, dst, stride, abgr);
+}
+
+
+void pngdDelete(png_decoder* decoder)
+{
+    delete(decoder);
+}
@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _TVG_PNGD_H_
+#define _TVG_PNGD_H_
+
+#include <cstdint>
+
+struct png_decoder;
+
+struct png_frame
+{
+    uint32_t x, y, w, h;                    //the area on the image
+    uint32_t delay;                         //in 1/100 seconds
+    uint8_t dispose;                        //0: none, 1: to the background, 2: to the previous
+    bool blend;                             //over the image, otherwise replaces the area
+};
+
+//reads the chunks up to the image data, the data must stay valid until the decoder is deleted.
+png_decoder* pngdHeader(const char* data, uint32_t size, uint32_t* width, uint32_t* height);
+//decodes the alpha-premultiplied pixels in the ABGR8888 or ARGB8888 order
+bool pngdDecompress(png_decoder* decoder, uint32_t* dst, uint32_t stride, bool abgr);
+//the frames of an animated png (APNG), zero for a still image
+uint32_t pngdFrames(const png_decoder* decoder);
+const png_frame* pngdFrame(const png_decoder* decoder, uint32_t index);
+//decodes the area of the frame like pngdDecompress()
+bool pngdDecompress(png_decoder* decoder, uint32_t index, uint32_t* dst, uint32_t stride, bool abgr);
+void pngdDelete(png_decoder* decoder);
+
+#endif //_TVG_PNGD_H_
@@ -45,30 +45,42 @@ RawLoader::~RawLoader()
 }
 
 
-bool RawLoader::open(const uint32_t* data, uint32_t w, uint32_t h, bool copy)
+//it's called again with the next frame of the picture, see Picture::load()
+bool RawLoader::open(const uint32_t* data, uint32_t w, uint32_t h, uint32_t stride, ColorSpace cs, bool copy)
 {
-    if (!LoadModule::read()) return true;
+    LoadModule::read();
+
+    if (!data || w == 0 || h == 0 || stride < w) return false;
 
-    if (!data || w == 0 || h == 0) return false;
+    if (this->copy) free(surface.buf32);
+    surface.buf32 = nullptr;
 
     this->w = (float)w;
     this->h = (float)h;
     this->copy = copy;
 
+    //the rows are packed in the copy, the original is used as it is without any modification
     if (copy) {
         surface.buf32 = (uint32_t*)malloc(sizeof(uint32_t) * w * h);
-        if (!surface.buf32) return false;
-        memcpy((void*)surface.buf32, data, sizeof(uint32_t) * w * h);
+        if (!surface.buf32) {
+            this->copy = false;
+            return false;
+        }
+        for (uint32_t y = 0; y < h; ++y) {
+            memcpy(surface.buf32 + y * w, data + y * stride, sizeof(uint32_t) * w);
+        }
+        stride = w;
     }
     else surface.buf32 = const_cast<uint32_t*>(data);
 
     //setup the surface
-    surface.stride = w;
+    surface.stride = stride;
     surface.w = w;
     surface.h = h;
-    surface.cs = ColorSpace::ARGB8888;
+    surface.cs = cs;
     surface.channelSize = sizeof(uint32_t);
-    surface.premultiplied = true;
+    surface.premultiplied = (cs == ColorSpace::ABGR8888 || cs == ColorSpace::ARGB8888);
+    surface.readonly = !copy;
 
     return true;
 }
@@ -22,6 +22,7 @@
 
 #include "tvgSvgCssStyle.h"
 
+#include <cctype>
 #include <cstring>
 
 /************************************************************************/
@@ -71,10 +72,9 @@ static void _copyStyle(SvgStyleProperty* to, const SvgStyleProperty* from)
         to->fill.paint.color = from->fill.paint.color;
         to->fill.paint.none = from->fill.paint.none;
         to->fill.paint.curColor = from->fill.paint.curColor;
-        if (from->fill.paint.url) {
-            if (to->fill.paint.url) free(to->fill.paint.url);
-            to->fill.paint.url = strdup(from->fill.paint.url);
-        }
+        //the paint of the node attribute is replaced as a whole
+        free(to->fill.paint.url);
+        to->fill.paint.url = from->fill.paint.url ? strdup(from->fill.paint.url) : nullptr;
         to->fill.flags = (to->fill.flags | SvgFillFlags::Paint);
         to->flags = (to->flags | SvgStyleFlags::Fill);
         if (from->flagsImportance & SvgStyleFlags::Fill) {
@@ -105,10 +105,9 @@ static void _copyStyle(SvgStyleProperty* to, const SvgStyleProperty* from)
         to->stroke.paint.color = from->stroke.paint.color;
         to->stroke.paint.none = from->stroke.paint.none;
         to->stroke.paint.curColor = from->stroke.paint.curColor;
-        if (from->stroke.paint.url) {
-            if (to->stroke.paint.url) free(to->stroke.paint.url);
-            to->stroke.paint.url = strdup(from->stroke.paint.url);
-        }
+        //the paint of the node attribute is replaced as a whole
+        free(to->stroke.paint.url);
+        to->stroke.paint.url = from->stroke.paint.url ? strdup(from->stroke.paint.url) : nullptr;
         to->stroke.flags = (to->stroke.flags | SvgStrokeFlags::Paint);
         to->flags = (to->flags | SvgStyleFlags::Stroke);
         if (from->flagsImportance & SvgStyleFlags::Stroke) {
@@ -179,6 +178,68 @@ static void _copyStyle(SvgStyleProperty* to, const SvgStyleProperty* from)
 }
 
 
+//the selectors of more ids, classes and types in order, and the later rule of the same ones wins.
+static uint32_t _priority(uint32_t specificity, uint32_t order)
+{
+    return (specificity << 28) | (order & 0x0fffffff);
+}
+
+
+static uint32_t _hash(const char* str, size_t len)
+{
+    uint32_t hash = 5381;
+    for (size_t i = 0; i < len; ++i) {
+        hash = ((hash << 5) + hash) + (unsigned char)str[i];
+    }
+    return hash;
+}
+
+
+//the class or the id (without the leading '#') selected by the rule
+static const char* _ruleName(const SvgNode* rule)
+{
+    return (rule->id[0] == '#') ? rule->id + 1 : rule->id;
+}
+
+
+static void _indexName(SvgCssIndex& index, const SvgCssIndex::Rule& rule)
+{
+    index.names.push(rule);
+
+    //keep the load factor under 1/2, rehash the rules in the document order
+    auto from = index.names.count - 1;
+    if (index.names.count * 2 > index.size) {
+        index.size = index.size ? index.size * 2 : 64;
+        free(index.slots);
+        index.slots = (uint32_t*)calloc(index.size, sizeof(uint32_t));
+        from = 0;
+    }
+
+    auto mask = index.size - 1;
+    for (auto i = from; i < index.names.count; ++i) {
+        auto name = _ruleName(index.names[i].node);
+        auto slot = _hash(name, strlen(name)) & mask;
+        while (index.slots[slot]) slot = (slot + 1) & mask;
+        index.slots[slot] = i + 1;
+    }
+}
+
+
+static void _matchNames(SvgCssIndex& index, const SvgNode* node, const char* name, size_t len, bool id)
+{
+    if (index.size == 0) return;
+
+    auto mask = index.size - 1;
+    for (auto slot = _hash(name, len) & mask; index.slots[slot]; slot = (slot + 1) & mask) {
+        auto& rule = index.names[index.slots[slot] - 1];
+        if ((rule.node->id[0] == '#') != id) continue;
+        if (rule.node->type != SvgNodeType::CssStyle && rule.node->type != node->type) continue;
+        auto ruleName = _ruleName(rule.node);
+        if (!strncmp(ruleName, name, len) && !ruleName[len]) index.matched.push(rule);
+    }
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -187,7 +248,7 @@ void cssCopyStyleAttr(SvgNode* to, const SvgNode* from)
 {
     //Copy matrix attribute
     if (from->transform && !(to->style->flags & SvgStyleFlags::Transform)) {
-        to->transform = (Matrix*)malloc(sizeof(Matrix));
+        if (!to->transform) to->transform = (Matrix*)malloc(sizeof(Matrix));
         if (to->transform) {
             *to->transform = *from->transform;
             to->style->flags = (to->style->flags | SvgStyleFlags::Transform);
@@ -207,59 +268,71 @@ void cssCopyStyleAttr(SvgNode* to, const SvgNode* from)
 }
 
 
-SvgNode* cssFindStyleNode(const SvgNode* style, const char* title, SvgNodeType type)
+void cssIndexStyle(SvgCssIndex& index, const SvgNode* style)
 {
-    if (!style) return nullptr;
+    if (!style) return;
 
-    auto child = style->child.data;
-    for (uint32_t i = 0; i < style->child.count; ++i, ++child) {
-        if ((*child)->type == type) {
-            if ((!title && !(*child)->id) || (title && (*child)->id && !strcmp((*child)->id, title))) return (*child);
+    for (auto i = index.count; i < style->child.count; ++i) {
+        auto node = style->child[i];
+        auto typed = (node->type != SvgNodeType::CssStyle) ? 1 : 0;
+        if (node->id) {
+            auto specificity = (node->id[0] == '#') ? 4 : 2;
+            _indexName(index, {node, _priority(specificity + typed, i)});
+        } else if (typed && node->type != SvgNodeType::Unknown) {
+            index.types[(int)node->type].push({node, _priority(1, i)});
         }
     }
-    return nullptr;
+    index.count = style->child.count;
 }
 
 
-SvgNode* cssFindStyleNode(const SvgNode* style, const char* title)
+void cssApplyStyle(SvgCssIndex& index, SvgNode* node)
 {
-    if (!style || !title) return nullptr;
+    if (index.count == 0 || node->type == SvgNodeType::Unknown) return;
 
-    auto child = style->child.data;
-    for (uint32_t i = 0; i < style->child.count; ++i, ++child) {
-        if ((*child)->type == SvgNodeType::CssStyle) {
-            if ((*child)->id && !strcmp((*child)->id, title)) return (*child);
-        }
+    auto& matched = index.matched;
+    matched.clear();
+
+    auto& types = index.types[(int)node->type];
+    for (auto rule = types.begin(); rule < types.end(); ++rule) {
+        matched.push(*rule);
     }
-    return nullptr;
-}
+    if (node->id) _matchNames(index, node, node->id, strlen(node->id), true);
 
+    //the class attribute is a list of the class names separated by white spaces
+    if (auto name = node->style->cssClass) {
+        while (*name) {
+            while (*name && isspace((unsigned char)*name)) ++name;
+            auto end = name;
+            while (*end && !isspace((unsigned char)*end)) ++end;
+            if (end > name) _matchNames(index, node, name, end - name, false);
+            name = end;
+        }
+    }
 
-void cssUpdateStyle(SvgNode* doc, SvgNode* style)
-{
-    if (doc->child.count > 0) {
-        auto child = doc->child.data;
-        for (uint32_t i = 0; i < doc->child.count; ++i, ++child) {
-            if (auto cssNode = cssFindStyleNode(style, nullptr, (*child)->type)) {
-                cssCopyStyleAttr(*child, cssNode);
-            }
-            cssUpdateStyle(*child, style);
+    //the rules are applied from the most specific one, and the later one of the same specificity,
+    //the properties set by a rule are not overridden by the following rules unless they're important.
+    for (uint32_t i = 1; i < matched.count; ++i) {
+        auto rule = matched[i];
+        auto j = i;
+        for (; j > 0 && matched[j - 1].priority < rule.priority; --j) {
+            matched[j] = matched[j - 1];
         }
+        matched[j] = rule;
+    }
+
+    for (auto rule = matched.begin(); rule < matched.end(); ++rule) {
+        cssCopyStyleAttr(node, rule->node);
     }
 }
 
 
-void cssApplyStyleToPostponeds(Array<SvgNodeIdPair>& postponeds, SvgNode* style)
+void cssUpdateStyle(SvgCssIndex& index, SvgNode* node)
 {
-    for (uint32_t i = 0; i < postponeds.count; ++i) {
-        auto nodeIdPair = postponeds[i];
+    cssApplyStyle(index, node);
 
-        //css styling: tag.name has higher priority than .name
-        if (auto cssNode = cssFindStyleNode(style, nodeIdPair.id, nodeIdPair.node->type)) {
-            cssCopyStyleAttr(nodeIdPair.node, cssNode);
-        }
-        if (auto cssNode = cssFindStyleNode(style, nodeIdPair.id)) {
-            cssCopyStyleAttr(nodeIdPair.node, cssNode);
-        }
+    auto child = node->child.data;
+    for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
+        cssUpdateStyle(index, *child);
     }
 }
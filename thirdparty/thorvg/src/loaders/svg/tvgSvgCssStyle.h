@@ -26,9 +26,8 @@
 #include "tvgSvgLoaderCommon.h"
 
 void cssCopyStyleAttr(SvgNode* to, const SvgNode* from);
-SvgNode* cssFindStyleNode(const SvgNode* style, const char* title, SvgNodeType type);
-SvgNode* cssFindStyleNode(const SvgNode* style, const char* title);
-void cssUpdateStyle(SvgNode* doc, SvgNode* style);
-void cssApplyStyleToPostponeds(Array<SvgNodeIdPair>& postponeds, SvgNode* style);
+void cssIndexStyle(SvgCssIndex& index, const SvgNode* style);
+void cssApplyStyle(SvgCssIndex& index, SvgNode* node);
+void cssUpdateStyle(SvgCssIndex& index, SvgNode* node);
 
 #endif //_TVG_SVG_CSS_STYLE_H_
@@ -49,14 +49,15 @@
 */
 
 #include <cstring>
-#include <fstream>
 #include <float.h>
 #include "tvgLoader.h"
 #include "tvgXmlParser.h"
 #include "tvgSvgLoader.h"
 #include "tvgSvgSceneBuilder.h"
 #include "tvgStr.h"
+#include "tvgCompressor.h"
 #include "tvgSvgCssStyle.h"
+#include "tvgSvgLookup.h"
 #include "tvgMath.h"
 
 /************************************************************************/
@@ -428,7 +429,7 @@ static unsigned char _parseColor(const char* value, char** end)
 
 static constexpr struct
 {
-    const char* name;
+    const char* tag;
     unsigned int value;
 } colors[] = {
     { "aliceblue", 0xfff0f8ff },
@@ -580,6 +581,17 @@ static constexpr struct
     { "yellowgreen", 0xff9acd32 }
 };
 
+static constexpr uint16_t colorSeeds[] = {
+    0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    2, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 1, 0,
+    0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 2, 1, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0, 2, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 0, 0, 0, 0,
+    1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 1, 0, 2, 0, 0, 1, 1, 0, 0, 0, 0, 0, 0,
+    1, 1, 3, 0, 0, 0, 0, 0, 0, 2, 0, 0, 2, 1, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0, 0, 0
+};
+SVG_LOOKUP_DEF(colorLookup, colors, colorSeeds);
+
 
 static bool _hslToRgb(float hue, float saturation, float brightness, uint8_t* red, uint8_t* green, uint8_t* blue)
 {
@@ -740,13 +752,11 @@ static bool _toColor(const char* str, uint8_t* r, uint8_t* g, uint8_t* b, char**
         }
     } else {
         //Handle named color
-        for (unsigned int i = 0; i < (sizeof(colors) / sizeof(colors[0])); i++) {
-            if (!strcasecmp(colors[i].name, str)) {
-                *r = (((uint8_t*)(&(colors[i].value)))[2]);
-                *g = (((uint8_t*)(&(colors[i].value)))[1]);
-                *b = (((uint8_t*)(&(colors[i].value)))[0]);
-                return true;
-            }
+        if (auto color = svgLookupNoCase(colors, colorLookup, str, strlen(str))) {
+            *r = (((uint8_t*)(&(color->value)))[2]);
+            *g = (((uint8_t*)(&(color->value)))[1]);
+            *b = (((uint8_t*)(&(color->value)))[0]);
+            return true;
         }
     }
     return false;
@@ -1175,26 +1185,13 @@ static void _handlePaintOrderAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* nod
 }
 
 
-static void _handleCssClassAttr(SvgLoaderData* loader, SvgNode* node, const char* value)
+//the style sheets are applied with the classes once the document is parsed
+static void _handleCssClassAttr(TVG_UNUSED SvgLoaderData* loader, SvgNode* node, const char* value)
 {
     auto cssClass = &node->style->cssClass;
 
     if (*cssClass && value) free(*cssClass);
     *cssClass = _copyId(value);
-
-    bool cssClassFound = false;
-
-    //css styling: tag.name has higher priority than .name
-    if (auto cssNode = cssFindStyleNode(loader->cssStyle, *cssClass, node->type)) {
-        cssClassFound = true;
-        cssCopyStyleAttr(node, cssNode);
-    }
-    if (auto cssNode = cssFindStyleNode(loader->cssStyle, *cssClass)) {
-        cssClassFound = true;
-        cssCopyStyleAttr(node, cssNode);
-    }
-
-    if (!cssClassFound) _postpone(loader->nodesToStyle, node, *cssClass);
 }
 
 
@@ -1231,6 +1228,9 @@ static constexpr struct
     STYLE_DEF(paint-order, PaintOrder, SvgStyleFlags::PaintOrder)
 };
 
+static constexpr uint16_t styleSeeds[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 1, 0, 0, 0, 0, 0, 1};
+SVG_LOOKUP_DEF(styleLookup, styleTags, styleSeeds);
+
 
 static bool _parseStyleAttr(void* data, const char* key, const char* value, bool style)
 {
@@ -1244,31 +1244,29 @@ static bool _parseStyleAttr(void* data, const char* key, const char* value, bool
     value = _skipSpace(value, nullptr);
 
     sz = strlen(key);
-    for (unsigned int i = 0; i < sizeof(styleTags) / sizeof(styleTags[0]); i++) {
-        if (styleTags[i].sz - 1 == sz && !strncmp(styleTags[i].tag, key, sz)) {
-            bool importance = false;
-            if (auto ptr = strstr(value, "!important")) {
-                size_t size = ptr - value;
-                while (size > 0 && isspace(value[size - 1])) {
-                    size--;
-                }
-                value = strDuplicate(value, size);
-                importance = true;
+    if (auto tag = svgLookup(styleTags, styleLookup, key, sz)) {
+        bool importance = false;
+        if (auto ptr = strstr(value, "!important")) {
+            size_t size = ptr - value;
+            while (size > 0 && isspace(value[size - 1])) {
+                size--;
             }
-            if (style) {
-                if (importance || !(node->style->flagsImportance & styleTags[i].flag)) {
-                    styleTags[i].tagHandler(loader, node, value);
-                    node->style->flags = (node->style->flags | styleTags[i].flag);
-                }
-            } else if (!(node->style->flags & styleTags[i].flag)) {
-                styleTags[i].tagHandler(loader, node, value);
-            }
-            if (importance) {
-                node->style->flagsImportance = (node->style->flags | styleTags[i].flag);
-                free(const_cast<char*>(value));
+            value = strDuplicate(value, size);
+            importance = true;
+        }
+        if (style) {
+            if (importance || !(node->style->flagsImportance & tag->flag)) {
+                tag->tagHandler(loader, node, value);
+                node->style->flags = (node->style->flags | tag->flag);
             }
-            return true;
+        } else if (!(node->style->flags & tag->flag)) {
+            tag->tagHandler(loader, node, value);
+        }
+        if (importance) {
+            node->style->flagsImportance = (node->style->flags | tag->flag);
+            free(const_cast<char*>(value));
         }
+        return true;
     }
 
     return false;
@@ -1618,6 +1616,9 @@ static constexpr struct
     {"r", SvgParserLengthType::Diagonal, sizeof("r"), offsetof(SvgCircleNode, r)}
 };
 
+static constexpr uint16_t circleSeeds[] = {0, 0, 0};
+SVG_LOOKUP_DEF(circleLookup, circleTags, circleSeeds);
+
 
 /* parse the attributes for a circle element.
  * https://www.w3.org/TR/SVG/shapes.html#CircleElement
@@ -1631,11 +1632,9 @@ static bool _attrParseCircleNode(void* data, const char* key, const char* value)
     int sz = strlen(key);
 
     array = (unsigned char*)circle;
-    for (unsigned int i = 0; i < sizeof(circleTags) / sizeof(circleTags[0]); i++) {
-        if (circleTags[i].sz - 1 == sz && !strncmp(circleTags[i].tag, key, sz)) {
-            *((float*)(array + circleTags[i].offset)) = _toFloat(loader->svgParse, value, circleTags[i].type);
-            return true;
-        }
+    if (auto tag = svgLookup(circleTags, circleLookup, key, sz)) {
+        *((float*)(array + tag->offset)) = _toFloat(loader->svgParse, value, tag->type);
+        return true;
     }
 
     if (!strcmp(key, "style")) {
@@ -1680,6 +1679,9 @@ static constexpr struct
     {"ry", SvgParserLengthType::Vertical, sizeof("ry"), offsetof(SvgEllipseNode, ry)}
 };
 
+static constexpr uint16_t ellipseSeeds[] = {0, 0, 0, 0};
+SVG_LOOKUP_DEF(ellipseLookup, ellipseTags, ellipseSeeds);
+
 
 /* parse the attributes for an ellipse element.
  * https://www.w3.org/TR/SVG/shapes.html#EllipseElement
@@ -1693,11 +1695,9 @@ static bool _attrParseEllipseNode(void* data, const char* key, const char* value
     int sz = strlen(key);
 
     array = (unsigned char*)ellipse;
-    for (unsigned int i = 0; i < sizeof(ellipseTags) / sizeof(ellipseTags[0]); i++) {
-        if (ellipseTags[i].sz - 1 == sz && !strncmp(ellipseTags[i].tag, key, sz)) {
-            *((float*)(array + ellipseTags[i].offset)) = _toFloat(loader->svgParse, value, ellipseTags[i].type);
-            return true;
-        }
+    if (auto tag = svgLookup(ellipseTags, ellipseLookup, key, sz)) {
+        *((float*)(array + tag->offset)) = _toFloat(loader->svgParse, value, tag->type);
+        return true;
     }
 
     if (!strcmp(key, "id")) {
@@ -1808,6 +1808,9 @@ static constexpr struct
     {"ry", SvgParserLengthType::Vertical, sizeof("ry"), offsetof(SvgRectNode, ry)}
 };
 
+static constexpr uint16_t rectSeeds[] = {0, 0, 0, 0, 0, 0};
+SVG_LOOKUP_DEF(rectLookup, rectTags, rectSeeds);
+
 
 /* parse the attributes for a rect element.
  * https://www.w3.org/TR/SVG/shapes.html#RectElement
@@ -1822,18 +1825,16 @@ static bool _attrParseRectNode(void* data, const char* key, const char* value)
     int sz = strlen(key);
 
     array = (unsigned char*)rect;
-    for (unsigned int i = 0; i < sizeof(rectTags) / sizeof(rectTags[0]); i++) {
-        if (rectTags[i].sz - 1 == sz && !strncmp(rectTags[i].tag, key, sz)) {
-            *((float*)(array + rectTags[i].offset)) = _toFloat(loader->svgParse, value, rectTags[i].type);
+    if (auto tag = svgLookup(rectTags, rectLookup, key, sz)) {
+        *((float*)(array + tag->offset)) = _toFloat(loader->svgParse, value, tag->type);
 
-            //Case if only rx or ry is declared
-            if (!strncmp(rectTags[i].tag, "rx", sz)) rect->hasRx = true;
-            if (!strncmp(rectTags[i].tag, "ry", sz)) rect->hasRy = true;
+        //Case if only rx or ry is declared
+        if (!strncmp(tag->tag, "rx", sz)) rect->hasRx = true;
+        if (!strncmp(tag->tag, "ry", sz)) rect->hasRy = true;
 
-            if ((rect->rx >= FLOAT_EPSILON) && (rect->ry < FLOAT_EPSILON) && rect->hasRx && !rect->hasRy) rect->ry = rect->rx;
-            if ((rect->ry >= FLOAT_EPSILON) && (rect->rx < FLOAT_EPSILON) && !rect->hasRx && rect->hasRy) rect->rx = rect->ry;
-            return ret;
-        }
+        if ((rect->rx >= FLOAT_EPSILON) && (rect->ry < FLOAT_EPSILON) && rect->hasRx && !rect->hasRy) rect->ry = rect->rx;
+        if ((rect->ry >= FLOAT_EPSILON) && (rect->rx < FLOAT_EPSILON) && !rect->hasRx && rect->hasRy) rect->rx = rect->ry;
+        return ret;
     }
 
     if (!strcmp(key, "id")) {
@@ -1881,6 +1882,9 @@ static constexpr struct
     {"y2", SvgParserLengthType::Vertical, sizeof("y2"), offsetof(SvgLineNode, y2)}
 };
 
+static constexpr uint16_t lineSeeds[] = {0, 0, 0, 6};
+SVG_LOOKUP_DEF(lineLookup, lineTags, lineSeeds);
+
 
 /* parse the attributes for a line element.
  * https://www.w3.org/TR/SVG/shapes.html#LineElement
@@ -1894,11 +1898,9 @@ static bool _attrParseLineNode(void* data, const char* key, const char* value)
     int sz = strlen(key);
 
     array = (unsigned char*)line;
-    for (unsigned int i = 0; i < sizeof(lineTags) / sizeof(lineTags[0]); i++) {
-        if (lineTags[i].sz - 1 == sz && !strncmp(lineTags[i].tag, key, sz)) {
-            *((float*)(array + lineTags[i].offset)) = _toFloat(loader->svgParse, value, lineTags[i].type);
-            return true;
-        }
+    if (auto tag = svgLookup(lineTags, lineLookup, key, sz)) {
+        *((float*)(array + tag->offset)) = _toFloat(loader->svgParse, value, tag->type);
+        return true;
     }
 
     if (!strcmp(key, "id")) {
@@ -1951,6 +1953,9 @@ static constexpr struct
     {"height", SvgParserLengthType::Vertical, sizeof("height"), offsetof(SvgRectNode, h)},
 };
 
+static constexpr uint16_t imageSeeds[] = {0, 0, 0, 0};
+SVG_LOOKUP_DEF(imageLookup, imageTags, imageSeeds);
+
 
 /* parse the attributes for a image element.
  * https://www.w3.org/TR/SVG/embedded.html#ImageElement
@@ -1964,16 +1969,21 @@ static bool _attrParseImageNode(void* data, const char* key, const char* value)
     int sz = strlen(key);
 
     array = (unsigned char*)image;
-    for (unsigned int i = 0; i < sizeof(imageTags) / sizeof(imageTags[0]); i++) {
-        if (imageTags[i].sz - 1 == sz && !strncmp(imageTags[i].tag, key, sz)) {
-            *((float*)(array + imageTags[i].offset)) = _toFloat(loader->svgParse, value, imageTags[i].type);
-            return true;
-        }
+    if (auto tag = svgLookup(imageTags, imageLookup, key, sz)) {
+        *((float*)(array + tag->offset)) = _toFloat(loader->svgParse, value, tag->type);
+        return true;
     }
 
     if (!strcmp(key, "href") || !strcmp(key, "xlink:href")) {
+        delete(image->task);
+        image->task = nullptr;
         if (image->href && value) free(image->href);
         image->href = _idFromHref(value);
+        //decode the embedded image in advance, the builder joins it
+        if (TaskScheduler::threads() > 0 && image->href && !strncmp(image->href, "data:", sizeof("data:") - 1)) {
+            image->task = new SvgImageTask(image->href);
+            TaskScheduler::request(image->task);
+        }
     } else if (!strcmp(key, "id")) {
         if (node->id && value) free(node->id);
         node->id = _copyId(value);
@@ -2020,21 +2030,52 @@ static SvgNode* _getDefsNode(SvgNode* node)
 }
 
 
-static SvgNode* _findNodeById(SvgNode *node, const char* id)
+static void _indexNode(SvgNodeIndex& index, SvgNode* node)
 {
-    if (!node) return nullptr;
+    if (!node->id) return;
 
-    SvgNode* result = nullptr;
-    if (node->id && !strcmp(node->id, id)) return node;
+    index.nodes.push(node);
 
-    if (node->child.count > 0) {
-        auto child = node->child.data;
-        for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
-            result = _findNodeById(*child, id);
-            if (result) break;
-        }
+    //keep the load factor under 1/2, rehash the nodes in the document order
+    auto from = index.nodes.count - 1;
+    if (index.nodes.count * 2 > index.size) {
+        index.size = index.size ? index.size * 2 : 64;
+        free(index.slots);
+        index.slots = (uint32_t*)calloc(index.size, sizeof(uint32_t));
+        from = 0;
     }
-    return result;
+
+    auto mask = index.size - 1;
+    for (auto i = from; i < index.nodes.count; ++i) {
+        auto slot = djb2Encode(index.nodes[i]->id) & mask;
+        while (index.slots[slot]) slot = (slot + 1) & mask;
+        index.slots[slot] = i + 1;
+    }
+}
+
+
+static bool _descendant(const SvgNode* node, const SvgNode* root)
+{
+    while (node) {
+        if (node == root) return true;
+        node = node->parent;
+    }
+    return false;
+}
+
+
+//the first node of the id in the subtree of the root, in the document order
+static SvgNode* _findNodeById(const SvgNodeIndex& index, SvgNode* root, const char* id)
+{
+    if (!root || !id || index.size == 0) return nullptr;
+
+    //the nodes of the same id are probed in the inserted order
+    auto mask = index.size - 1;
+    for (auto slot = djb2Encode(id) & mask; index.slots[slot]; slot = (slot + 1) & mask) {
+        auto node = index.nodes[index.slots[slot] - 1];
+        if (!strcmp(node->id, id) && _descendant(node, root)) return node;
+    }
+    return nullptr;
 }
 
 
@@ -2064,6 +2105,9 @@ static constexpr struct
     {"height", SvgParserLengthType::Vertical, sizeof("height"), offsetof(SvgUseNode, h)}
 };
 
+static constexpr uint16_t useSeeds[] = {0, 0, 0, 0};
+SVG_LOOKUP_DEF(useLookup, useTags, useSeeds);
+
 
 static void _cloneNode(SvgNode* from, SvgNode* parent, int depth);
 static bool _attrParseUseNode(void* data, const char* key, const char* value)
@@ -2075,21 +2119,19 @@ static bool _attrParseUseNode(void* data, const char* key, const char* value)
     SvgUseNode* use = &(node->node.use);
     int sz = strlen(key);
     unsigned char* array = (unsigned char*)use;
-    for (unsigned int i = 0; i < sizeof(useTags) / sizeof(useTags[0]); i++) {
-        if (useTags[i].sz - 1 == sz && !strncmp(useTags[i].tag, key, sz)) {
-            *((float*)(array + useTags[i].offset)) = _toFloat(loader->svgParse, value, useTags[i].type);
+    if (auto tag = svgLookup(useTags, useLookup, key, sz)) {
+        *((float*)(array + tag->offset)) = _toFloat(loader->svgParse, value, tag->type);
 
-            if (useTags[i].offset == offsetof(SvgUseNode, w)) use->isWidthSet = true;
-            else if (useTags[i].offset == offsetof(SvgUseNode, h)) use->isHeightSet = true;
+        if (tag->offset == offsetof(SvgUseNode, w)) use->isWidthSet = true;
+        else if (tag->offset == offsetof(SvgUseNode, h)) use->isHeightSet = true;
 
-            return true;
-        }
+        return true;
     }
 
     if (!strcmp(key, "href") || !strcmp(key, "xlink:href")) {
         id = _idFromHref(value);
         defs = _getDefsNode(node);
-        nodeFrom = _findNodeById(defs, id);
+        nodeFrom = _findNodeById(loader->ids, defs, id);
         if (nodeFrom) {
             if (!_findParentById(node, id, loader->doc)) {
                 _cloneNode(nodeFrom, node, 0);
@@ -2137,6 +2179,9 @@ static constexpr struct
         {"font-size", SvgParserLengthType::Vertical, sizeof("font-size"), offsetof(SvgTextNode, fontSize)}
 };
 
+static constexpr uint16_t textSeeds[] = {0, 0, 0};
+SVG_LOOKUP_DEF(textLookup, textTags, textSeeds);
+
 
 static bool _attrParseTextNode(void* data, const char* key, const char* value)
 {
@@ -2148,11 +2193,9 @@ static bool _attrParseTextNode(void* data, const char* key, const char* value)
     int sz = strlen(key);
 
     array = (unsigned char*)text;
-    for (unsigned int i = 0; i < sizeof(textTags) / sizeof(textTags[0]); i++) {
-        if (textTags[i].sz - 1 == sz && !strncmp(textTags[i].tag, key, sz)) {
-            *((float*)(array + textTags[i].offset)) = _toFloat(loader->svgParse, value, textTags[i].type);
-            return true;
-        }
+    if (auto tag = svgLookup(textTags, textLookup, key, sz)) {
+        *((float*)(array + tag->offset)) = _toFloat(loader->svgParse, value, tag->type);
+        return true;
     }
 
     if (!strcmp(key, "font-family")) {
@@ -2210,6 +2253,9 @@ static constexpr struct
     {"text", sizeof("text"), _createTextNode}
 };
 
+static constexpr uint16_t graphicsSeeds[] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+SVG_LOOKUP_DEF(graphicsLookup, graphicsTags, graphicsSeeds);
+
 
 static constexpr struct
 {
@@ -2226,24 +2272,20 @@ static constexpr struct
     {"symbol", sizeof("symbol"), _createSymbolNode}
 };
 
+static constexpr uint16_t groupSeeds[] = {0, 0, 0, 0, 1, 0, 0};
+SVG_LOOKUP_DEF(groupLookup, groupTags, groupSeeds);
 
-#define FIND_FACTORY(Short_Name, Tags_Array)                                           \
+
+#define FIND_FACTORY(Short_Name, Tags_Array, Lookup)                                   \
     static FactoryMethod                                                               \
         _find##Short_Name##Factory(const char* name)                                   \
     {                                                                                  \
-        unsigned int i;                                                                \
-        int sz = strlen(name);                                                         \
-                                                                                       \
-        for (i = 0; i < sizeof(Tags_Array) / sizeof(Tags_Array[0]); i++) {             \
-            if (Tags_Array[i].sz - 1 == sz && !strncmp(Tags_Array[i].tag, name, sz)) { \
-                return Tags_Array[i].tagHandler;                                       \
-            }                                                                          \
-        }                                                                              \
-        return nullptr;                                                                \
+        auto tag = svgLookup(Tags_Array, Lookup, name, strlen(name));                  \
+        return tag ? tag->tagHandler : nullptr;                                        \
     }
 
-FIND_FACTORY(Group, groupTags)
-FIND_FACTORY(Graphics, graphicsTags)
+FIND_FACTORY(Group, groupTags, groupLookup)
+FIND_FACTORY(Graphics, graphicsTags, graphicsLookup)
 
 
 FillSpread _parseSpreadValue(const char* value)
@@ -2475,6 +2517,9 @@ static constexpr struct
     RADIAL_DEF(fr, Fr, SvgGradientFlags::Fr)
 };
 
+static constexpr uint16_t radialSeeds[] = {0, 0, 0, 0, 0, 0};
+SVG_LOOKUP_DEF(radialLookup, radialTags, radialSeeds);
+
 
 static bool _attrParseRadialGradientNode(void* data, const char* key, const char* value)
 {
@@ -2483,12 +2528,10 @@ static bool _attrParseRadialGradientNode(void* data, const char* key, const char
     SvgRadialGradient* radial = grad->radial;
     int sz = strlen(key);
 
-    for (unsigned int i = 0; i < sizeof(radialTags) / sizeof(radialTags[0]); i++) {
-        if (radialTags[i].sz - 1 == sz && !strncmp(radialTags[i].tag, key, sz)) {
-            radialTags[i].tagHandler(loader, radial, value);
-            grad->flags = (grad->flags | radialTags[i].flag);
-            return true;
-        }
+    if (auto tag = svgLookup(radialTags, radialLookup, key, sz)) {
+        tag->tagHandler(loader, radial, value);
+        grad->flags = (grad->flags | tag->flag);
+        return true;
     }
 
     if (!strcmp(key, "id")) {
@@ -2743,6 +2786,9 @@ static constexpr struct
     LINEAR_DEF(y2, Y2, SvgGradientFlags::Y2)
 };
 
+static constexpr uint16_t linearSeeds[] = {0, 0, 0, 6};
+SVG_LOOKUP_DEF(linearLookup, linear_tags, linearSeeds);
+
 
 static bool _attrParseLinearGradientNode(void* data, const char* key, const char* value)
 {
@@ -2751,12 +2797,10 @@ static bool _attrParseLinearGradientNode(void* data, const char* key, const char
     SvgLinearGradient* linear = grad->linear;
     int sz = strlen(key);
 
-    for (unsigned int i = 0; i < sizeof(linear_tags) / sizeof(linear_tags[0]); i++) {
-        if (linear_tags[i].sz - 1 == sz && !strncmp(linear_tags[i].tag, key, sz)) {
-            linear_tags[i].tagHandler(loader, linear, value);
-            grad->flags = (grad->flags | linear_tags[i].flag);
-            return true;
-        }
+    if (auto tag = svgLookup(linear_tags, linearLookup, key, sz)) {
+        tag->tagHandler(loader, linear, value);
+        grad->flags = (grad->flags | tag->flag);
+        return true;
     }
 
     if (!strcmp(key, "id")) {
@@ -2832,15 +2876,16 @@ static constexpr struct
     GRADIENT_DEF(radialGradient, RadialGradient)
 };
 
+static constexpr uint16_t gradientSeeds[] = {0, 0};
+SVG_LOOKUP_DEF(gradientLookup, gradientTags, gradientSeeds);
+
 
 static GradientFactoryMethod _findGradientFactory(const char* name)
 {
     int sz = strlen(name);
 
-    for (unsigned int i = 0; i < sizeof(gradientTags) / sizeof(gradientTags[0]); i++) {
-        if (gradientTags[i].sz - 1 == sz && !strncmp(gradientTags[i].tag, name, sz)) {
-            return gradientTags[i].tagHandler;
-        }
+    if (auto tag = svgLookup(gradientTags, gradientLookup, name, sz)) {
+        return tag->tagHandler;
     }
     return nullptr;
 }
@@ -3155,23 +3200,19 @@ static void _copyAttr(SvgNode* to, const SvgNode* from)
             to->node.line.y2 = from->node.line.y2;
             break;
         }
+        //the geometry and the resources are borrowed from the source, see _freeNode()
         case SvgNodeType::Path: {
-            if (from->node.path.path) {
-                if (to->node.path.path) free(to->node.path.path);
-                to->node.path.path = strdup(from->node.path.path);
-            }
+            to->node.path.path = from->node.path.path;
             break;
         }
         case SvgNodeType::Polygon: {
-            if ((to->node.polygon.pts.count = from->node.polygon.pts.count)) {
-                to->node.polygon.pts = from->node.polygon.pts;
-            }
+            to->node.polygon.pts.data = from->node.polygon.pts.data;
+            to->node.polygon.pts.count = from->node.polygon.pts.count;
             break;
         }
         case SvgNodeType::Polyline: {
-            if ((to->node.polyline.pts.count = from->node.polyline.pts.count)) {
-                to->node.polyline.pts = from->node.polyline.pts;
-            }
+            to->node.polyline.pts.data = from->node.polyline.pts.data;
+            to->node.polyline.pts.count = from->node.polyline.pts.count;
             break;
         }
         case SvgNodeType::Image: {
@@ -3179,10 +3220,7 @@ static void _copyAttr(SvgNode* to, const SvgNode* from)
             to->node.image.y = from->node.image.y;
             to->node.image.w = from->node.image.w;
             to->node.image.h = from->node.image.h;
-            if (from->node.image.href) {
-                if (to->node.image.href) free(to->node.image.href);
-                to->node.image.href = strdup(from->node.image.href);
-            }
+            to->node.image.href = from->node.image.href;    //the prefetched data and the picture are resolved through the source
             break;
         }
         case SvgNodeType::Use: {
@@ -3231,6 +3269,7 @@ static void _cloneNode(SvgNode* from, SvgNode* parent, int depth)
     newNode = _createNode(parent, from->type);
     if (!newNode) return;
 
+    newNode->source = from->source ? from->source : from;
     _styleInherit(newNode->style, parent->style);
     _copyAttr(newNode, from);
 
@@ -3241,23 +3280,35 @@ static void _cloneNode(SvgNode* from, SvgNode* parent, int depth)
 }
 
 
-static void _clonePostponedNodes(Array<SvgNodeIdPair>* cloneNodes, SvgNode* doc)
+static SvgNode* _postponedSource(const SvgNodeIndex& index, const SvgNodeIdPair& nodeIdPair, SvgNode* doc)
 {
-    for (uint32_t i = 0; i < cloneNodes->count; ++i) {
-        auto nodeIdPair = (*cloneNodes)[i];
-        auto defs = _getDefsNode(nodeIdPair.node);
-        auto nodeFrom = _findNodeById(defs, nodeIdPair.id);
-        if (!nodeFrom) nodeFrom = _findNodeById(doc, nodeIdPair.id);
-        if (!_findParentById(nodeIdPair.node, nodeIdPair.id, doc)) {
-            _cloneNode(nodeFrom, nodeIdPair.node, 0);
-            if (nodeFrom && nodeFrom->type == SvgNodeType::Symbol && nodeIdPair.node->type == SvgNodeType::Use) {
-                nodeIdPair.node->node.use.symbol = nodeFrom;
-            }
-        } else {
-            TVGLOG("SVG", "%s is ancestor element. This reference is invalid.", nodeIdPair.id);
+    auto nodeFrom = _findNodeById(index, _getDefsNode(nodeIdPair.node), nodeIdPair.id);
+    if (!nodeFrom) nodeFrom = _findNodeById(index, doc, nodeIdPair.id);
+    return nodeFrom;
+}
+
+
+static void _clonePostponedNode(const SvgNodeIndex& index, SvgNodeIdPair& nodeIdPair, SvgNode* doc)
+{
+    auto nodeFrom = _postponedSource(index, nodeIdPair, doc);
+    if (!_findParentById(nodeIdPair.node, nodeIdPair.id, doc)) {
+        _cloneNode(nodeFrom, nodeIdPair.node, 0);
+        if (nodeFrom && nodeFrom->type == SvgNodeType::Symbol && nodeIdPair.node->type == SvgNodeType::Use) {
+            nodeIdPair.node->node.use.symbol = nodeFrom;
         }
-        free(nodeIdPair.id);
+    } else {
+        TVGLOG("SVG", "%s is ancestor element. This reference is invalid.", nodeIdPair.id);
+    }
+    free(nodeIdPair.id);
+}
+
+
+static void _clonePostponedNodes(const SvgNodeIndex& index, Array<SvgNodeIdPair>* cloneNodes, SvgNode* doc)
+{
+    for (uint32_t i = 0; i < cloneNodes->count; ++i) {
+        _clonePostponedNode(index, (*cloneNodes)[i], doc);
     }
+    cloneNodes->clear();
 }
 
 
@@ -3280,20 +3331,14 @@ static void _svgLoaderParserXmlClose(SvgLoaderData* loader, const char* content,
     }
     else return;
 
-    for (unsigned int i = 0; i < sizeof(groupTags) / sizeof(groupTags[0]); i++) {
-        if (!strncmp(tagName, groupTags[i].tag, sz)) {
-            loader->stack.pop();
-            break;
-        }
-    }
-
-    for (unsigned int i = 0; i < sizeof(graphicsTags) / sizeof(graphicsTags[0]); i++) {
-        if (!strncmp(tagName, graphicsTags[i].tag, sz)) {
-            loader->currentGraphicsNode = nullptr;
-            if (!strncmp(tagName, "text", 4)) loader->openedTag = OpenedTagType::Other;
-            loader->stack.pop();
-            break;
-        }
+    if (svgLookup(groupTags, groupLookup, tagName, sz)) {
+        loader->stack.pop();
+    } else if (svgLookup(graphicsTags, graphicsLookup, tagName, sz)) {
+        loader->currentGraphicsNode = nullptr;
+        if (!strncmp(tagName, "text", 4)) loader->openedTag = OpenedTagType::Other;
+        loader->stack.pop();
+    } else if (_findGradientFactory(tagName)) {
+        loader->openedGradient = nullptr;
     }
 
     loader->level--;
@@ -3341,20 +3386,20 @@ static void _svgLoaderParserXmlOpen(SvgLoaderData* loader, const char* content,
             if (loader->stack.count > 0) parent = loader->stack.last();
             else parent = loader->doc;
             if (!strcmp(tagName, "style")) {
-                // TODO: For now only the first style node is saved. After the css id selector
-                // is introduced this if condition shouldn't be necessary any more
+                //the rules of all the style sheets are gathered in the first one, in the document order
                 if (!loader->cssStyle) {
                     node = method(loader, nullptr, attrs, attrsLength, simpleXmlParseAttributes);
                     loader->cssStyle = node;
                     loader->doc->node.doc.style = node;
-                    loader->openedTag = OpenedTagType::Style;
-                }
+                } else node = loader->cssStyle;
+                loader->openedTag = OpenedTagType::Style;
             } else {
                 node = method(loader, parent, attrs, attrsLength, simpleXmlParseAttributes);
             }
         }
 
         if (!node) return;
+        _indexNode(loader->ids, node);
         if (node->type != SvgNodeType::Defs || !empty) {
             loader->stack.push(node);
         }
@@ -3362,6 +3407,7 @@ static void _svgLoaderParserXmlOpen(SvgLoaderData* loader, const char* content,
         if (loader->stack.count > 0) parent = loader->stack.last();
         else parent = loader->doc;
         node = method(loader, parent, attrs, attrsLength, simpleXmlParseAttributes);
+        if (node) _indexNode(loader->ids, node);
         if (node && !empty) {
             if (!strcmp(tagName, "text")) loader->openedTag = OpenedTagType::Text;
             auto defs = _createDefsNode(loader, nullptr, nullptr, 0, nullptr);
@@ -3383,6 +3429,7 @@ static void _svgLoaderParserXmlOpen(SvgLoaderData* loader, const char* content,
             loader->gradients.push(gradient);
         }
         loader->latestGradient = gradient;
+        if (!empty) loader->openedGradient = gradient;
     } else if (!strcmp(tagName, "stop")) {
         if (!loader->latestGradient) {
             TVGLOG("SVG", "Stop element is used outside of the Gradient element");
@@ -3596,20 +3643,20 @@ static void _updateGradient(SvgLoaderData* loader, SvgNode* node, Array<SvgStyle
 }
 
 
-static void _updateComposite(SvgNode* node, SvgNode* root)
+static void _updateComposite(const SvgNodeIndex& index, SvgNode* node, SvgNode* root)
 {
     if (node->style->clipPath.url && !node->style->clipPath.node) {
-        SvgNode* findResult = _findNodeById(root, node->style->clipPath.url);
+        SvgNode* findResult = _findNodeById(index, root, node->style->clipPath.url);
         if (findResult) node->style->clipPath.node = findResult;
     }
     if (node->style->mask.url && !node->style->mask.node) {
-        SvgNode* findResult = _findNodeById(root, node->style->mask.url);
+        SvgNode* findResult = _findNodeById(index, root, node->style->mask.url);
         if (findResult) node->style->mask.node = findResult;
     }
     if (node->child.count > 0) {
         auto child = node->child.data;
         for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
-            _updateComposite(*child, root);
+            _updateComposite(index, *child, root);
         }
     }
 }
@@ -3653,15 +3700,20 @@ static void _freeNode(SvgNode* node)
     free(node->transform);
     _freeNodeStyle(node->style);
     switch (node->type) {
+         //instances don't own the borrowed data
          case SvgNodeType::Path: {
+             if (node->source) break;
              free(node->node.path.path);
+             delete(node->node.path.shape);
              break;
          }
          case SvgNodeType::Polygon: {
+             if (node->source) break;
              free(node->node.polygon.pts.data);
              break;
          }
          case SvgNodeType::Polyline: {
+             if (node->source) break;
              free(node->node.polyline.pts.data);
              break;
          }
@@ -3681,7 +3733,10 @@ static void _freeNode(SvgNode* node)
              break;
          }
          case SvgNodeType::Image: {
+             if (node->source) break;
+             delete(node->node.image.task);
              free(node->node.image.href);
+             delete(node->node.image.picture);
              break;
          }
          case SvgNodeType::Text: {
@@ -3757,6 +3812,158 @@ static bool _svgLoaderParserForValidCheck(void* data, SimpleXMLType type, const
 }
 
 
+static void _updateDocument(SvgLoaderData& loaderData)
+{
+    auto defs = loaderData.doc->node.doc.defs;
+
+    if (loaderData.cssStyle) {
+        cssIndexStyle(loaderData.css, loaderData.cssStyle);
+        cssUpdateStyle(loaderData.css, loaderData.doc);
+        if (defs) cssUpdateStyle(loaderData.css, defs);
+    }
+
+    if (loaderData.cloneNodes.count > 0) _clonePostponedNodes(loaderData.ids, &loaderData.cloneNodes, loaderData.doc);
+
+    _updateComposite(loaderData.ids, loaderData.doc, loaderData.doc);
+    if (defs) _updateComposite(loaderData.ids, loaderData.doc, defs);
+
+    _updateStyle(loaderData.doc, nullptr);
+    if (defs) _updateStyle(defs, nullptr);
+
+    if (loaderData.gradients.count > 0) _updateGradient(&loaderData, loaderData.doc, &loaderData.gradients);
+    if (defs) _updateGradient(&loaderData, loaderData.doc, &defs->node.defs.gradients);
+}
+
+
+//the child of the document (or the defs) containing the node
+static SvgNode* _topNode(SvgNode* node)
+{
+    while (node->parent && node->parent->parent) node = node->parent;
+    return node;
+}
+
+
+static SvgStyleGradient* _findGradient(SvgLoaderData* loader, const char* id)
+{
+    auto defs = loader->doc->node.doc.defs;
+    for (auto p = loader->gradients.begin(); p < loader->gradients.end(); ++p) {
+        if ((*p)->id && !strcmp((*p)->id, id)) return *p;
+    }
+    if (defs) {
+        for (auto p = defs->node.defs.gradients.begin(); p < defs->node.defs.gradients.end(); ++p) {
+            if ((*p)->id && !strcmp((*p)->id, id)) return *p;
+        }
+    }
+    return nullptr;
+}
+
+
+static bool _resolvedGradient(SvgLoaderData* loader, const char* id)
+{
+    auto gradient = _findGradient(loader, id);
+    if (!gradient || gradient == loader->openedGradient) return false;
+    if (!gradient->ref) return true;
+
+    auto ref = _findGradient(loader, gradient->ref);
+    return ref && ref != loader->openedGradient;
+}
+
+
+static SvgNode* _compositeSource(SvgLoaderData* loader, const char* id)
+{
+    auto node = _findNodeById(loader->ids, loader->doc, id);
+    if (!node) node = _findNodeById(loader->ids, loader->doc->node.doc.defs, id);
+    return node;
+}
+
+
+static SvgNodeIdPair* _postponedClone(SvgLoaderData* loader, const SvgNode* node)
+{
+    for (auto p = loader->cloneNodes.begin(); p < loader->cloneNodes.end(); ++p) {
+        if (p->node == node) return p;
+    }
+    return nullptr;
+}
+
+
+static bool _resolvedNode(SvgLoaderData* loader, SvgNode* node, const SvgNode* top, int depth);
+
+//The referred node must be closed, and updated before the top-level node which refers it.
+static bool _resolvedRef(SvgLoaderData* loader, SvgNode* ref, const SvgNode* top, int depth)
+{
+    if (!ref) return false;
+
+    for (auto p = loader->stack.begin(); p < loader->stack.end(); ++p) {
+        if (_descendant(*p, ref)) return false;
+    }
+
+    auto refTop = _topNode(ref);
+    if (refTop->parent == loader->doc) {
+        if (refTop->built || refTop == top) return true;
+        return false;
+    }
+
+    //a node of the defs, its own references are checked one level deep only
+    return depth > 0 || _resolvedNode(loader, ref, top, depth + 1);
+}
+
+
+//Whether all the references of the node can be resolved with the data parsed so far
+static bool _resolvedNode(SvgLoaderData* loader, SvgNode* node, const SvgNode* top, int depth)
+{
+    auto style = node->style;
+
+    if (style->fill.paint.url && !_resolvedGradient(loader, style->fill.paint.url)) return false;
+    if (style->stroke.paint.url && !_resolvedGradient(loader, style->stroke.paint.url)) return false;
+    if (style->clipPath.url && !_resolvedRef(loader, _compositeSource(loader, style->clipPath.url), top, depth)) return false;
+    if (style->mask.url && !_resolvedRef(loader, _compositeSource(loader, style->mask.url), top, depth)) return false;
+
+    if (node->type == SvgNodeType::Use) {
+        if (auto pair = _postponedClone(loader, node)) {
+            if (!_resolvedRef(loader, _postponedSource(loader->ids, *pair, loader->doc), top, depth)) return false;
+        }
+    }
+
+    auto child = node->child.data;
+    for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
+        if (!_resolvedNode(loader, *child, top, depth)) return false;
+    }
+    return true;
+}
+
+
+//The updates of _updateDocument() confined to a top-level node
+static void _updateTopNode(SvgLoaderData* loader, SvgNode* node)
+{
+    auto doc = loader->doc;
+    auto defs = doc->node.doc.defs;
+
+    if (loader->css.count > 0) cssUpdateStyle(loader->css, node);
+
+    //clone the instances in the node, and the ones in the defs which are ready to be referred.
+    //the pairs are in the document order, so the ones of the following nodes are left as they are.
+    auto& cloneNodes = loader->cloneNodes;
+    uint32_t i = 0, remains = 0;
+    for (; i < cloneNodes.count; ++i) {
+        auto top = _topNode(cloneNodes[i].node);
+        if (top->parent == doc && top != node) break;
+        if (top == node || _resolvedRef(loader, _postponedSource(loader->ids, cloneNodes[i], doc), node, 1)) {
+            _clonePostponedNode(loader->ids, cloneNodes[i], doc);
+        } else cloneNodes[remains++] = cloneNodes[i];
+    }
+    for (; i < cloneNodes.count; ++i) cloneNodes[remains++] = cloneNodes[i];
+    cloneNodes.count = remains;
+
+    _updateComposite(loader->ids, node, doc);
+    if (defs) _updateComposite(loader->ids, node, defs);
+
+    _updateStyle(node, doc->style);
+
+    if (loader->gradients.count > 0) _updateGradient(loader, node, &loader->gradients);
+    if (defs) _updateGradient(loader, node, &defs->node.defs.gradients);
+}
+
+
 void SvgLoader::clear(bool all)
 {
     //flush out the intermediate data
@@ -3769,9 +3976,20 @@ void SvgLoader::clear(bool all)
     }
     loaderData.gradients.reset();
 
+    //the pairs left by the interrupted progressive loading
+    for (auto p = loaderData.cloneNodes.begin(); p < loaderData.cloneNodes.end(); ++p) {
+        free(p->id);
+    }
+    loaderData.cloneNodes.reset();
+    loaderData.css.reset();
+    loaderData.cssStyle = nullptr;
+    loaderData.latestGradient = nullptr;
+    loaderData.openedGradient = nullptr;
+
     _freeNode(loaderData.doc);
     loaderData.doc = nullptr;
     loaderData.stack.reset();
+    loaderData.ids.reset();
 
     if (!all) return;
 
@@ -3781,13 +3999,164 @@ void SvgLoader::clear(bool all)
     loaderData.images.reset();
 
     if (copy) free((char*)content);
+    file.close();
 
     delete(root);
     root = nullptr;
+    layer = nullptr;
 
     size = 0;
+    reserved = 0;
+    built = 0;
+    styledDefs = 0;
     content = nullptr;
     copy = false;
+    streaming = started = restyle = false;
+}
+
+
+//Decides the viewport with the <svg> element. Returns false when the whole picture is needed for it.
+bool SvgLoader::viewport()
+{
+    viewFlag = loaderData.doc->node.doc.viewFlag;
+    align = loaderData.doc->node.doc.align;
+    meetOrSlice = loaderData.doc->node.doc.meetOrSlice;
+
+    if (viewFlag & SvgViewFlag::Viewbox) {
+        vx = loaderData.doc->node.doc.vx;
+        vy = loaderData.doc->node.doc.vy;
+        vw = loaderData.doc->node.doc.vw;
+        vh = loaderData.doc->node.doc.vh;
+
+        if (viewFlag & SvgViewFlag::Width) w = loaderData.doc->node.doc.w;
+        else {
+            w = loaderData.doc->node.doc.vw;
+            if (viewFlag & SvgViewFlag::WidthInPercent) {
+                w *= loaderData.doc->node.doc.w;
+                viewFlag = (viewFlag ^ SvgViewFlag::WidthInPercent);
+            }
+            viewFlag = (viewFlag | SvgViewFlag::Width);
+        }
+        if (viewFlag & SvgViewFlag::Height) h = loaderData.doc->node.doc.h;
+        else {
+            h = loaderData.doc->node.doc.vh;
+            if (viewFlag & SvgViewFlag::HeightInPercent) {
+                h *= loaderData.doc->node.doc.h;
+                viewFlag = (viewFlag ^ SvgViewFlag::HeightInPercent);
+            }
+            viewFlag = (viewFlag | SvgViewFlag::Height);
+        }
+        return true;
+    }
+
+    //Before loading, set default viewbox & size if they are empty
+    vx = vy = 0.0f;
+    if (viewFlag & SvgViewFlag::Width) {
+        vw = w = loaderData.doc->node.doc.w;
+    } else {
+        vw = 1.0f;
+        if (viewFlag & SvgViewFlag::WidthInPercent) {
+            w = loaderData.doc->node.doc.w;
+        } else w = 1.0f;
+    }
+
+    if (viewFlag & SvgViewFlag::Height) {
+        vh = h = loaderData.doc->node.doc.h;
+    } else {
+        vh = 1.0f;
+        if (viewFlag & SvgViewFlag::HeightInPercent) {
+            h = loaderData.doc->node.doc.h;
+        } else h = 1.0f;
+    }
+    return false;
+}
+
+
+void SvgLoader::build()
+{
+    if (loaderData.doc) _updateDocument(loaderData);
+
+    root = svgSceneBuild(loaderData, {vx, vy, vw, vh}, w, h, align, meetOrSlice, svgPath, viewFlag);
+
+    //In case no viewbox and width/height data is provided the completion of loading
+    //has to be forced, in order to establish this data based on the whole picture.
+    if (!(viewFlag & SvgViewFlag::Viewbox)) {
+        //Override viewbox & size again after svg loading.
+        vx = loaderData.doc->node.doc.vx;
+        vy = loaderData.doc->node.doc.vy;
+        vw = loaderData.doc->node.doc.vw;
+        vh = loaderData.doc->node.doc.vh;
+        w = loaderData.doc->node.doc.w;
+        h = loaderData.doc->node.doc.h;
+    }
+
+    clear(false);
+}
+
+
+//Appends the closed top-level nodes whose references are resolved to the layer, in the document order.
+bool SvgLoader::append(bool last)
+{
+    auto doc = loaderData.doc;
+    auto defs = doc->node.doc.defs;
+
+    //the style sheets must be closed before any styled node is built
+    if (loaderData.cssStyle) {
+        if (!last && loaderData.openedTag == OpenedTagType::Style) return false;
+        if (loaderData.css.count < loaderData.cssStyle->child.count) {
+            cssIndexStyle(loaderData.css, loaderData.cssStyle);
+            cssApplyStyle(loaderData.css, doc);
+            //the nodes built already missed the rules, they're rebuilt at the end.
+            //the ones styled by the former rules take the new ones with the lower priority.
+            if (built > 0) restyle = true;
+            styledDefs = 0;
+        }
+    }
+
+    if (restyle) {
+        if (!last) return false;
+        layer->clear();
+        _updateDocument(loaderData);
+        for (built = 0; built < doc->child.count; ++built) {
+            svgSceneAppend(loaderData, layer, doc->child[built], {vx, vy, vw, vh}, svgPath);
+        }
+        return true;
+    }
+
+    auto count = doc->child.count;
+    if (!last) {
+        //the last node is still open
+        if (loaderData.stack.count > 1 && loaderData.stack[1]->parent == doc) --count;
+        //the inherited paints of the document
+        if (doc->style->fill.paint.url && !_resolvedGradient(&loaderData, doc->style->fill.paint.url)) return false;
+        if (doc->style->stroke.paint.url && !_resolvedGradient(&loaderData, doc->style->stroke.paint.url)) return false;
+    }
+
+    if (built == count) return false;
+
+    if (defs) {
+        //the closed definitions are styled, the last one may be still open
+        if (loaderData.css.count > 0) {
+            for (; styledDefs < defs->child.count; ++styledDefs) {
+                auto node = defs->child[styledDefs];
+                if (!last && loaderData.stack.count > 0 && _descendant(loaderData.stack.last(), node)) break;
+                cssUpdateStyle(loaderData.css, node);
+            }
+        }
+        _updateStyle(defs, nullptr);
+    }
+
+    auto appended = false;
+    while (built < count) {
+        auto node = doc->child[built];
+        if (!last && !_resolvedNode(&loaderData, node, node, 0)) break;
+        _updateTopNode(&loaderData, node);
+        svgSceneAppend(loaderData, layer, node, {vx, vy, vw, vh}, svgPath);
+        node->built = true;
+        ++built;
+        appended = true;
+    }
+    return appended;
 }
 
 
@@ -3818,38 +4187,7 @@ void SvgLoader::run(unsigned tid)
 
     if (!simpleXmlParse(content, size, true, _svgLoaderParser, &(loaderData))) return;
 
-    if (loaderData.doc) {
-        auto defs = loaderData.doc->node.doc.defs;
-
-        if (loaderData.nodesToStyle.count > 0) cssApplyStyleToPostponeds(loaderData.nodesToStyle, loaderData.cssStyle);
-        if (loaderData.cssStyle) cssUpdateStyle(loaderData.doc, loaderData.cssStyle);
-
-        if (loaderData.cloneNodes.count > 0) _clonePostponedNodes(&loaderData.cloneNodes, loaderData.doc);
-
-        _updateComposite(loaderData.doc, loaderData.doc);
-        if (defs) _updateComposite(loaderData.doc, defs);
-
-        _updateStyle(loaderData.doc, nullptr);
-        if (defs) _updateStyle(defs, nullptr);
-
-        if (loaderData.gradients.count > 0) _updateGradient(&loaderData, loaderData.doc, &loaderData.gradients);
-        if (defs) _updateGradient(&loaderData, loaderData.doc, &defs->node.defs.gradients);
-    }
-    root = svgSceneBuild(loaderData, {vx, vy, vw, vh}, w, h, align, meetOrSlice, svgPath, viewFlag);
-
-    //In case no viewbox and width/height data is provided the completion of loading
-    //has to be forced, in order to establish this data based on the whole picture.
-    if (!(viewFlag & SvgViewFlag::Viewbox)) {
-        //Override viewbox & size again after svg loading.
-        vx = loaderData.doc->node.doc.vx;
-        vy = loaderData.doc->node.doc.vy;
-        vw = loaderData.doc->node.doc.vw;
-        vh = loaderData.doc->node.doc.vh;
-        w = loaderData.doc->node.doc.w;
-        h = loaderData.doc->node.doc.h;
-    }
-
-    clear(false);
+    build();
 }
 
 
@@ -3867,60 +4205,9 @@ bool SvgLoader::header()
     simpleXmlParse(content, size, true, _svgLoaderParserForValidCheck, &(loaderData));
 
     if (loaderData.doc && loaderData.doc->type == SvgNodeType::Doc) {
-        viewFlag = loaderData.doc->node.doc.viewFlag;
-        align = loaderData.doc->node.doc.align;
-        meetOrSlice = loaderData.doc->node.doc.meetOrSlice;
-
-        if (viewFlag & SvgViewFlag::Viewbox) {
-            vx = loaderData.doc->node.doc.vx;
-            vy = loaderData.doc->node.doc.vy;
-            vw = loaderData.doc->node.doc.vw;
-            vh = loaderData.doc->node.doc.vh;
-
-            if (viewFlag & SvgViewFlag::Width) w = loaderData.doc->node.doc.w;
-            else {
-                w = loaderData.doc->node.doc.vw;
-                if (viewFlag & SvgViewFlag::WidthInPercent) {
-                    w *= loaderData.doc->node.doc.w;
-                    viewFlag = (viewFlag ^ SvgViewFlag::WidthInPercent);
-                }
-                viewFlag = (viewFlag | SvgViewFlag::Width);
-            }
-            if (viewFlag & SvgViewFlag::Height) h = loaderData.doc->node.doc.h;
-            else {
-                h = loaderData.doc->node.doc.vh;
-                if (viewFlag & SvgViewFlag::HeightInPercent) {
-                    h *= loaderData.doc->node.doc.h;
-                    viewFlag = (viewFlag ^ SvgViewFlag::HeightInPercent);
-                }
-                viewFlag = (viewFlag | SvgViewFlag::Height);
-            }
         //In case no viewbox and width/height data is provided the completion of loading
         //has to be forced, in order to establish this data based on the whole picture.
-        } else {
-            //Before loading, set default viewbox & size if they are empty
-            vx = vy = 0.0f;
-            if (viewFlag & SvgViewFlag::Width) {
-                vw = w = loaderData.doc->node.doc.w;
-            } else {
-                vw = 1.0f;
-                if (viewFlag & SvgViewFlag::WidthInPercent) {
-                    w = loaderData.doc->node.doc.w;
-                } else w = 1.0f;
-            }
-
-            if (viewFlag & SvgViewFlag::Height) {
-                vh = h = loaderData.doc->node.doc.h;
-            } else {
-                vh = 1.0f;
-                if (viewFlag & SvgViewFlag::HeightInPercent) {
-                    h = loaderData.doc->node.doc.h;
-                } else h = 1.0f;
-            }
-
-            run(0);
-        }
-
+        if (!viewport()) run(0);
         return true;
     }
 
@@ -3951,21 +4238,99 @@ bool SvgLoader::open(const string& path)
 {
     clear();
 
-    ifstream f;
-    f.open(path);
-
-    if (!f.is_open()) return false;
+    if (!file.open(path.c_str(), false, true)) return false;
 
     svgPath = path;
-    getline(f, filePath, '\0');
-    f.close();
+    content = file.data;
+    size = file.size;
 
-    if (filePath.empty()) return false;
+    return header();
+}
 
-    content = (char*)filePath.c_str();
-    size = filePath.size();
 
-    return header();
+bool SvgLoader::stream()
+{
+    clear();
+
+    loaderData.svgParse = (SvgParser*)malloc(sizeof(SvgParser));
+    if (!loaderData.svgParse) return false;
+
+    loaderData.svgParse->flags = SvgStopStyleFlags::StopDefault;
+    viewFlag = SvgViewFlag::None;
+
+    //the content keeps the data not parsed yet
+    streaming = true;
+    copy = true;
+
+    return true;
+}
+
+
+bool SvgLoader::feed(const char* data, uint32_t size, bool last, bool* updated)
+{
+    *updated = false;
+
+    if (!streaming) return false;
+
+    if (this->size + size >= reserved) {
+        auto reserved = this->size + size + 1;
+        if (reserved < this->reserved * 2) reserved = this->reserved * 2;
+        auto buf = (char*)realloc(content, reserved);
+        if (!buf) return false;
+        content = buf;
+        this->reserved = reserved;
+    }
+    if (size > 0) memcpy(content + this->size, data, size);
+    this->size += size;
+    content[this->size] = '\0';
+
+    //the markup cut off by the end of the data waits for the following one
+    unsigned parsed = this->size;
+    if (!simpleXmlParse(content, this->size, true, _svgLoaderParser, &(loaderData), last ? nullptr : &parsed)) {
+        streaming = false;
+        return false;
+    }
+    this->size -= parsed;
+    memmove(content, content + parsed, this->size + 1);
+
+    if (!started && loaderData.doc) {
+        started = true;
+        if (viewport()) {
+            //According to the SVG standard the value of the width/height of the viewbox set to 0 disables rendering
+            if (fabsf(vw) <= FLOAT_EPSILON || fabsf(vh) <= FLOAT_EPSILON) {
+                TVGLOG("SVG", "The <viewBox> width and/or height set to 0 - rendering disabled.");
+                root = Scene::gen().release();
+            } else {
+                root = svgSceneStart(loaderData, {vx, vy, vw, vh}, w, h, align, meetOrSlice, &layer);
+            }
+            *updated = true;
+        }
+    }
+
+    if (layer && append(last)) *updated = true;
+
+    if (!last) return true;
+
+    streaming = false;
+
+    if (!loaderData.doc) {
+        TVGLOG("SVG", "No SVG File. There is no <svg/>");
+        return false;
+    }
+
+    if (layer) {
+        //the rest of the postponed instances, they have no node to build
+        if (loaderData.cloneNodes.count > 0) _clonePostponedNodes(loaderData.ids, &loaderData.cloneNodes, loaderData.doc);
+        svgSceneFinish(loaderData, layer, {vx, vy, vw, vh}, svgPath);
+        layer = nullptr;
+        clear(false);
+    } else if (!(viewFlag & SvgViewFlag::Viewbox)) {
+        build();
+        *updated = true;
+    } else {
+        clear(false);
+    }
+    return true;
 }
 
 
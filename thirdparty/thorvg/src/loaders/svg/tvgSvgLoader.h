@@ -25,11 +25,12 @@
 
 #include "tvgTaskScheduler.h"
 #include "tvgSvgLoaderCommon.h"
+#include "tvgFile.h"
 
 class SvgLoader : public ImageLoader, public Task
 {
 public:
-    string filePath;
+    FileView file;
     string svgPath = "";
     char* content = nullptr;
     uint32_t size = 0;
@@ -44,6 +45,8 @@ public:
 
     bool open(const string& path) override;
     bool open(const char* data, uint32_t size, bool copy) override;
+    bool stream() override;
+    bool feed(const char* data, uint32_t size, bool last, bool* updated) override;
     bool resize(Paint* paint, float w, float h) override;
     bool read() override;
     bool close() override;
@@ -59,7 +62,19 @@ private:
     float vw = 0;
     float vh = 0;
 
+    //progressive loading
+    Scene* layer = nullptr;           //the document scene, the top-level nodes are appended to it
+    uint32_t reserved = 0;            //the capacity of the content
+    uint32_t built = 0;               //the number of the top-level nodes appended to the layer
+    uint32_t styledDefs = 0;          //the number of the definitions styled by the style sheets
+    bool streaming = false;
+    bool started = false;             //the <svg> element is parsed
+    bool restyle = false;             //the style sheet came after the built nodes
+
     bool header();
+    bool viewport();
+    void build();
+    bool append(bool last);
     void clear(bool all = true);
     void run(unsigned tid) override;
 };
@@ -25,6 +25,8 @@
 
 #include "tvgCommon.h"
 #include "tvgArray.h"
+#include "tvgLock.h"
+#include "tvgTaskScheduler.h"
 
 struct SvgNode;
 struct SvgStyleGradient;
@@ -344,15 +346,32 @@ struct SvgLineNode
     float y2;
 };
 
+//decodes the embedded data of an <image> while the rest of the document is parsed
+struct SvgImageTask : Task
+{
+    const char* href;           //the data url, owned by the node
+    Picture* picture = nullptr;
+    char* decoded = nullptr;    //the source of the picture
+
+    SvgImageTask(const char* href) : href(href) {}
+    ~SvgImageTask();
+
+protected:
+    void run(unsigned tid) override;
+};
+
 struct SvgImageNode
 {
     float x, y, w, h;
     char* href;
+    Picture* picture;           //loaded image shared by the instances
+    SvgImageTask* task;         //taken by the builder
 };
 
 struct SvgPathNode
 {
     char* path;
+    Shape* shape;               //parsed path duplicated by the instances
 };
 
 struct SvgPolygonNode
@@ -415,7 +434,6 @@ struct SvgComposite
 {
     char *url;
     SvgNode* node;
-    bool applying;              //flag for checking circular dependency.
 };
 
 struct SvgColor
@@ -506,6 +524,8 @@ struct SvgNode
 {
     SvgNodeType type;
     SvgNode* parent;
+    SvgNode* source;   //the original node if this is an instance of <use>, its data is borrowed from the source
+    bool built;        //the top-level node is built into the scene already (progressive loading)
     Array<SvgNode*> child;
     char *id;
     SvgStyleProperty *style;
@@ -555,6 +575,59 @@ struct SvgNodeIdPair
     char *id;
 };
 
+//index of the identified nodes, resolves the references by id
+struct SvgNodeIndex
+{
+    Array<SvgNode*> nodes;        //indexed nodes in the document order
+    uint32_t* slots = nullptr;    //hash table of the positions in nodes, starts from 1 (0 is empty)
+    uint32_t size = 0;            //slot count, power of two
+
+    ~SvgNodeIndex()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        free(slots);
+        slots = nullptr;
+        size = 0;
+        nodes.reset();
+    }
+};
+
+//index of the rules of the style sheets, matches the nodes by the type, class and id selectors
+struct SvgCssIndex
+{
+    struct Rule
+    {
+        SvgNode* node;
+        uint32_t priority;        //specificity in the upper bits, the order in the style sheets in the rest
+    };
+
+    Array<Rule> types[(int)SvgNodeType::Unknown];    //rules of the type selectors by the node type
+    Array<Rule> names;            //rules of the class and id selectors in the document order
+    uint32_t* slots = nullptr;    //hash table of the positions in names, starts from 1 (0 is empty)
+    uint32_t size = 0;            //slot count, power of two
+    uint32_t count = 0;           //rules of the style sheets indexed so far
+    Array<Rule> matched;          //rules matching the node being styled
+
+    ~SvgCssIndex()
+    {
+        reset();
+    }
+
+    void reset()
+    {
+        for (auto& type : types) type.reset();
+        names.reset();
+        matched.reset();
+        free(slots);
+        slots = nullptr;
+        size = count = 0;
+    }
+};
+
 enum class OpenedTagType : uint8_t
 {
     Other = 0,
@@ -570,14 +643,17 @@ struct SvgLoaderData
     SvgNode* cssStyle = nullptr;
     Array<SvgStyleGradient*> gradients;
     SvgStyleGradient* latestGradient = nullptr; //For stops
+    SvgStyleGradient* openedGradient = nullptr; //the stops of the gradient are not closed yet
     SvgParser* svgParse = nullptr;
     Array<SvgNodeIdPair> cloneNodes;
-    Array<SvgNodeIdPair> nodesToStyle;
+    SvgNodeIndex ids;
+    SvgCssIndex css;
     Array<char*> images;        //embedded images
     int level = 0;
     bool result = false;
     OpenedTagType openedTag = OpenedTagType::Other;
     SvgNode* currentGraphicsNode = nullptr;
+    Key key;                    //guards the data shared by the nodes built concurrently
 };
 
 struct Box
@@ -0,0 +1,133 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _TVG_SVG_LOOKUP_H_
+#define _TVG_SVG_LOOKUP_H_
+
+#include "tvgCommon.h"
+
+/*
+ * Perfect hash tables of the keyword tables of the svg loader.
+ *
+ * The keys are distributed to N buckets by the upper half of a 64bit FNV-1a hash.
+ * Each bucket has its own seed which scatters the keys of the bucket into the free slots
+ * by the lower half of the hash, so a lookup costs one hash and one comparison.
+ * The hash folds ASCII letters to lower case, so the same table serves case insensitive keywords.
+ *
+ * The seeds are searched offline by svg-lookup-seeds.py and committed along the tables,
+ * the compiler only places the keys by them and rejects any collision.
+ */
+
+static constexpr uint64_t svgHash(const char* str, size_t len)
+{
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t i = 0; i < len; ++i) {
+        auto c = static_cast<uint8_t>(str[i]);
+        if (c >= 'A' && c <= 'Z') c |= 0x20;
+        hash = (hash ^ c) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+
+static constexpr uint32_t svgLookupSize(size_t keys)
+{
+    uint32_t size = 4;
+    while (size < 2 * keys) size <<= 1;   //twice the keys at least
+    return size;
+}
+
+
+template<size_t N>
+struct SvgLookup
+{
+    static constexpr uint32_t SIZE = svgLookupSize(N);
+
+    uint16_t seeds[N] = {};
+    uint16_t slots[SIZE] = {};     //key index + 1, zero is empty
+    bool valid = true;
+
+    static constexpr uint32_t bucket(uint64_t hash)
+    {
+        return static_cast<uint32_t>(hash >> 32) % N;
+    }
+
+    static constexpr uint32_t slot(uint64_t hash, uint32_t seed)
+    {
+        auto h = static_cast<uint32_t>(hash) ^ (seed * 0x9e3779b9U);
+        h ^= h >> 16;
+        h *= 0x85ebca6bU;
+        h ^= h >> 13;
+        h *= 0xc2b2ae35U;
+        h ^= h >> 16;
+        return h & (SIZE - 1);
+    }
+
+    template<typename T>
+    constexpr SvgLookup(const T (&table)[N], const uint16_t (&seeds)[N])
+    {
+        for (uint32_t i = 0; i < N; ++i) {
+            this->seeds[i] = seeds[i];
+        }
+        for (uint32_t i = 0; i < N; ++i) {
+            size_t len = 0;
+            while (table[i].tag[len]) ++len;
+            auto hash = svgHash(table[i].tag, len);
+            auto& s = slots[slot(hash, seeds[bucket(hash)])];
+            if (s) valid = false;
+            s = i + 1;
+        }
+    }
+
+    //Returns the only candidate index of the key, the caller must compare the key with it.
+    int32_t find(const char* key, size_t len) const
+    {
+        auto hash = svgHash(key, len);
+        return static_cast<int32_t>(slots[slot(hash, seeds[bucket(hash)])]) - 1;
+    }
+};
+
+
+//Returns the entry of the table matching the key, or nullptr.
+template<typename T, size_t N>
+static inline const T* svgLookup(const T (&table)[N], const SvgLookup<N>& lookup, const char* key, size_t len)
+{
+    auto i = lookup.find(key, len);
+    if (i < 0 || strncmp(table[i].tag, key, len) || table[i].tag[len]) return nullptr;
+    return &table[i];
+}
+
+
+//Case insensitive variant of the svgLookup()
+template<typename T, size_t N>
+static inline const T* svgLookupNoCase(const T (&table)[N], const SvgLookup<N>& lookup, const char* key, size_t len)
+{
+    auto i = lookup.find(key, len);
+    if (i < 0 || strncasecmp(table[i].tag, key, len) || table[i].tag[len]) return nullptr;
+    return &table[i];
+}
+
+#define SVG_LOOKUP_DEF(Name, Table, Seeds)                                                    \
+    static constexpr SvgLookup<sizeof(Table) / sizeof(Table[0])> Name(Table, Seeds);         \
+    static_assert(Name.valid, "colliding keys of " #Table ", regenerate the seeds by svg-lookup-seeds.py")
+
+#endif //_TVG_SVG_LOOKUP_H_
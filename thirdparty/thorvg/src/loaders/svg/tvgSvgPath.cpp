@@ -62,9 +62,22 @@
 /* Internal Class Implementation                                        */
 /************************************************************************/
 
+//locale independent isspace()
+static inline bool _isSpace(char c)
+{
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+
+static inline bool _isAlpha(char c)
+{
+    return static_cast<unsigned char>((c | 0x20) - 'a') < 26;
+}
+
+
 static char* _skipComma(const char* content)
 {
-    while (*content && isspace(*content)) {
+    while (_isSpace(*content)) {
         content++;
     }
     if (*content == ',') return (char*)content + 1;
@@ -226,12 +239,15 @@ void _pathAppendArcTo(Array<PathCommand>* cmds, Array<Point>* pts, Point* cur, P
     cosTheta1 = cosf(theta1);
     sinTheta1 = sinf(theta1);
 
+    //the segments advance by the same angle, rotate instead of evaluating the trigonometry per segment
+    auto cosDelta = cosf(delta);
+    auto sinDelta = sinf(delta);
+
     for (int i = 0; i < segments; ++i) {
         //End angle (for this segment) = current + delta
         float c1x, c1y, ex, ey, c2x, c2y;
-        float theta2 = theta1 + delta;
-        float cosTheta2 = cosf(theta2);
-        float sinTheta2 = sinf(theta2);
+        float cosTheta2 = cosTheta1 * cosDelta - sinTheta1 * sinDelta;
+        float sinTheta2 = sinTheta1 * cosDelta + cosTheta1 * sinDelta;
         Point p[3];
 
         //First control point (based on start point sx,sy)
@@ -258,7 +274,6 @@ void _pathAppendArcTo(Array<PathCommand>* cmds, Array<Point>* pts, Point* cur, P
         //Next start point is the current end point (same for angle)
         sx = ex;
         sy = ey;
-        theta1 = theta2;
         //Avoid recomputations
         cosTheta1 = cosTheta2;
         sinTheta1 = sinTheta2;
@@ -311,8 +326,16 @@ static int _numberCount(char cmd)
 }
 
 
+//The numbers are parsed in place, right after the points. The move, line and cubic commands keep them there.
 static bool _processCommand(Array<PathCommand>* cmds, Array<Point>* pts, char cmd, float* arr, int count, Point* cur, Point* curCtl, Point* startPoint, bool *isQuadratic, bool* closed)
 {
+    //the other commands write the points over the numbers or reallocate them
+    float copy[7];
+    if (cmd != 'M' && cmd != 'm' && cmd != 'L' && cmd != 'l' && cmd != 'C' && cmd != 'c') {
+        memcpy(copy, arr, sizeof(float) * count);
+        arr = copy;
+    }
+
     switch (cmd) {
         case 'm':
         case 'l':
@@ -347,33 +370,25 @@ static bool _processCommand(Array<PathCommand>* cmds, Array<Point>* pts, char cm
     switch (cmd) {
         case 'm':
         case 'M': {
-            Point p = {arr[0], arr[1]};
             cmds->push(PathCommand::MoveTo);
-            pts->push(p);
+            ++pts->count;
             *cur = {arr[0], arr[1]};
             *startPoint = {arr[0], arr[1]};
             break;
         }
         case 'l':
         case 'L': {
-            Point p = {arr[0], arr[1]};
             cmds->push(PathCommand::LineTo);
-            pts->push(p);
+            ++pts->count;
             *cur = {arr[0], arr[1]};
             break;
         }
         case 'c':
         case 'C': {
-            Point p[3];
             cmds->push(PathCommand::CubicTo);
-            p[0] = {arr[0], arr[1]};
-            p[1] = {arr[2], arr[3]};
-            p[2] = {arr[4], arr[5]};
-            pts->push(p[0]);
-            pts->push(p[1]);
-            pts->push(p[2]);
-            *curCtl = p[1];
-            *cur = p[2];
+            pts->count += 3;
+            *curCtl = {arr[2], arr[3]};
+            *cur = {arr[4], arr[5]};
             *isQuadratic = false;
             break;
         }
@@ -494,7 +509,7 @@ static char* _nextCommand(char* path, char* cmd, float* arr, int* count, bool* c
     int large, sweep;
 
     path = _skipComma(path);
-    if (isalpha(*path)) {
+    if (_isAlpha(*path)) {
         *cmd = *path;
         path++;
         *count = _numberCount(*cmd);
@@ -545,7 +560,6 @@ static char* _nextCommand(char* path, char* cmd, float* arr, int* count, bool* c
 
 bool svgPathToShape(const char* svgPath, Shape* shape)
 {
-    float numberArray[7];
     int numberCount = 0;
     Point cur = { 0, 0 };
     Point curCtl = { 0, 0 };
@@ -559,11 +573,19 @@ bool svgPathToShape(const char* svgPath, Shape* shape)
     auto& cmds = P(shape)->rs.path.cmds;
     auto lastCmds = cmds.count;
 
+    //a rough estimation from the usual density of the path data, it saves the most of the reallocations
+    auto len = strlen(svgPath);
+    pts.grow(len / 8);
+    cmds.grow(len / 16);
+
     while ((path[0] != '\0')) {
-        path = _nextCommand(path, &cmd, numberArray, &numberCount, &closed);
+        //room for the numbers of any command (up to 7), parsed in place after the points
+        if (pts.count + 4 > pts.reserved) pts.reserve(pts.count + 4 + pts.count / 2);
+        auto numbers = reinterpret_cast<float*>(pts.end());
+        path = _nextCommand(path, &cmd, numbers, &numberCount, &closed);
         if (!path) break;
         closed = false;
-        if (!_processCommand(&cmds, &pts, cmd, numberArray, numberCount, &cur, &curCtl, &startPoint, &isQuadratic, &closed)) break;
+        if (!_processCommand(&cmds, &pts, cmd, numbers, numberCount, &cur, &curCtl, &startPoint, &isQuadratic, &closed)) break;
     }
 
     if (cmds.count > lastCmds && cmds[lastCmds] != PathCommand::MoveTo) return false;
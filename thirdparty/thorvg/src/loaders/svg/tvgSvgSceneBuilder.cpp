@@ -39,7 +39,20 @@
 
 static bool _appendShape(SvgLoaderData& loaderData, SvgNode* node, Shape* shape, const Box& vBox, const string& svgPath);
 static bool _appendClipShape(SvgLoaderData& loaderData, SvgNode* node, Shape* shape, const Box& vBox, const string& svgPath, const Matrix* transform);
-static unique_ptr<Scene> _sceneBuildHelper(SvgLoaderData& loaderData, const SvgNode* node, const Box& vBox, const string& svgPath, bool mask, int depth, bool* isMaskWhite = nullptr);
+static unique_ptr<Scene> _sceneBuildHelper(SvgLoaderData& loaderData, const SvgNode* node, const Box& vBox, const string& svgPath, bool mask, int depth, bool* isMaskWhite = nullptr, bool parallel = false);
+
+//the compositions being applied on this thread, to break the circular dependencies
+static thread_local Array<const SvgComposite*> _compositions;
+
+struct SvgBuildJob
+{
+    SvgLoaderData* loaderData;
+    const SvgNode* node;
+    const Box* vBox;
+    const string* svgPath;
+    int depth;
+    Paint** paints;             //the built children in the document order
+};
 
 
 static inline bool _isGroupType(SvgNodeType type)
@@ -97,11 +110,14 @@ static unique_ptr<LinearGradient> _applyLinearGradientProperty(SvgStyleGradient*
     Matrix finalTransform = {1, 0, 0, 0, 1, 0, 0, 0, 1};
     if (isTransform) finalTransform = *g->transform;
 
+    //the gradient may be applied multiple times (and concurrently) by the shared nodes, it's kept as it is.
+    auto linear = *g->linear;
+
     if (g->userSpace) {
-        g->linear->x1 = g->linear->x1 * vBox.w;
-        g->linear->y1 = g->linear->y1 * vBox.h;
-        g->linear->x2 = g->linear->x2 * vBox.w;
-        g->linear->y2 = g->linear->y2 * vBox.h;
+        linear.x1 *= vBox.w;
+        linear.y1 *= vBox.h;
+        linear.x2 *= vBox.w;
+        linear.y2 *= vBox.h;
     } else {
         Matrix m = {vBox.w, 0, vBox.x, 0, vBox.h, vBox.y, 0, 0, 1};
         if (isTransform) _transformMultiply(&m, &finalTransform);
@@ -113,7 +129,7 @@ static unique_ptr<LinearGradient> _applyLinearGradientProperty(SvgStyleGradient*
 
     if (isTransform) fillGrad->transform(finalTransform);
 
-    fillGrad->linear(g->linear->x1, g->linear->y1, g->linear->x2, g->linear->y2);
+    fillGrad->linear(linear.x1, linear.y1, linear.x2, linear.y2);
     fillGrad->spread(g->spread);
 
     //Update the stops
@@ -152,15 +168,17 @@ static unique_ptr<RadialGradient> _applyRadialGradientProperty(SvgStyleGradient*
     Matrix finalTransform = {1, 0, 0, 0, 1, 0, 0, 0, 1};
     if (isTransform) finalTransform = *g->transform;
 
+    auto radial = *g->radial;
+
     if (g->userSpace) {
         //The radius scaling is done according to the Units section:
         //https://www.w3.org/TR/2015/WD-SVG2-20150915/coords.html
-        g->radial->cx = g->radial->cx * vBox.w;
-        g->radial->cy = g->radial->cy * vBox.h;
-        g->radial->r = g->radial->r * sqrtf(powf(vBox.w, 2.0f) + powf(vBox.h, 2.0f)) / sqrtf(2.0f);
-        g->radial->fx = g->radial->fx * vBox.w;
-        g->radial->fy = g->radial->fy * vBox.h;
-        g->radial->fr = g->radial->fr * sqrtf(powf(vBox.w, 2.0f) + powf(vBox.h, 2.0f)) / sqrtf(2.0f);
+        radial.cx *= vBox.w;
+        radial.cy *= vBox.h;
+        radial.r *= sqrtf(powf(vBox.w, 2.0f) + powf(vBox.h, 2.0f)) / sqrtf(2.0f);
+        radial.fx *= vBox.w;
+        radial.fy *= vBox.h;
+        radial.fr *= sqrtf(powf(vBox.w, 2.0f) + powf(vBox.h, 2.0f)) / sqrtf(2.0f);
     } else {
         Matrix m = {vBox.w, 0, vBox.x, 0, vBox.h, vBox.y, 0, 0, 1};
         if (isTransform) _transformMultiply(&m, &finalTransform);
@@ -172,7 +190,7 @@ static unique_ptr<RadialGradient> _applyRadialGradientProperty(SvgStyleGradient*
 
     if (isTransform) fillGrad->transform(finalTransform);
 
-    P(fillGrad)->radial(g->radial->cx, g->radial->cy, g->radial->r, g->radial->fx, g->radial->fy, g->radial->fr);
+    P(fillGrad)->radial(radial.cx, radial.cy, radial.r, radial.fx, radial.fy, radial.fr);
     fillGrad->spread(g->spread);
 
     //Update the stops
@@ -248,17 +266,26 @@ static Matrix _compositionTransform(Paint* paint, const SvgNode* node, const Svg
 }
 
 
+static bool _applying(const SvgComposite* composite)
+{
+    for (auto p = _compositions.begin(); p < _compositions.end(); ++p) {
+        if (*p == composite) return true;
+    }
+    return false;
+}
+
+
 static void _applyComposition(SvgLoaderData& loaderData, Paint* paint, const SvgNode* node, const Box& vBox, const string& svgPath)
 {
     /* ClipPath */
     /* Do not drop in Circular Dependency for ClipPath.
        Composition can be applied recursively if its children nodes have composition target to this one. */
-    if (node->style->clipPath.applying) {
+    if (_applying(&node->style->clipPath)) {
         TVGLOG("SVG", "Multiple Composition Tried! Check out Circular dependency?");
     } else {
         auto compNode = node->style->clipPath.node;
         if (compNode && compNode->child.count > 0) {
-            node->style->clipPath.applying = true;
+            _compositions.push(&node->style->clipPath);
 
             auto comp = Shape::gen();
 
@@ -275,19 +302,19 @@ static void _applyComposition(SvgLoaderData& loaderData, Paint* paint, const Svg
                 paint->clip(std::move(comp));
             }
 
-            node->style->clipPath.applying = false;
+            _compositions.pop();
         }
     }
 
     /* Mask */
     /* Do not drop in Circular Dependency for Mask.
        Composition can be applied recursively if its children nodes have composition target to this one. */
-    if (node->style->mask.applying) {
+    if (_applying(&node->style->mask)) {
         TVGLOG("SVG", "Multiple Composition Tried! Check out Circular dependency?");
     } else {
         auto compNode = node->style->mask.node;
         if (compNode && compNode->child.count > 0) {
-            node->style->mask.applying = true;
+            _compositions.push(&node->style->mask);
 
             bool isMaskWhite = true;
             if (auto comp = _sceneBuildHelper(loaderData, compNode, vBox, svgPath, true, 0, &isMaskWhite)) {
@@ -305,7 +332,7 @@ static void _applyComposition(SvgLoaderData& loaderData, Paint* paint, const Svg
                 }
             }
 
-            node->style->mask.applying = false;
+            _compositions.pop();
         }
     }
 }
@@ -392,23 +419,57 @@ static void _applyProperty(SvgLoaderData& loaderData, SvgNode* node, Shape* vg,
 }
 
 
+//The path data of a <use> source is parsed once by its first instance, the source shares it as well.
+//The parsed data is shared by reference, the duplicates of the shape don't copy it.
+static Shape* _sharedPath(SvgLoaderData& loaderData, SvgNode* node)
+{
+    auto source = node->source ? node->source : node;
+    {
+        ScopedLock lock(loaderData.key);
+        if (source->node.path.shape || !node->source) return source->node.path.shape;
+    }
+
+    auto shape = Shape::gen();
+    if (!svgPathToShape(node->node.path.path, shape.get())) return nullptr;
+    P(shape.get())->rs.path.share();
+
+    ScopedLock lock(loaderData.key);
+    if (!source->node.path.shape) source->node.path.shape = shape.release();
+    return source->node.path.shape;
+}
+
+
 static unique_ptr<Shape> _shapeBuildHelper(SvgLoaderData& loaderData, SvgNode* node, const Box& vBox, const string& svgPath)
 {
+    //the shared path is duplicated by reference, then the instance applies its own transform and style
+    if (node->type == SvgNodeType::Path && node->node.path.path) {
+        if (auto path = _sharedPath(loaderData, node)) {
+            auto shape = unique_ptr<Shape>(static_cast<Shape*>(path->duplicate()));
+            _applyProperty(loaderData, node, shape.get(), vBox, svgPath, false);
+            return shape;
+        }
+    }
+
     auto shape = Shape::gen();
     if (_appendShape(loaderData, node, shape.get(), vBox, svgPath)) return shape;
     else return nullptr;
 }
 
 
-static bool _recognizeShape(SvgNode* node, Shape* shape)
+static bool _recognizeShape(SvgLoaderData& loaderData, SvgNode* node, Shape* shape)
 {
     switch (node->type) {
         case SvgNodeType::Path: {
-            if (node->node.path.path) {
-                if (!svgPathToShape(node->node.path.path, shape)) {
-                    TVGERR("SVG", "Invalid path information.");
-                    return false;
-                }
+            if (!node->node.path.path) break;
+            if (auto path = _sharedPath(loaderData, node)) {
+                const PathCommand* cmds;
+                const Point* pts;
+                auto cmdCnt = path->pathCommands(&cmds);
+                auto ptsCnt = path->pathCoords(&pts);
+                shape->appendPath(cmds, cmdCnt, pts, ptsCnt);
+            } else if (!svgPathToShape(node->node.path.path, shape)) {
+                TVGERR("SVG", "Invalid path information.");
+                return false;
             }
             break;
         }
@@ -458,7 +519,7 @@ static bool _recognizeShape(SvgNode* node, Shape* shape)
 
 static bool _appendShape(SvgLoaderData& loaderData, SvgNode* node, Shape* shape, const Box& vBox, const string& svgPath)
 {
-    if (!_recognizeShape(node, shape)) return false;
+    if (!_recognizeShape(loaderData, node, shape)) return false;
 
     _applyProperty(loaderData, node, shape, vBox, svgPath, false);
     return true;
@@ -476,7 +537,7 @@ static bool _appendClipShape(SvgLoaderData& loaderData, SvgNode* node, Shape* sh
         currentPtsCnt = shape->pathCoords(&tmp);
     }
 
-    if (!_recognizeShape(node, shape)) return false;
+    if (!_recognizeShape(loaderData, node, shape)) return false;
 
     if (m) {
         const Point *pts = nullptr;
@@ -566,37 +627,88 @@ static bool _isValidImageMimeTypeAndEncoding(const char** href, const char** mim
     return false;
 }
 
-#include "tvgTaskScheduler.h"
+static unique_ptr<Picture> _imageSetup(SvgLoaderData& loaderData, SvgNode* node, unique_ptr<Picture> picture, const Box& vBox, const string& svgPath)
+{
+    float w, h;
+    Matrix m = {1, 0, 0, 0, 1, 0, 0, 0, 1};
+    if (picture->size(&w, &h) == Result::Success && w  > 0 && h > 0) {
+        auto sx = node->node.image.w / w;
+        auto sy = node->node.image.h / h;
+        m = {sx, 0, node->node.image.x, 0, sy, node->node.image.y, 0, 0, 1};
+    }
+    if (node->transform) m = *node->transform * m;
+    picture->transform(m);
 
-static unique_ptr<Picture> _imageBuildHelper(SvgLoaderData& loaderData, SvgNode* node, const Box& vBox, const string& svgPath)
+    _applyComposition(loaderData, picture.get(), node, vBox, svgPath);
+
+    return picture;
+}
+
+
+//The picture is scaled by its transform, let the loader decode the image at its own size.
+static void _imageFullSize(Picture* picture)
 {
-    if (!node->node.image.href || !strlen(node->node.image.href)) return nullptr;
+    float w, h;
+    if (picture->size(&w, &h) == Result::Success) picture->size(w, h);
+}
+
+
+//Loads the data url. The decoded data is the source of the picture, so it must outlive the picture.
+static bool _imageDecode(const char* href, Picture* picture, char** decoded)
+{
+    const char* mimetype;
+    imageMimeTypeEncoding encoding;
+    if (!_isValidImageMimeTypeAndEncoding(&href, &mimetype, &encoding)) return false; //not allowed mime type or encoding
+
+    size_t size;
+    if (encoding == imageMimeTypeEncoding::base64) size = b64Decode(href, strlen(href), decoded);
+    else size = svgUtilURLDecode(href, decoded);
+
+    if (picture->load(*decoded, size, mimetype, false) == Result::Success) {
+        _imageFullSize(picture);
+        return true;
+    }
+
+    free(*decoded);
+    *decoded = nullptr;
+    return false;
+}
+
+
+static unique_ptr<Picture> _imageLoad(SvgLoaderData& loaderData, SvgNode* node, const string& svgPath)
+{
+    //the embedded data has been decoded in parallel with the parsing, the first builder of the node takes it
+    SvgImageTask* task;
+    {
+        ScopedLock lock(loaderData.key);
+        task = node->node.image.task;
+        node->node.image.task = nullptr;
+    }
+    if (task) {
+        TaskScheduler::join(task);
+        unique_ptr<Picture> picture(task->picture);
+        if (picture) {
+            ScopedLock lock(loaderData.key);
+            loaderData.images.push(task->decoded);
+        }
+        task->picture = nullptr;
+        task->decoded = nullptr;
+        delete(task);
+        return picture;
+    }
+
     auto picture = Picture::gen();
 
     TaskScheduler::async(false);    //force to load a picture on the same thread
 
     const char* href = node->node.image.href;
     if (!strncmp(href, "data:", sizeof("data:") - 1)) {
-        href += sizeof("data:") - 1;
-        const char* mimetype;
-        imageMimeTypeEncoding encoding;
-        if (!_isValidImageMimeTypeAndEncoding(&href, &mimetype, &encoding)) return nullptr; //not allowed mime type or encoding
-        char *decoded = nullptr;
-        if (encoding == imageMimeTypeEncoding::base64) {
-            auto size = b64Decode(href, strlen(href), &decoded);
-            if (picture->load(decoded, size, mimetype, false) != Result::Success) {
-                free(decoded);
-                TaskScheduler::async(true);
-                return nullptr;
-            }
-        } else {
-            auto size = svgUtilURLDecode(href, &decoded);
-            if (picture->load(decoded, size, mimetype, false) != Result::Success) {
-                free(decoded);
-                TaskScheduler::async(true);
-                return nullptr;
-            }
+        char* decoded = nullptr;
+        if (!_imageDecode(href + sizeof("data:") - 1, picture.get(), &decoded)) {
+            TaskScheduler::async(true);
+            return nullptr;
         }
+        ScopedLock lock(loaderData.key);
         loaderData.images.push(decoded);
     } else {
         if (!strncmp(href, "file://", sizeof("file://") - 1)) href += sizeof("file://") - 1;
@@ -617,23 +729,38 @@ static unique_ptr<Picture> _imageBuildHelper(SvgLoaderData& loaderData, SvgNode*
             TaskScheduler::async(true);
             return nullptr;
         }
+        _imageFullSize(picture.get());
     }
 
     TaskScheduler::async(true);
 
-    float w, h;
-    Matrix m = {1, 0, 0, 0, 1, 0, 0, 0, 1};
-    if (picture->size(&w, &h) == Result::Success && w  > 0 && h > 0) {
-        auto sx = node->node.image.w / w;
-        auto sy = node->node.image.h / h;
-        m = {sx, 0, node->node.image.x, 0, sy, node->node.image.y, 0, 0, 1};
+    return picture;
+}
+
+
+static unique_ptr<Picture> _imageBuildHelper(SvgLoaderData& loaderData, SvgNode* node, const Box& vBox, const string& svgPath)
+{
+    if (!node->node.image.href || !strlen(node->node.image.href)) return nullptr;
+
+    //the instances of <use> and the repeated builds of a mask or a clip share the image loaded once,
+    //the instances resolve through their source which holds the prefetched data
+    auto origin = node->source ? node->source : node;
+    Picture* shared = nullptr;
+    {
+        ScopedLock lock(loaderData.key);
+        if (origin->node.image.picture) shared = (Picture*)origin->node.image.picture->duplicate();
     }
-    if (node->transform) m = *node->transform * m;
-    picture->transform(m);
+    if (shared) return _imageSetup(loaderData, node, unique_ptr<Picture>(shared), vBox, svgPath);
 
-    _applyComposition(loaderData, picture.get(), node, vBox, svgPath);
+    auto picture = _imageLoad(loaderData, origin, svgPath);
+    if (!picture) return nullptr;
 
-    return picture;
+    {
+        ScopedLock lock(loaderData.key);
+        if (!origin->node.image.picture) origin->node.image.picture = (Picture*)picture->duplicate();
+    }
+
+    return _imageSetup(loaderData, node, std::move(picture), vBox, svgPath);
 }
 
 
@@ -825,7 +952,65 @@ static unique_ptr<Text> _textBuildHelper(SvgLoaderData& loaderData, const SvgNod
 }
 
 
-static unique_ptr<Scene> _sceneBuildHelper(SvgLoaderData& loaderData, const SvgNode* node, const Box& vBox, const string& svgPath, bool mask, int depth, bool* isMaskWhite)
+static unique_ptr<Paint> _childBuildHelper(SvgLoaderData& loaderData, const SvgNode* node, SvgNode* child, const Box& vBox, const string& svgPath, int depth, bool* isMaskWhite)
+{
+    if (_isGroupType(child->type)) {
+        if (child->type == SvgNodeType::Use)
+            return _useBuildHelper(loaderData, child, vBox, svgPath, depth + 1, isMaskWhite);
+        else if (!(child->type == SvgNodeType::Symbol && node->type != SvgNodeType::Use))
+            return _sceneBuildHelper(loaderData, child, vBox, svgPath, false, depth + 1, isMaskWhite);
+    } else if (child->type == SvgNodeType::Image) {
+        auto image = _imageBuildHelper(loaderData, child, vBox, svgPath);
+        if (image && isMaskWhite) *isMaskWhite = false;
+        return image;
+    } else if (child->type == SvgNodeType::Text) {
+        return _textBuildHelper(loaderData, child, vBox, svgPath);
+    } else if (child->type != SvgNodeType::Mask) {
+        auto shape = _shapeBuildHelper(loaderData, child, vBox, svgPath);
+        if (shape && isMaskWhite) {
+            uint8_t r, g, b;
+            shape->fillColor(&r, &g, &b);
+            if (shape->fill() || r < 255 || g < 255 || b < 255 || shape->strokeFill() ||
+                (shape->strokeColor(&r, &g, &b) == Result::Success && (r < 255 || g < 255 || b < 255))) {
+                *isMaskWhite = false;
+            }
+        }
+        return shape;
+    }
+    return nullptr;
+}
+
+
+static void _appendChild(SvgLoaderData& loaderData, Scene* scene, const SvgNode* node, SvgNode* child, const Box& vBox, const string& svgPath, int depth, bool* isMaskWhite)
+{
+    if (auto paint = _childBuildHelper(loaderData, node, child, vBox, svgPath, depth, isMaskWhite)) scene->push(std::move(paint));
+}
+
+
+static void _buildChild(void* data, uint32_t idx)
+{
+    auto job = static_cast<SvgBuildJob*>(data);
+    job->paints[idx] = _childBuildHelper(*job->loaderData, job->node, job->node->child[idx], *job->vBox, *job->svgPath, job->depth, nullptr).release();
+}
+
+
+//The subtrees of the siblings are built concurrently, then joined in the document order.
+static void _appendChildren(SvgLoaderData& loaderData, Scene* scene, const SvgNode* node, const Box& vBox, const string& svgPath, int depth)
+{
+    auto paints = (Paint**)calloc(node->child.count, sizeof(Paint*));
+    if (!paints) return;
+
+    SvgBuildJob job = {&loaderData, node, &vBox, &svgPath, depth, paints};
+    TaskScheduler::parallel(node->child.count, _buildChild, &job);
+
+    for (uint32_t i = 0; i < node->child.count; ++i) {
+        if (paints[i]) scene->push(unique_ptr<Paint>(paints[i]));
+    }
+    free(paints);
+}
+
+
+static unique_ptr<Scene> _sceneBuildHelper(SvgLoaderData& loaderData, const SvgNode* node, const Box& vBox, const string& svgPath, bool mask, int depth, bool* isMaskWhite, bool parallel)
 {
     /* Exception handling: Prevent invalid SVG data input.
        The size is the arbitrary value, we need an experimental size. */
@@ -840,35 +1025,15 @@ static unique_ptr<Scene> _sceneBuildHelper(SvgLoaderData& loaderData, const SvgN
         if (!mask && node->transform && node->type != SvgNodeType::Symbol) scene->transform(*node->transform);
 
         if (node->style->display && node->style->opacity != 0) {
-            auto child = node->child.data;
-            for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
-                if (_isGroupType((*child)->type)) {
-                    if ((*child)->type == SvgNodeType::Use)
-                        scene->push(_useBuildHelper(loaderData, *child, vBox, svgPath, depth + 1, isMaskWhite));
-                    else if (!((*child)->type == SvgNodeType::Symbol && node->type != SvgNodeType::Use))
-                        scene->push(_sceneBuildHelper(loaderData, *child, vBox, svgPath, false, depth + 1, isMaskWhite));
-                } else if ((*child)->type == SvgNodeType::Image) {
-                    auto image = _imageBuildHelper(loaderData, *child, vBox, svgPath);
-                    if (image) {
-                        scene->push(std::move(image));
-                        if (isMaskWhite) *isMaskWhite = false;
-                    }
-                } else if ((*child)->type == SvgNodeType::Text) {
-                    auto text = _textBuildHelper(loaderData, *child, vBox, svgPath);
-                    if (text) scene->push(std::move(text));
-                } else if ((*child)->type != SvgNodeType::Mask) {
-                    auto shape = _shapeBuildHelper(loaderData, *child, vBox, svgPath);
-                    if (shape) {
-                        if (isMaskWhite) {
-                            uint8_t r, g, b;
-                            shape->fillColor(&r, &g, &b);
-                            if (shape->fill() || r < 255 || g < 255 || b < 255 || shape->strokeFill() ||
-                                (shape->strokeColor(&r, &g, &b) == Result::Success && (r < 255 || g < 255 || b < 255))) {
-                                *isMaskWhite = false;
-                            }
-                        }
-                        scene->push(std::move(shape));
-                    }
+            if (parallel && node->child.count > 1 && TaskScheduler::threads() > 0) {
+                _appendChildren(loaderData, scene.get(), node, vBox, svgPath, depth);
+            //a single group wrapping the whole contents, its children are the siblings to be built concurrently.
+            } else if (parallel && node->child.count == 1 && node->child[0]->type == SvgNodeType::G) {
+                scene->push(_sceneBuildHelper(loaderData, node->child[0], vBox, svgPath, false, depth + 1, isMaskWhite, true));
+            } else {
+                auto child = node->child.data;
+                for (uint32_t i = 0; i < node->child.count; ++i, ++child) {
+                    _appendChild(loaderData, scene.get(), node, *child, vBox, svgPath, depth, isMaskWhite);
                 }
             }
             _applyComposition(loaderData, scene.get(), node, vBox, svgPath);
@@ -900,20 +1065,9 @@ static void _updateInvalidViewSize(const Scene* scene, Box& vBox, float& w, floa
     if (!validHeight) h *= vBox.h;
 }
 
-/************************************************************************/
-/* External Class Implementation                                        */
-/************************************************************************/
 
-Scene* svgSceneBuild(SvgLoaderData& loaderData, Box vBox, float w, float h, AspectRatioAlign align, AspectRatioMeetOrSlice meetOrSlice, const string& svgPath, SvgViewFlag viewFlag)
+static Scene* _rootBuildHelper(unique_ptr<Scene> docNode, const Box& vBox, float w, float h, AspectRatioAlign align, AspectRatioMeetOrSlice meetOrSlice)
 {
-    //TODO: aspect ratio is valid only if viewBox was set
-
-    if (!loaderData.doc || (loaderData.doc->type != SvgNodeType::Doc)) return nullptr;
-
-    auto docNode = _sceneBuildHelper(loaderData, loaderData.doc, vBox, svgPath, false, 0);
-
-    if (!(viewFlag & SvgViewFlag::Viewbox)) _updateInvalidViewSize(docNode.get(), vBox, w, h, viewFlag);
-
     if (!tvg::equal(w, vBox.w) || !tvg::equal(h, vBox.h)) {
         Matrix m = _calculateAspectRatioMatrix(align, meetOrSlice, w, h, vBox);
         docNode->transform(m);
@@ -931,6 +1085,45 @@ Scene* svgSceneBuild(SvgLoaderData& loaderData, Box vBox, float w, float h, Aspe
     auto root = Scene::gen();
     root->push(std::move(compositeLayer));
 
+    return root.release();
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+void SvgImageTask::run(TVG_UNUSED unsigned tid)
+{
+    auto picture = Picture::gen();
+
+    TaskScheduler::async(false);    //the image decoding belongs to this task
+
+    if (_imageDecode(href + sizeof("data:") - 1, picture.get(), &decoded)) this->picture = picture.release();
+
+    TaskScheduler::async(true);
+}
+
+
+SvgImageTask::~SvgImageTask()
+{
+    TaskScheduler::join(this);
+    delete(picture);
+    free(decoded);
+}
+
+
+Scene* svgSceneBuild(SvgLoaderData& loaderData, Box vBox, float w, float h, AspectRatioAlign align, AspectRatioMeetOrSlice meetOrSlice, const string& svgPath, SvgViewFlag viewFlag)
+{
+    //TODO: aspect ratio is valid only if viewBox was set
+
+    if (!loaderData.doc || (loaderData.doc->type != SvgNodeType::Doc)) return nullptr;
+
+    auto docNode = _sceneBuildHelper(loaderData, loaderData.doc, vBox, svgPath, false, 0, nullptr, true);
+
+    if (!(viewFlag & SvgViewFlag::Viewbox)) _updateInvalidViewSize(docNode.get(), vBox, w, h, viewFlag);
+
+    auto root = _rootBuildHelper(std::move(docNode), vBox, w, h, align, meetOrSlice);
+
     loaderData.doc->node.doc.vx = vBox.x;
     loaderData.doc->node.doc.vy = vBox.y;
     loaderData.doc->node.doc.vw = vBox.w;
@@ -938,5 +1131,35 @@ Scene* svgSceneBuild(SvgLoaderData& loaderData, Box vBox, float w, float h, Aspe
     loaderData.doc->node.doc.w = w;
     loaderData.doc->node.doc.h = h;
 
-    return root.release();
+    return root;
+}
+
+
+Scene* svgSceneStart(SvgLoaderData& loaderData, const Box& vBox, float w, float h, AspectRatioAlign align, AspectRatioMeetOrSlice meetOrSlice, Scene** layer)
+{
+    if (!loaderData.doc || (loaderData.doc->type != SvgNodeType::Doc)) return nullptr;
+
+    auto docNode = Scene::gen();
+    if (loaderData.doc->transform) docNode->transform(*loaderData.doc->transform);
+
+    *layer = docNode.get();
+
+    return _rootBuildHelper(std::move(docNode), vBox, w, h, align, meetOrSlice);
+}
+
+
+void svgSceneAppend(SvgLoaderData& loaderData, Scene* layer, SvgNode* node, const Box& vBox, const string& svgPath)
+{
+    auto doc = loaderData.doc;
+    if (doc->style->display && doc->style->opacity != 0) _appendChild(loaderData, layer, doc, node, vBox, svgPath, 0, nullptr);
+}
+
+
+void svgSceneFinish(SvgLoaderData& loaderData, Scene* layer, const Box& vBox, const string& svgPath)
+{
+    auto doc = loaderData.doc;
+    if (doc->style->display && doc->style->opacity != 0) {
+        _applyComposition(loaderData, layer, doc, vBox, svgPath);
+        layer->opacity(doc->style->opacity);
+    }
 }
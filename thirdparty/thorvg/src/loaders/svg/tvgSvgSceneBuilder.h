@@ -27,4 +27,9 @@
 
 Scene* svgSceneBuild(SvgLoaderData& loaderData, Box vBox, float w, float h, AspectRatioAlign align, AspectRatioMeetOrSlice meetOrSlice, const string& svgPath, SvgViewFlag viewFlag);
 
+//progressive building: the top-level nodes of the document are appended to the layer one by one.
+Scene* svgSceneStart(SvgLoaderData& loaderData, const Box& vBox, float w, float h, AspectRatioAlign align, AspectRatioMeetOrSlice meetOrSlice, Scene** layer);
+void svgSceneAppend(SvgLoaderData& loaderData, Scene* layer, SvgNode* node, const Box& vBox, const string& svgPath);
+void svgSceneFinish(SvgLoaderData& loaderData, Scene* layer, const Box& vBox, const string& svgPath);
+
 #endif //_TVG_SVG_SCENE_BUILDER_H_
@@ -32,6 +32,20 @@
     #include <stdlib.h>
 #endif
 
+//XML_SCALAR_SCAN builds the scalar tokenizer only, the reference of the vectorized one.
+#if defined(XML_SCALAR_SCAN)
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #include <emmintrin.h>
+    #define XML_SSE2_SCAN
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #include <arm_neon.h>
+    #define XML_NEON_SCAN
+#endif
+
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+
 #include "tvgXmlParser.h"
 #include "tvgStr.h"
 
@@ -39,6 +53,72 @@
 /* Internal Class Implementation                                        */
 /************************************************************************/
 
+#if defined(XML_SSE2_SCAN) || defined(XML_NEON_SCAN)
+
+static inline uint32_t _ctz(uint64_t mask)
+{
+#ifdef _MSC_VER
+    unsigned long idx;
+    #if defined(_M_X64) || defined(_M_ARM64)
+        _BitScanForward64(&idx, mask);
+    #else
+        if (_BitScanForward(&idx, (unsigned long)mask)) return idx;
+        _BitScanForward(&idx, (unsigned long)(mask >> 32));
+        idx += 32;
+    #endif
+    return idx;
+#else
+    return __builtin_ctzll(mask);
+#endif
+}
+
+#endif
+
+
+/* Finds the first quote or tag bracket, 32 bytes per step.
+   The tail shorter than a step goes through the scalar loop. */
+static const char* _simpleXmlFindStructural(const char* itr, const char* itrEnd)
+{
+#if defined(XML_SSE2_SCAN)
+    const auto dquote = _mm_set1_epi8('"');
+    const auto squote = _mm_set1_epi8('\'');
+    const auto open = _mm_set1_epi8('<');
+    const auto close = _mm_set1_epi8('>');
+
+    auto match = [&](const char* p) -> uint32_t {
+        auto v = _mm_loadu_si128((const __m128i*)p);
+        auto m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, dquote), _mm_cmpeq_epi8(v, squote)), _mm_or_si128(_mm_cmpeq_epi8(v, open), _mm_cmpeq_epi8(v, close)));
+        return (uint32_t)_mm_movemask_epi8(m);
+    };
+
+    for (; itrEnd - itr >= 32; itr += 32) {
+        auto mask = match(itr) | (match(itr + 16) << 16);
+        if (mask) return itr + _ctz(mask);
+    }
+#elif defined(XML_NEON_SCAN)
+    const auto dquote = vdupq_n_u8('"');
+    const auto squote = vdupq_n_u8('\'');
+    const auto open = vdupq_n_u8('<');
+    const auto close = vdupq_n_u8('>');
+
+    //4 bits per byte, the usual substitution of movemask
+    auto match = [&](const char* p) -> uint64_t {
+        auto v = vld1q_u8((const uint8_t*)p);
+        auto m = vorrq_u8(vorrq_u8(vceqq_u8(v, dquote), vceqq_u8(v, squote)), vorrq_u8(vceqq_u8(v, open), vceqq_u8(v, close)));
+        return vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(m), 4)), 0);
+    };
+
+    for (; itrEnd - itr >= 32; itr += 32) {
+        if (auto mask = match(itr)) return itr + (_ctz(mask) >> 2);
+        if (auto mask = match(itr + 16)) return itr + 16 + (_ctz(mask) >> 2);
+    }
+#endif
+    for (; itr < itrEnd; itr++) {
+        if (*itr == '"' || *itr == '\'' || *itr == '<' || *itr == '>') return itr;
+    }
+    return itrEnd;
+}
+
 bool _isIgnoreUnsupportedLogAttributes(TVG_UNUSED const char* tagAttribute, TVG_UNUSED const char* tagValue)
 {
 #ifdef THORVG_LOG_ENABLED
@@ -105,7 +185,7 @@ static const char* _simpleXmlSkipXmlEntities(const char* itr, const char* itrEnd
     auto p = itr;
     while (itr < itrEnd && *itr == '&') {
         for (int i = 0; i < NUMBER_OF_XML_ENTITIES; ++i) {
-            if (strncmp(itr, xmlEntity[i], xmlEntityLength[i]) == 0) {
+            if (itrEnd - itr >= xmlEntityLength[i] && memcmp(itr, xmlEntity[i], xmlEntityLength[i]) == 0) {
                 itr += xmlEntityLength[i];
                 break;
             }
@@ -171,43 +251,44 @@ static const char* _simpleXmlFindStartTag(const char* itr, const char* itrEnd)
 
 static const char* _simpleXmlFindEndTag(const char* itr, const char* itrEnd)
 {
-    bool insideQuote[2] = {false, false}; // 0: ", 1: '
-    for (; itr < itrEnd; itr++) {
-        if (*itr == '"' && !insideQuote[1]) insideQuote[0] = !insideQuote[0];
-        if (*itr == '\'' && !insideQuote[0]) insideQuote[1] = !insideQuote[1];
-        if (!insideQuote[0] && !insideQuote[1]) {
-            if ((*itr == '>') || (*itr == '<'))
-                return itr;
-        }
+    while (itr < itrEnd) {
+        itr = _simpleXmlFindStructural(itr, itrEnd);
+        if (itr == itrEnd) break;
+        if ((*itr == '>') || (*itr == '<')) return itr;
+        //brackets inside of the quoted value don't count
+        itr = (const char*)memchr(itr + 1, *itr, itrEnd - itr - 1);
+        if (!itr) break;
+        ++itr;
     }
     return nullptr;
 }
 
 
-static const char* _simpleXmlFindEndCommentTag(const char* itr, const char* itrEnd)
+static const char* _simpleXmlFindEndMark(const char* itr, const char* itrEnd, char mark)
 {
-    for (; itr < itrEnd; itr++) {
-        if ((*itr == '-') && ((itr + 1 < itrEnd) && (*(itr + 1) == '-')) && ((itr + 2 < itrEnd) && (*(itr + 2) == '>'))) return itr + 2;
+    while ((itr = (const char*)memchr(itr, mark, itrEnd - itr))) {
+        if ((itr + 2 < itrEnd) && (itr[1] == mark) && (itr[2] == '>')) return itr + 2;
+        ++itr;
     }
     return nullptr;
 }
 
 
+static const char* _simpleXmlFindEndCommentTag(const char* itr, const char* itrEnd)
+{
+    return _simpleXmlFindEndMark(itr, itrEnd, '-');
+}
+
+
 static const char* _simpleXmlFindEndCdataTag(const char* itr, const char* itrEnd)
 {
-    for (; itr < itrEnd; itr++) {
-        if ((*itr == ']') && ((itr + 1 < itrEnd) && (*(itr + 1) == ']')) && ((itr + 2 < itrEnd) && (*(itr + 2) == '>'))) return itr + 2;
-    }
-    return nullptr;
+    return _simpleXmlFindEndMark(itr, itrEnd, ']');
 }
 
 
 static const char* _simpleXmlFindDoctypeChildEndTag(const char* itr, const char* itrEnd)
 {
-    for (; itr < itrEnd; itr++) {
-        if (*itr == '>') return itr;
-    }
-    return nullptr;
+    return (const char*)memchr(itr, '>', itrEnd - itr);
 }
 
 
@@ -331,7 +412,7 @@ bool simpleXmlParseAttributes(const char* buf, unsigned bufLength, simpleXMLAttr
         if (value == itrEnd) goto error;
 
         if ((*value == '"') || (*value == '\'')) {
-            valueEnd = (const char*)memchr(value + 1, *value, itrEnd - value);
+            valueEnd = (const char*)memchr(value + 1, *value, itrEnd - value - 1);
             if (!valueEnd) goto error;
             value++;
         } else {
@@ -349,7 +430,13 @@ bool simpleXmlParseAttributes(const char* buf, unsigned bufLength, simpleXMLAttr
         tval = tmpBuf + (keyEnd - key) + 1;
         int i = 0;
         while (value < valueEnd) {
-            value = _simpleXmlSkipXmlEntities(value, valueEnd);
+            //copy the runs between the entities at once
+            auto amp = (const char*)memchr(value, '&', valueEnd - value);
+            if (!amp) amp = valueEnd;
+            memcpy(tval + i, value, amp - value);
+            i += amp - value;
+            if (amp == valueEnd) break;
+            value = _simpleXmlSkipXmlEntities(amp, valueEnd);
             tval[i++] = *value;
             value++;
         }
@@ -372,7 +459,8 @@ error:
 }
 
 
-bool simpleXmlParse(const char* buf, unsigned bufLength, bool strip, simpleXMLCb func, const void* data)
+//With the parsed, the markup cut off by the end of the buffer is left to the following data and the parsed length is returned.
+bool simpleXmlParse(const char* buf, unsigned bufLength, bool strip, simpleXMLCb func, const void* data, unsigned* parsed)
 {
     const char *itr = buf, *itrEnd = buf + bufLength;
 
@@ -380,8 +468,11 @@ bool simpleXmlParse(const char* buf, unsigned bufLength, bool strip, simpleXMLCb
 
     while (itr < itrEnd) {
         if (itr[0] == '<') {
-            //Invalid case
-            if (itr + 1 >= itrEnd) return false;
+            //Invalid case, or the markup continues in the following data
+            if (itr + 1 >= itrEnd) {
+                if (parsed) break;
+                return false;
+            }
 
             size_t toff = 0;
             SimpleXMLType type = _getXMLType(itr, itrEnd, toff);
@@ -434,6 +525,7 @@ bool simpleXmlParse(const char* buf, unsigned bufLength, bool strip, simpleXMLCb
 
                 itr = p + 1;
             } else {
+                if (parsed) break;
                 return false;
             }
         } else {
@@ -449,7 +541,11 @@ bool simpleXmlParse(const char* buf, unsigned bufLength, bool strip, simpleXMLCb
             }
 
             p = _simpleXmlFindStartTag(itr, itrEnd);
-            if (!p) p = itrEnd;
+            if (!p) {
+                //the text continues in the following data
+                if (parsed) break;
+                p = itrEnd;
+            }
 
             end = p;
             if (strip) end = _unskipWhiteSpacesAndXmlEntities(end, itr);
@@ -461,6 +557,7 @@ bool simpleXmlParse(const char* buf, unsigned bufLength, bool strip, simpleXMLCb
             itr = p;
         }
     }
+    if (parsed) *parsed = (unsigned)(itr - buf);
     return true;
 }
 
@@ -532,7 +629,8 @@ bool simpleXmlParseW3CAttribute(const char* buf, unsigned bufLength, simpleXMLAt
 
 /*
  * Supported formats:
- * tag {}, .name {}, tag.name{}
+ * tag {}, .name {}, tag.name{}, #name {}, tag#name {}
+ * The name of an id selector keeps its leading '#'.
  */
 const char* simpleXmlParseCSSAttribute(const char* buf, unsigned bufLength, char** tag, char** name, const char** attrs, unsigned* attrsLength)
 {
@@ -555,16 +653,17 @@ const char* simpleXmlParseCSSAttribute(const char* buf, unsigned bufLength, char
     const char *p;
 
     itrEnd = _simpleXmlUnskipWhiteSpace(itrEnd, itr);
-    if (*(itrEnd - 1) == '.') return nullptr;
+    if (*(itrEnd - 1) == '.' || *(itrEnd - 1) == '#') return nullptr;
 
     for (p = itr; p < itrEnd; p++) {
-        if (*p == '.') break;
+        if (*p == '.' || *p == '#') break;
     }
 
     if (p == itr) *tag = strdup("all");
     else *tag = strDuplicate(itr, p - itr);
 
     if (p == itrEnd) *name = nullptr;
+    else if (*p == '#') *name = strDuplicate(p, itrEnd - p);
     else *name = strDuplicate(p + 1, itrEnd - p - 1);
 
     return (nextElement ? nextElement + 1 : nullptr);
@@ -145,12 +145,33 @@ struct SwFill
         float invA, a;
     };
 
+    //the nine-slice mapping of an axis, from the sliced size to the image
+    struct SwSlice {
+        float d0, d1;               //the inner part in the sliced size
+        float k0, k1, k2;           //the scales of the three parts
+        float s0, s1;               //the inner part in the image
+    };
+
+    struct SwPattern {
+        float a11, a12, a13;        //the inverse transform to the image pixels
+        float a21, a22, a23;
+        const uint32_t* data;       //premultiplied, in the channel order of the target
+        uint32_t w, h, stride;
+        uint32_t level;             //the level of a tiled image, its pixels are 2^level of the image
+        SwSlice sx, sy;
+        uint8_t opacity;
+        bool translated;            //not scaled nor rotated, the pixels are copied as they are
+        bool sliced;
+    };
+
     union {
         SwLinear linear;
         SwRadial radial;
+        SwPattern pattern;
     };
 
     uint32_t* ctable;
+    uint32_t* image;                //the converted copy of the pattern image
     FillSpread spread;
 
     bool solid = false; //solid color fill with the last color from colorStops
@@ -232,6 +253,7 @@ struct SwImage
     int32_t      oy = 0;         //offset y
     float        scale;
     uint8_t      channelSize;
+    FilterMethod filter = FilterMethod::Bilinear;
 
     bool         direct = false;  //draw image directly (with offset)
     bool         scaled = false;  //draw scaled image
@@ -542,6 +564,12 @@ void fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint3
 void fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a);                          //blending + BlendingMethod(op2) ver.
 void fillRadial(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity);     //matting ver.
 
+void fillPattern(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, SwMask op, uint8_t a);                                            //composite masking ver.
+void fillPattern(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwMask op, uint8_t a);                              //direct masking ver.
+void fillPattern(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, uint8_t a);                                        //blending ver.
+void fillPattern(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a);                         //blending + BlendingMethod(op2) ver.
+void fillPattern(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity);    //matting ver.
+
 SwRle* rleRender(SwRle* rle, const SwOutline* outline, const SwBBox& renderRegion, bool antiAlias);
 SwRle* rleRender(const SwBBox* bbox);
 void rleFree(SwRle* rle);
@@ -573,6 +601,7 @@ void rasterXYFlip(uint32_t* src, uint32_t* dst, int32_t stride, int32_t w, int32
 void rasterUnpremultiply(RenderSurface* surface);
 void rasterPremultiply(RenderSurface* surface);
 bool rasterConvertCS(RenderSurface* surface, ColorSpace to);
+bool rasterAligned(const RenderSurface* source, ColorSpace cs);
 
 bool effectGaussianBlur(SwImage& image, SwImage& buffer, const SwBBox& bbox, const RenderEffectGaussian* params);
 bool effectGaussianPrepare(RenderEffectGaussian* effect);
@@ -32,6 +32,7 @@
 #define GRADIENT_STOP_SIZE 1024
 #define FIXPT_BITS 8
 #define FIXPT_SIZE (1<<FIXPT_BITS)
+#define PATTERN_SPAN 256        //the pattern pixels sampled at once
 
 /*
  * quadratic equation with the following coefficients (rx and ry defined in the _calculateCoefficients()):
@@ -321,6 +322,164 @@ bool _prepareRadial(SwFill* fill, const RadialGradient* radial, const Matrix& tr
 }
 
 
+//the level of a tiled image is fetched whole, over this size the pattern is declined
+#define PATTERN_TILED_SIZE (4096 * 4096)
+
+//the pattern image in the channel order of the target, a copy is converted if the source isn't the one
+static bool _updatePattern(SwFill* fill, const ImagePattern* pattern, const SwSurface* surface)
+{
+    auto source = P(pattern)->surface;
+    if (!source || source->channelSize != sizeof(uint32_t) || source->w == 0 || source->h == 0) return false;
+
+    auto p = &fill->pattern;
+    p->w = source->w;
+    p->h = source->h;
+    p->level = 0;
+
+    //the alpha of the image is not scanned
+    fill->translucent = true;
+
+    free(fill->image);
+    fill->image = nullptr;
+
+    //a tiled image is fetched at the level of the scale, see _fetchPattern()
+    if (source->tiles) {
+        p->data = nullptr;
+        return true;
+    }
+
+    if (rasterAligned(source, surface->cs)) {
+        p->data = source->buf32;
+        p->stride = source->stride;
+        return true;
+    }
+
+    //the shared source is not modified, it may be drawn by the others at the same time
+    fill->image = static_cast<uint32_t*>(malloc(p->w * p->h * sizeof(uint32_t)));
+    if (!fill->image) return false;
+
+    RenderSurface image;
+    image.buf32 = fill->image;
+    image.stride = image.w = p->w;
+    image.h = p->h;
+    image.channelSize = sizeof(uint32_t);
+
+    for (uint32_t y = 0; y < p->h; ++y) {
+        memcpy(image.buf32 + y * image.stride, source->buf32 + y * source->stride, p->w * sizeof(uint32_t));
+    }
+    image.cs = source->cs;
+    image.premultiplied = source->premultiplied;
+    rasterConvertCS(&image, surface->cs);
+    rasterPremultiply(&image);
+
+    p->data = fill->image;
+    p->stride = p->w;
+    return true;
+}
+
+
+//the insets are shrunk proportionally if the size is smaller than them
+static void _slice(SwFill::SwSlice& slice, float size, float image, float lo, float hi)
+{
+    auto scale = (lo + hi > size) ? size / (lo + hi) : 1.0f;
+    auto dlo = lo * scale;
+    auto dhi = hi * scale;
+
+    slice.d0 = dlo;
+    slice.d1 = size - dhi;
+    slice.s0 = lo;
+    slice.s1 = image - hi;
+    slice.k0 = (dlo > 0.0f) ? lo / dlo : 0.0f;
+    slice.k1 = (slice.d1 > slice.d0) ? (slice.s1 - slice.s0) / (slice.d1 - slice.d0) : 0.0f;
+    slice.k2 = (dhi > 0.0f) ? hi / dhi : 0.0f;
+}
+
+
+//Fetches the whole level of a tiled image, the most reduced one not coarser than the canvas pixels.
+//The sampling wraps around and slices the image, so its visible part isn't known here.
+static bool _fetchPattern(SwFill* fill, const RenderSurface* source, const Matrix& m, const SwSurface* surface)
+{
+    auto tiles = source->tiles;
+    auto p = &fill->pattern;
+
+    auto scaleX = sqrtf((m.e11 * m.e11) + (m.e21 * m.e21));
+    auto scaleY = sqrtf((m.e22 * m.e22) + (m.e12 * m.e12));
+    auto scale = std::max(scaleX, scaleY);
+    uint32_t level = 0;
+    while (level + 1 < tiles->levels && scale * float(2 << level) <= 1.0f) ++level;
+
+    if (p->data && level == p->level) return true;
+
+    auto w = (source->w + (1 << level) - 1) >> level;
+    auto h = (source->h + (1 << level) - 1) >> level;
+    if (size_t(w) * h > PATTERN_TILED_SIZE) {
+        TVGLOG("SW_ENGINE", "Pattern of a tiled image is declined at this scale, level(%u) size(%u x %u)", level, w, h);
+        return false;
+    }
+
+    p->data = nullptr;
+    free(fill->image);
+    fill->image = static_cast<uint32_t*>(malloc(size_t(w) * h * sizeof(uint32_t)));
+    if (!fill->image) return false;
+
+    RenderSurface image;
+    image.buf32 = fill->image;
+    image.stride = image.w = w;
+    image.h = h;
+    image.channelSize = sizeof(uint32_t);
+    image.cs = ColorSpace::ARGB8888;
+    image.premultiplied = true;
+    if (!tiles->fetch({0, 0, int32_t(w), int32_t(h)}, level, image.buf32, image.stride)) return false;
+    rasterConvertCS(&image, surface->cs);
+
+    p->data = fill->image;
+    p->w = p->stride = w;
+    p->h = h;
+    p->level = level;
+    return true;
+}
+
+
+static bool _preparePattern(SwFill* fill, const ImagePattern* pattern, const Matrix& transform, const SwSurface* surface)
+{
+    auto p = &fill->pattern;
+
+    auto m = pattern->transform();
+    if (identity((const Matrix*)(&m))) m = transform;
+    else m = transform * m;
+
+    //the pattern works in the pixels of the level, its size is rounded up so the image is mapped onto it exactly
+    auto source = P(pattern)->surface;
+    if (source && source->tiles && !_fetchPattern(fill, source, m, surface)) return false;
+    auto unitX = 1.0f, unitY = 1.0f;
+    if (p->level > 0) {
+        unitX = float(source->w) / float(p->w);
+        unitY = float(source->h) / float(p->h);
+        m = m * Matrix{unitX, 0, 0, 0, unitY, 0, 0, 0, 1};
+    }
+
+    Matrix inv;
+    if (!inverse(&m, &inv)) return false;
+
+    p->a11 = inv.e11;
+    p->a12 = inv.e12;
+    p->a13 = inv.e13;
+    p->a21 = inv.e21;
+    p->a22 = inv.e22;
+    p->a23 = inv.e23;
+
+    auto impl = P(pattern);
+    p->sliced = impl->sliced;
+    if (p->sliced) {
+        _slice(p->sx, impl->w / unitX, float(p->w), impl->insets[0] / unitX, impl->insets[2] / unitX);
+        _slice(p->sy, impl->h / unitY, float(p->h), impl->insets[1] / unitY, impl->insets[3] / unitY);
+    }
+    p->translated = !p->sliced && tvg::equal(p->a11, 1.0f) && tvg::equal(p->a22, 1.0f) && tvg::zero(p->a12) && tvg::zero(p->a21);
+
+    return true;
+}
+
+
 static inline uint32_t _clamp(const SwFill* fill, int32_t pos)
 {
     switch (fill->spread) {
@@ -360,6 +519,94 @@ static inline uint32_t _pixel(const SwFill* fill, float pos)
 }
 
 
+static inline int32_t _wrap(FillSpread spread, int32_t i, int32_t size)
+{
+    switch (spread) {
+        case FillSpread::Pad: {
+            if (i < 0) return 0;
+            if (i >= size) return size - 1;
+            return i;
+        }
+        case FillSpread::Repeat: {
+            i %= size;
+            return (i < 0) ? i + size : i;
+        }
+        case FillSpread::Reflect: {
+            auto limit = size * 2;
+            i %= limit;
+            if (i < 0) i += limit;
+            return (i < size) ? i : limit - i - 1;
+        }
+    }
+    return 0;
+}
+
+
+//far from the image, the precision doesn't matter
+static inline int32_t _floor(float v)
+{
+    if (v < -1.0e9f) v = -1.0e9f;
+    else if (v > 1.0e9f) v = 1.0e9f;
+    return static_cast<int32_t>(floorf(v));
+}
+
+
+static inline float _unslice(const SwFill::SwSlice& slice, float pos)
+{
+    if (pos < slice.d0) return pos * slice.k0;
+    if (pos < slice.d1) return slice.s0 + (pos - slice.d0) * slice.k1;
+    return slice.s1 + (pos - slice.d1) * slice.k2;
+}
+
+
+//samples the premultiplied pixels of the pattern at the span, the opacity applied
+static void _fetch(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len)
+{
+    auto p = &fill->pattern;
+    auto spread = fill->spread;
+    auto w = static_cast<int32_t>(p->w);
+    auto h = static_cast<int32_t>(p->h);
+
+    //the image pixels are on the canvas pixels, copied without the filtering
+    if (p->translated) {
+        auto row = p->data + _wrap(spread, _floor(y + 0.5f + p->a23), h) * p->stride;
+        auto ix = _floor(x + 0.5f + p->a13);
+        if (spread == FillSpread::Repeat) {
+            ix = _wrap(spread, ix, w);
+            for (uint32_t i = 0; i < len; ) {
+                auto n = std::min(len - i, uint32_t(w - ix));
+                memcpy(dst + i, row + ix, n * sizeof(uint32_t));
+                i += n;
+                ix = 0;
+            }
+        } else {
+            for (uint32_t i = 0; i < len; ++i) dst[i] = row[_wrap(spread, ix + int32_t(i), w)];
+        }
+    //bilinear
+    } else {
+        auto fx = (x + 0.5f) * p->a11 + (y + 0.5f) * p->a12 + p->a13;
+        auto fy = (x + 0.5f) * p->a21 + (y + 0.5f) * p->a22 + p->a23;
+        for (uint32_t i = 0; i < len; ++i, fx += p->a11, fy += p->a21) {
+            auto u = (p->sliced ? _unslice(p->sx, fx) : fx) - 0.5f;
+            auto v = (p->sliced ? _unslice(p->sy, fy) : fy) - 0.5f;
+            auto iu = _floor(u);
+            auto iv = _floor(v);
+            auto du = static_cast<uint8_t>((u - iu) * 255.0f);
+            auto dv = static_cast<uint8_t>((v - iv) * 255.0f);
+            auto r0 = p->data + _wrap(spread, iv, h) * p->stride;
+            auto r1 = p->data + _wrap(spread, iv + 1, h) * p->stride;
+            auto x0 = _wrap(spread, iu, w);
+            auto x1 = _wrap(spread, iu + 1, w);
+            dst[i] = INTERPOLATE(INTERPOLATE(r1[x1], r1[x0], du), INTERPOLATE(r0[x1], r0[x0], du), dv);
+        }
+    }
+
+    if (p->opacity < 255) {
+        for (uint32_t i = 0; i < len; ++i) dst[i] = ALPHA_BLEND(dst[i], p->opacity);
+    }
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -822,12 +1069,100 @@ void fillLinear(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint3
 }
 
 
+void fillPattern(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, SwMask maskOp, uint8_t a)
+{
+    uint32_t buffer[PATTERN_SPAN];
+    while (len > 0) {
+        auto n = std::min(len, uint32_t(PATTERN_SPAN));
+        _fetch(fill, buffer, y, x, n);
+        for (uint32_t i = 0; i < n; ++i, ++dst) {
+            auto src = MULTIPLY(a, A(buffer[i]));
+            *dst = maskOp(src, *dst, ~src);
+        }
+        x += n;
+        len -= n;
+    }
+}
+
+
+void fillPattern(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwMask maskOp, uint8_t a)
+{
+    uint32_t buffer[PATTERN_SPAN];
+    while (len > 0) {
+        auto n = std::min(len, uint32_t(PATTERN_SPAN));
+        _fetch(fill, buffer, y, x, n);
+        for (uint32_t i = 0; i < n; ++i, ++dst, ++cmp) {
+            auto src = MULTIPLY(A(buffer[i]), a);
+            auto tmp = maskOp(src, *cmp, 0);
+            *dst = tmp + MULTIPLY(*dst, ~tmp);
+        }
+        x += n;
+        len -= n;
+    }
+}
+
+
+void fillPattern(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, uint8_t a)
+{
+    uint32_t buffer[PATTERN_SPAN];
+    while (len > 0) {
+        auto n = std::min(len, uint32_t(PATTERN_SPAN));
+        _fetch(fill, buffer, y, x, n);
+        for (uint32_t i = 0; i < n; ++i, ++dst) {
+            *dst = op(buffer[i], *dst, a);
+        }
+        x += n;
+        len -= n;
+    }
+}
+
+
+void fillPattern(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a)
+{
+    uint32_t buffer[PATTERN_SPAN];
+    while (len > 0) {
+        auto n = std::min(len, uint32_t(PATTERN_SPAN));
+        _fetch(fill, buffer, y, x, n);
+        for (uint32_t i = 0; i < n; ++i, ++dst) {
+            auto tmp = op(buffer[i], *dst, 255);
+            auto tmp2 = op2(tmp, *dst, 255);
+            *dst = (a == 255) ? tmp2 : INTERPOLATE(tmp2, *dst, a);
+        }
+        x += n;
+        len -= n;
+    }
+}
+
+
+void fillPattern(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity)
+{
+    uint32_t buffer[PATTERN_SPAN];
+    while (len > 0) {
+        auto n = std::min(len, uint32_t(PATTERN_SPAN));
+        _fetch(fill, buffer, y, x, n);
+        for (uint32_t i = 0; i < n; ++i, ++dst, cmp += csize) {
+            *dst = opBlendNormal(buffer[i], *dst, MULTIPLY(opacity, alpha(cmp)));
+        }
+        x += n;
+        len -= n;
+    }
+}
+
+
 bool fillGenColorTable(SwFill* fill, const Fill* fdata, const Matrix& transform, SwSurface* surface, uint8_t opacity, bool ctable)
 {
     if (!fill) return false;
 
     fill->spread = fdata->spread();
 
+    //the pattern image takes the place of the color table
+    if (fdata->type() == Type::ImagePattern) {
+        auto pattern = static_cast<const ImagePattern*>(fdata);
+        if (ctable && !_updatePattern(fill, pattern, surface)) return false;
+        fill->pattern.opacity = opacity;
+        return _preparePattern(fill, pattern, transform, surface);
+    }
+
     if (fdata->type() == Type::LinearGradient) {
         if (!_prepareLinear(fill, static_cast<const LinearGradient*>(fdata), transform)) return false;
     } else if (fdata->type() == Type::RadialGradient) {
@@ -857,6 +1192,8 @@ void fillReset(SwFill* fill)
         free(fill->ctable);
         fill->ctable = nullptr;
     }
+    free(fill->image);
+    fill->image = nullptr;
     fill->translucent = false;
     fill->solid = false;
 }
@@ -867,6 +1204,7 @@ void fillFree(SwFill* fill)
     if (!fill) return;
 
     if (fill->ctable) free(fill->ctable);
+    free(fill->image);
 
     free(fill);
 }
@@ -94,6 +94,34 @@ struct FillRadial
     }
 };
 
+struct FillPattern
+{
+    void operator()(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, SwMask op, uint8_t a)
+    {
+        fillPattern(fill, dst, y, x, len, op, a);
+    }
+
+    void operator()(const SwFill* fill, uint8_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwMask op, uint8_t a)
+    {
+        fillPattern(fill, dst, y, x, len, cmp, op, a);
+    }
+
+    void operator()(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, uint8_t a)
+    {
+        fillPattern(fill, dst, y, x, len, op, a);
+    }
+
+    void operator()(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, uint8_t* cmp, SwAlpha alpha, uint8_t csize, uint8_t opacity)
+    {
+        fillPattern(fill, dst, y, x, len, cmp, alpha, csize, opacity);
+    }
+
+    void operator()(const SwFill* fill, uint32_t* dst, uint32_t y, uint32_t x, uint32_t len, SwBlender op, SwBlender op2, uint8_t a)
+    {
+        fillPattern(fill, dst, y, x, len, op, op2, a);
+    }
+};
+
 
 static inline uint8_t _alpha(uint8_t* a)
 {
@@ -261,7 +289,7 @@ static inline uint32_t _sampleSize(float scale)
 
 //Bilinear Interpolation
 //OPTIMIZE_ME: Skip the function pointer access
-static uint32_t _interpUpScaler(const uint32_t *img, TVG_UNUSED uint32_t stride, uint32_t w, uint32_t h, float sx, float sy, TVG_UNUSED int32_t miny, TVG_UNUSED int32_t maxy, TVG_UNUSED int32_t n)
+static uint32_t _interpUpScaler(const uint32_t *img, uint32_t stride, uint32_t w, uint32_t h, float sx, float sy, TVG_UNUSED int32_t miny, TVG_UNUSED int32_t maxy, TVG_UNUSED int32_t n)
 {
     auto rx = (size_t)(sx);
     auto ry = (size_t)(sy);
@@ -273,10 +301,10 @@ static uint32_t _interpUpScaler(const uint32_t *img, TVG_UNUSED uint32_t stride,
     auto dx = (sx > 0.0f) ? static_cast<uint8_t>((sx - rx) * 255.0f) : 0;
     auto dy = (sy > 0.0f) ? static_cast<uint8_t>((sy - ry) * 255.0f) : 0;
 
-    auto c1 = img[rx + ry * w];
-    auto c2 = img[rx2 + ry * w];
-    auto c3 = img[rx + ry2 * w];
-    auto c4 = img[rx2 + ry2 * w];
+    auto c1 = img[rx + ry * stride];
+    auto c2 = img[rx2 + ry * stride];
+    auto c3 = img[rx + ry2 * stride];
+    auto c4 = img[rx2 + ry2 * stride];
 
     return INTERPOLATE(INTERPOLATE(c4, c3, dx), INTERPOLATE(c2, c1, dx), dy);
 }
@@ -320,6 +348,80 @@ static uint32_t _interpDownScaler(const uint32_t *img, uint32_t stride, uint32_t
 }
 
 
+//Nearest Neighbor, the range macros keep the pixel in the image
+static uint32_t _interpNearest(const uint32_t *img, uint32_t stride, TVG_UNUSED uint32_t w, TVG_UNUSED uint32_t h, float sx, float sy, TVG_UNUSED int32_t miny, TVG_UNUSED int32_t maxy, TVG_UNUSED int32_t n)
+{
+    return img[(uint32_t)(sx + 0.5f) + (uint32_t)(sy + 0.5f) * stride];
+}
+
+
+//Catmull-Rom weights of the 4 pixels around
+static inline void _cubicWeights(float t, float* w)
+{
+    auto t2 = t * t;
+    auto t3 = t2 * t;
+    w[0] = -0.5f * t3 + t2 - 0.5f * t;
+    w[1] = 1.5f * t3 - 2.5f * t2 + 1.0f;
+    w[2] = -1.5f * t3 + 2.0f * t2 + 0.5f * t;
+    w[3] = 0.5f * t3 - 0.5f * t2;
+}
+
+
+//Bicubic Interpolation
+static uint32_t _interpBicubic(const uint32_t *img, uint32_t stride, uint32_t w, uint32_t h, float sx, float sy, TVG_UNUSED int32_t miny, TVG_UNUSED int32_t maxy, TVG_UNUSED int32_t n)
+{
+    auto fx = floorf(sx);
+    auto fy = floorf(sy);
+    float wx[4], wy[4];
+    _cubicWeights(sx - fx, wx);
+    _cubicWeights(sy - fy, wy);
+
+    int32_t xs[4];
+    for (int32_t i = 0; i < 4; ++i) {
+        xs[i] = static_cast<int32_t>(fx) + i - 1;
+        if (xs[i] < 0) xs[i] = 0;
+        else if (xs[i] >= (int32_t)w) xs[i] = w - 1;
+    }
+
+    float c[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (int32_t j = 0; j < 4; ++j) {
+        auto y = static_cast<int32_t>(fy) + j - 1;
+        if (y < 0) y = 0;
+        else if (y >= (int32_t)h) y = h - 1;
+        auto row = img + y * stride;
+        float r[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+        for (int32_t i = 0; i < 4; ++i) {
+            auto p = row[xs[i]];
+            r[0] += A(p) * wx[i];
+            r[1] += C1(p) * wx[i];
+            r[2] += C2(p) * wx[i];
+            r[3] += C3(p) * wx[i];
+        }
+        for (int32_t k = 0; k < 4; ++k) c[k] += r[k] * wy[j];
+    }
+
+    //the overshoots are clamped, the colors premultiplied not over the alpha
+    auto a = static_cast<uint32_t>(std::min(std::max(c[0] + 0.5f, 0.0f), 255.0f));
+    uint32_t ret = a << 24;
+    for (int32_t k = 1; k < 4; ++k) {
+        auto v = static_cast<uint32_t>(std::min(std::max(c[k] + 0.5f, 0.0f), float(a)));
+        ret |= v << (24 - 8 * k);
+    }
+    return ret;
+}
+
+
+typedef uint32_t(*SwScaler)(const uint32_t*, uint32_t, uint32_t, uint32_t, float, float, int32_t, int32_t, int32_t);
+
+static SwScaler _scaler(const SwImage* image)
+{
+    if (image->filter == FilterMethod::Nearest) return _interpNearest;
+    if (image->scale < DOWN_SCALE_TOLERANCE) return _interpDownScaler;
+    if (image->filter == FilterMethod::Bicubic) return _interpBicubic;
+    return _interpUpScaler;
+}
+
+
 /************************************************************************/
 /* Rect                                                                 */
 /************************************************************************/
@@ -708,7 +810,7 @@ static bool _rasterScaledMattedRleImage(SwSurface* surface, const SwImage* image
     auto span = image->rle->spans;
     auto csize = surface->compositor->image.channelSize;
     auto alpha = surface->alpha(surface->compositor->method);
-    auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
+    auto scaleMethod = _scaler(image);
     auto sampleSize = _sampleSize(image->scale);
     int32_t miny = 0, maxy = 0;
 
@@ -731,7 +833,7 @@ static bool _rasterScaledMattedRleImage(SwSurface* surface, const SwImage* image
 static bool _rasterScaledBlendingRleImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity)
 {
     auto span = image->rle->spans;
-    auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
+    auto scaleMethod = _scaler(image);
     auto sampleSize = _sampleSize(image->scale);
     int32_t miny = 0, maxy = 0;
 
@@ -762,7 +864,7 @@ static bool _rasterScaledBlendingRleImage(SwSurface* surface, const SwImage* ima
 static bool _rasterScaledRleImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity)
 {
     auto span = image->rle->spans;
-    auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
+    auto scaleMethod = _scaler(image);
     auto sampleSize = _sampleSize(image->scale);
     int32_t miny = 0, maxy = 0;
 
@@ -935,7 +1037,7 @@ static bool _rasterScaledMattedImage(SwSurface* surface, const SwImage* image, c
 
     TVGLOG("SW_ENGINE", "Scaled Matted(%d) Image [Region: %lu %lu %lu %lu]", (int)surface->compositor->method, region.min.x, region.min.y, region.max.x - region.min.x, region.max.y - region.min.y);
 
-    auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
+    auto scaleMethod = _scaler(image);
     auto sampleSize = _sampleSize(image->scale);
     int32_t miny = 0, maxy = 0;
 
@@ -964,7 +1066,7 @@ static bool _rasterScaledBlendingImage(SwSurface* surface, const SwImage* image,
     }
 
     auto dbuffer = surface->buf32 + (region.min.y * surface->stride + region.min.x);
-    auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
+    auto scaleMethod = _scaler(image);
     auto sampleSize = _sampleSize(image->scale);
     int32_t miny = 0, maxy = 0;
 
@@ -984,7 +1086,7 @@ static bool _rasterScaledBlendingImage(SwSurface* surface, const SwImage* image,
 
 static bool _rasterScaledImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity)
 {
-    auto scaleMethod = image->scale < DOWN_SCALE_TOLERANCE ? _interpDownScaler : _interpUpScaler;
+    auto scaleMethod = _scaler(image);
     auto sampleSize = _sampleSize(image->scale);
     int32_t miny = 0, maxy = 0;
 
@@ -1017,6 +1119,67 @@ static bool _rasterScaledImage(SwSurface* surface, const SwImage* image, const M
 }
 
 
+/* The nearest sampling of the plain drawing in the integers only. The pixels of an integer enlargement, ex. the HiDPI icons,
+   are repeated by the scale, the others are stepped in 32.32 fixed point. */
+static bool _rasterNearestImage(SwSurface* surface, const SwImage* image, const Matrix* itransform, const SwBBox& region, uint8_t opacity)
+{
+    //the columns in the image, the same on all the rows
+    auto column = [&](SwCoord x) -> float { return x * itransform->e11 + itransform->e13 - 0.49f; };
+    auto x0 = region.min.x;
+    auto x1 = region.max.x;
+    while (x0 < x1 && column(x0) <= -0.5f) ++x0;
+    while (x1 > x0 && (uint32_t)(column(x1 - 1) + 0.5f) >= image->w) --x1;
+    if (x0 >= x1) return true;
+
+    auto len = static_cast<uint32_t>(x1 - x0);
+    auto first = static_cast<uint32_t>(column(x0) + 0.5f);
+    //only an exact integer scale, the columns of a near one would drift away from the mapping over a long row
+    auto repeat = static_cast<uint32_t>(nearbyint(1.0f / itransform->e11));
+    if (repeat < 2 || fabsf(itransform->e11 * float(repeat) - 1.0f) > FLT_EPSILON) repeat = 0;
+
+    //the pixels of the first column might be less than the scale
+    uint32_t run = 0;
+    if (repeat > 0) {
+        while (run < len && static_cast<uint32_t>(column(x0 + run) + 0.5f) == first) ++run;
+    }
+    //32 bits of the fraction keep the steps from drifting over a long row
+    auto fx = static_cast<int64_t>((double(column(x0)) + 0.5) * 4294967296.0);
+    auto step = static_cast<int64_t>(llround(double(itransform->e11) * 4294967296.0));
+    auto limit = static_cast<int64_t>(image->w - 1);
+
+    auto buffer = surface->buf32 + (region.min.y * surface->stride + x0);
+    for (auto y = region.min.y; y < region.max.y; ++y, buffer += surface->stride) {
+        auto sy = y * itransform->e22 + itransform->e23 - 0.49f;
+        if (sy <= -0.5f || (uint32_t)(sy + 0.5f) >= image->h) continue;
+        auto row = image->buf32 + (uint32_t)(sy + 0.5f) * image->stride;
+        auto dst = buffer;
+        auto end = buffer + len;
+        if (repeat > 0) {
+            auto src = row + first;
+            auto last = row + image->w - 1;
+            auto cnt = run;
+            while (dst < end) {
+                auto c = (opacity < 255) ? ALPHA_BLEND(*src, opacity) : *src;
+                auto ia = IA(c);
+                for (auto n = std::min(cnt, uint32_t(end - dst)); n > 0; --n, ++dst) {
+                    *dst = c + ALPHA_BLEND(*dst, ia);
+                }
+                cnt = repeat;
+                if (src < last) ++src;
+            }
+        } else {
+            auto x = fx;
+            for (; dst < end; ++dst, x += step) {
+                auto c = row[std::min(x >> 32, limit)];
+                if (opacity < 255) c = ALPHA_BLEND(c, opacity);
+                *dst = c + ALPHA_BLEND(*dst, IA(c));
+            }
+        }
+    }
+    return true;
+}
+
+
 static bool _scaledImage(SwSurface* surface, const SwImage* image, const Matrix& transform, const SwBBox& region, uint8_t opacity)
 {
     Matrix itransform;
@@ -1029,6 +1192,9 @@ static bool _scaledImage(SwSurface* surface, const SwImage* image, const Matrix&
     } else if (_blending(surface)) {
         return _rasterScaledBlendingImage(surface, image, &itransform, region, opacity);
     } else {
+        if (image->filter == FilterMethod::Nearest && surface->channelSize == sizeof(uint32_t) && itransform.e11 > 0.0f) {
+            return _rasterNearestImage(surface, image, &itransform, region, opacity);
+        }
         return _rasterScaledImage(surface, image, &itransform, region, opacity);
     }
     return false;
@@ -1429,6 +1595,19 @@ static bool _rasterRadialGradientRect(SwSurface* surface, const SwBBox& region,
 }
 
 
+//the pattern image is not scanned for the opaque pixels
+static bool _rasterPatternRect(SwSurface* surface, const SwBBox& region, const SwFill* fill)
+{
+    if (_compositing(surface)) {
+        if (_matting(surface)) return _rasterGradientMattedRect<FillPattern>(surface, region, fill);
+        else return _rasterGradientMaskedRect<FillPattern>(surface, region, fill);
+    } else if (_blending(surface)) {
+        return _rasterBlendingGradientRect<FillPattern>(surface, region, fill);
+    }
+    return _rasterTranslucentGradientRect<FillPattern>(surface, region, fill);
+}
+
+
 /************************************************************************/
 /* Rle Gradient                                                         */
 /************************************************************************/
@@ -1594,6 +1773,20 @@ static bool _rasterRadialGradientRle(SwSurface* surface, const SwRle* rle, const
 }
 
 
+static bool _rasterPatternRle(SwSurface* surface, const SwRle* rle, const SwFill* fill)
+{
+    if (!rle) return false;
+
+    if (_compositing(surface)) {
+        if (_matting(surface)) return _rasterGradientMattedRle<FillPattern>(surface, rle, fill);
+        else return _rasterGradientMaskedRle<FillPattern>(surface, rle, fill);
+    } else if (_blending(surface)) {
+        return _rasterBlendingGradientRle<FillPattern>(surface, rle, fill);
+    }
+    return _rasterTranslucentGradientRle<FillPattern>(surface, rle, fill);
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -1740,9 +1933,11 @@ bool rasterGradientShape(SwSurface* surface, SwShape* shape, const Fill* fdata,
     if (shape->fastTrack) {
         if (type == Type::LinearGradient) return _rasterLinearGradientRect(surface, shape->bbox, shape->fill);
         else if (type == Type::RadialGradient)return _rasterRadialGradientRect(surface, shape->bbox, shape->fill);
+        else if (type == Type::ImagePattern) return _rasterPatternRect(surface, shape->bbox, shape->fill);
     } else {
         if (type == Type::LinearGradient) return _rasterLinearGradientRle(surface, shape->rle, shape->fill);
         else if (type == Type::RadialGradient) return _rasterRadialGradientRle(surface, shape->rle, shape->fill);
+        else if (type == Type::ImagePattern) return _rasterPatternRle(surface, shape->rle, shape->fill);
     }
     return false;
 }
@@ -1760,6 +1955,7 @@ bool rasterGradientStroke(SwSurface* surface, SwShape* shape, const Fill* fdata,
     auto type = fdata->type();
     if (type == Type::LinearGradient) return _rasterLinearGradientRle(surface, shape->strokeRle, shape->stroke->fill);
     else if (type == Type::RadialGradient) return _rasterRadialGradientRle(surface, shape->strokeRle, shape->stroke->fill);
+    else if (type == Type::ImagePattern) return _rasterPatternRle(surface, shape->strokeRle, shape->stroke->fill);
 
     return false;
 }
@@ -1818,6 +2014,15 @@ bool rasterConvertCS(RenderSurface* surface, ColorSpace to)
 }
 
 
+//the source can be drawn as it is, in the channel order of the target and premultiplied
+bool rasterAligned(const RenderSurface* source, ColorSpace cs)
+{
+    if (!source->premultiplied || source->channelSize != sizeof(uint32_t)) return false;
+    auto abgr = (source->cs == ColorSpace::ABGR8888 || source->cs == ColorSpace::ABGR8888S);
+    return abgr == (cs == ColorSpace::ABGR8888 || cs == ColorSpace::ABGR8888S);
+}
+
+
 //TODO: SIMD OPTIMIZATION?
 void rasterXYFlip(uint32_t* src, uint32_t* dst, int32_t stride, int32_t w, int32_t h, const SwBBox& bbox, bool flipped)
 {
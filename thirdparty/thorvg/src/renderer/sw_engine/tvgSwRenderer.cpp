@@ -204,6 +204,10 @@ struct SwImageTask : SwTask
 {
     SwImage image;
     RenderSurface* source;                //Image source
+    RenderSurface window;                 //the visible part of a tiled or a read-only source
+    RenderRegion area = {0, 0, 0, 0};     //the window in the pixels of the level
+    uint32_t level = 0;
+    uint32_t reserved = 0;                //the window buffer size in pixels
 
     bool clip(SwRle* target) override
     {
@@ -211,9 +215,89 @@ struct SwImageTask : SwTask
         return true;
     }
 
+    //Fetches the visible part of a tiled source at the level fitting the scale, or copies the one of a read-only source
+    //to convert it. The transform is replaced for the window.
+    bool fetch(const SwBBox& clipRegion)
+    {
+        auto tiles = source->tiles;
+
+        Matrix inv;
+        if (!inverse(&transform, &inv)) return false;
+
+        Point pts[4] = {{float(clipRegion.min.x), float(clipRegion.min.y)}, {float(clipRegion.max.x), float(clipRegion.min.y)},
+                        {float(clipRegion.max.x), float(clipRegion.max.y)}, {float(clipRegion.min.x), float(clipRegion.max.y)}};
+        auto min = pts[0] * inv;
+        auto max = min;
+        for (int i = 1; i < 4; ++i) {
+            auto pt = pts[i] * inv;
+            min.x = std::min(min.x, pt.x);
+            min.y = std::min(min.y, pt.y);
+            max.x = std::max(max.x, pt.x);
+            max.y = std::max(max.y, pt.y);
+        }
+
+        //the most reduced level not coarser than the canvas pixels
+        uint32_t level = 0;
+        if (tiles) {
+            auto scaleX = sqrtf((transform.e11 * transform.e11) + (transform.e21 * transform.e21));
+            auto scaleY = sqrtf((transform.e22 * transform.e22) + (transform.e12 * transform.e12));
+            auto scale = std::max(scaleX, scaleY);
+            while (level + 1 < tiles->levels && scale * float(2 << level) <= 1.0f) ++level;
+        }
+
+        //the pixels more around for the filtering, two for the bicubic one
+        auto margin = (image.filter == FilterMethod::Bicubic) ? 2.0f : 1.0f;
+        auto unit = float(1 << level);
+        auto lw = float((source->w + (1 << level) - 1) >> level);
+        auto lh = float((source->h + (1 << level) - 1) >> level);
+        auto x0 = static_cast<int32_t>(std::max(floorf(min.x / unit) - margin, 0.0f));
+        auto y0 = static_cast<int32_t>(std::max(floorf(min.y / unit) - margin, 0.0f));
+        auto x1 = static_cast<int32_t>(std::min(ceilf(max.x / unit) + margin, lw));
+        auto y1 = static_cast<int32_t>(std::min(ceilf(max.y / unit) + margin, lh));
+        if (x1 <= x0 || y1 <= y0) return false;
+
+        //the read-only source might have been changed since, and its window is converted in place
+        RenderRegion area = {x0, y0, x1 - x0, y1 - y0};
+        if (!tiles || !(area == this->area) || level != this->level || !window.data) {
+            auto size = static_cast<uint32_t>(area.w * area.h);
+            if (size > reserved) {
+                free(window.data);
+                window.data = static_cast<pixel_t*>(malloc(size * sizeof(pixel_t)));
+                reserved = window.data ? size : 0;
+                if (!window.data) return false;
+            }
+            window.w = window.stride = area.w;
+            window.h = area.h;
+            window.cs = tiles ? ColorSpace::ARGB8888 : source->cs;
+            window.channelSize = sizeof(uint32_t);
+            window.premultiplied = tiles ? true : source->premultiplied;
+            this->area = {0, 0, 0, 0};
+            if (tiles) {
+                if (!tiles->fetch(area, level, window.buf32, window.stride)) return false;
+            } else {
+                auto src = source->buf32 + size_t(y0) * source->stride + x0;
+                for (int32_t y = 0; y < area.h; ++y, src += source->stride) {
+                    memcpy(window.buf32 + y * window.stride, src, area.w * sizeof(uint32_t));
+                }
+            }
+            this->area = area;
+            this->level = level;
+        }
+
+        transform = transform * Matrix{unit, 0, x0 * unit, 0, unit, y0 * unit, 0, 0, 1};
+        return true;
+    }
+
     void run(unsigned tid) override
     {
         auto clipRegion = bbox;
+        auto source = this->source;
+
+        //only the visible part of a large image, or of a user's image to be converted
+        if (source->tiles || (source->readonly && !rasterAligned(source, surface->cs))) {
+            source = &window;
+            if (!fetch(clipRegion)) window.w = window.h = 0;
+        }
 
         //Convert colorspace if it's not aligned.
         rasterConvertCS(source, surface->cs);
@@ -255,6 +339,9 @@ struct SwImageTask : SwTask
     void dispose() override
     {
        imageFree(&image);
+       free(window.data);
+       window.data = nullptr;
+       reserved = 0;
     }
 };
 
@@ -414,7 +501,7 @@ bool SwRenderer::renderImage(RenderData data)
     auto task = static_cast<SwImageTask*>(data);
     task->done();
 
-    if (task->opacity == 0) return true;
+    if (task->opacity == 0 || task->image.w == 0 || task->image.h == 0) return true;
 
     return rasterImage(surface, &task->image, task->transform, task->bbox, task->opacity);
 }
@@ -723,7 +810,7 @@ void* SwRenderer::prepareCommon(SwTask* task, const Matrix& transform, const Arr
 }
 
 
-RenderData SwRenderer::prepare(RenderSurface* surface, RenderData data, const Matrix& transform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flags)
+RenderData SwRenderer::prepare(RenderSurface* surface, RenderData data, const Matrix& transform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flags, FilterMethod filter)
 {
     //prepare task
     auto task = static_cast<SwImageTask*>(data);
@@ -731,6 +818,7 @@ RenderData SwRenderer::prepare(RenderSurface* surface, RenderData data, const Ma
     else task->done();
 
     task->source = surface;
+    task->image.filter = filter;
 
     return prepareCommon(task, transform, clips, opacity, flags);
 }
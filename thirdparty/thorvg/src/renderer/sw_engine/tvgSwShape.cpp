@@ -274,10 +274,10 @@ static void _trimPattern(SwDashStroke* dash, const RenderShape* rshape, float le
 
 static float _outlineLength(const RenderShape* rshape, uint32_t shiftPts, uint32_t shiftCmds, bool subpath)
 {
-    const PathCommand* cmds = rshape->path.cmds.data + shiftCmds;
-    auto cmdCnt = rshape->path.cmds.count - shiftCmds;
-    const Point* pts = rshape->path.pts.data + shiftPts;
-    auto ptsCnt = rshape->path.pts.count - shiftPts;
+    const PathCommand* cmds = rshape->path.commands() + shiftCmds;
+    auto cmdCnt = rshape->path.commandsCnt() - shiftCmds;
+    const Point* pts = rshape->path.points() + shiftPts;
+    auto ptsCnt = rshape->path.pointsCnt() - shiftPts;
 
     //No actual shape data
     if (cmdCnt <= 0 || ptsCnt <= 0) return 0.0f;
@@ -325,10 +325,10 @@ static float _outlineLength(const RenderShape* rshape, uint32_t shiftPts, uint32
 
 static SwOutline* _genDashOutline(const RenderShape* rshape, const Matrix& transform, bool trimmed, SwMpool* mpool, unsigned tid)
 {
-    const PathCommand* cmds = rshape->path.cmds.data;
-    auto cmdCnt = rshape->path.cmds.count;
-    const Point* pts = rshape->path.pts.data;
-    auto ptsCnt = rshape->path.pts.count;
+    const PathCommand* cmds = rshape->path.commands();
+    auto cmdCnt = rshape->path.commandsCnt();
+    const Point* pts = rshape->path.points();
+    auto ptsCnt = rshape->path.pointsCnt();
 
     //No actual shape data
     if (cmdCnt == 0 || ptsCnt == 0) return nullptr;
@@ -439,10 +439,10 @@ static bool _axisAlignedRect(const SwOutline* outline)
 
 static bool _genOutline(SwShape* shape, const RenderShape* rshape, const Matrix& transform, SwMpool* mpool, unsigned tid, bool hasComposite)
 {
-    const PathCommand* cmds = rshape->path.cmds.data;
-    auto cmdCnt = rshape->path.cmds.count;
-    const Point* pts = rshape->path.pts.data;
-    auto ptsCnt = rshape->path.pts.count;
+    const PathCommand* cmds = rshape->path.commands();
+    auto cmdCnt = rshape->path.commandsCnt();
+    const Point* pts = rshape->path.points();
+    auto ptsCnt = rshape->path.pointsCnt();
 
     //No actual shape data
     if (cmdCnt == 0 || ptsCnt == 0) return false;
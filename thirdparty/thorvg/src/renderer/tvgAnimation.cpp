@@ -49,8 +49,11 @@ Result Animation::frame(float no) noexcept
     if (!loader) return Result::InsufficientCondition;
     if (!loader->animatable()) return Result::NonSupport;
 
-    if (static_cast<FrameModule*>(loader)->frame(no)) return Result::Success;
-    return Result::InsufficientCondition;
+    if (!static_cast<FrameModule*>(loader)->frame(no)) return Result::InsufficientCondition;
+
+    //the bitmap of an animated image is drawn in place
+    if (pImpl->picture->pImpl->surface) PP(pImpl->picture)->renderFlag |= RenderUpdateFlag::Image;
+    return Result::Success;
 }
 
 
@@ -21,6 +21,7 @@
  */
 
 #include "tvgFill.h"
+#include "tvgPicture.h"
 
 /************************************************************************/
 /* Internal Class Implementation                                        */
@@ -71,6 +72,33 @@ Fill* LinearGradient::Impl::duplicate()
 };
 
 
+ImagePattern::Impl::~Impl()
+{
+    delete(picture);
+}
+
+
+Fill* ImagePattern::Impl::duplicate()
+{
+    auto ret = ImagePattern::gen();
+    if (!ret) return nullptr;
+
+    auto dup = ret->pImpl;
+    if (picture) {
+        dup->picture = static_cast<Picture*>(picture->duplicate());
+        dup->surface = P(dup->picture)->surface;
+    } else {
+        dup->surface = surface;
+    }
+    memcpy(dup->insets, insets, sizeof(insets));
+    dup->w = w;
+    dup->h = h;
+    dup->sliced = sliced;
+
+    return ret.release();
+}
+
+
 /************************************************************************/
 /* External Class Implementation                                        */
 /************************************************************************/
@@ -257,3 +285,54 @@ Type LinearGradient::type() const noexcept
 {
     return Type::LinearGradient;
 }
+
+
+ImagePattern::ImagePattern():pImpl(new Impl())
+{
+    Fill::pImpl->method(new FillDup<ImagePattern::Impl>(pImpl));
+    Fill::pImpl->spread = FillSpread::Repeat;
+}
+
+
+ImagePattern::~ImagePattern()
+{
+    delete(pImpl);
+}
+
+
+Result ImagePattern::picture(unique_ptr<Picture> picture) noexcept
+{
+    auto p = picture.release();
+    if (!p) return Result::InvalidArguments;
+
+    //the pattern is drawn by the bitmap, decode it now rather than on the rendering threads.
+    P(p)->load();
+    if (!P(p)->surface) {
+        delete(p);
+        return Result::InsufficientCondition;
+    }
+
+    delete(pImpl->picture);
+    pImpl->picture = p;
+    pImpl->surface = P(p)->surface;
+
+    return Result::Success;
+}
+
+
+const Picture* ImagePattern::picture() const noexcept
+{
+    return pImpl->picture;
+}
+
+
+unique_ptr<ImagePattern> ImagePattern::gen() noexcept
+{
+    return unique_ptr<ImagePattern>(new ImagePattern);
+}
+
+
+Type ImagePattern::type() const noexcept
+{
+    return Type::ImagePattern;
+}
@@ -26,6 +26,7 @@
 #include <cstdlib>
 #include <cstring>
 #include "tvgCommon.h"
+#include "tvgRender.h"
 
 template<typename T>
 struct DuplicateMethod
@@ -108,4 +109,19 @@ struct LinearGradient::Impl
 };
 
 
+struct ImagePattern::Impl
+{
+    Picture* picture = nullptr;           //the source image, null for the bitmap of a sliced picture
+    RenderSurface* surface = nullptr;     //the bitmap of the source
+
+    //a sliced picture stretches the image to w x h, keeping the insets (left, top, right, bottom) unscaled, see Picture::slice()
+    float insets[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float w = 0.0f, h = 0.0f;
+    bool sliced = false;
+
+    ~Impl();
+    Fill* duplicate();
+};
+
+
 #endif  //_TVG_FILL_H_
@@ -0,0 +1,279 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <cstring>
+#include "tvgCommon.h"
+#include "tvgArray.h"
+#include "tvgInlist.h"
+#include "tvgLock.h"
+#include "tvgImageCache.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+struct CachedBitmap
+{
+    INLIST_ITEM(CachedBitmap);
+
+    uint64_t source;
+    uint64_t tag;
+    RenderSurface surface;
+};
+
+static Inlist<CachedBitmap> _lru;                   //the recently parked ones in front
+static Array<uint64_t> _pins;
+static Key _key;
+static size_t _used = 0;
+static uint64_t _hits = 0;
+static uint64_t _misses = 0;
+
+
+static uint64_t _mix(uint64_t h, uint64_t v)
+{
+    h ^= v * 0x87c37b91114253d5ULL;
+    h = (h << 31) | (h >> 33);
+    return h * 0x4cf5ad432745937fULL;
+}
+
+
+static uint64_t _hash(const char* data, size_t size, uint64_t seed)
+{
+    auto h = _mix(seed, size);
+    auto end = data + (size & ~size_t(7));
+    uint64_t v;
+    for (; data < end; data += 8) {
+        memcpy(&v, data, 8);
+        h = _mix(h, v);
+    }
+    v = 0;
+    memcpy(&v, data, size & 7);
+    h = _mix(h, v);
+
+    //finalize, the bits of the last words reach the whole key
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    return h;
+}
+
+
+static size_t _bytes(const RenderSurface& surface)
+{
+    return size_t(surface.stride) * surface.h * surface.channelSize;
+}
+
+
+static bool _pinned(uint64_t source)
+{
+    for (auto p = _pins.begin(); p < _pins.end(); ++p) {
+        if (*p == source) return true;
+    }
+    return false;
+}
+
+
+static void _drop(CachedBitmap* bitmap)
+{
+    _lru.remove(bitmap);
+    _used -= _bytes(bitmap->surface);
+    free(bitmap->surface.data);
+    delete(bitmap);
+}
+
+
+//frees the least recently parked ones over the budget, the pinned ones stay
+static void _evict()
+{
+    auto bitmap = _lru.tail;
+    while (_used > BitmapCache::budget && bitmap) {
+        auto prev = bitmap->prev;
+        if (!_pinned(bitmap->source)) _drop(bitmap);
+        bitmap = prev;
+    }
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+size_t BitmapCache::budget = 64 * 1024 * 1024;
+
+
+uint64_t BitmapCache::key(const char* path)
+{
+    return _hash(path, strlen(path), 0x70617468ULL);
+}
+
+
+uint64_t BitmapCache::key(const char* data, uint32_t size)
+{
+    return _hash(data, size, 0x64617461ULL);
+}
+
+
+//the size alone doesn't tell a file rewritten in the same size
+uint64_t BitmapCache::tag(uint32_t size, uint64_t mtime)
+{
+    return _mix(_mix(0x74616767ULL, size), mtime);
+}
+
+
+bool BitmapCache::take(uint64_t source, uint64_t tag, uint32_t w, uint32_t h, ColorSpace cs, RenderSurface* surface)
+{
+    ScopedLock lock(_key);
+
+    for (auto bitmap = _lru.head; bitmap; bitmap = bitmap->next) {
+        if (bitmap->source != source || bitmap->surface.w != w || bitmap->surface.h != h) continue;
+        //the source has been changed since, it won't be asked any more.
+        if (bitmap->tag != tag) {
+            _drop(bitmap);
+            break;
+        }
+        if (bitmap->surface.cs != cs) continue;
+        surface->data = bitmap->surface.data;
+        surface->stride = bitmap->surface.stride;
+        surface->w = bitmap->surface.w;
+        surface->h = bitmap->surface.h;
+        surface->cs = bitmap->surface.cs;
+        surface->channelSize = bitmap->surface.channelSize;
+        surface->premultiplied = bitmap->surface.premultiplied;
+        _lru.remove(bitmap);
+        _used -= _bytes(bitmap->surface);
+        delete(bitmap);
+        ++_hits;
+        return true;
+    }
+    ++_misses;
+    return false;
+}
+
+
+bool BitmapCache::park(uint64_t source, uint64_t tag, const RenderSurface* surface)
+{
+    if (!surface->data || surface->tiles) return false;
+
+    ScopedLock lock(_key);
+
+    auto bytes = _bytes(*surface);
+    auto pinned = _pinned(source);
+    if (bytes > budget && !pinned) return false;
+
+    auto bitmap = new CachedBitmap;
+    bitmap->source = source;
+    bitmap->tag = tag;
+    bitmap->surface.data = surface->data;
+    bitmap->surface.stride = surface->stride;
+    bitmap->surface.w = surface->w;
+    bitmap->surface.h = surface->h;
+    bitmap->surface.cs = surface->cs;
+    bitmap->surface.channelSize = surface->channelSize;
+    bitmap->surface.premultiplied = surface->premultiplied;
+    _lru.front(bitmap);
+    _used += bytes;
+
+    _evict();
+    return true;
+}
+
+
+void BitmapCache::pin(uint64_t source, bool pinned)
+{
+    ScopedLock lock(_key);
+
+    for (uint32_t i = 0; i < _pins.count; ++i) {
+        if (_pins[i] != source) continue;
+        if (!pinned) {
+            _pins[i] = _pins.last();
+            _pins.pop();
+            _evict();
+        }
+        return;
+    }
+    if (pinned) _pins.push(source);
+}
+
+
+void BitmapCache::stats(uint64_t* hits, uint64_t* misses, size_t* bytes)
+{
+    ScopedLock lock(_key);
+
+    if (hits) *hits = _hits;
+    if (misses) *misses = _misses;
+    if (bytes) *bytes = _used;
+}
+
+
+void BitmapCache::clear(bool all)
+{
+    ScopedLock lock(_key);
+
+    auto bitmap = _lru.head;
+    while (bitmap) {
+        auto next = bitmap->next;
+        if (all || !_pinned(bitmap->source)) _drop(bitmap);
+        bitmap = next;
+    }
+    if (all) _pins.reset();
+}
+
+
+Result ImageCache::budget(size_t bytes) noexcept
+{
+    {
+        ScopedLock lock(_key);
+        BitmapCache::budget = bytes;
+        _evict();
+    }
+    return Result::Success;
+}
+
+
+Result ImageCache::pin(const std::string& path, bool pinned) noexcept
+{
+    if (path.empty()) return Result::InvalidArguments;
+    BitmapCache::pin(BitmapCache::key(path.c_str()), pinned);
+    return Result::Success;
+}
+
+
+Result ImageCache::pin(const char* data, uint32_t size, bool pinned) noexcept
+{
+    if (!data || size == 0) return Result::InvalidArguments;
+    BitmapCache::pin(BitmapCache::key(data, size), pinned);
+    return Result::Success;
+}
+
+
+Result ImageCache::stats(uint64_t* hits, uint64_t* misses, size_t* bytes) noexcept
+{
+    BitmapCache::stats(hits, misses, bytes);
+    return Result::Success;
+}
+
+
+Result ImageCache::clear() noexcept
+{
+    BitmapCache::clear(false);
+    return Result::Success;
+}
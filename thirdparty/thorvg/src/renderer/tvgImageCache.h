@@ -0,0 +1,49 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _TVG_IMAGE_CACHE_H_
+#define _TVG_IMAGE_CACHE_H_
+
+#include "tvgRender.h"
+
+/* The decoded bitmaps of the closed images, kept for the images loaded again from the same source.
+   A bitmap is owned by either a loader or the cache, it's taken out while a loader uses it.
+   The least recently parked ones are freed over the budget, except the pinned sources. */
+struct BitmapCache
+{
+    static size_t budget;                           //the memory of the parked bitmaps in bytes, zero disables the cache
+
+    static uint64_t key(const char* path);          //a source by its path
+    static uint64_t key(const char* data, uint32_t size);   //a source by its content
+    static uint64_t tag(uint32_t size, uint64_t mtime);     //the revision of a file, see FileView::mtime
+
+    //takes the parked bitmap of the source in the size and the colorspace, the tag tells the revision of the source
+    static bool take(uint64_t source, uint64_t tag, uint32_t w, uint32_t h, ColorSpace cs, RenderSurface* surface);
+    //parks the malloc'ed bitmap of the surface, false if the cache doesn't take it over
+    static bool park(uint64_t source, uint64_t tag, const RenderSurface* surface);
+
+    static void pin(uint64_t source, bool pinned);
+    static void stats(uint64_t* hits, uint64_t* misses, size_t* bytes);
+    static void clear(bool all);                    //all: the pinned ones too
+};
+
+#endif //_TVG_IMAGE_CACHE_H_
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#include <algorithm>
+#include <cstring>
+#include "tvgImageFrames.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+static RenderRegion _clip(const RenderRegion& area, const RenderSurface* surface)
+{
+    auto x0 = std::max(area.x, 0);
+    auto y0 = std::max(area.y, 0);
+    auto x1 = std::min(area.x + area.w, int32_t(surface->w));
+    auto y1 = std::min(area.y + area.h, int32_t(surface->h));
+    if (x1 <= x0 || y1 <= y0) return {0, 0, 0, 0};
+    return {x0, y0, x1 - x0, y1 - y0};
+}
+
+
+//the canvas area from or to the buffer of the area size
+static void _copy(RenderSurface* surface, const RenderRegion& area, uint32_t* buffer, bool save)
+{
+    auto canvas = surface->buf32 + area.y * surface->stride + area.x;
+    for (int32_t y = 0; y < area.h; ++y, canvas += surface->stride, buffer += area.w) {
+        if (save) memcpy(buffer, canvas, area.w * sizeof(uint32_t));
+        else memcpy(canvas, buffer, area.w * sizeof(uint32_t));
+    }
+}
+
+
+static void _clear(RenderSurface* surface, const RenderRegion& area)
+{
+    auto canvas = surface->buf32 + area.y * surface->stride + area.x;
+    for (int32_t y = 0; y < area.h; ++y, canvas += surface->stride) {
+        memset(canvas, 0, area.w * sizeof(uint32_t));
+    }
+}
+
+
+//the premultiplied source over the destination
+static inline uint32_t _blend(uint32_t s, uint32_t d)
+{
+    auto ia = 256 - (s >> 24);
+    return s + ((((d >> 8) & 0x00ff00ff) * ia) & 0xff00ff00) + ((((d & 0x00ff00ff) * ia) >> 8) & 0x00ff00ff);
+}
+
+
+bool ImageFrames::draw(uint32_t index)
+{
+    //the shown frame leaves its area
+    if (shown >= 0) {
+        auto& prev = frames[shown];
+        auto area = _clip(prev.area, surface);
+        if (prev.dispose == FrameDispose::Background) _clear(surface, area);
+        else if (prev.dispose == FrameDispose::Previous) _copy(surface, area, saved, false);
+    }
+
+    auto& frame = frames[index];
+    auto area = _clip(frame.area, surface);
+
+    //nothing of the frame is on the canvas
+    if (area.w == 0) {
+        shown = index;
+        return true;
+    }
+
+    //the canvas under the frame, it replaces the saved one of the shown frame after the frame is drawn
+    uint32_t* keep = nullptr;
+    if (frame.dispose == FrameDispose::Previous) {
+        keep = static_cast<uint32_t*>(malloc(area.w * area.h * sizeof(uint32_t)));
+        if (!keep) return false;
+        _copy(surface, area, keep, true);
+    }
+
+    auto size = size_t(frame.area.w) * frame.area.h;
+    if (size > capacity) {
+        free(this->area);
+        this->area = static_cast<uint32_t*>(malloc(size * sizeof(uint32_t)));
+        capacity = this->area ? size : 0;
+    }
+    if (!this->area || !decode(index, this->area, frame.area.w)) {
+        free(keep);
+        return false;
+    }
+
+    auto src = this->area + (area.y - frame.area.y) * frame.area.w + (area.x - frame.area.x);
+    auto dst = surface->buf32 + area.y * surface->stride + area.x;
+    for (int32_t y = 0; y < area.h; ++y, src += frame.area.w, dst += surface->stride) {
+        if (frame.blend) {
+            for (int32_t x = 0; x < area.w; ++x) dst[x] = _blend(src[x], dst[x]);
+        } else {
+            memcpy(dst, src, area.w * sizeof(uint32_t));
+        }
+    }
+
+    if (keep) {
+        free(saved);
+        saved = keep;
+    }
+    shown = index;
+    return true;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+ImageFrames::~ImageFrames()
+{
+    free(area);
+    free(saved);
+}
+
+
+bool ImageFrames::init(RenderSurface* surface, uint32_t w, uint32_t h, ColorSpace cs)
+{
+    surface->buf32 = static_cast<uint32_t*>(calloc(size_t(w) * h, sizeof(uint32_t)));
+    if (!surface->buf32) return false;
+
+    surface->stride = surface->w = w;
+    surface->h = h;
+    surface->cs = cs;
+    surface->channelSize = sizeof(uint32_t);
+    surface->premultiplied = true;
+
+    this->surface = surface;
+    shown = -1;
+
+    return true;
+}
+
+
+bool ImageFrames::seek(float no)
+{
+    if (!surface || frames.count == 0) return false;
+
+    uint32_t index = 0;
+    float time = 0.0f;
+    for (; index + 1 < frames.count; ++index) {
+        time += frames[index].delay;
+        if (no < time) break;
+    }
+    if (int32_t(index) == shown) return false;
+
+    //the frames are drawn on the last one, from the first one again to go back
+    if (int32_t(index) < shown) {
+        _clear(surface, {0, 0, int32_t(surface->w), int32_t(surface->h)});
+        shown = -1;
+    }
+
+    auto from = shown;
+    while (shown < int32_t(index)) {
+        if (!draw(shown + 1)) {
+            TVGERR("RENDERER", "Failed to decode the frame %d", shown + 1);
+            break;
+        }
+    }
+    return shown != from;
+}
+
+
+float ImageFrames::total()
+{
+    float time = 0.0f;
+    for (auto frame = frames.begin(); frame < frames.end(); ++frame) time += frame->delay;
+    return time;
+}
+
+
+float ImageFrames::current()
+{
+    float time = 0.0f;
+    for (int32_t i = 0; i < shown; ++i) time += frames[i].delay;
+    return time;
+}
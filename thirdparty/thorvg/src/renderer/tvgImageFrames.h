@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+#ifndef _TVG_IMAGE_FRAMES_H_
+#define _TVG_IMAGE_FRAMES_H_
+
+#include "tvgRender.h"
+
+//how the area of a frame is left before the next frame, see GIF89a and APNG
+enum class FrameDispose : uint8_t { None = 0, Background, Previous };
+
+struct ImageFrame
+{
+    RenderRegion area;                              //on the canvas
+    uint32_t delay;                                 //in 1/100 seconds
+    FrameDispose dispose;
+    bool blend;                                     //composited over the canvas, otherwise replaces the area
+};
+
+/* The frames of an animated image, drawn one after another on a canvas of the image size.
+   Only the area of the next frame is decoded and composited on the canvas, so the memory stays about two frames:
+   the canvas and the area of a frame, plus the area kept to be restored by FrameDispose::Previous.
+   The frame numbers are on the timeline in 1/100 seconds, the frames are shown as long as their delays. */
+struct ImageFrames
+{
+    Array<ImageFrame> frames;
+
+    virtual ~ImageFrames();
+
+    //the canvas is the surface of the loader, w x h premultiplied pixels in the colorspace
+    bool init(RenderSurface* surface, uint32_t w, uint32_t h, ColorSpace cs);
+    //draws the frame of the timeline number on the canvas, false if it's shown already
+    bool seek(float no);
+    float total();                                  //the length of the timeline
+    float current();                                //the timeline number of the shown frame
+
+protected:
+    //decodes the area of the frame to dst in the premultiplied pixels of the canvas colorspace. Called in order from the first frame.
+    virtual bool decode(uint32_t index, uint32_t* dst, uint32_t stride) = 0;
+
+private:
+    RenderSurface* surface = nullptr;
+    uint32_t* area = nullptr;                       //the decoded area of a frame
+    uint32_t* saved = nullptr;                      //the canvas area under the shown frame, see FrameDispose::Previous
+    size_t capacity = 0;                            //the pixels of the area buffer
+    int32_t shown = -1;                             //the index of the frame on the canvas
+
+    bool draw(uint32_t index);
+};
+
+#endif //_TVG_IMAGE_FRAMES_H_
@@ -41,6 +41,7 @@ struct LoadModule
     uint16_t sharing = 0;                           //reference count
     bool readied = false;                           //read done already.
     bool pathcache = false;                         //cached by path
+    bool exclusive = false;                         //not sharable any more, see ImageLoader::hint()
 
     LoadModule(FileType type) : type(type) {}
     virtual ~LoadModule()
@@ -50,6 +51,8 @@ struct LoadModule
 
     virtual bool open(const string& path) { return false; }
     virtual bool open(const char* data, uint32_t size, bool copy) { return false; }
+    virtual bool stream() { return false; }  //the progressive loading, the data is given by feed()
+    virtual bool feed(const char* data, uint32_t size, bool last, bool* updated) { return false; }
     virtual bool resize(Paint* paint, float w, float h) { return false; }
     virtual void sync() {};  //finish immediately if any async update jobs.
 
@@ -85,11 +88,12 @@ struct ImageLoader : LoadModule
     ImageLoader(FileType type) : LoadModule(type) {}
 
     virtual bool animatable() { return false; }  //true if this loader supports animation.
+    virtual void hint(float w, float h) {}       //the target size of the image, the loader may reduce its bitmap to it.
     virtual Paint* paint() { return nullptr; }
 
     virtual RenderSurface* bitmap()
     {
-        if (surface.data) return &surface;
+        if (surface.data || surface.tiles) return &surface;
         return nullptr;
     }
 };
@@ -25,6 +25,7 @@
 #include "tvgInlist.h"
 #include "tvgLoader.h"
 #include "tvgLock.h"
+#include "tvgImageCache.h"
 
 #ifdef THORVG_SVG_LOADER_SUPPORT
     #include "tvgSvgLoader.h"
@@ -54,6 +55,10 @@
     #include "tvgLottieLoader.h"
 #endif
 
+#ifdef THORVG_GIF_LOADER_SUPPORT
+    #include "tvgGifLoader.h"
+#endif
+
 #include "tvgRawLoader.h"
 
 
@@ -114,6 +119,12 @@ static LoadModule* _find(FileType type)
         case FileType::Lottie: {
 #ifdef THORVG_LOTTIE_LOADER_SUPPORT
             return new LottieLoader;
+#endif
+            break;
+        }
+        case FileType::Gif: {
+#ifdef THORVG_GIF_LOADER_SUPPORT
+            return new GifLoader;
 #endif
             break;
         }
@@ -161,6 +172,10 @@ static LoadModule* _find(FileType type)
             format = "WEBP";
             break;
         }
+        case FileType::Gif: {
+            format = "GIF";
+            break;
+        }
         default: {
             format = "???";
             break;
@@ -177,10 +192,11 @@ static LoadModule* _findByPath(const string& path)
     auto ext = path.substr(path.find_last_of(".") + 1);
     if (!ext.compare("tvg")) return _find(FileType::Tvg);
     if (!ext.compare("svg")) return _find(FileType::Svg);
-    if (!ext.compare("json")) return _find(FileType::Lottie);
+    if (!ext.compare("json") || !ext.compare("tvl")) return _find(FileType::Lottie);
     if (!ext.compare("png")) return _find(FileType::Png);
     if (!ext.compare("jpg")) return _find(FileType::Jpg);
     if (!ext.compare("webp")) return _find(FileType::Webp);
+    if (!ext.compare("gif")) return _find(FileType::Gif);
     if (!ext.compare("ttf") || !ext.compare("ttc")) return _find(FileType::Ttf);
     if (!ext.compare("otf") || !ext.compare("otc")) return _find(FileType::Ttf);
     return nullptr;
@@ -199,6 +215,7 @@ static FileType _convert(const string& mimeType)
     else if (mimeType == "png") type = FileType::Png;
     else if (mimeType == "jpg" || mimeType == "jpeg") type = FileType::Jpg;
     else if (mimeType == "webp") type = FileType::Webp;
+    else if (mimeType == "gif") type = FileType::Gif;
     else TVGLOG("RENDERER", "Given mimetype is unknown = \"%s\".", mimeType.c_str());
 
     return type;
@@ -218,7 +235,7 @@ static LoadModule* _findFromCache(const string& path)
     auto loader = _activeLoaders.head;
 
     while (loader) {
-        if (loader->pathcache && !strcmp(loader->hashpath, path.c_str())) {
+        if (loader->pathcache && !loader->exclusive && !strcmp(loader->hashpath, path.c_str())) {
             ++loader->sharing;
             return loader;
         }
@@ -239,7 +256,7 @@ static LoadModule* _findFromCache(const char* data, uint32_t size, const string&
     auto key = HASH_KEY(data);
 
     while (loader) {
-        if (loader->type == type && loader->hashkey == key) {
+        if (loader->type == type && !loader->exclusive && loader->hashkey == key) {
             ++loader->sharing;
             return loader;
         }
@@ -272,6 +289,10 @@ bool LoaderMgr::term()
         _activeLoaders.remove(tmp);
         if (ret) delete(tmp);
     }
+
+    //the bitmaps of the closed images
+    BitmapCache::clear(true);
+
     return true;
 }
 
@@ -297,7 +318,7 @@ LoadModule* LoaderMgr::loader(const string& path, bool* invalid)
     //TODO: svg & lottie is not sharable.
     auto allowCache = true;
     auto ext = path.substr(path.find_last_of(".") + 1);
-    if (!ext.compare("svg") || !ext.compare("json")) allowCache = false;
+    if (!ext.compare("svg") || !ext.compare("json") || !ext.compare("tvl")) allowCache = false;
 
     if (allowCache) {
         if (auto loader = _findFromCache(path)) return loader;
@@ -411,19 +432,31 @@ LoadModule* LoaderMgr::loader(const char* data, uint32_t size, const string& mim
 }
 
 
-LoadModule* LoaderMgr::loader(const uint32_t *data, uint32_t w, uint32_t h, bool copy)
+//the progressive loading data is not sharable, no cache.
+LoadModule* LoaderMgr::stream(const string& mimeType)
+{
+    if (auto loader = _findByType(mimeType)) {
+        if (loader->stream()) return loader;
+        TVGLOG("LOADER", "Given mimetype \"%s\" doesn't support the progressive loading.", mimeType.c_str());
+        delete(loader);
+    }
+    return nullptr;
+}
+
+
+LoadModule* LoaderMgr::loader(const uint32_t *data, uint32_t w, uint32_t h, uint32_t stride, ColorSpace cs, bool copy)
 {
     //Note that users could use the same data pointer with the different content.
-    //Thus caching is only valid for shareable.
-    if (!copy) {
-        //TODO: should we check premultiplied??
+    //Thus caching is only valid for shareable, and the layout must be the same as well.
+    auto sharable = !copy && stride == w && cs == ColorSpace::ARGB8888;
+    if (sharable) {
         if (auto loader = _findFromCache((const char*)(data), w * h, "raw")) return loader;
     }
 
     //function is dedicated for raw images only
     auto loader = new RawLoader;
-    if (loader->open(data, w, h, copy)) {
-        if (!copy) {
+    if (loader->open(data, w, h, stride, cs, copy)) {
+        if (sharable) {
             loader->hashkey = HASH_KEY((const char*)data);
             ScopedLock lock(key);
             _activeLoaders.back(loader);
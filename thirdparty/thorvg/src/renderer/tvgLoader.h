@@ -31,9 +31,10 @@ struct LoaderMgr
     static bool term();
     static LoadModule* loader(const string& path, bool* invalid);
     static LoadModule* loader(const char* data, uint32_t size, const string& mimeType, bool copy);
-    static LoadModule* loader(const uint32_t* data, uint32_t w, uint32_t h, bool copy);
+    static LoadModule* loader(const uint32_t* data, uint32_t w, uint32_t h, uint32_t stride, ColorSpace cs, bool copy);
     static LoadModule* loader(const char* name, const char* data, uint32_t size, const string& mimeType, bool copy);
     static LoadModule* loader(const char* key);
+    static LoadModule* stream(const string& mimeType);
     static bool retrieve(const string& path);
     static bool retrieve(LoadModule* loader);
 };
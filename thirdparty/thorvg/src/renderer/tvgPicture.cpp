@@ -22,6 +22,8 @@
 
 #include "tvgPaint.h"
 #include "tvgPicture.h"
+#include "tvgShape.h"
+#include "tvgFill.h"
 
 /************************************************************************/
 /* Internal Class Implementation                                        */
@@ -76,6 +78,10 @@ bool Picture::Impl::render(RenderMethod* renderer)
     bool ret = false;
     renderer->blend(PP(picture)->blendMethod);
 
+    if (sliced) {
+        PP(sliced)->blendMethod = PP(picture)->blendMethod;
+        return PP(sliced)->render(renderer);
+    }
     if (surface) return renderer->renderImage(rd);
     else if (paint) {
         RenderCompositor* cmp = nullptr;
@@ -95,12 +101,14 @@ bool Picture::Impl::size(float w, float h)
     this->w = w;
     this->h = h;
     resizing = true;
+    if (loader && !surface) loader->hint(w, h);
     return true;
 }
 
 
 RenderRegion Picture::Impl::bounds(RenderMethod* renderer)
 {
+    if (sliced) return P(sliced)->bounds(renderer);
     if (rd) return renderer->region(rd);
     if (paint) return paint->pImpl->bounds(renderer);
     return {0, 0, 0, 0};
@@ -119,6 +127,11 @@ Result Picture::Impl::load(ImageLoader* loader)
 
     this->loader = loader;
 
+    //a progressive loading in progress is over, the data is fed to the replaced loader no more
+    streaming = false;
+    streamFunc = nullptr;
+    streamData = nullptr;
+
     if (!loader->read()) return Result::Unknown;
 
     this->w = loader->w;
@@ -128,6 +141,42 @@ Result Picture::Impl::load(ImageLoader* loader)
 }
 
 
+/* The bitmap is drawn by a rectangle of the picture size filled with the sliced image pattern.
+   The pattern works in the bitmap pixels, which may be reduced from the image, see ImageLoader::hint(). */
+RenderData Picture::Impl::slice(RenderMethod* renderer, const Matrix& transform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flag, bool clipper)
+{
+    //the image itself isn't drawn in the meantime
+    if (rd) {
+        renderer->dispose(rd);
+        rd = nullptr;
+    }
+
+    auto rx = surface->w / loader->w;
+    auto ry = surface->h / loader->h;
+    float pw = w * rx, ph = h * ry;
+    float pinsets[4] = {insets[0] * rx, insets[1] * ry, insets[2] * rx, insets[3] * ry};
+
+    if (!sliced) sliced = Shape::gen().release();
+
+    auto fill = static_cast<const ImagePattern*>(sliced->fill());
+    if (!fill || (flag & RenderUpdateFlag::Image) || P(fill)->w != pw || P(fill)->h != ph || memcmp(P(fill)->insets, pinsets, sizeof(pinsets))) {
+        auto pattern = ImagePattern::gen();
+        auto impl = P(pattern.get());
+        impl->surface = surface;
+        impl->sliced = true;
+        impl->w = pw;
+        impl->h = ph;
+        memcpy(impl->insets, pinsets, sizeof(pinsets));
+        pattern->spread(FillSpread::Pad);
+        pattern->transform({1.0f / rx, 0, 0, 0, 1.0f / ry, 0, 0, 0, 1});
+        sliced->fill(std::move(pattern));
+        sliced->reset();
+        sliced->appendRect(0, 0, w, h);
+    }
+    return PP(sliced)->update(renderer, transform, clips, opacity, flag, clipper);
+}
+
+
 
 /************************************************************************/
 /* External Class Implementation                                        */
@@ -188,7 +237,32 @@ Result Picture::load(uint32_t* data, uint32_t w, uint32_t h, bool copy) noexcept
 {
     if (!data || w <= 0 || h <= 0) return Result::InvalidArguments;
 
-    return pImpl->load(data, w, h, copy);
+    //the frame is replaced in place by the overload with the layout only, this one loads a picture once as ever.
+    if (pImpl->paint || pImpl->surface) return Result::InsufficientCondition;
+
+    return pImpl->load(data, w, h, w, ColorSpace::ARGB8888, copy);
+}
+
+
+Result Picture::load(uint32_t* data, uint32_t w, uint32_t h, uint32_t stride, uint32_t cs, bool copy) noexcept
+{
+    if (!data || w <= 0 || h <= 0 || stride < w || cs > ColorSpace::ARGB8888S) return Result::InvalidArguments;
+
+    return pImpl->load(data, w, h, stride, static_cast<ColorSpace>(cs), copy);
+}
+
+
+Result Picture::stream(const std::string& mimeType, std::function<void(Picture* picture, void* data)> func, void* data) noexcept
+{
+    return pImpl->stream(mimeType, func, data);
+}
+
+
+Result Picture::feed(const char* data, uint32_t size, bool last) noexcept
+{
+    if (!data && size > 0) return Result::InvalidArguments;
+
+    return pImpl->feed(data, size, last);
 }
 
 
@@ -199,6 +273,43 @@ Result Picture::size(float w, float h) noexcept
 }
 
 
+Result Picture::slice(float left, float top, float right, float bottom) noexcept
+{
+    if (left < 0.0f || top < 0.0f || right < 0.0f || bottom < 0.0f) return Result::InvalidArguments;
+
+    pImpl->insets[0] = left;
+    pImpl->insets[1] = top;
+    pImpl->insets[2] = right;
+    pImpl->insets[3] = bottom;
+
+    //back to the image drawing
+    if (!pImpl->slicing()) {
+        delete(pImpl->sliced);
+        pImpl->sliced = nullptr;
+    }
+    PP(this)->renderFlag |= RenderUpdateFlag::Image;
+
+    return Result::Success;
+}
+
+
+Result Picture::filter(FilterMethod method) noexcept
+{
+    if (pImpl->filter == method) return Result::Success;
+
+    pImpl->filter = method;
+    PP(this)->renderFlag |= RenderUpdateFlag::Image;
+
+    return Result::Success;
+}
+
+
+FilterMethod Picture::filter() const noexcept
+{
+    return pImpl->filter;
+}
+
+
 Result Picture::size(float* w, float* h) const noexcept
 {
     if (!pImpl->loader) return Result::InsufficientCondition;
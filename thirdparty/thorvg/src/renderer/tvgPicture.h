@@ -23,9 +23,11 @@
 #ifndef _TVG_PICTURE_H_
 #define _TVG_PICTURE_H_
 
+#include <memory.h>
 #include <string>
 #include "tvgPaint.h"
 #include "tvgLoader.h"
+#include "tvgRawLoader.h"
 
 
 struct PictureIterator : Iterator
@@ -63,15 +65,22 @@ struct Picture::Impl
     RenderSurface* surface = nullptr; //bitmap picture uses
     RenderData rd = nullptr;          //engine data
     float w = 0, h = 0;
+    float insets[4] = {0, 0, 0, 0};   //the nine-slice insets (left, top, right, bottom), see Picture::slice()
+    Shape* sliced = nullptr;          //draws the sliced bitmap with an image pattern
+    FilterMethod filter = FilterMethod::Bilinear;
     Picture* picture = nullptr;
     bool resizing = false;
     bool needComp = false;            //need composition
+    bool streaming = false;           //progressive loading
+    function<void(Picture*, void*)> streamFunc = nullptr;
+    void* streamData = nullptr;
 
     bool needComposition(uint8_t opacity);
     bool render(RenderMethod* renderer);
     bool size(float w, float h);
     RenderRegion bounds(RenderMethod* renderer);
     Result load(ImageLoader* ploader);
+    RenderData slice(RenderMethod* renderer, const Matrix& transform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flag, bool clipper);
 
     Impl(Picture* p) : picture(p)
     {
@@ -85,23 +94,33 @@ struct Picture::Impl
                 renderer->dispose(rd);
             }
         }
+        delete(sliced);
         delete(paint);
     }
 
-    RenderData update(RenderMethod* renderer, const Matrix& transform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag pFlag, TVG_UNUSED bool clipper)
+    bool slicing()
+    {
+        return insets[0] > 0.0f || insets[1] > 0.0f || insets[2] > 0.0f || insets[3] > 0.0f;
+    }
+
+    RenderData update(RenderMethod* renderer, const Matrix& transform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag pFlag, bool clipper)
     {
         auto flag = static_cast<RenderUpdateFlag>(pFlag | load());
 
         if (surface) {
+            if (slicing()) return slice(renderer, transform, clips, opacity, flag, clipper);
             if (flag == RenderUpdateFlag::None) return rd;
 
             //Overriding Transformation by the desired image size
             auto sx = w / loader->w;
             auto sy = h / loader->h;
             auto scale = sx < sy ? sx : sy;
-            auto m = transform * Matrix{scale, 0, 0, 0, scale, 0, 0, 0, 1};
+            //the loader might have decoded a reduced bitmap, see ImageLoader::hint()
+            auto rx = scale * loader->w / surface->w;
+            auto ry = scale * loader->h / surface->h;
+            auto m = transform * Matrix{rx, 0, 0, 0, ry, 0, 0, 0, 1};
 
-            rd = renderer->prepare(surface, rd, m, clips, opacity, flag);
+            rd = renderer->prepare(surface, rd, m, clips, opacity, flag, filter);
         } else if (paint) {
             if (resizing) {
                 loader->resize(paint, w, h);
@@ -143,11 +162,53 @@ struct Picture::Impl
         return load(loader);
     }
 
-    Result load(uint32_t* data, uint32_t w, uint32_t h, bool copy)
+    Result stream(const string& mimeType, function<void(Picture*, void*)> func, void* data)
+    {
+        if (paint || surface || loader) return Result::InsufficientCondition;
+
+        auto loader = static_cast<ImageLoader*>(LoaderMgr::stream(mimeType));
+        if (!loader) return Result::NonSupport;
+
+        this->loader = loader;
+        streaming = true;
+        streamFunc = func;
+        streamData = data;
+
+        return Result::Success;
+    }
+
+    Result feed(const char* data, uint32_t size, bool last)
+    {
+        if (!streaming) return Result::InsufficientCondition;
+        if (last) streaming = false;
+
+        bool updated;
+        if (!loader->feed(data, size, last, &updated)) return Result::InvalidArguments;
+
+        if (updated) {
+            load();
+            if (streamFunc) streamFunc(picture, streamData);
+        }
+        return Result::Success;
+    }
+
+    Result load(uint32_t* data, uint32_t w, uint32_t h, uint32_t stride, ColorSpace cs, bool copy)
     {
+        //the next frame replaces the pixels of the own raw image, without reloading the picture
+        if (surface && loader->type == FileType::Raw && !loader->cached() && loader->sharing == 0) {
+            if (!static_cast<RawLoader*>(loader)->open(data, w, h, stride, cs, copy)) return Result::InvalidArguments;
+            //a frame of another size resizes the picture, unless the user sized it (the frame is fitted into it then)
+            if (!resizing) {
+                this->w = loader->w;
+                this->h = loader->h;
+            }
+            PP(picture)->renderFlag |= RenderUpdateFlag::Image;
+            return Result::Success;
+        }
+
         if (paint || surface) return Result::InsufficientCondition;
 
-        auto loader = static_cast<ImageLoader*>(LoaderMgr::loader(data, w, h, copy));
+        auto loader = static_cast<ImageLoader*>(LoaderMgr::loader(data, w, h, stride, cs, copy));
         if (!loader) return Result::FailedAllocation;
 
         return load(loader);
@@ -173,6 +234,8 @@ struct Picture::Impl
         dup->surface = surface;
         dup->w = w;
         dup->h = h;
+        memcpy(dup->insets, insets, sizeof(insets));
+        dup->filter = filter;
         dup->resizing = resizing;
 
         return picture;
@@ -189,7 +252,10 @@ struct Picture::Impl
         //Try it, If not loaded yet.
         load();
 
-        if (loader) {
+        if (surface) {
+            if (w) *w = surface->w;
+            if (h) *h = surface->h;
+        } else if (loader) {
             if (w) *w = static_cast<uint32_t>(loader->w);
             if (h) *h = static_cast<uint32_t>(loader->h);
         } else {
@@ -25,6 +25,7 @@
 
 #include <math.h>
 #include <cstdarg>
+#include <atomic>
 #include "tvgCommon.h"
 #include "tvgArray.h"
 #include "tvgLock.h"
@@ -48,6 +49,8 @@ enum ColorSpace : uint8_t
     Unsupported        //TODO: Change to the default, At the moment, we put it in the last to align with SwCanvas::Colorspace.
 };
 
+struct RenderTiles;
+
 struct RenderSurface
 {
     union {
@@ -56,11 +59,13 @@ struct RenderSurface
         uint8_t*  buf8;             //for explicit 8bits grayscale
     };
     Key key;                        //a reserved lock for the thread safety
+    RenderTiles* tiles = nullptr;   //the pixels are fetched in tiles instead of the data, see RenderTiles
     uint32_t stride = 0;
     uint32_t w = 0, h = 0;
     ColorSpace cs = ColorSpace::Unsupported;
     uint8_t channelSize = 0;
     bool premultiplied = false;         //Alpha-premultiplied
+    bool readonly = false;              //the pixels belong to the user, they can't be converted in place
 
     RenderSurface()
     {
@@ -69,12 +74,14 @@ struct RenderSurface
     RenderSurface(const RenderSurface* rhs)
     {
         data = rhs->data;
+        tiles = rhs->tiles;
         stride = rhs->stride;
         w = rhs->w;
         h = rhs->h;
         cs = rhs->cs;
         channelSize = rhs->channelSize;
         premultiplied = rhs->premultiplied;
+        readonly = rhs->readonly;
     }
 
 
@@ -100,6 +107,18 @@ struct RenderRegion
     }
 };
 
+//The pixels of an image too large to be held at once, they are fetched for the visible region only.
+struct RenderTiles
+{
+    uint32_t w = 0, h = 0;          //the full size of the image
+    uint32_t levels = 1;            //the level n is the image reduced by 1/2^n
+
+    virtual ~RenderTiles() {}
+
+    //Fills dst with the ARGB8888 premultiplied pixels of the region, in the coordinates of the level. Thread safe.
+    virtual bool fetch(const RenderRegion& region, uint32_t level, uint32_t* dst, uint32_t stride) = 0;
+};
+
 struct RenderStroke
 {
     float width = 0.0f;
@@ -177,13 +196,95 @@ struct RenderStroke
     }
 };
 
-struct RenderShape
+//the immutable path data shared by the duplicates of a shape, see RenderPath::share()
+struct RenderSharedPath
 {
-    struct
+    Array<PathCommand> cmds;
+    Array<Point> pts;
+    std::atomic<uint32_t> refCnt{1};
+};
+
+struct RenderPath
+{
+    Array<PathCommand> cmds;
+    Array<Point> pts;
+    RenderSharedPath* shared = nullptr;     //in place of cmds and pts, the readers go through commands() and points()
+
+    ~RenderPath()
+    {
+        release();
+    }
+
+    const PathCommand* commands() const
+    {
+        return shared ? shared->cmds.data : cmds.data;
+    }
+
+    uint32_t commandsCnt() const
+    {
+        return shared ? shared->cmds.count : cmds.count;
+    }
+
+    const Point* points() const
+    {
+        return shared ? shared->pts.data : pts.data;
+    }
+
+    uint32_t pointsCnt() const
+    {
+        return shared ? shared->pts.count : pts.count;
+    }
+
+    //the data moves to a shared block, the duplicates refer it instead of copying it
+    void share()
+    {
+        if (shared) return;
+        shared = new RenderSharedPath;
+        _move(cmds, shared->cmds);
+        _move(pts, shared->pts);
+    }
+
+    void share(const RenderPath& rhs)
+    {
+        if (shared == rhs.shared) return;
+        release();
+        cmds.clear();
+        pts.clear();
+        ++rhs.shared->refCnt;
+        shared = rhs.shared;
+    }
+
+    //the shared data is copied back before any modification
+    void own()
+    {
+        if (!shared) return;
+        cmds = shared->cmds;
+        pts = shared->pts;
+        release();
+    }
+
+    void release()
+    {
+        if (shared && --shared->refCnt == 0) delete(shared);
+        shared = nullptr;
+    }
+
+private:
+    template<typename T>
+    static void _move(Array<T>& from, Array<T>& to)
     {
-        Array<PathCommand> cmds;
-        Array<Point> pts;
-    } path;
+        to.reset();
+        to.data = from.data;
+        to.count = from.count;
+        to.reserved = from.reserved;
+        from.data = nullptr;
+        from.count = from.reserved = 0;
+    }
+};
+
+struct RenderShape
+{
+    RenderPath path;
 
     Fill *fill = nullptr;
     RenderStroke *stroke = nullptr;
@@ -310,7 +411,7 @@ public:
 
     virtual ~RenderMethod() {}
     virtual RenderData prepare(const RenderShape& rshape, RenderData data, const Matrix& transform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flags, bool clipper) = 0;
-    virtual RenderData prepare(RenderSurface* surface, RenderData data, const Matrix& transform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flags) = 0;
+    virtual RenderData prepare(RenderSurface* surface, RenderData data, const Matrix& transform, Array<RenderData>& clips, uint8_t opacity, RenderUpdateFlag flags, FilterMethod filter) = 0;
     virtual bool preRender() = 0;
     virtual bool renderShape(RenderData data) = 0;
     virtual bool renderImage(RenderData data) = 0;
@@ -63,6 +63,7 @@ Type Shape::type() const noexcept
 
 Result Shape::reset() noexcept
 {
+    pImpl->rs.path.release();
     pImpl->rs.path.cmds.clear();
     pImpl->rs.path.pts.clear();
 
@@ -74,15 +75,15 @@ Result Shape::reset() noexcept
 
 uint32_t Shape::pathCommands(const PathCommand** cmds) const noexcept
 {
-    if (cmds) *cmds = pImpl->rs.path.cmds.data;
-    return pImpl->rs.path.cmds.count;
+    if (cmds) *cmds = pImpl->rs.path.commands();
+    return pImpl->rs.path.commandsCnt();
 }
 
 
 uint32_t Shape::pathCoords(const Point** pts) const noexcept
 {
-    if (pts) *pts = pImpl->rs.path.pts.data;
-    return pImpl->rs.path.pts.count;
+    if (pts) *pts = pImpl->rs.path.points();
+    return pImpl->rs.path.pointsCnt();
 }
 
 
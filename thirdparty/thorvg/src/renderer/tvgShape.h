@@ -125,12 +125,13 @@ struct Shape::Impl
     bool bounds(float* x, float* y, float* w, float* h, bool stroking)
     {
         //Path bounding size
-        if (rs.path.pts.count > 0 ) {
-            auto pts = rs.path.pts.begin();
+        auto ptsCnt = rs.path.pointsCnt();
+        if (ptsCnt > 0 ) {
+            auto pts = rs.path.points();
             Point min = { pts->x, pts->y };
             Point max = { pts->x, pts->y };
 
-            for (auto pts2 = pts + 1; pts2 < rs.path.pts.end(); ++pts2) {
+            for (auto pts2 = pts + 1; pts2 < pts + ptsCnt; ++pts2) {
                 if (pts2->x < min.x) min.x = pts2->x;
                 if (pts2->y < min.y) min.y = pts2->y;
                 if (pts2->x > max.x) max.x = pts2->x;
@@ -150,21 +151,24 @@ struct Shape::Impl
             if (w) *w += rs.stroke->width;
             if (h) *h += rs.stroke->width;
         }
-        return rs.path.pts.count > 0 ? true : false;
+        return ptsCnt > 0 ? true : false;
     }
 
     void reserveCmd(uint32_t cmdCnt)
     {
+        rs.path.own();
         rs.path.cmds.reserve(cmdCnt);
     }
 
     void reservePts(uint32_t ptsCnt)
     {
+        rs.path.own();
         rs.path.pts.reserve(ptsCnt);
     }
 
     void grow(uint32_t cmdCnt, uint32_t ptsCnt)
     {
+        rs.path.own();
         rs.path.cmds.grow(cmdCnt);
         rs.path.pts.grow(ptsCnt);
     }
@@ -179,18 +183,21 @@ struct Shape::Impl
 
     void moveTo(float x, float y)
     {
+        rs.path.own();
         rs.path.cmds.push(PathCommand::MoveTo);
         rs.path.pts.push({x, y});
     }
 
     void lineTo(float x, float y)
     {
+        rs.path.own();
         rs.path.cmds.push(PathCommand::LineTo);
         rs.path.pts.push({x, y});
     }
 
     void cubicTo(float cx1, float cy1, float cx2, float cy2, float x, float y)
     {
+        rs.path.own();
         rs.path.cmds.push(PathCommand::CubicTo);
         rs.path.pts.push({cx1, cy1});
         rs.path.pts.push({cx2, cy2});
@@ -199,6 +206,8 @@ struct Shape::Impl
 
     void close()
     {
+        rs.path.own();
+
         //Don't close multiple times.
         if (rs.path.cmds.count > 0 && rs.path.cmds.last() == PathCommand::Close) return;
 
@@ -365,8 +374,11 @@ struct Shape::Impl
         memcpy(dup->rs.color, rs.color, sizeof(rs.color));
 
         //Path
-        dup->rs.path.cmds.push(rs.path.cmds);
-        dup->rs.path.pts.push(rs.path.pts);
+        if (rs.path.shared) dup->rs.path.share(rs.path);
+        else {
+            dup->rs.path.cmds.push(rs.path.cmds);
+            dup->rs.path.pts.push(rs.path.pts);
+        }
 
         //Stroke
         if (rs.stroke) {
@@ -387,6 +399,7 @@ struct Shape::Impl
     void reset()
     {
         PP(shape)->reset();
+        rs.path.release();
         rs.path.cmds.clear();
         rs.path.pts.clear();
 
@@ -98,6 +98,44 @@ struct TaskQueue {
         }
         ready.notify_one();
     }
+
+    bool remove(Task* task)
+    {
+        lock_guard<mutex> lock{mtx};
+
+        for (auto t = taskDeque.head; t; t = t->next) {
+            if (t != task) continue;
+            if (t == taskDeque.head) taskDeque.front();
+            else taskDeque.remove(t);
+            return true;
+        }
+        return false;
+    }
+};
+
+
+struct ParallelJob
+{
+    void (*func)(void* data, uint32_t idx);
+    void* data;
+    uint32_t cnt;
+    atomic<uint32_t> next{0};
+
+    void work()
+    {
+        for (auto idx = next++; idx < cnt; idx = next++) func(data, idx);
+    }
+};
+
+
+struct ParallelTask : Task
+{
+    ParallelJob* job = nullptr;
+
+    void run(TVG_UNUSED unsigned tid) override
+    {
+        job->work();
+    }
 };
 
 
@@ -170,6 +208,57 @@ struct TaskSchedulerImpl
         }
     }
 
+    //Take back the given task if it's still waiting in a queue.
+    bool cancel(Task* task)
+    {
+        for (auto tq = taskQueues.begin(); tq < taskQueues.end(); ++tq) {
+            if ((*tq)->remove(task)) {
+                task->ready = true;
+                task->pending = false;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //Unlike done(), this never waits on a task that no thread has picked up yet.
+    void join(Task* task)
+    {
+        if (cancel(task)) task->run(0);
+        else task->done();
+    }
+
+    void parallel(uint32_t cnt, void (*func)(void* data, uint32_t idx), void* data)
+    {
+        ParallelJob job;
+        job.func = func;
+        job.data = data;
+        job.cnt = cnt;
+
+        //Sync
+        if (threads.count == 0 || !_async || cnt < 2) {
+            job.work();
+            return;
+        }
+
+        //Async, the caller joins the job as well so that this never blocks on unstarted tasks.
+        //This allows to split the job even inside of a running task.
+        auto helperCnt = (cnt - 1 < threads.count) ? (cnt - 1) : threads.count;
+        auto helpers = new ParallelTask[helperCnt];
+
+        for (uint32_t i = 0; i < helperCnt; ++i) {
+            helpers[i].job = &job;
+            request(&helpers[i]);
+        }
+
+        job.work();
+
+        for (uint32_t i = 0; i < helperCnt; ++i) {
+            if (!cancel(&helpers[i])) helpers[i].done();
+        }
+        delete[](helpers);
+    }
+
     uint32_t threadCnt()
     {
         return threads.count;
@@ -184,7 +273,13 @@ struct TaskSchedulerImpl
 {
     TaskSchedulerImpl(TVG_UNUSED uint32_t threadCnt) {}
     void request(Task* task) { task->run(0); }
+    void join(TVG_UNUSED Task* task) {}
     uint32_t threadCnt() { return 0; }
+
+    void parallel(uint32_t cnt, void (*func)(void* data, uint32_t idx), void* data)
+    {
+        for (uint32_t idx = 0; idx < cnt; ++idx) func(data, idx);
+    }
 };
 
 #endif //THORVG_THREAD_SUPPORT
@@ -215,6 +310,12 @@ void TaskScheduler::request(Task* task)
 }
 
 
+void TaskScheduler::join(Task* task)
+{
+    if (inst) inst->join(task);
+}
+
+
 uint32_t TaskScheduler::threads()
 {
     if (inst) return inst->threadCnt();
@@ -226,4 +327,13 @@ void TaskScheduler::async(bool on)
 {
     //toggle async tasking for each thread on/off
     _async = on;
+}
+
+
+void TaskScheduler::parallel(uint32_t cnt, void (*job)(void* data, uint32_t idx), void* data)
+{
+    if (inst) inst->parallel(cnt, job, data);
+    else {
+        for (uint32_t idx = 0; idx < cnt; ++idx) job(data, idx);
+    }
 }
\ No newline at end of file
@@ -103,7 +103,9 @@ struct TaskScheduler
     static void init(uint32_t threads);
     static void term();
     static void request(Task* task);
+    static void join(Task* task);     //waits for the task, or runs it on the caller if it's still queued
     static void async(bool on);
+    static void parallel(uint32_t cnt, void (*job)(void* data, uint32_t idx), void* data);
 };
 
 }  //namespace
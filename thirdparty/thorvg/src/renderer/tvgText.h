@@ -120,7 +120,7 @@ struct Text::Impl
                 P(static_cast<LinearGradient*>(fill))->y1 *= scale;
                 P(static_cast<LinearGradient*>(fill))->x2 *= scale;
                 P(static_cast<LinearGradient*>(fill))->y2 *= scale;
-            } else {
+            } else if (fill->type() == Type::RadialGradient) {
                 P(static_cast<RadialGradient*>(fill))->cx *= scale;
                 P(static_cast<RadialGradient*>(fill))->cy *= scale;
                 P(static_cast<RadialGradient*>(fill))->r *= scale;
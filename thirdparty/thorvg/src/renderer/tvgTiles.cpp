@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include "tvgInlist.h"
+#include "tvgTiles.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+struct ImageTile
+{
+    INLIST_ITEM(ImageTile);
+
+    ImageTiles* owner;
+    uint32_t slot;
+    uint32_t stamp;                                 //the last fetch used it
+    uint32_t w, h;
+    uint32_t* data;                                 //follows the tile in the same allocation
+};
+
+static Inlist<ImageTile> _lru;                      //the recently used ones in front
+static Key _key;
+static size_t _used = 0;
+static uint32_t _stamp = 0;
+
+
+static uint32_t _reduce(uint32_t size, uint32_t level)
+{
+    return (size + (1 << level) - 1) >> level;
+}
+
+
+//copies the intersection of the source area (from) and the destination area (to)
+static void _copy(const uint32_t* src, uint32_t sstride, const RenderRegion& from, uint32_t* dst, uint32_t dstride, const RenderRegion& to)
+{
+    auto x0 = std::max(from.x, to.x);
+    auto y0 = std::max(from.y, to.y);
+    auto x1 = std::min(from.x + from.w, to.x + to.w);
+    auto y1 = std::min(from.y + from.h, to.y + to.h);
+    if (x1 <= x0 || y1 <= y0) return;
+
+    src += (y0 - from.y) * sstride + (x0 - from.x);
+    dst += (y0 - to.y) * dstride + (x0 - to.x);
+
+    for (auto y = y0; y < y1; ++y, src += sstride, dst += dstride) {
+        memcpy(dst, src, (x1 - x0) * sizeof(uint32_t));
+    }
+}
+
+
+static void _drop(ImageTile* tile)
+{
+    _lru.remove(tile);
+    _used -= tile->w * tile->h * sizeof(uint32_t);
+    free(tile);
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+size_t ImageTiles::budget = 64 * 1024 * 1024;
+
+
+ImageTiles::ImageTiles(uint32_t w, uint32_t h, uint32_t depth) : depth(depth)
+{
+    this->w = w;
+    this->h = h;
+
+    //down to the level fitting in a tile
+    uint32_t count = 0;
+    for (levels = 0; levels < 32; ++levels) {
+        auto lw = _reduce(w, levels);
+        auto lh = _reduce(h, levels);
+        offsets[levels] = count;
+        count += ((lw + SIZE - 1) / SIZE) * ((lh + SIZE - 1) / SIZE);
+        if (lw <= SIZE && lh <= SIZE) break;
+    }
+    ++levels;
+
+    slots = static_cast<ImageTile**>(calloc(count, sizeof(ImageTile*)));
+}
+
+
+ImageTiles::~ImageTiles()
+{
+    if (!slots) return;
+
+    ScopedLock lock(_key);
+    auto cnt = offsets[levels - 1] + 1;
+    for (uint32_t i = 0; i < cnt; ++i) {
+        if (slots[i]) _drop(slots[i]);
+    }
+    free(slots);
+}
+
+
+bool ImageTiles::fetch(const RenderRegion& region, uint32_t level, uint32_t* dst, uint32_t stride)
+{
+    if (!slots || level >= levels) return false;
+
+    auto lw = _reduce(w, level);
+    auto lh = _reduce(h, level);
+    if (region.x < 0 || region.y < 0 || region.w <= 0 || region.h <= 0) return false;
+    if (uint32_t(region.x + region.w) > lw || uint32_t(region.y + region.h) > lh) return false;
+
+    auto cols = (lw + SIZE - 1) / SIZE;
+    auto level_slots = slots + offsets[level];
+    int32_t tx0 = region.x / SIZE, tx1 = (region.x + region.w - 1) / SIZE;
+    int32_t ty0 = region.y / SIZE, ty1 = (region.y + region.h - 1) / SIZE;
+
+    //the cached ones are copied right away, the others are decoded together in a box
+    int32_t mx0 = INT32_MAX, my0 = INT32_MAX, mx1 = -1, my1 = -1;
+    {
+        ScopedLock lock(_key);
+        auto stamp = ++_stamp;
+        for (auto ty = ty0; ty <= ty1; ++ty) {
+            for (auto tx = tx0; tx <= tx1; ++tx) {
+                if (auto tile = level_slots[ty * cols + tx]) {
+                    _lru.remove(tile);
+                    _lru.front(tile);
+                    tile->stamp = stamp;
+                    _copy(tile->data, tile->w, {int32_t(tx * SIZE), int32_t(ty * SIZE), int32_t(tile->w), int32_t(tile->h)}, dst, stride, region);
+                } else {
+                    mx0 = std::min(mx0, tx);
+                    my0 = std::min(my0, ty);
+                    mx1 = std::max(mx1, tx);
+                    my1 = std::max(my1, ty);
+                }
+            }
+        }
+    }
+    if (mx1 < 0) return true;
+
+    //decoded without the lock, the other threads may fetch the same tiles in the meantime.
+    RenderRegion box = {int32_t(mx0 * SIZE), int32_t(my0 * SIZE), 0, 0};
+    box.w = std::min(uint32_t((mx1 + 1) * SIZE), lw) - box.x;
+    box.h = std::min(uint32_t((my1 + 1) * SIZE), lh) - box.y;
+
+    auto buffer = static_cast<uint32_t*>(malloc(box.w * box.h * sizeof(uint32_t)));
+    if (!buffer) return false;
+
+    auto ret = (level < depth) ? decode(box, level, buffer, box.w) : reduce(box, level, buffer);
+
+    if (ret) {
+        _copy(buffer, box.w, box, dst, stride, region);
+
+        ScopedLock lock(_key);
+        auto stamp = ++_stamp;
+        for (auto ty = my0; ty <= my1; ++ty) {
+            for (auto tx = mx0; tx <= mx1; ++tx) {
+                auto& slot = level_slots[ty * cols + tx];
+                if (slot) continue;
+                RenderRegion area = {int32_t(tx * SIZE), int32_t(ty * SIZE), 0, 0};
+                area.w = std::min(uint32_t(area.x) + SIZE, lw) - area.x;
+                area.h = std::min(uint32_t(area.y) + SIZE, lh) - area.y;
+                auto tile = static_cast<ImageTile*>(malloc(sizeof(ImageTile) + area.w * area.h * sizeof(uint32_t)));
+                if (!tile) continue;
+                tile->owner = this;
+                tile->slot = offsets[level] + ty * cols + tx;
+                tile->stamp = stamp;
+                tile->w = area.w;
+                tile->h = area.h;
+                tile->data = reinterpret_cast<uint32_t*>(tile + 1);
+                _copy(buffer, box.w, box, tile->data, tile->w, area);
+                _lru.front(tile);
+                _used += tile->w * tile->h * sizeof(uint32_t);
+                slot = tile;
+            }
+        }
+        //over the budget, the tiles of this fetch are kept anyway.
+        while (_used > budget && _lru.tail && _lru.tail->stamp != stamp) {
+            auto tile = _lru.tail;
+            tile->owner->slots[tile->slot] = nullptr;
+            _drop(tile);
+        }
+    }
+    free(buffer);
+    return ret;
+}
+
+
+//the levels beyond the decoder are halved from their upper levels, a row of tiles at a time
+bool ImageTiles::reduce(const RenderRegion& region, uint32_t level, uint32_t* dst)
+{
+    auto uw = _reduce(w, level - 1);
+    auto uh = _reduce(h, level - 1);
+    RenderRegion upper = {region.x * 2, 0, int32_t(std::min(uint32_t(region.w * 2), uw - region.x * 2)), 0};
+
+    auto buffer = static_cast<uint32_t*>(malloc(upper.w * SIZE * 2 * sizeof(uint32_t)));
+    if (!buffer) return false;
+
+    for (auto y = region.y; y < region.y + region.h; y += SIZE) {
+        auto rows = std::min(int32_t(SIZE), region.y + region.h - y);
+        upper.y = y * 2;
+        upper.h = std::min(uint32_t(rows * 2), uh - upper.y);
+        if (!fetch(upper, level - 1, buffer, upper.w)) {
+            free(buffer);
+            return false;
+        }
+        //average of the 2x2 pixels, the last ones of an odd size are repeated.
+        for (int32_t j = 0; j < rows; ++j) {
+            auto s0 = buffer + (j * 2) * upper.w;
+            auto s1 = (j * 2 + 1 < upper.h) ? s0 + upper.w : s0;
+            auto d = dst + (y - region.y + j) * region.w;
+            for (int32_t i = 0; i < region.w; ++i) {
+                auto x0 = i * 2;
+                auto x1 = (x0 + 1 < upper.w) ? x0 + 1 : x0;
+                uint32_t c[4] = {s0[x0], s0[x1], s1[x0], s1[x1]};
+                uint32_t ag = 0, rb = 0;
+                for (int k = 0; k < 4; ++k) {
+                    ag += (c[k] >> 8) & 0x00ff00ff;
+                    rb += c[k] & 0x00ff00ff;
+                }
+                d[i] = ((((ag + 0x00020002) >> 2) & 0x00ff00ff) << 8) | (((rb + 0x00020002) >> 2) & 0x00ff00ff);
+            }
+        }
+    }
+    free(buffer);
+    return true;
+}
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#ifndef _TVG_TILES_H_
+#define _TVG_TILES_H_
+
+#include "tvgRender.h"
+
+struct ImageTile;
+
+/* The tiles of a large image, decoded on demand and cached.
+   The tiles of all the images share a memory budget, the least recently used ones are dropped over it. */
+struct ImageTiles : RenderTiles
+{
+    static constexpr uint32_t SIZE = 256;           //the tile width and height
+    static size_t budget;                           //the memory of the cached tiles in bytes
+
+    //the decoder provides the levels less than the depth, the deeper ones are reduced from their upper levels.
+    ImageTiles(uint32_t w, uint32_t h, uint32_t depth);
+    ~ImageTiles();
+
+    bool fetch(const RenderRegion& region, uint32_t level, uint32_t* dst, uint32_t stride) override;
+
+protected:
+    //decodes the region of the level to dst, the region is aligned to the tiles. Called by the threads concurrently.
+    virtual bool decode(const RenderRegion& region, uint32_t level, uint32_t* dst, uint32_t stride) = 0;
+
+private:
+    ImageTile** slots = nullptr;                    //the cached tiles of all the levels
+    uint32_t offsets[32];                           //the first slot of each level
+    uint32_t depth;
+
+    bool reduce(const RenderRegion& region, uint32_t level, uint32_t* dst);
+};
+
+#endif //_TVG_TILES_H_
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+#
+# Generates the bucket seeds of the perfect hash tables of the svg loader (see tvgSvgLookup.h)
+# and rewrites them in place:
+#
+#     static constexpr uint16_t <Table>Seeds[] = {...};
+#     SVG_LOOKUP_DEF(<Lookup>, <Table>, <Table>Seeds);
+#
+# Run it after changing the keys of a table, the build rejects the stale or colliding seeds.
+#
+# usage: svg-lookup-seeds.py [src/loaders/svg/tvgSvgLoader.cpp]
+
+import os
+import re
+import sys
+
+M32 = 0xffffffff
+M64 = 0xffffffffffffffff
+
+
+def svg_hash(key):
+    h = 0xcbf29ce484222325
+    for c in key.encode():
+        if ord('A') <= c <= ord('Z'):
+            c |= 0x20
+        h = ((h ^ c) * 0x100000001b3) & M64
+    return h
+
+
+def lookup_size(keys):
+    size = 4
+    while size < 2 * keys:
+        size <<= 1
+    return size
+
+
+def slot(h, seed, size):
+    h = (h & M32) ^ ((seed * 0x9e3779b9) & M32)
+    h ^= h >> 16
+    h = (h * 0x85ebca6b) & M32
+    h ^= h >> 13
+    h = (h * 0xc2b2ae35) & M32
+    h ^= h >> 16
+    return h & (size - 1)
+
+
+def seeds(keys):
+    n = len(keys)
+    size = lookup_size(n)
+    hashes = [svg_hash(k) for k in keys]
+    buckets = [[] for _ in range(n)]
+    for h in hashes:
+        buckets[(h >> 32) % n].append(h)
+
+    slots = [False] * size
+    result = [0] * n
+    # place the crowded buckets first while the slots are sparse
+    for b in sorted(range(n), key=lambda b: -len(buckets[b])):
+        if not buckets[b]:
+            continue
+        for seed in range(0xffff):
+            taken = [slot(h, seed, size) for h in buckets[b]]
+            if len(set(taken)) == len(taken) and not any(slots[s] for s in taken):
+                for s in taken:
+                    slots[s] = True
+                result[b] = seed
+                break
+        else:
+            sys.exit("no perfect hash of %s" % keys)
+    return result
+
+
+def table_keys(source, table):
+    body = re.search(r'\}\s*' + re.escape(table) + r'\[\]\s*=\s*\{(.*?)\n\};', source, re.S)
+    if not body:
+        sys.exit("table %s not found" % table)
+    keys = []
+    for line in body.group(1).splitlines():
+        # { "key", ... } or NAME_DEF(key, ...)
+        entry = re.match(r'\s*\{\s*"([^"]*)"', line) or re.match(r'\s*[A-Z]+_DEF\(\s*([^,\s]+)\s*,', line)
+        if entry:
+            keys.append(entry.group(1))
+    return keys
+
+
+def main():
+    path = sys.argv[1] if len(sys.argv) > 1 else os.path.join(os.path.dirname(__file__), "src/loaders/svg/tvgSvgLoader.cpp")
+    with open(path) as f:
+        source = f.read()
+
+    def generate(match):
+        table, seed_name = match.group(2), match.group(3)
+        values = [str(s) for s in seeds(table_keys(source, table))]
+        if len(values) <= 24:
+            values = "{" + ", ".join(values) + "}"
+        else:
+            rows = [", ".join(values[i:i + 24]) for i in range(0, len(values), 24)]
+            values = "{\n    " + ",\n    ".join(rows) + "\n}"
+        return "static constexpr uint16_t %s[] = %s;\nSVG_LOOKUP_DEF(%s, %s, %s);" % (seed_name, values, match.group(1), table, seed_name)
+
+    pattern = r'static constexpr uint16_t \w+\[\] = \{[^}]*\};\nSVG_LOOKUP_DEF\((\w+), (\w+), (\w+)\);'
+    source, count = re.subn(pattern, generate, source)
+
+    with open(path, "w") as f:
+        f.write(source)
+    print("%d tables" % count)
+
+
+if __name__ == "__main__":
+    main()
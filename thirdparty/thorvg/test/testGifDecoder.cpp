@@ -0,0 +1,386 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*
+ * GIF decoding test of the built-in decoder against the indices the images are encoded from.
+ * The frames are encoded in the test with its own LZW, with the clear codes at random, the deferred
+ * clear at the full table and the sub-blocks of random sizes, and placed partly out of the screen.
+ *
+ * usage: tvgGifDecoder [images]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "tvgGifd.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+struct Frame
+{
+    uint32_t x, y, w, h;
+    std::vector<uint8_t> indices;           //row by row
+    std::vector<uint8_t> palette;           //the local one, empty for the global one
+    int32_t transparent = -1;
+    uint32_t delay = 0;
+    uint8_t dispose = 0;                    //as in the graphic control
+    uint8_t codeSize;
+    bool interlace = false;
+};
+
+
+struct Gif
+{
+    uint32_t w, h;
+    std::vector<uint8_t> palette;           //the global one
+    std::vector<Frame> frames;
+};
+
+
+static uint64_t _rand(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+static void _le16(std::vector<uint8_t>& out, uint32_t v)
+{
+    out.push_back(uint8_t(v));
+    out.push_back(uint8_t(v >> 8));
+}
+
+
+struct Codes
+{
+    std::vector<uint8_t> out;
+    uint32_t bits = 0;
+    uint32_t count = 0;
+
+    void put(uint32_t code, uint32_t size)
+    {
+        bits |= code << count;
+        count += size;
+        while (count >= 8) {
+            out.push_back(uint8_t(bits));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+};
+
+
+//the encoder adds a string a code ahead of the decoder, the code size grows when the decoder would fill it
+static std::vector<uint8_t> _lzw(const std::vector<uint8_t>& indices, uint8_t minSize, uint64_t& state)
+{
+    auto clear = 1u << minSize;
+    auto eoi = clear + 1;
+    auto deferred = _rand(state) % 2;       //the table is kept full instead of cleared
+    auto interval = (_rand(state) % 3 == 0) ? 1 + uint32_t(_rand(state) % 500) : 0;
+
+    Codes codes;
+    std::unordered_map<uint32_t, uint32_t> table;
+    uint32_t size, next;
+    auto reset = [&]() {
+        table.clear();
+        size = minSize + 1;
+        next = clear + 2;
+    };
+    reset();
+    codes.put(clear, size);
+
+    int32_t cur = -1;
+    uint32_t emitted = 0;
+    auto emit = [&](uint32_t code, uint8_t index, bool last) {
+        codes.put(code, size);
+        ++emitted;
+        if (last) return;
+        if (next < 4096) {
+            table[(code << 8) | index] = next;
+            if (++next > (1u << size) && size < 12) ++size;
+        }
+        if ((next == 4096 && !deferred) || (interval && emitted % interval == 0)) {
+            codes.put(clear, size);
+            reset();
+        }
+    };
+
+    for (auto index : indices) {
+        if (cur < 0) {
+            cur = index;
+            continue;
+        }
+        auto found = table.find((uint32_t(cur) << 8) | index);
+        if (found != table.end()) {
+            cur = int32_t(found->second);
+            continue;
+        }
+        emit(uint32_t(cur), index, false);
+        cur = index;
+    }
+    if (cur >= 0) emit(uint32_t(cur), 0, true);
+    codes.put(eoi, size);
+    if (codes.count > 0) codes.put(0, 8 - codes.count);
+    return codes.out;
+}
+
+
+static std::vector<uint8_t> _encode(const Gif& gif, uint64_t& state)
+{
+    std::vector<uint8_t> out = {'G', 'I', 'F', '8', '9', 'a'};
+    _le16(out, gif.w);
+    _le16(out, gif.h);
+
+    auto bits = [](size_t colors) { uint8_t n = 0; while ((2u << n) < colors) ++n; return n; };
+    out.push_back(gif.palette.empty() ? 0 : uint8_t(0x80 | bits(gif.palette.size() / 3)));
+    out.push_back(0);
+    out.push_back(0);
+    out.insert(out.end(), gif.palette.begin(), gif.palette.end());
+
+    //an application extension is skipped
+    const char* loop = "\x21\xff\x0bNETSCAPE2.0\x03\x01\x00\x00\x00";
+    out.insert(out.end(), loop, loop + 19);
+
+    for (auto& frame : gif.frames) {
+        uint8_t control[] = {0x21, 0xf9, 4, uint8_t((frame.dispose << 2) | (frame.transparent >= 0 ? 1 : 0)),
+                             uint8_t(frame.delay), uint8_t(frame.delay >> 8), uint8_t(frame.transparent >= 0 ? frame.transparent : 0), 0};
+        out.insert(out.end(), control, control + sizeof(control));
+
+        out.push_back(0x2c);
+        _le16(out, frame.x);
+        _le16(out, frame.y);
+        _le16(out, frame.w);
+        _le16(out, frame.h);
+        auto packed = frame.interlace ? 0x40 : 0;
+        if (!frame.palette.empty()) packed |= 0x80 | bits(frame.palette.size() / 3);
+        out.push_back(uint8_t(packed));
+        out.insert(out.end(), frame.palette.begin(), frame.palette.end());
+
+        //the rows in the order of the passes
+        std::vector<uint8_t> stream;
+        if (frame.interlace) {
+            static const uint8_t START[4] = {0, 4, 2, 1};
+            static const uint8_t STEP[4] = {8, 8, 4, 2};
+            for (int pass = 0; pass < 4; ++pass) {
+                for (auto y = uint32_t(START[pass]); y < frame.h; y += STEP[pass]) {
+                    stream.insert(stream.end(), frame.indices.begin() + y * frame.w, frame.indices.begin() + (y + 1) * frame.w);
+                }
+            }
+        } else stream = frame.indices;
+
+        out.push_back(frame.codeSize);
+        auto data = _lzw(stream, frame.codeSize, state);
+        for (size_t pos = 0; pos < data.size();) {
+            auto n = std::min(data.size() - pos, size_t(1 + _rand(state) % 255));
+            out.push_back(uint8_t(n));
+            out.insert(out.end(), data.begin() + pos, data.begin() + pos + n);
+            pos += n;
+        }
+        out.push_back(0);
+    }
+    out.push_back(0x3b);
+    return out;
+}
+
+
+static std::vector<uint8_t> _palette(uint32_t colors, uint64_t& state)
+{
+    std::vector<uint8_t> palette(colors * 3);
+    for (auto& c : palette) c = uint8_t(_rand(state));
+    return palette;
+}
+
+
+//runs of the same indices and noise, the strings of the table have something to do
+static Gif _gif(uint32_t w, uint32_t h, uint32_t frames, uint64_t& state)
+{
+    Gif gif;
+    gif.w = w;
+    gif.h = h;
+    if (_rand(state) % 4) gif.palette = _palette(2u << (_rand(state) % 8), state);
+
+    for (uint32_t i = 0; i < frames; ++i) {
+        Frame frame;
+        //partly out of the screen at times
+        frame.w = 1 + uint32_t(_rand(state) % (w + w / 4));
+        frame.h = 1 + uint32_t(_rand(state) % (h + h / 4));
+        frame.x = uint32_t(_rand(state) % (w + 2));
+        frame.y = uint32_t(_rand(state) % (h + 2));
+        if (gif.palette.empty() || _rand(state) % 3 == 0) frame.palette = _palette(2u << (_rand(state) % 8), state);
+        auto colors = uint32_t((frame.palette.empty() ? gif.palette : frame.palette).size() / 3);
+        frame.codeSize = 2;
+        while ((1u << frame.codeSize) < colors) ++frame.codeSize;
+        if (_rand(state) % 2) frame.transparent = int32_t(_rand(state) % colors);
+        frame.delay = uint32_t(_rand(state) % 200);
+        frame.dispose = uint8_t(_rand(state) % 4);
+        frame.interlace = _rand(state) % 2;
+
+        //an index out of the palette at times, the code size allows it
+        auto max = (_rand(state) % 8 == 0) ? (1u << frame.codeSize) : colors;
+        auto run = 1 + uint32_t(_rand(state) % 16);
+        frame.indices.resize(size_t(frame.w) * frame.h);
+        uint8_t index = 0;
+        for (size_t p = 0; p < frame.indices.size(); ++p) {
+            if (p % run == 0) index = uint8_t(_rand(state) % max);
+            frame.indices[p] = index;
+        }
+        gif.frames.push_back(frame);
+    }
+    return gif;
+}
+
+
+static uint32_t _expected(const Gif& gif, const Frame& frame, uint32_t x, uint32_t y, bool abgr)
+{
+    auto index = frame.indices[size_t(y) * frame.w + x];
+    auto& palette = frame.palette.empty() ? gif.palette : frame.palette;
+    if (index * 3u >= palette.size() || int32_t(index) == frame.transparent) return 0;
+    auto c = &palette[index * 3];
+    if (abgr) return 0xff000000 | (c[2] << 16) | (c[1] << 8) | c[0];
+    return 0xff000000 | (c[0] << 16) | (c[1] << 8) | c[2];
+}
+
+
+static bool _verify(const Gif& gif, const std::vector<uint8_t>& data, const char* name)
+{
+    static const uint8_t DISPOSE[4] = {0, 0, 1, 2};
+
+    uint32_t w, h, frames;
+    auto decoder = gifdHeader((const char*)data.data(), uint32_t(data.size()), &w, &h, &frames);
+    if (!decoder || w != gif.w || h != gif.h || frames != gif.frames.size()) {
+        fprintf(stderr, "%s: the header isn't read\n", name);
+        gifdDelete(decoder);
+        return false;
+    }
+
+    auto ret = true;
+    for (uint32_t i = 0; i < frames && ret; ++i) {
+        auto& src = gif.frames[i];
+        auto info = gifdFrame(decoder, i);
+        //the frame is clipped to the screen, the one out of the screen is empty at the origin
+        uint32_t fx = src.x, fy = src.y, fw = 0, fh = 0;
+        if (src.x < w && src.y < h) {
+            fw = std::min(src.w, w - src.x);
+            fh = std::min(src.h, h - src.y);
+        } else fx = fy = 0;
+        if (info->x != fx || info->y != fy || info->w != fw || info->h != fh || info->delay != src.delay || info->dispose != DISPOSE[src.dispose]) {
+            fprintf(stderr, "%s: the frame %u is (%u, %u, %u, %u) %u %u, not (%u, %u, %u, %u) %u %u\n", name, i, info->x, info->y, info->w, info->h, info->delay, info->dispose, fx, fy, fw, fh, src.delay, DISPOSE[src.dispose]);
+            ret = false;
+            break;
+        }
+
+        //the pixels out of the stride are kept
+        auto stride = fw + 5;
+        std::vector<uint32_t> dst(size_t(stride) * std::max(fh, 1u), 0xdeadbeef);
+        for (auto abgr : {true, false}) {
+            if (!gifdDecompress(decoder, i, dst.data(), stride, abgr)) {
+                fprintf(stderr, "%s: the frame %u is not decoded\n", name, i);
+                ret = false;
+                break;
+            }
+            for (uint32_t y = 0; y < fh && ret; ++y) {
+                for (uint32_t x = 0; x < stride; ++x) {
+                    auto expected = (x < fw) ? _expected(gif, src, x, y, abgr) : 0xdeadbeef;
+                    if (dst[size_t(y) * stride + x] != expected) {
+                        fprintf(stderr, "%s: the pixel (%u, %u) of the frame %u is %08x, not %08x (%s)\n", name, x, y, i, dst[size_t(y) * stride + x], expected, abgr ? "abgr" : "argb");
+                        ret = false;
+                        break;
+                    }
+                }
+            }
+            if (!ret) break;
+        }
+    }
+    gifdDelete(decoder);
+    return ret;
+}
+
+
+//broken data is decoded as far as it goes without reading out of it
+static void _truncated(const std::vector<uint8_t>& data)
+{
+    for (size_t size = 0; size < data.size(); size += 1 + size / 5) {
+        std::vector<uint8_t> copy(data.begin(), data.begin() + size);
+        uint32_t w, h, frames;
+        auto decoder = gifdHeader((const char*)copy.data(), uint32_t(copy.size()), &w, &h, &frames);
+        if (!decoder) continue;
+        for (uint32_t i = 0; i < frames; ++i) {
+            auto info = gifdFrame(decoder, i);
+            std::vector<uint32_t> dst(std::max(size_t(info->w) * info->h, size_t(1)));
+            gifdDecompress(decoder, i, dst.data(), info->w, true);
+        }
+        gifdDelete(decoder);
+    }
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    auto cnt = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 500UL;
+    uint64_t state = 0x4749464445434f44ULL;
+    auto failures = 0;
+    char name[64];
+
+    for (unsigned long i = 0; i < cnt; ++i) {
+        auto large = (i % 10 == 0);
+        auto gif = _gif(1 + uint32_t(_rand(state) % (large ? 400 : 40)), 1 + uint32_t(_rand(state) % (large ? 300 : 40)), 1 + uint32_t(_rand(state) % 4), state);
+        auto data = _encode(gif, state);
+        snprintf(name, sizeof(name), "gif %lu, %ux%u", i, gif.w, gif.h);
+        if (!_verify(gif, data, name)) ++failures;
+        if (i < 30) _truncated(data);
+    }
+
+    //the decoding speed of a full screen frame
+    auto gif = _gif(512, 512, 1, state);
+    auto& frame = gif.frames[0];
+    frame.x = frame.y = 0;
+    frame.w = frame.h = 512;
+    frame.indices.resize(512 * 512);
+    for (size_t p = 0; p < frame.indices.size(); ++p) frame.indices[p] = uint8_t(((p % 512) / 16 + (p / 512) / 16 + _rand(state) % 3) % (1u << frame.codeSize));
+    auto data = _encode(gif, state);
+    uint32_t w, h, frames;
+    auto decoder = gifdHeader((const char*)data.data(), uint32_t(data.size()), &w, &h, &frames);
+    std::vector<uint32_t> dst(size_t(w) * h);
+    auto best = 1e9;
+    for (int r = 0; r < 8; ++r) {
+        auto begin = std::chrono::steady_clock::now();
+        gifdDecompress(decoder, 0, dst.data(), w, true);
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        if (ms < best) best = ms;
+    }
+    gifdDelete(decoder);
+    printf("512x512 frame, %zu bytes: %.2f ms (%.1f Mpixels/s)\n", data.size(), best, double(w) * h / best / 1000.0);
+
+    printf("failures: %d\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*
+ * Animated image test of ImageFrames, the frames composited on a canvas with their disposals.
+ * The canvas after every seek, forward and back, is compared to the one drawn from the first frame
+ * by a straight model keeping the whole canvas for FrameDispose::Previous.
+ * The frames are opaque or transparent pixels only, so the composition is exact on both.
+ *
+ * usage: tvgImageFrames [animations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+#include "tvgImageFrames.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+static uint64_t _rand(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+static uint32_t _pixel(uint32_t index, int32_t x, int32_t y)
+{
+    auto h = (index + 1) * 0x9e3779b9u ^ uint32_t(x) * 0x85ebca6bu ^ uint32_t(y) * 0xc2b2ae35u;
+    h ^= h >> 15;
+    //a third of the pixels is transparent
+    if (h % 3 == 0) return 0;
+    return 0xff000000 | (h & 0x00ffffff);
+}
+
+
+struct TestFrames : ImageFrames
+{
+    int32_t decoded = -1;
+    uint32_t failures = 0;
+
+    bool decode(uint32_t index, uint32_t* dst, uint32_t stride) override
+    {
+        //in order from the first frame, the ones out of the canvas are skipped
+        if (int32_t(index) <= decoded) {
+            fprintf(stderr, "the frame %u is decoded after the frame %d\n", index, decoded);
+            ++failures;
+        }
+        decoded = index;
+        auto& area = frames[index].area;
+        for (int32_t y = 0; y < area.h; ++y) {
+            for (int32_t x = 0; x < area.w; ++x) dst[y * stride + x] = _pixel(index, x, y);
+        }
+        return true;
+    }
+};
+
+
+//the canvas of the frame drawn from the first one
+static std::vector<uint32_t> _model(const Array<ImageFrame>& frames, uint32_t index, int32_t w, int32_t h)
+{
+    std::vector<uint32_t> canvas(size_t(w) * h, 0), saved;
+    auto inside = [&](const RenderRegion& area, int32_t x, int32_t y) {
+        return x >= std::max(area.x, 0) && x < std::min(area.x + area.w, w) && y >= std::max(area.y, 0) && y < std::min(area.y + area.h, h);
+    };
+
+    for (uint32_t i = 0; i <= index; ++i) {
+        if (i > 0) {
+            auto& prev = frames[i - 1];
+            for (int32_t y = 0; y < h; ++y) {
+                for (int32_t x = 0; x < w; ++x) {
+                    if (!inside(prev.area, x, y)) continue;
+                    if (prev.dispose == FrameDispose::Background) canvas[y * w + x] = 0;
+                    else if (prev.dispose == FrameDispose::Previous) canvas[y * w + x] = saved[y * w + x];
+                }
+            }
+        }
+        auto& frame = frames[i];
+        if (frame.dispose == FrameDispose::Previous) saved = canvas;
+        for (int32_t y = 0; y < h; ++y) {
+            for (int32_t x = 0; x < w; ++x) {
+                if (!inside(frame.area, x, y)) continue;
+                auto s = _pixel(i, x - frame.area.x, y - frame.area.y);
+                if (!frame.blend || s) canvas[y * w + x] = s;
+            }
+        }
+    }
+    return canvas;
+}
+
+
+static uint32_t _index(const Array<ImageFrame>& frames, float no)
+{
+    float time = 0.0f;
+    for (uint32_t i = 0; i < frames.count; ++i) {
+        time += frames[i].delay;
+        if (no < time) return i;
+    }
+    return frames.count - 1;
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    auto cnt = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 300UL;
+    uint64_t state = 0x4652414d45534551ULL;
+    auto failures = 0UL;
+
+    for (unsigned long n = 0; n < cnt && failures < 10; ++n) {
+        auto w = 1 + int32_t(_rand(state) % 48);
+        auto h = 1 + int32_t(_rand(state) % 48);
+
+        TestFrames frames;
+        auto count = 1 + uint32_t(_rand(state) % 12);
+        for (uint32_t i = 0; i < count; ++i) {
+            //partly out of the canvas at times
+            ImageFrame frame;
+            frame.area.w = 1 + int32_t(_rand(state) % (w + 8));
+            frame.area.h = 1 + int32_t(_rand(state) % (h + 8));
+            frame.area.x = int32_t(_rand(state) % (w + 4)) - 4;
+            frame.area.y = int32_t(_rand(state) % (h + 4)) - 4;
+            frame.delay = uint32_t(_rand(state) % 10);
+            frame.dispose = FrameDispose(_rand(state) % 3);
+            frame.blend = _rand(state) % 2;
+            frames.frames.push(frame);
+        }
+
+        RenderSurface surface;
+        if (!frames.init(&surface, w, h, ColorSpace::ARGB8888)) return 1;
+
+        //forward in steps, then at random back and forth
+        auto total = frames.total();
+        int32_t shown = -1;
+        for (int step = 0; step < 40; ++step) {
+            auto no = (step < 16) ? total * step / 16.0f : float(_rand(state) % (uint32_t(total) + 2));
+            auto index = _index(frames.frames, no);
+            if (int32_t(index) < shown) frames.decoded = -1;
+            auto seeked = frames.seek(no);
+            if (seeked != (int32_t(index) != shown)) {
+                fprintf(stderr, "animation %lu: the seek to %g (frame %u from %d) returns %d\n", n, no, index, shown, seeked);
+                ++failures;
+            }
+            shown = index;
+
+            auto expected = _model(frames.frames, index, w, h);
+            for (int32_t p = 0; p < w * h; ++p) {
+                if (surface.buf32[p] != expected[p]) {
+                    fprintf(stderr, "animation %lu: the pixel (%d, %d) of the frame %u is %08x, not %08x\n", n, p % w, p / w, index, surface.buf32[p], expected[p]);
+                    ++failures;
+                    break;
+                }
+            }
+        }
+        failures += frames.failures;
+        free(surface.buf32);
+    }
+
+    printf("failures: %lu\n", failures);
+
+    return failures ? 1 : 0;
+}
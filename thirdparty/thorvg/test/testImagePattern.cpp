@@ -0,0 +1,305 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Image pattern test of the software rasterizer, the pattern fills and the nine-slice pictures drawn on a canvas
+ * against the pixels sampled from the image here. The translations by whole pixels copy the image pixels as they are,
+ * in the pad, repeat and reflect spreads. The other transforms and the slices sample the image bilinearly, within
+ * a few steps of the exact interpolation as its fixed point truncates. The corners of a nine-slice picture keep
+ * the image pixels exactly.
+ *
+ * usage: tvgImagePattern [drawings]
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <vector>
+#include <thorvg.h>
+
+using namespace tvg;
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+#define WIDTH 96
+#define HEIGHT 80
+
+struct Image
+{
+    uint32_t w, h;
+    std::vector<uint32_t> pixels;
+};
+
+//the nine-slice mapping of an axis from the picture size to the image
+struct Slice
+{
+    double size, image, lo, hi;
+
+    double unslice(double pos) const
+    {
+        auto scale = (lo + hi > size) ? size / (lo + hi) : 1.0;
+        auto dlo = lo * scale;
+        auto dhi = hi * scale;
+        if (pos < dlo) return pos * lo / dlo;
+        if (pos < size - dhi) return lo + (pos - dlo) * (image - lo - hi) / (size - dlo - dhi);
+        return image - hi + (pos - size + dhi) * hi / dhi;
+    }
+};
+
+
+static uint64_t _rand(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+static uint32_t _premultiplied(uint64_t& state)
+{
+    auto c = uint32_t(_rand(state));
+    auto a = c >> 24;
+    //a quarter of the pixels is opaque, another one transparent
+    if ((c & 3) == 0) a = 255;
+    else if ((c & 3) == 1) a = 0;
+    auto r = ((c >> 16) & 0xff) * a / 255;
+    auto g = ((c >> 8) & 0xff) * a / 255;
+    auto b = (c & 0xff) * a / 255;
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+
+static Image _image(uint64_t& state, uint32_t min, uint32_t max)
+{
+    Image image;
+    image.w = min + uint32_t(_rand(state) % (max - min + 1));
+    image.h = min + uint32_t(_rand(state) % (max - min + 1));
+    image.pixels.resize(image.w * image.h);
+    for (auto& p : image.pixels) p = _premultiplied(state);
+    return image;
+}
+
+
+static int32_t _wrap(FillSpread spread, int32_t i, int32_t size)
+{
+    if (spread == FillSpread::Pad) return (i < 0) ? 0 : (i >= size ? size - 1 : i);
+    if (spread == FillSpread::Repeat) return ((i % size) + size) % size;
+    auto j = ((i % (2 * size)) + 2 * size) % (2 * size);
+    return (j < size) ? j : 2 * size - 1 - j;
+}
+
+
+//the pixel at the point of the image, its pixel centers at the halves
+static uint32_t _bilinear(const Image& image, FillSpread spread, double x, double y)
+{
+    auto u = x - 0.5;
+    auto v = y - 0.5;
+    auto iu = int32_t(floor(u));
+    auto iv = int32_t(floor(v));
+    auto du = u - iu;
+    auto dv = v - iv;
+    auto x0 = _wrap(spread, iu, image.w), x1 = _wrap(spread, iu + 1, image.w);
+    auto y0 = _wrap(spread, iv, image.h), y1 = _wrap(spread, iv + 1, image.h);
+    uint32_t c[4] = {image.pixels[y0 * image.w + x0], image.pixels[y0 * image.w + x1], image.pixels[y1 * image.w + x0], image.pixels[y1 * image.w + x1]};
+    uint32_t ret = 0;
+    for (int shift = 0; shift < 32; shift += 8) {
+        auto top = ((c[0] >> shift) & 0xff) * (1.0 - du) + ((c[1] >> shift) & 0xff) * du;
+        auto bottom = ((c[2] >> shift) & 0xff) * (1.0 - du) + ((c[3] >> shift) & 0xff) * du;
+        ret |= uint32_t(lround(top * (1.0 - dv) + bottom * dv)) << shift;
+    }
+    return ret;
+}
+
+
+static bool _close(uint32_t a, uint32_t b, int tolerance)
+{
+    for (int shift = 0; shift < 32; shift += 8) {
+        if (abs(int((a >> shift) & 0xff) - int((b >> shift) & 0xff)) > tolerance) return false;
+    }
+    return true;
+}
+
+
+//the drawn pixels against the expected ones, the pixels off the drawn area are cleared
+static bool _verify(const char* name, unsigned long n, const std::vector<uint32_t>& buffer, const std::vector<uint32_t>& expected, int tolerance)
+{
+    for (uint32_t i = 0; i < WIDTH * HEIGHT; ++i) {
+        if (!_close(buffer[i], expected[i], tolerance)) {
+            fprintf(stderr, "drawing %lu (%s): the pixel (%u, %u) is %08x, not %08x\n", n, name, i % WIDTH, i / WIDTH, buffer[i], expected[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static void _draw(Canvas* canvas, std::unique_ptr<Paint> paint)
+{
+    canvas->push(std::move(paint));
+    canvas->update();
+    canvas->draw();
+    canvas->sync();
+    canvas->clear();
+}
+
+
+//a rectangle filled with the pattern of the image, the pattern transformed by the matrix
+static bool _pattern(Canvas* canvas, const std::vector<uint32_t>& buffer, uint64_t& state, unsigned long n, bool translated)
+{
+    auto image = _image(state, 1, 24);
+    auto spread = FillSpread(_rand(state) % 3);
+
+    Matrix m;
+    if (translated) {
+        m = {1, 0, float(int32_t(_rand(state) % 80) - 40), 0, 1, float(int32_t(_rand(state) % 80) - 40), 0, 0, 1};
+    } else {
+        auto sx = 0.4f + float(_rand(state) % 1000) * 0.0031f;
+        auto sy = (_rand(state) % 2) ? sx : 0.4f + float(_rand(state) % 1000) * 0.0031f;
+        auto angle = (_rand(state) % 2) ? 0.0f : float(_rand(state) % 3600) * 0.1f * 3.14159265f / 180.0f;
+        auto c = cosf(angle), s = sinf(angle);
+        m = {sx * c, -sy * s, float(int32_t(_rand(state) % 800) - 400) * 0.1f, sx * s, sy * c, float(int32_t(_rand(state) % 800) - 400) * 0.1f, 0, 0, 1};
+    }
+
+    auto x0 = uint32_t(_rand(state) % WIDTH);
+    auto y0 = uint32_t(_rand(state) % HEIGHT);
+    auto w = 1 + uint32_t(_rand(state) % (WIDTH - x0));
+    auto h = 1 + uint32_t(_rand(state) % (HEIGHT - y0));
+
+    auto picture = Picture::gen();
+    picture->load(image.pixels.data(), image.w, image.h, image.w, SwCanvas::ARGB8888, true);
+    auto pattern = ImagePattern::gen();
+    pattern->picture(std::move(picture));
+    pattern->spread(spread);
+    pattern->transform(m);
+    auto shape = Shape::gen();
+    shape->appendRect(float(x0), float(y0), float(w), float(h));
+    shape->fill(std::move(pattern));
+    _draw(canvas, std::move(shape));
+
+    //the canvas pixel centers back in the image
+    double det = double(m.e11) * m.e22 - double(m.e12) * m.e21;
+    std::vector<uint32_t> expected(WIDTH * HEIGHT, 0);
+    for (auto y = y0; y < y0 + h; ++y) {
+        for (auto x = x0; x < x0 + w; ++x) {
+            if (translated) {
+                auto ix = _wrap(spread, int32_t(x) - int32_t(m.e13), image.w);
+                auto iy = _wrap(spread, int32_t(y) - int32_t(m.e23), image.h);
+                expected[y * WIDTH + x] = image.pixels[iy * image.w + ix];
+            } else {
+                auto px = x + 0.5 - m.e13;
+                auto py = y + 0.5 - m.e23;
+                auto u = (m.e22 * px - m.e12 * py) / det;
+                auto v = (m.e11 * py - m.e21 * px) / det;
+                expected[y * WIDTH + x] = _bilinear(image, spread, u, v);
+            }
+        }
+    }
+
+    static const char* spreads[] = {"pad", "reflect", "repeat"};
+    char name[128];
+    snprintf(name, sizeof(name), "%ux%u %s pattern by %g, %g, %g, %g at %g, %g", image.w, image.h, spreads[int(spread)], m.e11, m.e12, m.e21, m.e22, m.e13, m.e23);
+    return _verify(name, n, buffer, expected, translated ? 0 : 5);
+}
+
+
+//a nine-slice picture at whole pixels, sized over or under its corners
+static bool _nineSlice(Canvas* canvas, const std::vector<uint32_t>& buffer, uint64_t& state, unsigned long n)
+{
+    auto image = _image(state, 3, 24);
+    auto left = uint32_t(_rand(state) % (image.w - 1));
+    auto right = uint32_t(_rand(state) % (image.w - left));
+    auto top = uint32_t(_rand(state) % (image.h - 1));
+    auto bottom = uint32_t(_rand(state) % (image.h - top));
+    if (left + right + top + bottom == 0) left = 1;
+
+    auto w = 1 + uint32_t(_rand(state) % 72);
+    auto h = 1 + uint32_t(_rand(state) % 64);
+    auto x0 = uint32_t(_rand(state) % (WIDTH - w + 1));
+    auto y0 = uint32_t(_rand(state) % (HEIGHT - h + 1));
+
+    auto picture = Picture::gen();
+    picture->load(image.pixels.data(), image.w, image.h, image.w, SwCanvas::ARGB8888, true);
+    picture->size(float(w), float(h));
+    picture->slice(float(left), float(top), float(right), float(bottom));
+    picture->translate(float(x0), float(y0));
+    _draw(canvas, std::move(picture));
+
+    Slice sx = {double(w), double(image.w), double(left), double(right)};
+    Slice sy = {double(h), double(image.h), double(top), double(bottom)};
+
+    //the corners of the full size map the pixels one to one
+    std::vector<uint32_t> expected(WIDTH * HEIGHT, 0);
+    for (uint32_t y = 0; y < h; ++y) {
+        for (uint32_t x = 0; x < w; ++x) {
+            auto& pixel = expected[(y0 + y) * WIDTH + x0 + x];
+            pixel = _bilinear(image, FillSpread::Pad, sx.unslice(x + 0.5), sy.unslice(y + 0.5));
+            auto cx = (left + right <= w) && (x < left || x >= w - right);
+            auto cy = (top + bottom <= h) && (y < top || y >= h - bottom);
+            if (cx && cy && pixel != buffer[(y0 + y) * WIDTH + x0 + x]) {
+                fprintf(stderr, "drawing %lu (%ux%u nine-slice picture by %u, %u, %u, %u sized %ux%u at %u, %u): the corner pixel (%u, %u) is %08x, not %08x\n", n, image.w, image.h, left, top, right, bottom, w, h, x0, y0, x0 + x, y0 + y, buffer[(y0 + y) * WIDTH + x0 + x], pixel);
+                return false;
+            }
+        }
+    }
+
+    char name[128];
+    snprintf(name, sizeof(name), "%ux%u nine-slice picture by %u, %u, %u, %u sized %ux%u at %u, %u", image.w, image.h, left, top, right, bottom, w, h, x0, y0);
+    return _verify(name, n, buffer, expected, 5);
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    if (Initializer::init(CanvasEngine::Sw, 0) != Result::Success) return 1;
+
+    auto cnt = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 600UL;
+    uint64_t state = 0x5041545445524eULL;
+    auto failures = 0UL;
+
+    {
+        std::vector<uint32_t> buffer(WIDTH * HEIGHT);
+        auto canvas = SwCanvas::gen();
+        canvas->target(buffer.data(), WIDTH, WIDTH, HEIGHT, SwCanvas::ARGB8888);
+
+        for (unsigned long n = 0; n < cnt && failures < 10; ++n) {
+            bool ret;
+            switch (n % 3) {
+                case 0: ret = _pattern(canvas.get(), buffer, state, n, true); break;
+                case 1: ret = _pattern(canvas.get(), buffer, state, n, false); break;
+                default: ret = _nineSlice(canvas.get(), buffer, state, n); break;
+            }
+            if (!ret) ++failures;
+        }
+    }
+
+    Initializer::term(CanvasEngine::Sw);
+
+    printf("failures: %lu\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,816 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*
+ * JPEG decoding test of jpgd against the decoder before the scaled, vectorized and threaded decoding, vendored in baseline/.
+ * The images are encoded in the test, baseline or progressive (spectral selection), gray or YCbCr of every subsampling,
+ * with and without the restart markers, with the huffman tables of their own symbols. Then
+ * - the full decoding, vectorized, is compared to the one of the reference, bit exact,
+ * - the reduced decoding (1/2, 1/4, 1/8) is compared to the box averages of the full decode of the reference,
+ * - the decoding of the large ones on the worker threads, in the bands of the restart intervals, of the progressive
+ *   coefficients or in the pipeline, is compared to the serial one, bit exact,
+ * - the regions of the tiles, from the restart interval of their first row or not, are compared to the crops of the whole
+ *   decode at the same scale, bit exact, the progressive ones are refused.
+ *
+ * usage: tvgJpgDecoder [images]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "tvgCommon.h"
+#include "tvgTaskScheduler.h"
+#include "tvgJpgd.h"
+
+namespace baseline {
+    #include "baseline/tvgJpgd.cpp"
+}
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+struct Image
+{
+    uint32_t w, h;
+    uint32_t comps;                 //1: gray, 3: rgb
+    std::vector<uint8_t> pixels;
+};
+
+
+struct Encoding
+{
+    uint32_t h = 1, v = 1;          //the luma sampling, the chroma is 1x1
+    uint32_t restart = 0;           //the mcus of a restart interval
+    bool progressive = false;
+};
+
+
+static uint64_t _rand(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+//the natural index of the zigzag order
+static const uint8_t* _zigzag()
+{
+    static uint8_t zigzag[64];
+    static bool done = false;
+    if (!done) {
+        auto k = 0;
+        for (int s = 0; s < 15; ++s) {
+            auto lo = std::max(0, s - 7), hi = std::min(s, 7);
+            if (s & 1) for (int r = lo; r <= hi; ++r) zigzag[k++] = uint8_t(r * 8 + s - r);
+            else for (int r = hi; r >= lo; --r) zigzag[k++] = uint8_t(r * 8 + s - r);
+        }
+        done = true;
+    }
+    return zigzag;
+}
+
+
+//the entropy coded bits go from their most significant bit, a 0xff byte is stuffed with a zero
+struct Bits
+{
+    std::vector<uint8_t>& out;
+    uint32_t bits = 0;
+    uint32_t count = 0;
+
+    Bits(std::vector<uint8_t>& out) : out(out) {}
+
+    void put(uint32_t v, uint32_t n)
+    {
+        while (n > 0) {
+            --n;
+            bits = (bits << 1) | ((v >> n) & 1);
+            if (++count == 8) {
+                out.push_back(uint8_t(bits));
+                if (bits == 0xff) out.push_back(0);
+                bits = count = 0;
+            }
+        }
+    }
+
+    //filled with ones to the byte boundary
+    void pad()
+    {
+        while (count > 0) put(1, 1);
+    }
+};
+
+
+struct Symbol
+{
+    uint8_t table;                  //0, 1: the dc, ac of the luma, 2, 3: of the chroma, RESTART: the marker
+    uint8_t value;                  //the huffman symbol, the number of the marker
+    uint16_t extra;                 //the additional bits of the value
+    uint8_t size;
+};
+
+static constexpr uint8_t RESTART = 0xff;
+
+
+static void _huffman(std::vector<uint32_t> freqs, uint32_t limit, uint8_t* lengths)
+{
+    auto n = freqs.size();
+    while (true) {
+        std::vector<uint64_t> weights;
+        std::vector<int32_t> parents;
+        std::vector<int32_t> live;
+        for (size_t i = 0; i < n; ++i) {
+            lengths[i] = 0;
+            if (freqs[i] == 0) continue;
+            weights.push_back(freqs[i]);
+            parents.push_back(-1);
+            live.push_back(int32_t(weights.size() - 1));
+        }
+        if (live.empty()) return;
+        if (live.size() == 1) {
+            for (size_t i = 0; i < n; ++i) if (freqs[i]) lengths[i] = 1;
+            return;
+        }
+        while (live.size() > 1) {
+            //the two lightest nodes are merged
+            size_t a = 0, b = 1;
+            if (weights[live[b]] < weights[live[a]]) std::swap(a, b);
+            for (size_t k = 2; k < live.size(); ++k) {
+                if (weights[live[k]] < weights[live[a]]) {
+                    b = a;
+                    a = k;
+                } else if (weights[live[k]] < weights[live[b]]) b = k;
+            }
+            weights.push_back(weights[live[a]] + weights[live[b]]);
+            parents.push_back(-1);
+            parents[live[a]] = parents[live[b]] = int32_t(weights.size() - 1);
+            auto merged = int32_t(weights.size() - 1);
+            if (a < b) std::swap(a, b);
+            live.erase(live.begin() + a);
+            live[b] = merged;
+        }
+        uint32_t max = 0;
+        int32_t leaf = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (freqs[i] == 0) continue;
+            uint32_t len = 0;
+            for (auto p = parents[leaf]; p >= 0; p = parents[p]) ++len;
+            lengths[i] = uint8_t(std::min(len, 255u));
+            if (len > max) max = len;
+            ++leaf;
+        }
+        if (max <= limit) return;
+        for (auto& f : freqs) if (f) f = (f >> 1) | 1;
+    }
+}
+
+
+struct Table
+{
+    uint8_t lengths[257];
+    uint16_t codes[257];
+    std::vector<uint8_t> values;    //in the order of the codes
+    uint8_t counts[17];
+};
+
+
+//the symbols of a table from their frequencies, the codes of all ones are reserved by a dummy symbol never written
+static void _table(const std::vector<uint32_t>& freqs, Table& table)
+{
+    auto f = freqs;
+    f.push_back(1);
+    _huffman(f, 16, table.lengths);
+
+    auto longest = *std::max_element(table.lengths, table.lengths + 257);
+    if (table.lengths[256] < longest) {
+        for (int i = 0; i < 256; ++i) {
+            if (table.lengths[i] == longest) {
+                std::swap(table.lengths[i], table.lengths[256]);
+                break;
+            }
+        }
+    }
+
+    memset(table.counts, 0, sizeof(table.counts));
+    table.values.clear();
+    uint16_t code = 0;
+    for (uint32_t len = 1; len <= 16; ++len) {
+        for (int i = 0; i < 256; ++i) {
+            if (table.lengths[i] != len) continue;
+            table.codes[i] = code++;
+            table.values.push_back(uint8_t(i));
+            ++table.counts[len];
+        }
+        code <<= 1;
+    }
+}
+
+
+static uint8_t _magnitude(int32_t v, uint16_t& extra)
+{
+    auto a = uint32_t(abs(v));
+    uint8_t size = 0;
+    while (a >> size) ++size;
+    extra = uint16_t((v >= 0 ? v : v + (1 << size) - 1) & ((1 << size) - 1));
+    return size;
+}
+
+
+//the coefficients of a block in the spectral range, the dc as the difference from the previous one
+static void _block(std::vector<Symbol>& symbols, const int16_t* coefs, int32_t ss, int32_t se, int32_t& pred, uint8_t dc, uint8_t ac)
+{
+    auto zigzag = _zigzag();
+    uint16_t extra;
+    if (ss == 0) {
+        auto size = _magnitude(coefs[0] - pred, extra);
+        symbols.push_back({dc, size, extra, size});
+        pred = coefs[0];
+        ss = 1;
+    }
+    uint32_t run = 0;
+    for (auto k = ss; k <= se; ++k) {
+        auto c = coefs[zigzag[k]];
+        if (c == 0) {
+            ++run;
+            continue;
+        }
+        for (; run > 15; run -= 16) symbols.push_back({ac, 0xf0, 0, 0});
+        auto size = _magnitude(c, extra);
+        symbols.push_back({ac, uint8_t((run << 4) | size), extra, size});
+        run = 0;
+    }
+    if (run > 0) symbols.push_back({ac, 0x00, 0, 0});
+}
+
+
+static void _marker(std::vector<uint8_t>& out, uint8_t marker, const std::vector<uint8_t>& data)
+{
+    out.push_back(0xff);
+    out.push_back(marker);
+    out.push_back(uint8_t((data.size() + 2) >> 8));
+    out.push_back(uint8_t(data.size() + 2));
+    out.insert(out.end(), data.begin(), data.end());
+}
+
+
+static void _fdct(const float* in, const uint8_t* quant, int16_t* out)
+{
+    static float basis[8][8];
+    static bool done = false;
+    if (!done) {
+        for (int u = 0; u < 8; ++u) {
+            for (int x = 0; x < 8; ++x) basis[u][x] = (u == 0 ? sqrtf(0.5f) : 1.0f) * 0.5f * cosf(float((2 * x + 1) * u) * 3.14159265f / 16.0f);
+        }
+        done = true;
+    }
+    float tmp[64];
+    for (int y = 0; y < 8; ++y) {
+        for (int u = 0; u < 8; ++u) {
+            auto sum = 0.0f;
+            for (int x = 0; x < 8; ++x) sum += in[y * 8 + x] * basis[u][x];
+            tmp[y * 8 + u] = sum;
+        }
+    }
+    for (int v = 0; v < 8; ++v) {
+        for (int u = 0; u < 8; ++u) {
+            auto sum = 0.0f;
+            for (int y = 0; y < 8; ++y) sum += tmp[y * 8 + u] * basis[v][y];
+            auto c = int32_t(lroundf(sum / quant[v * 8 + u]));
+            out[v * 8 + u] = int16_t(std::min(std::max(c, -1023), 1023));
+        }
+    }
+}
+
+
+struct Component
+{
+    uint32_t h, v;                  //the sampling
+    uint32_t bw, bh;                //the blocks of the mcus
+    uint32_t cw, ch;                //the blocks of the component itself, the ones of a non-interleaved scan
+    std::vector<int16_t> coefs;
+    uint8_t quant;
+};
+
+
+//the symbols of a scan over the components, interleaved in the mcus or the blocks of one component
+static std::vector<Symbol> _scan(std::vector<Component>& comps, const std::vector<uint32_t>& list, uint32_t mcux, uint32_t mcuy, int32_t ss, int32_t se, uint32_t restart)
+{
+    std::vector<Symbol> symbols;
+    int32_t preds[3] = {0, 0, 0};
+    uint32_t units = 0, marker = 0;
+
+    auto unit = [&]() {
+        if (restart > 0 && units > 0 && units % restart == 0) {
+            symbols.push_back({RESTART, uint8_t(marker++ & 7), 0, 0});
+            preds[0] = preds[1] = preds[2] = 0;
+        }
+        ++units;
+    };
+    auto block = [&](uint32_t c, uint32_t bx, uint32_t by) {
+        auto& comp = comps[c];
+        auto table = uint8_t(c == 0 ? 0 : 2);
+        _block(symbols, comp.coefs.data() + (size_t(by) * comp.bw + bx) * 64, ss, se, preds[c], table, table + 1);
+    };
+
+    if (list.size() > 1) {
+        for (uint32_t my = 0; my < mcuy; ++my) {
+            for (uint32_t mx = 0; mx < mcux; ++mx) {
+                unit();
+                for (auto c : list) {
+                    for (uint32_t v = 0; v < comps[c].v; ++v) {
+                        for (uint32_t h = 0; h < comps[c].h; ++h) block(c, mx * comps[c].h + h, my * comps[c].v + v);
+                    }
+                }
+            }
+        }
+    } else {
+        auto c = list[0];
+        for (uint32_t by = 0; by < comps[c].ch; ++by) {
+            for (uint32_t bx = 0; bx < comps[c].cw; ++bx) {
+                unit();
+                block(c, bx, by);
+            }
+        }
+    }
+    return symbols;
+}
+
+
+//the huffman tables of the symbols, then the scan header and the entropy coded data
+static void _write(std::vector<uint8_t>& out, const std::vector<Symbol>& symbols, const std::vector<uint32_t>& list, int32_t ss, int32_t se)
+{
+    std::vector<uint32_t> freqs[4];
+    for (auto& f : freqs) f.assign(256, 0);
+    for (auto& s : symbols) {
+        if (s.table != RESTART) ++freqs[s.table][s.value];
+    }
+
+    Table tables[4];
+    std::vector<uint8_t> dht;
+    for (uint8_t t = 0; t < 4; ++t) {
+        if (*std::max_element(freqs[t].begin(), freqs[t].end()) == 0) continue;
+        _table(freqs[t], tables[t]);
+        dht.push_back(uint8_t(((t & 1) << 4) | (t >> 1)));
+        dht.insert(dht.end(), tables[t].counts + 1, tables[t].counts + 17);
+        dht.insert(dht.end(), tables[t].values.begin(), tables[t].values.end());
+    }
+    _marker(out, 0xc4, dht);
+
+    std::vector<uint8_t> sos = {uint8_t(list.size())};
+    for (auto c : list) {
+        sos.push_back(uint8_t(c + 1));
+        sos.push_back(c == 0 ? 0x00 : 0x11);
+    }
+    sos.push_back(uint8_t(ss));
+    sos.push_back(uint8_t(se));
+    sos.push_back(0);
+    _marker(out, 0xda, sos);
+
+    Bits bits(out);
+    for (auto& s : symbols) {
+        if (s.table == RESTART) {
+            bits.pad();
+            out.push_back(0xff);
+            out.push_back(uint8_t(0xd0 + s.value));
+            continue;
+        }
+        bits.put(tables[s.table].codes[s.value], tables[s.table].lengths[s.value]);
+        if (s.size > 0) bits.put(s.extra, s.size);
+    }
+    bits.pad();
+}
+
+
+static std::vector<uint8_t> _encode(const Image& img, const Encoding& enc, uint64_t& state)
+{
+    auto hmax = (img.comps == 1) ? 1 : enc.h;
+    auto vmax = (img.comps == 1) ? 1 : enc.v;
+    auto mcux = (img.w + 8 * hmax - 1) / (8 * hmax);
+    auto mcuy = (img.h + 8 * vmax - 1) / (8 * vmax);
+
+    //the quantization of the luma and the chroma, from the lossless to the coarse ones
+    uint8_t quants[2][64];
+    for (auto& quant : quants) {
+        auto base = 1.0f + float(_rand(state) % 24);
+        auto slope = float(_rand(state) % 16) / 8.0f;
+        for (int v = 0; v < 8; ++v) {
+            for (int u = 0; u < 8; ++u) quant[v * 8 + u] = uint8_t(std::min(255.0f, roundf(base * (1.0f + float(u + v) * slope))));
+        }
+    }
+
+    //the samples of the components, the edges are repeated over the mcus
+    std::vector<Component> comps(img.comps);
+    for (uint32_t c = 0; c < img.comps; ++c) {
+        auto& comp = comps[c];
+        comp.h = (c == 0) ? hmax : 1;
+        comp.v = (c == 0) ? vmax : 1;
+        comp.bw = mcux * comp.h;
+        comp.bh = mcuy * comp.v;
+        comp.cw = ((img.w * comp.h + hmax - 1) / hmax + 7) / 8;
+        comp.ch = ((img.h * comp.v + vmax - 1) / vmax + 7) / 8;
+        comp.quant = (c == 0) ? 0 : 1;
+        comp.coefs.resize(size_t(comp.bw) * comp.bh * 64);
+    }
+
+    auto sample = [&](uint32_t c, uint32_t x, uint32_t y) -> float {
+        auto p = &img.pixels[(size_t(std::min(y, img.h - 1)) * img.w + std::min(x, img.w - 1)) * img.comps];
+        if (img.comps == 1) return p[0];
+        float r = p[0], g = p[1], b = p[2];
+        if (c == 0) return 0.299f * r + 0.587f * g + 0.114f * b;
+        if (c == 1) return -0.168736f * r - 0.331264f * g + 0.5f * b + 128.0f;
+        return 0.5f * r - 0.418688f * g - 0.081312f * b + 128.0f;
+    };
+
+    for (uint32_t c = 0; c < img.comps; ++c) {
+        auto& comp = comps[c];
+        auto sh = hmax / comp.h, sv = vmax / comp.v;
+        float in[64];
+        for (uint32_t by = 0; by < comp.bh; ++by) {
+            for (uint32_t bx = 0; bx < comp.bw; ++bx) {
+                for (uint32_t y = 0; y < 8; ++y) {
+                    for (uint32_t x = 0; x < 8; ++x) {
+                        auto sum = 0.0f;
+                        for (uint32_t j = 0; j < sv; ++j) {
+                            for (uint32_t i = 0; i < sh; ++i) sum += sample(c, ((bx * 8 + x) * sh + i), ((by * 8 + y) * sv + j));
+                        }
+                        in[y * 8 + x] = sum / float(sh * sv) - 128.0f;
+                    }
+                }
+                _fdct(in, quants[comp.quant], comp.coefs.data() + (size_t(by) * comp.bw + bx) * 64);
+            }
+        }
+    }
+
+    std::vector<uint8_t> out = {0xff, 0xd8};
+
+    auto zigzag = _zigzag();
+    std::vector<uint8_t> dqt;
+    for (uint8_t t = 0; t < (img.comps == 1 ? 1 : 2); ++t) {
+        dqt.push_back(t);
+        for (int k = 0; k < 64; ++k) dqt.push_back(quants[t][zigzag[k]]);
+    }
+    _marker(out, 0xdb, dqt);
+
+    std::vector<uint8_t> sof = {8, uint8_t(img.h >> 8), uint8_t(img.h), uint8_t(img.w >> 8), uint8_t(img.w), uint8_t(img.comps)};
+    for (uint32_t c = 0; c < img.comps; ++c) {
+        sof.push_back(uint8_t(c + 1));
+        sof.push_back(uint8_t((comps[c].h << 4) | comps[c].v));
+        sof.push_back(comps[c].quant);
+    }
+    _marker(out, enc.progressive ? 0xc2 : 0xc0, sof);
+
+    if (enc.restart > 0) _marker(out, 0xdd, {uint8_t(enc.restart >> 8), uint8_t(enc.restart)});
+
+    std::vector<uint32_t> all;
+    for (uint32_t c = 0; c < img.comps; ++c) all.push_back(c);
+
+    if (enc.progressive) {
+        //the dc of all the components first, then the ac of each one in a few bands
+        _write(out, _scan(comps, all, mcux, mcuy, 0, 0, enc.restart), all, 0, 0);
+        for (uint32_t c = 0; c < img.comps; ++c) {
+            int32_t ss = 1;
+            while (ss <= 63) {
+                auto se = (_rand(state) % 3 == 0) ? 63 : std::min(63, ss + int32_t(_rand(state) % 24));
+                _write(out, _scan(comps, {c}, mcux, mcuy, ss, se, enc.restart), {c}, ss, se);
+                ss = se + 1;
+            }
+        }
+    } else {
+        _write(out, _scan(comps, all, mcux, mcuy, 0, 63, enc.restart), all, 0, 63);
+    }
+
+    out.push_back(0xff);
+    out.push_back(0xd9);
+    return out;
+}
+
+
+//gradients with the rectangles of the flat colors and the noise over them, off the extremes not to clamp the decoded samples
+static Image _image(uint32_t w, uint32_t h, uint32_t comps, uint64_t& state)
+{
+    Image img = {w, h, comps, std::vector<uint8_t>(size_t(w) * h * comps)};
+
+    float base[3], dx[3], dy[3];
+    for (uint32_t c = 0; c < comps; ++c) {
+        base[c] = float(_rand(state) % 256);
+        dx[c] = (float(_rand(state) % 2001) - 1000.0f) / 1000.0f * 255.0f / float(w);
+        dy[c] = (float(_rand(state) % 2001) - 1000.0f) / 1000.0f * 255.0f / float(h);
+    }
+    auto noise = uint32_t(_rand(state) % 48);
+
+    struct Rect { uint32_t x, y, w, h; uint8_t color[3]; };
+    std::vector<Rect> rects(_rand(state) % 6);
+    for (auto& r : rects) {
+        r.x = uint32_t(_rand(state) % w);
+        r.y = uint32_t(_rand(state) % h);
+        r.w = 1 + uint32_t(_rand(state) % w);
+        r.h = 1 + uint32_t(_rand(state) % h);
+        for (auto& c : r.color) c = uint8_t(24 + _rand(state) % 208);
+    }
+
+    for (uint32_t y = 0; y < h; ++y) {
+        for (uint32_t x = 0; x < w; ++x) {
+            auto p = &img.pixels[(size_t(y) * w + x) * comps];
+            for (uint32_t c = 0; c < comps; ++c) p[c] = uint8_t(std::min(std::max(base[c] + dx[c] * float(x) + dy[c] * float(y), 24.0f), 231.0f));
+            for (auto& r : rects) {
+                if (x >= r.x && x < r.x + r.w && y >= r.y && y < r.y + r.h) {
+                    for (uint32_t c = 0; c < comps; ++c) p[c] = r.color[c];
+                }
+            }
+            if (noise > 0) {
+                for (uint32_t c = 0; c < comps; ++c) p[c] = uint8_t(std::min(std::max(int32_t(p[c]) + int32_t(_rand(state) % (2 * noise + 1)) - int32_t(noise), 24), 231));
+            }
+        }
+    }
+    return img;
+}
+
+
+static std::vector<uint8_t> _reference(const std::vector<uint8_t>& jpg)
+{
+    int w, h;
+    auto decoder = baseline::jpgdHeader((const char*)jpg.data(), int(jpg.size()), &w, &h);
+    if (!decoder) return {};
+    auto pixels = baseline::jpgdDecompress(decoder);
+    baseline::jpgdDelete(decoder);
+    if (!pixels) return {};
+    std::vector<uint8_t> ret(pixels, pixels + size_t(w) * h * 4);
+    free(pixels);
+    return ret;
+}
+
+
+static std::vector<uint8_t> _decode(const std::vector<uint8_t>& jpg, int scale)
+{
+    int w, h;
+    auto decoder = jpgdHeader((const char*)jpg.data(), int(jpg.size()), &w, &h);
+    if (!decoder) return {};
+    auto pixels = jpgdDecompress(decoder, scale);
+    jpgdDelete(decoder);
+    if (!pixels) return {};
+    auto sw = (w + scale - 1) / scale, sh = (h + scale - 1) / scale;
+    std::vector<uint8_t> ret(pixels, pixels + size_t(sw) * sh * 4);
+    free(pixels);
+    return ret;
+}
+
+
+//the vectorized idct and color conversion compute the same fixed point math as the reference
+static bool _exact(const Image& img, const std::vector<uint8_t>& jpg, const std::vector<uint8_t>& reference, const char* name)
+{
+    auto pixels = _decode(jpg, 1);
+    if (pixels.size() != reference.size()) {
+        fprintf(stderr, "%s: failed to decode\n", name);
+        return false;
+    }
+    for (size_t p = 0; p < pixels.size(); p += 4) {
+        if (memcmp(&pixels[p], &reference[p], 4)) {
+            uint32_t c, r;
+            memcpy(&c, &pixels[p], 4);
+            memcpy(&r, &reference[p], 4);
+            fprintf(stderr, "%s: the pixel (%zu, %zu) is %08x, not %08x\n", name, (p / 4) % img.w, (p / 4) / img.w, c, r);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+static float _luma(const uint8_t* bgra)
+{
+    return 0.299f * bgra[2] + 0.587f * bgra[1] + 0.114f * bgra[0];
+}
+
+
+static void _chroma(const uint8_t* bgra, float* cbcr)
+{
+    cbcr[0] += -0.168736f * bgra[2] - 0.331264f * bgra[1] + 0.5f * bgra[0];
+    cbcr[1] += 0.5f * bgra[2] - 0.418688f * bgra[1] - 0.081312f * bgra[0];
+}
+
+
+/* The reduced image is the box average of the full one, up to the rounding of the float idct and the clamping of the samples.
+   Its chroma stays subsampled though, a chroma sample is shared by the reduced pixels of the sampling, so the luma is compared
+   pixel by pixel and the chroma by the groups of the sampling. The boxes over the image edges average the padding of the blocks,
+   they are left out. */
+static bool _scaled(const Image& img, const Encoding& enc, const std::vector<uint8_t>& jpg, const std::vector<uint8_t>& reference, const char* name)
+{
+    auto hs = (img.comps == 1) ? 1 : enc.h;
+    auto vs = (img.comps == 1) ? 1 : enc.v;
+
+    for (uint32_t scale = 2; scale <= 8; scale *= 2) {
+        auto pixels = _decode(jpg, scale);
+        auto sw = (img.w + scale - 1) / scale, sh = (img.h + scale - 1) / scale;
+        if (pixels.size() != size_t(sw) * sh * 4) {
+            fprintf(stderr, "%s: failed to decode at 1/%u\n", name, scale);
+            return false;
+        }
+        auto worst = 0.0f;
+        auto total = 0.0, bias = 0.0;
+        size_t cnt = 0;
+
+        auto compare = [&](float value, float expected) {
+            auto diff = fabsf(value - expected);
+            worst = std::max(worst, diff);
+            total += diff;
+            bias += value - expected;
+            ++cnt;
+        };
+
+        for (uint32_t y = 0; y < img.h / scale; ++y) {
+            for (uint32_t x = 0; x < img.w / scale; ++x) {
+                auto sum = 0.0f;
+                for (uint32_t j = y * scale; j < (y + 1) * scale; ++j) {
+                    for (uint32_t i = x * scale; i < (x + 1) * scale; ++i) sum += _luma(&reference[(size_t(j) * img.w + i) * 4]);
+                }
+                compare(_luma(&pixels[(size_t(y) * sw + x) * 4]), sum / float(scale * scale));
+            }
+        }
+
+        if (img.comps == 3) {
+            for (uint32_t y = 0; y < img.h / (scale * vs); ++y) {
+                for (uint32_t x = 0; x < img.w / (scale * hs); ++x) {
+                    float value[2] = {0.0f, 0.0f}, expected[2] = {0.0f, 0.0f};
+                    for (uint32_t j = y * vs; j < (y + 1) * vs; ++j) {
+                        for (uint32_t i = x * hs; i < (x + 1) * hs; ++i) _chroma(&pixels[(size_t(j) * sw + i) * 4], value);
+                    }
+                    for (uint32_t j = y * vs * scale; j < (y + 1) * vs * scale; ++j) {
+                        for (uint32_t i = x * hs * scale; i < (x + 1) * hs * scale; ++i) _chroma(&reference[(size_t(j) * img.w + i) * 4], expected);
+                    }
+                    for (int c = 0; c < 2; ++c) compare(value[c] / float(hs * vs), expected[c] / float(hs * vs * scale * scale));
+                }
+            }
+        }
+
+        auto mean = cnt ? total / double(cnt) : 0.0;
+        if (cnt) bias /= double(cnt);
+        if (worst > 24.0f || mean > 1.5 || (cnt >= 64 && fabs(bias) > 0.5)) {
+            fprintf(stderr, "%s: the pixels at 1/%u differ by %.1f at most, %.2f on average, %.2f of a bias\n", name, scale, worst, mean, bias);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+//the same pixels on the worker threads, full and reduced
+static bool _threaded(const Image& img, const std::vector<uint8_t>& jpg, const std::vector<uint8_t>& reference, int scale, const char* name)
+{
+    auto serial = _decode(jpg, scale);
+
+    TaskScheduler::init(4);
+    auto full = _decode(jpg, 1);
+    auto reduced = _decode(jpg, scale);
+    TaskScheduler::term();
+
+    if (full != reference) {
+        fprintf(stderr, "%s: the pixels decoded on the threads differ\n", name);
+        return false;
+    }
+    if (serial.empty() || reduced != serial) {
+        fprintf(stderr, "%s: the pixels decoded on the threads at 1/%d differ\n", name, scale);
+        return false;
+    }
+    return true;
+}
+
+
+//the regions of the reduced image, in a larger stride kept untouched around them
+static bool _regions(const Image& img, const std::vector<uint8_t>& jpg, bool progressive, uint64_t& state, const char* name)
+{
+    static constexpr uint8_t UNTOUCHED = 0xa5;
+
+    for (int n = 0; n < 3; ++n) {
+        auto scale = 1 << (_rand(state) % 4);
+        auto whole = _decode(jpg, scale);
+        auto sw = (img.w + scale - 1) / scale, sh = (img.h + scale - 1) / scale;
+
+        auto x = uint32_t(_rand(state) % sw), y = uint32_t(_rand(state) % sh);
+        auto w = 1 + uint32_t(_rand(state) % (sw - x)), h = 1 + uint32_t(_rand(state) % (sh - y));
+        auto stride = (w + 3) * 4;
+        std::vector<uint8_t> dst(size_t(stride) * h, UNTOUCHED);
+
+        int iw, ih;
+        auto decoder = jpgdHeader((const char*)jpg.data(), int(jpg.size()), &iw, &ih);
+        auto decoded = jpgdDecompress(decoder, scale, x, y, w, h, dst.data(), stride);
+        jpgdDelete(decoder);
+
+        if (progressive) {
+            if (!decoded) continue;
+            fprintf(stderr, "%s: the region of the progressive image is decoded\n", name);
+            return false;
+        }
+        if (!decoded) {
+            fprintf(stderr, "%s: failed to decode the region %u, %u, %u, %u at 1/%d\n", name, x, y, w, h, scale);
+            return false;
+        }
+        for (uint32_t j = 0; j < h; ++j) {
+            auto row = &dst[size_t(j) * stride];
+            if (memcmp(row, &whole[(size_t(y + j) * sw + x) * 4], w * 4) || row[w * 4] != UNTOUCHED || row[stride - 1] != UNTOUCHED) {
+                fprintf(stderr, "%s: the row %u of the region %u, %u, %u, %u at 1/%d differs\n", name, j, x, y, w, h, scale);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    static const uint32_t SAMPLINGS[][2] = {{1, 1}, {2, 1}, {1, 2}, {2, 2}};
+
+    auto cnt = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 120UL;
+    uint64_t state = 0x4a50454744454344ULL;
+    auto failures = 0;
+    char name[128];
+
+    for (unsigned long i = 0; i < cnt; ++i) {
+        //every eighth one is large enough for the worker threads
+        auto large = (i % 8 == 7);
+        auto w = large ? 256 + uint32_t(_rand(state) % 400) : 1 + uint32_t(_rand(state) % 200);
+        auto h = large ? 256 + uint32_t(_rand(state) % 400) : 1 + uint32_t(_rand(state) % 200);
+        auto img = _image(w, h, (_rand(state) % 4 == 0) ? 1 : 3, state);
+
+        Encoding enc;
+        auto& sampling = SAMPLINGS[_rand(state) % 4];
+        enc.h = sampling[0];
+        enc.v = sampling[1];
+        enc.restart = (_rand(state) % 2) ? 1 + uint32_t(_rand(state) % 16) : 0;
+        enc.progressive = (_rand(state) % 3 == 0);
+        //the reference decodes the progressive ones wrongly with the subsampling, it gets the same coefficients in sequence
+        auto twin = state;
+        auto jpg = _encode(img, enc, state);
+        auto sequential = enc;
+        sequential.progressive = false;
+        auto reference = _reference(enc.progressive ? _encode(img, sequential, twin) : jpg);
+
+        snprintf(name, sizeof(name), "%ux%u %s %ux%u%s, restart %u", w, h, img.comps == 1 ? "gray" : "ycbcr", enc.h, enc.v, enc.progressive ? " progressive" : "", enc.restart);
+
+        if (reference.size() != size_t(w) * h * 4) {
+            fprintf(stderr, "%s: the reference failed to decode\n", name);
+            ++failures;
+            continue;
+        }
+        if (!_exact(img, jpg, reference, name)) ++failures;
+        if (!_scaled(img, enc, jpg, reference, name)) ++failures;
+        if (large && !_threaded(img, jpg, reference, 2 << (_rand(state) % 3), name)) ++failures;
+        if (!_regions(img, jpg, enc.progressive, state, name)) ++failures;
+    }
+
+    //the decoding speed of a noisy photo, 4:2:0 without the restart markers
+    state = 0x50484f544f313032ULL;
+    auto img = _image(1024, 1024, 3, state);
+    for (auto& p : img.pixels) p = uint8_t(std::min(std::max(int32_t(p) + int32_t(_rand(state) % 25) - 12, 24), 231));
+    Encoding enc;
+    enc.h = enc.v = 2;
+    auto jpg = _encode(img, enc, state);
+    auto measure = [&](std::vector<uint8_t> (*decode)(const std::vector<uint8_t>&)) {
+        auto best = 1e9;
+        for (int r = 0; r < 5; ++r) {
+            auto begin = std::chrono::steady_clock::now();
+            decode(jpg);
+            auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+            if (ms < best) best = ms;
+        }
+        return best;
+    };
+    auto reference = measure(_reference);
+    auto current = measure([](const std::vector<uint8_t>& jpg) { return _decode(jpg, 1); });
+    TaskScheduler::init(4);
+    auto threaded = measure([](const std::vector<uint8_t>& jpg) { return _decode(jpg, 1); });
+    TaskScheduler::term();
+    printf("1024x1024 ycbcr 2x2, %zu bytes: %.2f ms, %.2f ms on 4 threads, the reference %.2f ms\n", jpg.size(), current, threaded, reference);
+
+    printf("failures: %d\n", failures);
+
+    return failures ? 1 : 0;
+}
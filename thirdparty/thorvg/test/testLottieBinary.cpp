@@ -0,0 +1,272 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+
+/*
+ * Round trip test of the precompiled Lottie binary format.
+ * A Lottie document is compiled into the binary, both of them are loaded and rendered frame by frame,
+ * the frames must be identical. The corrupted binaries must be rejected or loaded without faults.
+ *
+ * usage: tvgLottieBinary [mutations] [seed]
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thorvg.h>
+#include "thorvg_lottie.h"
+#include "tvgLottieBinary.h"
+
+using namespace tvg;
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+#define WIDTH 200
+#define HEIGHT 200
+
+//the properties of the binary format: keyframes with the easings, paths, gradient stops, dashes,
+//trim paths, a precomposition, a solid layer, a slot and a marker
+static const char* LOTTIE = R"({
+"v":"5.7.0","nm":"binary","fr":30,"ip":0,"op":60,"w":200,"h":200,
+"assets":[{"id":"comp","layers":[
+  {"ty":1,"ind":1,"ip":0,"op":60,"st":0,"sc":"#3080ff","sw":50,"sh":40,
+   "ks":{"o":{"a":0,"k":80},"r":{"a":0,"k":15},"p":{"a":0,"k":[25,20,0]},"a":{"a":0,"k":[25,20,0]},"s":{"a":0,"k":[100,100,100]}}}]}],
+"layers":[
+  {"ty":4,"nm":"shapes","ind":1,"ip":0,"op":60,"st":0,
+   "ks":{"o":{"a":0,"k":100},
+         "r":{"a":1,"k":[{"t":0,"s":[0],"o":{"x":[0.4],"y":[0]},"i":{"x":[0.2],"y":[1]}},{"t":60,"s":[180]}]},
+         "p":{"a":1,"k":[{"t":0,"s":[60,60,0],"o":{"x":0.3,"y":0.1},"i":{"x":0.6,"y":0.9},"to":[20,0,0],"ti":[0,-20,0]},{"t":60,"s":[140,140,0]}]},
+         "a":{"a":0,"k":[0,0,0]},"s":{"a":0,"k":[100,100,100]}},
+   "shapes":[
+     {"ty":"gr","it":[
+       {"ty":"rc","p":{"a":0,"k":[0,0]},"s":{"a":0,"k":[80,60]},"r":{"a":0,"k":10}},
+       {"ty":"fl","c":{"a":0,"k":[1,0,0,1],"sid":"fill"},"o":{"a":0,"k":100}},
+       {"ty":"st","c":{"a":0,"k":[0,0,0,1]},"o":{"a":0,"k":100},"w":{"a":0,"k":3},"lc":2,"lj":2,"ml":4,
+        "d":[{"n":"d","v":{"a":0,"k":6}},{"n":"g","v":{"a":0,"k":3}},{"n":"o","v":{"a":0,"k":0}}]},
+       {"ty":"tr","p":{"a":0,"k":[0,0]},"a":{"a":0,"k":[0,0]},"s":{"a":0,"k":[100,100]},"r":{"a":0,"k":0},"o":{"a":0,"k":100}}]},
+     {"ty":"gr","it":[
+       {"ty":"el","p":{"a":0,"k":[0,0]},"s":{"a":1,"k":[{"t":0,"s":[20,20],"o":{"x":[0.5],"y":[0]},"i":{"x":[0.5],"y":[1]}},{"t":60,"s":[90,50]}]}},
+       {"ty":"gf","o":{"a":0,"k":100},"r":1,"t":1,"s":{"a":0,"k":[-40,0]},"e":{"a":0,"k":[40,0]},
+        "g":{"p":3,"k":{"a":1,"k":[{"t":0,"s":[0,1,0,0,0.5,0,1,0,1,0,0,1],"o":{"x":[0.3],"y":[0]},"i":{"x":[0.7],"y":[1]}},
+                                   {"t":60,"s":[0,0,0,1,0.5,1,1,0,1,1,0,0]}]}}},
+       {"ty":"tr","p":{"a":0,"k":[-30,40]},"a":{"a":0,"k":[0,0]},"s":{"a":0,"k":[100,100]},"r":{"a":0,"k":0},"o":{"a":0,"k":100}}]},
+     {"ty":"gr","it":[
+       {"ty":"sh","ks":{"a":1,"k":[
+         {"t":0,"s":[{"i":[[0,0],[0,0],[-10,0]],"o":[[0,0],[0,0],[10,0]],"v":[[0,0],[50,0],[25,40]],"c":true}],"o":{"x":0.5,"y":0},"i":{"x":0.5,"y":1}},
+         {"t":40,"h":1,"s":[{"i":[[0,0],[0,0],[-10,0]],"o":[[0,0],[0,0],[10,0]],"v":[[0,10],[60,0],[20,50]],"c":true}]},
+         {"t":60,"s":[{"i":[[0,0],[0,0],[0,0]],"o":[[0,0],[0,0],[0,0]],"v":[[10,10],[40,0],[30,30]],"c":true}]}]}},
+       {"ty":"tm","s":{"a":0,"k":0},"e":{"a":1,"k":[{"t":0,"s":[10],"o":{"x":[0.5],"y":[0]},"i":{"x":[0.5],"y":[1]}},{"t":60,"s":[100]}]},"o":{"a":0,"k":0},"m":1},
+       {"ty":"st","c":{"a":0,"k":[0,0.5,0,1]},"o":{"a":0,"k":100},"w":{"a":0,"k":4},"lc":1,"lj":1,"ml":4},
+       {"ty":"tr","p":{"a":0,"k":[-60,-70]},"a":{"a":0,"k":[0,0]},"s":{"a":0,"k":[100,100]},"r":{"a":0,"k":0},"o":{"a":0,"k":100}}]}]},
+  {"ty":0,"nm":"precomp","ind":2,"refId":"comp","ip":0,"op":60,"st":0,"w":200,"h":200,
+   "ks":{"o":{"a":0,"k":100},"r":{"a":0,"k":0},"p":{"a":1,"k":[{"t":0,"s":[0,150,0],"o":{"x":0.5,"y":0},"i":{"x":0.5,"y":1}},{"t":60,"s":[150,0,0]}]},
+         "a":{"a":0,"k":[0,0,0]},"s":{"a":0,"k":[100,100,100]}}}],
+"markers":[{"cm":"intro","tm":0,"dr":30}],
+"slots":{"fill":{"p":{"a":0,"k":[1,0,0,1]}}}
+})";
+
+static const char* SLOT = R"({"fill":{"p":{"a":1,"k":[{"t":0,"s":[0,0,1,1],"o":{"x":[0.5],"y":[0]},"i":{"x":[0.5],"y":[1]}},{"t":60,"s":[1,1,0,1]}]}}})";
+
+
+static uint32_t _rand(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+
+static bool _write(const char* path, const char* data, size_t size)
+{
+    auto f = fopen(path, "wb");
+    if (!f) return false;
+    auto ret = (fwrite(data, 1, size, f) == size);
+    fclose(f);
+    return ret;
+}
+
+
+static bool _read(const char* path, std::vector<char>& data)
+{
+    auto f = fopen(path, "rb");
+    if (!f) return false;
+    char buf[4096];
+    size_t size;
+    while ((size = fread(buf, 1, sizeof(buf), f)) > 0) data.insert(data.end(), buf, buf + size);
+    fclose(f);
+    return !data.empty();
+}
+
+
+struct Frames
+{
+    float totalFrame = 0.0f;
+    float w = 0.0f, h = 0.0f;
+    uint32_t markers = 0;
+    std::vector<uint32_t> pixels;
+};
+
+
+//renders every 3rd frame, the slot is overridden in the second half
+static bool _render(Picture* picture, LottieAnimation* animation, Frames& frames)
+{
+    auto canvas = SwCanvas::gen();
+    std::vector<uint32_t> buffer(WIDTH * HEIGHT);
+    if (canvas->target(buffer.data(), WIDTH, WIDTH, HEIGHT, SwCanvas::ARGB8888) != Result::Success) return false;
+
+    picture->size(&frames.w, &frames.h);
+    frames.totalFrame = animation->totalFrame();
+    frames.markers = animation->markersCnt();
+    if (canvas->push(tvg::cast(picture)) != Result::Success) return false;
+
+    for (int pass = 0; pass < 2; ++pass) {
+        if (pass == 1 && animation->override(SLOT) != Result::Success) return false;
+        for (float no = 0.0f; no < frames.totalFrame; no += 3.0f) {
+            animation->frame(no);
+            memset(buffer.data(), 0x00, buffer.size() * sizeof(uint32_t));
+            canvas->update();
+            canvas->draw();
+            canvas->sync();
+            frames.pixels.insert(frames.pixels.end(), buffer.begin(), buffer.end());
+        }
+    }
+    return true;
+}
+
+
+static bool _load(const char* path, Frames& frames)
+{
+    auto animation = LottieAnimation::gen();
+    auto picture = animation->picture();
+    if (picture->load(path) != Result::Success) return false;
+    return _render(picture, animation.get(), frames);
+}
+
+
+//a corrupted binary may load or not, it must not fault. the frames are built but not rasterized,
+//a corrupted coordinate may be huge enough to keep the rasterizer busy for minutes.
+static void _loadCorrupted(const std::vector<char>& data)
+{
+    auto animation = LottieAnimation::gen();
+    auto picture = animation->picture();
+    if (picture->load(data.data(), uint32_t(data.size()), "lottie", true) != Result::Success) return;
+
+    //the frame range is corrupted as well, the first, the middle and the last ones are enough
+    auto totalFrame = animation->totalFrame();
+    float nos[] = {0.0f, totalFrame * 0.5f, totalFrame - 1.0f};
+    for (auto no : nos) {
+        animation->frame(no);
+        picture->paint(0);  //waits for the built scene and walks it
+    }
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    auto mutations = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 2000UL;
+    uint32_t state = (argc > 2) ? uint32_t(strtoul(argv[2], nullptr, 10)) : 0x544c5631;
+    if (state == 0) state = 1;
+
+    if (Initializer::init(CanvasEngine::Sw, 0) != Result::Success) return 1;
+
+    auto json = "tvgLottieBinary.json";
+    auto binary = "tvgLottieBinary.tvl";
+    auto failures = 0;
+
+    if (!_write(json, LOTTIE, strlen(LOTTIE)) || LottieAnimation::compile(json, binary) != Result::Success) {
+        fprintf(stderr, "failed to compile %s\n", json);
+        return 1;
+    }
+
+    Frames reference, compiled;
+    if (!_load(json, reference) || !_load(binary, compiled)) {
+        fprintf(stderr, "failed to load %s or %s\n", json, binary);
+        return 1;
+    }
+
+    if (reference.totalFrame != compiled.totalFrame || reference.w != compiled.w || reference.h != compiled.h || reference.markers != compiled.markers) {
+        fprintf(stderr, "header mismatch: frames %f/%f, size %fx%f/%fx%f, markers %u/%u\n", reference.totalFrame, compiled.totalFrame,
+                reference.w, reference.h, compiled.w, compiled.h, reference.markers, compiled.markers);
+        ++failures;
+    }
+
+    auto size = WIDTH * HEIGHT;
+    if (reference.pixels.size() != compiled.pixels.size()) {
+        fprintf(stderr, "frame count mismatch: %zu/%zu\n", reference.pixels.size() / size, compiled.pixels.size() / size);
+        ++failures;
+    } else {
+        for (size_t i = 0; i < reference.pixels.size(); i += size) {
+            if (memcmp(reference.pixels.data() + i, compiled.pixels.data() + i, size * sizeof(uint32_t))) {
+                fprintf(stderr, "frame mismatch: %zu\n", i / size);
+                ++failures;
+            }
+        }
+    }
+
+    std::vector<char> data;
+    if (!_read(binary, data)) return 1;
+
+    //a huge string count is rejected before its allocation
+    auto corrupted = data;
+    uint32_t strCnt = 0xfffffff0;
+    memcpy(corrupted.data() + offsetof(LottieBinaryHeader, strCnt), &strCnt, sizeof(strCnt));
+    LottieBinaryReader reader(corrupted.data(), uint32_t(corrupted.size()), nullptr);
+    if (auto comp = reader.read()) {
+        fprintf(stderr, "the corrupted string count is accepted\n");
+        delete(comp);
+        ++failures;
+    }
+
+    //the mutations of the body, the header is kept to reach the reader
+    for (unsigned long i = 0; i < mutations; ++i) {
+        corrupted = data;
+        auto count = 1 + _rand(state) % 4;
+        for (uint32_t j = 0; j < count && corrupted.size() > sizeof(LottieBinaryHeader); ++j) {
+            auto pos = sizeof(LottieBinaryHeader) + _rand(state) % (corrupted.size() - sizeof(LottieBinaryHeader));
+            switch (_rand(state) % 3) {
+                case 0: corrupted[pos] = char(_rand(state)); break;
+                case 1: corrupted[pos] = char(0xff); break;
+                default: corrupted.resize(pos); break;
+            }
+        }
+        _loadCorrupted(corrupted);
+    }
+
+    remove(json);
+    remove(binary);
+
+    Initializer::term(CanvasEngine::Sw);
+
+    printf("frames: %zu, mutations: %lu, failures: %d\n", reference.pixels.size() / size, mutations, failures);
+    return failures ? 1 : 0;
+}
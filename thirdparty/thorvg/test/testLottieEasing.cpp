@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Easing micro-benchmark: evaluates every keyframe easing curve of the given Lottie files
+ * (or a built-in set of the common curves) with LottieInterpolator::progress() and the exact solver,
+ * then reports the per-evaluation costs and the largest deviation in 8-bit channel units.
+ * Build it with -DEASING_TABLE_SIZE=N to measure the baked table against the solver.
+ *
+ * usage: tvgLottieEasing [lottie files...]
+ */
+
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "tvgCommon.h"
+#include "tvgLottieInterpolator.h"
+#include "rapidjson/document.h"
+
+using namespace rapidjson;
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+#define SAMPLES 4096
+#define ROUNDS 16
+#define MAX_DEVIATION 1.0f      //in 8-bit channel units
+
+struct Curve
+{
+    Point in, out;
+};
+
+
+static bool _component(const Value& v, SizeType idx, float& out)
+{
+    if (v.IsNumber()) {
+        out = v.GetFloat();
+        return true;
+    }
+    if (v.IsArray() && v.Size() > 0) {
+        auto& e = v[idx < v.Size() ? idx : v.Size() - 1];
+        if (!e.IsNumber()) return false;
+        out = e.GetFloat();
+        return true;
+    }
+    return false;
+}
+
+
+static SizeType _dimension(const Value& v)
+{
+    return v.IsArray() ? v.Size() : 1;
+}
+
+
+static void _collect(const Value& v, std::vector<Curve>& curves)
+{
+    if (v.IsArray()) {
+        for (auto& e : v.GetArray()) _collect(e, curves);
+        return;
+    }
+    if (!v.IsObject()) return;
+
+    //a keyframe easing: {"o": {"x": .., "y": ..}, "i": {"x": .., "y": ..}}, one curve per dimension
+    auto i = v.FindMember("i");
+    auto o = v.FindMember("o");
+    if (i != v.MemberEnd() && o != v.MemberEnd() && i->value.IsObject() && o->value.IsObject()) {
+        auto ix = i->value.FindMember("x"), iy = i->value.FindMember("y");
+        auto ox = o->value.FindMember("x"), oy = o->value.FindMember("y");
+        if (ix != i->value.MemberEnd() && iy != i->value.MemberEnd() && ox != o->value.MemberEnd() && oy != o->value.MemberEnd()) {
+            auto dim = _dimension(ix->value);
+            for (SizeType d = 0; d < dim; ++d) {
+                Curve c;
+                if (_component(ix->value, d, c.in.x) && _component(iy->value, d, c.in.y) && _component(ox->value, d, c.out.x) && _component(oy->value, d, c.out.y)) {
+                    curves.push_back(c);
+                }
+            }
+        }
+    }
+
+    for (auto m = v.MemberBegin(); m != v.MemberEnd(); ++m) _collect(m->value, curves);
+}
+
+
+static bool _load(const char* path, std::vector<Curve>& curves)
+{
+    auto f = fopen(path, "rb");
+    if (!f) return false;
+    fseek(f, 0, SEEK_END);
+    auto size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    std::vector<char> buf(size + 1, 0);
+    auto ret = fread(buf.data(), 1, size, f) == size_t(size);
+    fclose(f);
+    if (!ret) return false;
+
+    Document doc;
+    if (doc.Parse(buf.data()).HasParseError()) return false;
+    _collect(doc, curves);
+    return true;
+}
+
+
+static void _builtin(std::vector<Curve>& curves)
+{
+    //the exporters' defaults, the css presets, an overshoot and the steep ones
+    static const float presets[][4] = {
+        {0.167f, 0.167f, 0.833f, 0.833f}, {0.333f, 0.0f, 0.667f, 1.0f}, {0.25f, 0.1f, 0.25f, 1.0f},
+        {0.42f, 0.0f, 1.0f, 1.0f}, {0.0f, 0.0f, 0.58f, 1.0f}, {0.42f, 0.0f, 0.58f, 1.0f},
+        {0.34f, 1.56f, 0.64f, 1.0f}, {0.7f, 0.0f, 0.3f, 1.0f}, {0.9f, 0.0f, 0.1f, 1.0f}, {1.0f, 0.0f, 0.0f, 1.0f}
+    };
+    for (auto& p : presets) {
+        curves.push_back({{p[2], p[3]}, {p[0], p[1]}});
+    }
+}
+
+
+template<typename Func>
+static double _measure(std::vector<LottieInterpolator*>& interpolators, Func func, float& sum)
+{
+    auto begin = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; ++r) {
+        for (auto i : interpolators) {
+            for (int s = 0; s <= SAMPLES; ++s) sum += func(i, float(s) / float(SAMPLES));
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::nano>(end - begin).count() / (double(ROUNDS) * interpolators.size() * (SAMPLES + 1));
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    std::vector<Curve> curves;
+    if (argc > 1) {
+        for (int i = 1; i < argc; ++i) {
+            if (!_load(argv[i], curves)) fprintf(stderr, "failed to load %s\n", argv[i]);
+        }
+    } else _builtin(curves);
+
+    if (curves.empty()) {
+        fprintf(stderr, "no easing curves\n");
+        return 1;
+    }
+
+    std::vector<LottieInterpolator*> interpolators;
+    for (auto& c : curves) {
+        auto interpolator = static_cast<LottieInterpolator*>(malloc(sizeof(LottieInterpolator)));
+        interpolator->set("", c.in, c.out);
+        interpolators.push_back(interpolator);
+    }
+
+    //the deviation is measured between the baking steps as well
+    auto deviation = 0.0f;
+    for (auto i : interpolators) {
+        for (int s = 0; s <= SAMPLES * 8; ++s) {
+            auto t = float(s) / float(SAMPLES * 8);
+            deviation = std::max(deviation, fabsf(i->progress(t) - i->solve(t)));
+        }
+    }
+
+    auto sum = 0.0f;
+    auto exact = _measure(interpolators, [](LottieInterpolator* i, float t) { return i->solve(t); }, sum);
+    auto progress = _measure(interpolators, [](LottieInterpolator* i, float t) { return i->progress(t); }, sum);
+
+    printf("curves: %zu, table: %d\n", curves.size(), EASING_TABLE_SIZE);
+    printf("solve: %.2f ns, progress: %.2f ns, max deviation: %.3f/255 (checksum %g)\n", exact, progress, deviation * 255.0f, sum);
+
+    for (auto i : interpolators) {
+        free(i->key);
+        free(i);
+    }
+
+    return (deviation * 255.0f <= MAX_DEVIATION) ? 0 : 1;
+}
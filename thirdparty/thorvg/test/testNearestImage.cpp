@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+/*
+ * Nearest image test of the software rasterizer, the plain drawing of _rasterNearestImage() against the generic
+ * sampling of _rasterScaledImage() with _interpNearest(). The integer enlargements go by the repeat of the pixels,
+ * the others by the fixed point steps, both are expected to pick the very same pixels as the generic one does.
+ * The images and the surfaces are random premultiplied pixels, drawn at random offsets, opacities and regions.
+ *
+ * usage: tvgNearestImage [drawings]
+ */
+
+#ifdef _WIN32
+    #include <malloc.h>
+#elif defined(__linux__)
+    #include <alloca.h>
+#else
+    #include <stdlib.h>
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+#include "tvgMath.h"
+#include "tvgRender.h"
+#include "tvgSwCommon.h"
+
+//the static rasterizers in a namespace of their own, not to collide with the engine linked in
+namespace raster {
+    #include "tvgSwRaster.cpp"
+}
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+static uint64_t _rand(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+static uint32_t _premultiplied(uint64_t& state)
+{
+    auto c = uint32_t(_rand(state));
+    auto a = c >> 24;
+    //a quarter of the pixels is opaque, another one transparent
+    if ((c & 3) == 0) a = 255;
+    else if ((c & 3) == 1) a = 0;
+    auto r = ((c >> 16) & 0xff) * a / 255;
+    auto g = ((c >> 8) & 0xff) * a / 255;
+    auto b = (c & 0xff) * a / 255;
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+
+static float _scale(uint64_t& state)
+{
+    //mostly the integer enlargements of the repeat path, then the steps up and down
+    static const float scales[] = {2.0f, 3.0f, 4.0f, 5.0f, 8.0f, 1.0f, 1.5f, 2.5f, 0.5f, 0.75f, 1.25f, 2.0001f};
+    return scales[_rand(state) % (sizeof(scales) / sizeof(scales[0]))];
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    auto cnt = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 2000UL;
+    uint64_t state = 0x4e454152455354ULL;
+    auto failures = 0UL;
+    auto repeats = 0UL;
+
+    for (unsigned long n = 0; n < cnt && failures < 10; ++n) {
+        //the image
+        auto iw = 1 + uint32_t(_rand(state) % 40);
+        auto ih = 1 + uint32_t(_rand(state) % 40);
+        auto istride = iw + uint32_t(_rand(state) % 3);
+        std::vector<uint32_t> pixels(istride * ih);
+        for (auto& p : pixels) p = _premultiplied(state);
+
+        SwImage image;
+        image.buf32 = pixels.data();
+        image.w = iw;
+        image.h = ih;
+        image.stride = istride;
+        image.channelSize = sizeof(uint32_t);
+        image.filter = FilterMethod::Nearest;
+        image.scaled = true;
+
+        //the transform, the fractions of the offsets move the pixel boundaries around
+        auto sx = _scale(state);
+        auto sy = (_rand(state) % 2) ? sx : _scale(state);
+        auto tx = float(int32_t(_rand(state) % 64) - 16) + float(_rand(state) % 8) * 0.125f;
+        auto ty = float(int32_t(_rand(state) % 64) - 16) + float(_rand(state) % 8) * 0.125f;
+        image.scale = sx < sy ? sx : sy;
+        Matrix transform = {sx, 0, tx, 0, sy, ty, 0, 0, 1};
+        Matrix itransform;
+        if (!inverse(&transform, &itransform)) continue;
+        if (itransform.e11 * nearbyintf(1.0f / itransform.e11) == 1.0f && sx >= 2.0f) ++repeats;
+
+        //the surface, the region anywhere in it
+        auto w = 1 + uint32_t(_rand(state) % 160);
+        auto h = 1 + uint32_t(_rand(state) % 160);
+        auto stride = w + uint32_t(_rand(state) % 3);
+        std::vector<uint32_t> background(stride * h);
+        for (auto& p : background) p = _premultiplied(state);
+
+        SwBBox region;
+        region.min.x = SwCoord(_rand(state) % w);
+        region.min.y = SwCoord(_rand(state) % h);
+        region.max.x = region.min.x + 1 + SwCoord(_rand(state) % (w - region.min.x));
+        region.max.y = region.min.y + 1 + SwCoord(_rand(state) % (h - region.min.y));
+
+        auto opacity = (_rand(state) % 2) ? uint8_t(255) : uint8_t(_rand(state) % 256);
+
+        auto expected = background;
+        auto drawn = background;
+
+        SwSurface surface;
+        surface.stride = stride;
+        surface.w = w;
+        surface.h = h;
+        surface.cs = ColorSpace::ARGB8888;
+        surface.channelSize = sizeof(uint32_t);
+        surface.premultiplied = true;
+
+        surface.buf32 = expected.data();
+        raster::_rasterScaledImage(&surface, &image, &itransform, region, opacity);
+        surface.buf32 = drawn.data();
+        raster::_rasterNearestImage(&surface, &image, &itransform, region, opacity);
+
+        for (uint32_t p = 0; p < stride * h; ++p) {
+            if (drawn[p] != expected[p]) {
+                fprintf(stderr, "drawing %lu (%ux%u by %g x %g at %g, %g, opacity %u): the pixel (%u, %u) is %08x, not %08x\n", n, iw, ih, sx, sy, tx, ty, opacity, p % stride, p / stride, drawn[p], expected[p]);
+                ++failures;
+                break;
+            }
+        }
+        surface.buf32 = nullptr;
+    }
+
+    printf("integer enlargements: %lu\n", repeats);
+    printf("failures: %lu\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*
+ * Raw image loading test of Picture::load().
+ * The overload with the layout replaces the frame of the loaded picture in place,
+ * the legacy one loads a picture once and rejects the next data.
+ */
+
+#include <vector>
+#include <stdio.h>
+#include <thorvg.h>
+
+using namespace tvg;
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+#define WIDTH 64
+#define HEIGHT 64
+
+
+static void _draw(Canvas* canvas)
+{
+    canvas->update();
+    canvas->draw();
+    canvas->sync();
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main()
+{
+    if (Initializer::init(CanvasEngine::Sw, 0) != Result::Success) return 1;
+
+    auto failures = 0;
+
+    std::vector<uint32_t> buffer(WIDTH * HEIGHT);
+    auto canvas = SwCanvas::gen();
+    canvas->target(buffer.data(), WIDTH, WIDTH, HEIGHT, SwCanvas::ARGB8888);
+
+    std::vector<uint32_t> red(16 * 16, 0xffff0000);
+    std::vector<uint32_t> blue(32 * 32, 0xff0000ff);
+
+    //the legacy overload
+    auto picture = Picture::gen();
+    auto legacy = picture.get();
+    picture->load(red.data(), 16, 16, true);
+    canvas->push(std::move(picture));
+    _draw(canvas.get());
+    if (legacy->load(blue.data(), 32, 32, true) != Result::InsufficientCondition) {
+        fprintf(stderr, "the legacy overload loads the picture again\n");
+        ++failures;
+    }
+    canvas->clear();
+
+    //the next frames of another size and layout, a packed frame without the copy would be shared by the cache
+    picture = Picture::gen();
+    auto frames = picture.get();
+    frames->load(red.data(), 16, 16, 16, SwCanvas::ARGB8888, true);
+    canvas->push(std::move(picture));
+    _draw(canvas.get());
+    if (buffer[0] != 0xffff0000 || buffer[16] != 0) {
+        fprintf(stderr, "the first frame is drawn wrong: %08x %08x\n", buffer[0], buffer[16]);
+        ++failures;
+    }
+
+    //the 16x16 part of the 32x32 buffer, then the whole buffer
+    if (frames->load(blue.data(), 16, 16, 32, SwCanvas::ARGB8888, false) != Result::Success) {
+        fprintf(stderr, "the frame with the stride is rejected\n");
+        ++failures;
+    }
+    _draw(canvas.get());
+    if (buffer[0] != 0xff0000ff || buffer[16] != 0) {
+        fprintf(stderr, "the frame with the stride is drawn wrong: %08x %08x\n", buffer[0], buffer[16]);
+        ++failures;
+    }
+
+    if (frames->load(blue.data(), 32, 32, 32, SwCanvas::ARGB8888, true) != Result::Success) {
+        fprintf(stderr, "the larger frame is rejected\n");
+        ++failures;
+    }
+    _draw(canvas.get());
+    float w, h;
+    frames->size(&w, &h);
+    if (w != 32.0f || h != 32.0f || buffer[31 * WIDTH + 31] != 0xff0000ff || buffer[32 * WIDTH + 32] != 0) {
+        fprintf(stderr, "the larger frame is drawn wrong: %gx%g %08x\n", w, h, buffer[31 * WIDTH + 31]);
+        ++failures;
+    }
+
+    Initializer::term(CanvasEngine::Sw);
+
+    printf("failures: %d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*
+ * Progressive loading test of Picture::stream() and Picture::feed().
+ * An SVG document is fed in the chunks of various sizes, the final picture must be rendered
+ * identically to the picture loaded at once.
+ */
+
+#include <cstring>
+#include <vector>
+#include <stdio.h>
+#include <thorvg.h>
+
+using namespace tvg;
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+#define WIDTH 200
+#define HEIGHT 200
+
+//the forward references, the styles and the elements cut off by the chunks are the interesting parts
+static const char* SVG = R"svg(<?xml version="1.0" encoding="UTF-8"?>
+<svg xmlns="http://www.w3.org/2000/svg" xmlns:xlink="http://www.w3.org/1999/xlink" viewBox="0 0 200 200" width="200" height="200">
+  <style>.outline { stroke: #202020; stroke-width: 3; } #dot { fill: orange; }</style>
+  <!-- the gradient is referenced before its definition -->
+  <rect x="10" y="10" width="120" height="80" rx="12" fill="url(#grad)" class="outline"/>
+  <g transform="translate(100 100) rotate(20)" opacity="0.8">
+    <path d="M0 0 L60 10 C70 40 40 70 10 60 Z" fill="#30a0ff" class="outline"/>
+    <circle id="dot" cx="-30" cy="30" r="18"/>
+  </g>
+  <use xlink:href="#dot" x="-40" y="60"/>
+  <use xlink:href="#star" transform="translate(140 20)"/>
+  <clipPath id="clip"><circle cx="150" cy="150" r="40"/></clipPath>
+  <rect x="100" y="100" width="100" height="100" fill="#80ff80" clip-path="url(#clip)"/>
+  <polygon id="star" points="20,0 26,14 40,14 29,23 33,38 20,29 7,38 11,23 0,14 14,14" fill="#e03050"/>
+  <linearGradient id="grad" x1="0" y1="0" x2="1" y2="1">
+    <stop offset="0" stop-color="#ff0000"/>
+    <stop offset="0.5" stop-color="#00ff00" stop-opacity="0.5"/>
+    <stop offset="1" stop-color="#0000ff"/>
+  </linearGradient>
+</svg>)svg";
+
+
+static bool _render(std::unique_ptr<Picture> picture, std::vector<uint32_t>& pixels)
+{
+    auto canvas = SwCanvas::gen();
+    pixels.assign(WIDTH * HEIGHT, 0);
+    if (canvas->target(pixels.data(), WIDTH, WIDTH, HEIGHT, SwCanvas::ARGB8888) != Result::Success) return false;
+    if (canvas->push(std::move(picture)) != Result::Success) return false;
+    canvas->draw();
+    canvas->sync();
+    return true;
+}
+
+
+//feeds the document in the chunks of the given size, 0 for the random sizes
+static std::unique_ptr<Picture> _stream(uint32_t chunk, uint32_t* updates)
+{
+    auto picture = Picture::gen();
+    auto func = [](Picture*, void* data) { ++*static_cast<uint32_t*>(data); };
+    if (picture->stream("svg", func, updates) != Result::Success) return nullptr;
+
+    uint32_t state = 0x5356471;
+    auto size = uint32_t(strlen(SVG));
+    for (uint32_t pos = 0; pos < size; ) {
+        auto len = chunk;
+        if (len == 0) {
+            state ^= state << 13;
+            state ^= state >> 17;
+            state ^= state << 5;
+            len = 1 + state % 97;
+        }
+        if (len > size - pos) len = size - pos;
+        if (picture->feed(SVG + pos, len, pos + len == size) != Result::Success) return nullptr;
+        pos += len;
+    }
+    return picture;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main()
+{
+    if (Initializer::init(CanvasEngine::Sw, 0) != Result::Success) return 1;
+
+    auto failures = 0;
+
+    std::vector<uint32_t> reference;
+    auto picture = Picture::gen();
+    if (picture->load(SVG, uint32_t(strlen(SVG)), "svg", true) != Result::Success || !_render(std::move(picture), reference)) {
+        fprintf(stderr, "failed to load the document at once\n");
+        return 1;
+    }
+
+    uint32_t chunks[] = {1, 7, 64, 1000, 0};
+    for (auto chunk : chunks) {
+        uint32_t updates = 0;
+        std::vector<uint32_t> pixels;
+        auto picture = _stream(chunk, &updates);
+        if (!picture || !_render(std::move(picture), pixels)) {
+            fprintf(stderr, "failed to stream the document in %u bytes\n", chunk);
+            ++failures;
+        } else if (pixels != reference) {
+            fprintf(stderr, "the document streamed in %u bytes is rendered differently\n", chunk);
+            ++failures;
+        } else if (updates == 0) {
+            fprintf(stderr, "the document streamed in %u bytes is never presented\n", chunk);
+            ++failures;
+        }
+    }
+
+    //a regular loading ends the progressive one
+    picture = Picture::gen();
+    if (picture->stream("svg") != Result::Success || picture->feed(SVG, 40) != Result::Success ||
+        picture->load(SVG, uint32_t(strlen(SVG)), "svg", true) != Result::Success) {
+        fprintf(stderr, "failed to load the document after the stream\n");
+        ++failures;
+    } else if (picture->feed(SVG + 40, 100) != Result::InsufficientCondition) {
+        fprintf(stderr, "the data is fed after the regular loading\n");
+        ++failures;
+    } else {
+        std::vector<uint32_t> pixels;
+        if (!_render(std::move(picture), pixels) || pixels != reference) {
+            fprintf(stderr, "the document loaded after the stream is rendered differently\n");
+            ++failures;
+        }
+    }
+
+    Initializer::term(CanvasEngine::Sw);
+
+    printf("chunk sizes: %zu, failures: %d\n", sizeof(chunks) / sizeof(chunks[0]), failures);
+    return failures ? 1 : 0;
+}
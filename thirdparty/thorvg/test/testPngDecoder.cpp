@@ -0,0 +1,755 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*
+ * PNG decoding test of the built-in decoder against the pixels the images are encoded from.
+ * The images of all the color types, bit depths and filters are encoded in the test with its own
+ * scalar filters and deflate (stored, fixed and dynamic blocks), so the decoded pixels are compared
+ * to the source, the vectorized unfiltering and the inflater against the straight reference.
+ *
+ * usage: tvgPngDecoder [images]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "tvgPngd.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+enum class Deflate {Stored, Fixed, Dynamic, Mixed};
+
+struct Image
+{
+    uint32_t w, h;
+    uint8_t type, depth;
+    bool interlace = false;
+    std::vector<uint16_t> samples;          //the channels of the pixels, row by row
+    std::vector<uint8_t> palette;           //rgb
+    std::vector<uint8_t> alphas;            //tRNS of the palette
+    uint16_t key[3];                        //tRNS of the gray and rgb
+    bool keyed = false;
+};
+
+
+static uint64_t _rand(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+static uint32_t _channels(uint8_t type)
+{
+    static const uint8_t CHANNELS[7] = {1, 0, 3, 1, 2, 0, 4};
+    return CHANNELS[type];
+}
+
+
+/* Deflate (RFC 1951) encoder */
+
+struct Bits
+{
+    std::vector<uint8_t> out;
+    uint64_t bits = 0;
+    uint32_t count = 0;
+
+    void put(uint32_t v, uint32_t n)
+    {
+        bits |= uint64_t(v) << count;
+        count += n;
+        while (count >= 8) {
+            out.push_back(uint8_t(bits));
+            bits >>= 8;
+            count -= 8;
+        }
+    }
+
+    //the huffman codes go from their most significant bit
+    void code(uint32_t c, uint32_t n)
+    {
+        uint32_t rev = 0;
+        for (uint32_t i = 0; i < n; ++i, c >>= 1) rev = (rev << 1) | (c & 1);
+        put(rev, n);
+    }
+
+    void align()
+    {
+        if (count > 0) put(0, 8 - count);
+    }
+};
+
+
+struct Token
+{
+    uint16_t len;                           //zero for a literal
+    uint16_t value;                         //the literal or the distance
+};
+
+
+static const uint16_t LBASE[29] = {3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t LEXTRA[29] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t DBASE[30] = {1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t DEXTRA[30] = {0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+
+
+static uint32_t _lengthCode(uint32_t len)
+{
+    uint32_t i = 28;
+    while (LBASE[i] > len) --i;
+    return i;
+}
+
+
+static uint32_t _distanceCode(uint32_t dist)
+{
+    uint32_t i = 29;
+    while (DBASE[i] > dist) --i;
+    return i;
+}
+
+
+//greedy matches of a hash chain
+static std::vector<Token> _tokenize(const std::vector<uint8_t>& data, uint32_t depth)
+{
+    std::vector<Token> tokens;
+    std::vector<int32_t> head(1 << 15, -1);
+    std::vector<int32_t> prev(data.size(), -1);
+    auto hash = [&](size_t i) { return ((data[i] << 10) ^ (data[i + 1] << 5) ^ data[i + 2]) & 0x7fff; };
+    auto insert = [&](size_t i) {
+        if (i + 2 >= data.size()) return;
+        auto h = hash(i);
+        prev[i] = head[h];
+        head[h] = int32_t(i);
+    };
+
+    size_t i = 0;
+    while (i < data.size()) {
+        uint32_t best = 0, dist = 0;
+        if (depth > 0 && i + 2 < data.size()) {
+            auto max = std::min(size_t(258), data.size() - i);
+            auto chain = depth;
+            for (auto j = head[hash(i)]; j >= 0 && i - j <= 32768 && chain-- > 0; j = prev[j]) {
+                uint32_t len = 0;
+                while (len < max && data[j + len] == data[i + len]) ++len;
+                if (len > best) {
+                    best = len;
+                    dist = uint32_t(i - j);
+                }
+            }
+        }
+        if (best >= 3) {
+            tokens.push_back({uint16_t(best), uint16_t(dist)});
+            for (uint32_t k = 0; k < best; ++k) insert(i + k);
+            i += best;
+        } else {
+            tokens.push_back({0, data[i]});
+            insert(i);
+            ++i;
+        }
+    }
+    return tokens;
+}
+
+
+//huffman code lengths up to the limit, the frequencies are flattened until they fit
+static void _huffman(std::vector<uint32_t> freqs, uint32_t limit, uint8_t* lengths)
+{
+    auto n = freqs.size();
+    while (true) {
+        std::vector<uint64_t> weights;
+        std::vector<int32_t> parents;
+        std::vector<int32_t> live;
+        for (size_t i = 0; i < n; ++i) {
+            lengths[i] = 0;
+            if (freqs[i] == 0) continue;
+            weights.push_back(freqs[i]);
+            parents.push_back(-1);
+            live.push_back(int32_t(weights.size() - 1));
+        }
+        if (live.empty()) return;
+        if (live.size() == 1) {
+            for (size_t i = 0; i < n; ++i) if (freqs[i]) lengths[i] = 1;
+            return;
+        }
+        while (live.size() > 1) {
+            //the two lightest nodes are merged
+            size_t a = 0, b = 1;
+            if (weights[live[b]] < weights[live[a]]) std::swap(a, b);
+            for (size_t k = 2; k < live.size(); ++k) {
+                if (weights[live[k]] < weights[live[a]]) {
+                    b = a;
+                    a = k;
+                } else if (weights[live[k]] < weights[live[b]]) b = k;
+            }
+            weights.push_back(weights[live[a]] + weights[live[b]]);
+            parents.push_back(-1);
+            parents[live[a]] = parents[live[b]] = int32_t(weights.size() - 1);
+            auto merged = int32_t(weights.size() - 1);
+            if (a < b) std::swap(a, b);
+            live.erase(live.begin() + a);
+            live[b] = merged;
+        }
+        uint32_t max = 0;
+        int32_t leaf = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (freqs[i] == 0) continue;
+            uint32_t len = 0;
+            for (auto p = parents[leaf]; p >= 0; p = parents[p]) ++len;
+            lengths[i] = uint8_t(std::min(len, 255u));
+            if (len > max) max = len;
+            ++leaf;
+        }
+        if (max <= limit) return;
+        for (auto& f : freqs) if (f) f = (f >> 1) | 1;
+    }
+}
+
+
+static void _canonical(const uint8_t* lengths, uint32_t n, uint32_t* codes)
+{
+    uint32_t counts[16] = {0}, next[16] = {0};
+    for (uint32_t i = 0; i < n; ++i) ++counts[lengths[i]];
+    counts[0] = 0;
+    uint32_t code = 0;
+    for (uint32_t len = 1; len < 16; ++len) {
+        code = (code + counts[len - 1]) << 1;
+        next[len] = code;
+    }
+    for (uint32_t i = 0; i < n; ++i) {
+        if (lengths[i]) codes[i] = next[lengths[i]]++;
+    }
+}
+
+
+static void _symbols(Bits& bits, const Token* begin, const Token* end, const uint8_t* llens, const uint32_t* lcodes, const uint8_t* dlens, const uint32_t* dcodes)
+{
+    for (auto t = begin; t < end; ++t) {
+        if (t->len == 0) {
+            bits.code(lcodes[t->value], llens[t->value]);
+            continue;
+        }
+        auto lc = _lengthCode(t->len);
+        bits.code(lcodes[257 + lc], llens[257 + lc]);
+        bits.put(t->len - LBASE[lc], LEXTRA[lc]);
+        auto dc = _distanceCode(t->value);
+        bits.code(dcodes[dc], dlens[dc]);
+        bits.put(t->value - DBASE[dc], DEXTRA[dc]);
+    }
+    bits.code(lcodes[256], llens[256]);
+}
+
+
+static void _fixed(Bits& bits, const Token* begin, const Token* end)
+{
+    uint8_t lengths[288 + 30];
+    memset(lengths, 8, 144);
+    memset(lengths + 144, 9, 112);
+    memset(lengths + 256, 7, 24);
+    memset(lengths + 280, 8, 8);
+    memset(lengths + 288, 5, 30);
+    uint32_t lcodes[288], dcodes[30];
+    _canonical(lengths, 288, lcodes);
+    _canonical(lengths + 288, 30, dcodes);
+    bits.put(1, 2);
+    _symbols(bits, begin, end, lengths, lcodes, lengths + 288, dcodes);
+}
+
+
+static void _dynamic(Bits& bits, const Token* begin, const Token* end)
+{
+    static const uint8_t ORDER[19] = {16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15};
+
+    std::vector<uint32_t> lfreqs(286, 0), dfreqs(30, 0);
+    for (auto t = begin; t < end; ++t) {
+        if (t->len == 0) ++lfreqs[t->value];
+        else {
+            ++lfreqs[257 + _lengthCode(t->len)];
+            ++dfreqs[_distanceCode(t->value)];
+        }
+    }
+    lfreqs[256] = 1;
+
+    uint8_t llens[286], dlens[30];
+    _huffman(lfreqs, 15, llens);
+    _huffman(dfreqs, 15, dlens);
+    uint32_t hlit = 286, hdist = 30;
+    while (hlit > 257 && llens[hlit - 1] == 0) --hlit;
+    while (hdist > 1 && dlens[hdist - 1] == 0) --hdist;
+
+    //the code lengths with the runs of 16, 17 and 18
+    std::vector<uint8_t> all(llens, llens + hlit);
+    all.insert(all.end(), dlens, dlens + hdist);
+    std::vector<std::pair<uint8_t, uint8_t>> runs;     //symbol, extra bits
+    for (size_t i = 0; i < all.size();) {
+        size_t n = 1;
+        while (i + n < all.size() && all[i + n] == all[i]) ++n;
+        if (all[i] == 0 && n >= 11) {
+            n = std::min(n, size_t(138));
+            runs.push_back({18, uint8_t(n - 11)});
+        } else if (all[i] == 0 && n >= 3) {
+            runs.push_back({17, uint8_t(n - 3)});
+        } else if (i > 0 && all[i] == all[i - 1] && n >= 3) {
+            n = std::min(n, size_t(6));
+            runs.push_back({16, uint8_t(n - 3)});
+        } else {
+            n = 1;
+            runs.push_back({all[i], 0});
+        }
+        i += n;
+    }
+
+    std::vector<uint32_t> cfreqs(19, 0);
+    for (auto& r : runs) ++cfreqs[r.first];
+    uint8_t clens[19];
+    uint32_t ccodes[19];
+    _huffman(cfreqs, 7, clens);
+    _canonical(clens, 19, ccodes);
+    uint32_t hclen = 19;
+    while (hclen > 4 && clens[ORDER[hclen - 1]] == 0) --hclen;
+
+    bits.put(2, 2);
+    bits.put(hlit - 257, 5);
+    bits.put(hdist - 1, 5);
+    bits.put(hclen - 4, 4);
+    for (uint32_t i = 0; i < hclen; ++i) bits.put(clens[ORDER[i]], 3);
+    for (auto& r : runs) {
+        bits.code(ccodes[r.first], clens[r.first]);
+        if (r.first == 16) bits.put(r.second, 2);
+        else if (r.first == 17) bits.put(r.second, 3);
+        else if (r.first == 18) bits.put(r.second, 7);
+    }
+
+    uint32_t lcodes[286], dcodes[30];
+    _canonical(llens, 286, lcodes);
+    _canonical(dlens, 30, dcodes);
+    _symbols(bits, begin, end, llens, lcodes, dlens, dcodes);
+}
+
+
+static std::vector<uint8_t> _zlib(const std::vector<uint8_t>& data, Deflate mode, uint64_t& state)
+{
+    Bits bits;
+    bits.out = {0x78, 0x01};
+
+    auto tokens = _tokenize(data, mode == Deflate::Stored ? 0 : 1 + uint32_t(_rand(state) % 32));
+    //the blocks of random sizes, the matches refer to the data of the previous blocks as well
+    size_t t = 0, pos = 0;
+    while (t < tokens.size() || pos == 0) {
+        auto n = std::min(tokens.size() - t, size_t(1 + _rand(state) % 20000));
+        auto type = (mode == Deflate::Mixed) ? Deflate(_rand(state) % 3) : mode;
+        size_t bytes = 0;
+        for (auto k = t; k < t + n; ++k) bytes += tokens[k].len ? tokens[k].len : 1;
+        //the stored block is limited to 64K
+        while (type == Deflate::Stored && bytes > 65535) {
+            --n;
+            bytes -= tokens[t + n].len ? tokens[t + n].len : 1;
+        }
+        bits.put((t + n == tokens.size()) ? 1 : 0, 1);
+        if (type == Deflate::Stored) {
+            bits.put(0, 2);
+            bits.align();
+            bits.put(uint32_t(bytes), 16);
+            bits.put(uint32_t(bytes) ^ 0xffff, 16);
+            bits.out.insert(bits.out.end(), data.begin() + pos, data.begin() + pos + bytes);
+        } else if (type == Deflate::Fixed) {
+            _fixed(bits, tokens.data() + t, tokens.data() + t + n);
+        } else {
+            _dynamic(bits, tokens.data() + t, tokens.data() + t + n);
+        }
+        t += n;
+        pos += bytes;
+        if (tokens.empty()) break;
+    }
+    bits.align();
+
+    uint32_t a = 1, b = 0;
+    for (auto c : data) {
+        a = (a + c) % 65521;
+        b = (b + a) % 65521;
+    }
+    auto adler = (b << 16) | a;
+    for (int i = 3; i >= 0; --i) bits.out.push_back(uint8_t(adler >> (i * 8)));
+    return bits.out;
+}
+
+
+/* PNG encoder */
+
+static uint8_t _predict(uint8_t a, uint8_t b, uint8_t c)
+{
+    auto p = int32_t(a) + b - c;
+    auto pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+    if (pa <= pb && pa <= pc) return a;
+    if (pb <= pc) return b;
+    return c;
+}
+
+
+//the scanline of the pixels, the samples are packed from the most significant bit or in the big endian
+static std::vector<uint8_t> _scanline(const Image& img, uint32_t y, uint32_t x0, uint32_t dx, uint32_t w)
+{
+    auto channels = _channels(img.type);
+    std::vector<uint8_t> row((size_t(w) * channels * img.depth + 7) / 8, 0);
+    size_t bit = 0;
+    for (uint32_t x = 0; x < w; ++x) {
+        auto sample = &img.samples[(size_t(y) * img.w + x0 + x * dx) * channels];
+        for (uint32_t c = 0; c < channels; ++c, bit += img.depth) {
+            if (img.depth == 16) {
+                row[bit / 8] = uint8_t(sample[c] >> 8);
+                row[bit / 8 + 1] = uint8_t(sample[c]);
+            } else if (img.depth == 8) {
+                row[bit / 8] = uint8_t(sample[c]);
+            } else {
+                row[bit / 8] |= uint8_t(sample[c] << (8 - img.depth - (bit & 7)));
+            }
+        }
+    }
+    return row;
+}
+
+
+static void _filter(uint8_t filter, uint8_t* out, const uint8_t* row, const uint8_t* prev, size_t size, uint32_t bpp)
+{
+    for (size_t i = 0; i < size; ++i) {
+        uint8_t a = i >= bpp ? row[i - bpp] : 0;
+        uint8_t c = i >= bpp ? prev[i - bpp] : 0;
+        uint8_t b = prev[i];
+        uint8_t p = 0;
+        if (filter == 1) p = a;
+        else if (filter == 2) p = b;
+        else if (filter == 3) p = uint8_t((uint32_t(a) + b) >> 1);
+        else if (filter == 4) p = _predict(a, b, c);
+        out[i] = uint8_t(row[i] - p);
+    }
+}
+
+
+static uint32_t _crc(const uint8_t* p, size_t size)
+{
+    static uint32_t table[256];
+    if (!table[1]) {
+        for (uint32_t i = 0; i < 256; ++i) {
+            auto c = i;
+            for (int k = 0; k < 8; ++k) c = (c & 1) ? 0xedb88320 ^ (c >> 1) : c >> 1;
+            table[i] = c;
+        }
+    }
+    auto c = 0xffffffffu;
+    for (size_t i = 0; i < size; ++i) c = table[(c ^ p[i]) & 0xff] ^ (c >> 8);
+    return c ^ 0xffffffffu;
+}
+
+
+static void _chunk(std::vector<uint8_t>& png, const char* type, const uint8_t* data, size_t size)
+{
+    for (int i = 3; i >= 0; --i) png.push_back(uint8_t(size >> (i * 8)));
+    auto begin = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data, data + size);
+    auto crc = _crc(png.data() + begin, size + 4);
+    for (int i = 3; i >= 0; --i) png.push_back(uint8_t(crc >> (i * 8)));
+}
+
+
+//filter: 0 - 4 for all the rows, 5 for the random ones
+static std::vector<uint8_t> _encode(const Image& img, uint8_t filter, Deflate mode, uint64_t& state)
+{
+    static const uint8_t XS[7] = {0, 4, 0, 2, 0, 1, 0};
+    static const uint8_t YS[7] = {0, 0, 4, 0, 2, 0, 1};
+    static const uint8_t DX[7] = {8, 8, 4, 4, 2, 2, 1};
+    static const uint8_t DY[7] = {8, 8, 8, 4, 4, 2, 2};
+
+    auto bpp = std::max(1u, _channels(img.type) * img.depth / 8);
+    std::vector<uint8_t> raw;
+    for (int pass = 0; pass < (img.interlace ? 7 : 1); ++pass) {
+        uint32_t x0 = 0, y0 = 0, dx = 1, dy = 1;
+        if (img.interlace) {
+            x0 = XS[pass];
+            y0 = YS[pass];
+            dx = DX[pass];
+            dy = DY[pass];
+        }
+        if (x0 >= img.w || y0 >= img.h) continue;
+        auto w = (img.w - x0 + dx - 1) / dx;
+        std::vector<uint8_t> prev;
+        for (auto y = y0; y < img.h; y += dy) {
+            auto row = _scanline(img, y, x0, dx, w);
+            if (prev.empty()) prev.assign(row.size(), 0);
+            auto f = (filter < 5) ? filter : uint8_t(_rand(state) % 5);
+            raw.push_back(f);
+            raw.resize(raw.size() + row.size());
+            _filter(f, raw.data() + raw.size() - row.size(), row.data(), prev.data(), row.size(), bpp);
+            prev = row;
+        }
+    }
+
+    std::vector<uint8_t> png = {137, 80, 78, 71, 13, 10, 26, 10};
+    uint8_t ihdr[13] = {uint8_t(img.w >> 24), uint8_t(img.w >> 16), uint8_t(img.w >> 8), uint8_t(img.w),
+                        uint8_t(img.h >> 24), uint8_t(img.h >> 16), uint8_t(img.h >> 8), uint8_t(img.h),
+                        img.depth, img.type, 0, 0, uint8_t(img.interlace ? 1 : 0)};
+    _chunk(png, "IHDR", ihdr, sizeof(ihdr));
+    if (img.type == 3) {
+        _chunk(png, "PLTE", img.palette.data(), img.palette.size());
+        if (!img.alphas.empty()) _chunk(png, "tRNS", img.alphas.data(), img.alphas.size());
+    } else if (img.keyed) {
+        uint8_t trns[6];
+        for (int i = 0; i < 3; ++i) {
+            trns[i * 2] = uint8_t(img.key[i] >> 8);
+            trns[i * 2 + 1] = uint8_t(img.key[i]);
+        }
+        _chunk(png, "tRNS", trns, img.type == 0 ? 2 : 6);
+    }
+    //an ancillary chunk is skipped
+    _chunk(png, "tEXt", (const uint8_t*)"Comment\0thorvg", 14);
+
+    //the image data in several chunks
+    auto zlib = _zlib(raw, mode, state);
+    for (size_t pos = 0; pos < zlib.size();) {
+        auto n = std::min(zlib.size() - pos, size_t(1 + _rand(state) % 8192));
+        _chunk(png, "IDAT", zlib.data() + pos, n);
+        pos += n;
+    }
+    _chunk(png, "IEND", nullptr, 0);
+    return png;
+}
+
+
+/* the reference */
+
+static uint32_t _premultiply(uint32_t c, uint32_t a)
+{
+    return (c * a * 2 + 255) / 510;
+}
+
+
+static uint32_t _expected(const Image& img, uint32_t x, uint32_t y, bool abgr)
+{
+    auto channels = _channels(img.type);
+    auto s = &img.samples[(size_t(y) * img.w + x) * channels];
+    auto max = (1u << img.depth) - 1;
+    auto eight = [&](uint16_t v) { return img.depth == 16 ? uint32_t(v >> 8) : uint32_t(v) * 255 / max; };
+
+    uint32_t r, g, b, a = 255;
+    switch (img.type) {
+        case 0: {
+            if (img.keyed && s[0] == img.key[0]) return 0;
+            r = g = b = eight(s[0]);
+            break;
+        }
+        case 2: {
+            if (img.keyed && s[0] == img.key[0] && s[1] == img.key[1] && s[2] == img.key[2]) return 0;
+            r = eight(s[0]);
+            g = eight(s[1]);
+            b = eight(s[2]);
+            break;
+        }
+        case 3: {
+            r = img.palette[s[0] * 3];
+            g = img.palette[s[0] * 3 + 1];
+            b = img.palette[s[0] * 3 + 2];
+            if (s[0] < img.alphas.size()) a = img.alphas[s[0]];
+            break;
+        }
+        case 4: {
+            r = g = b = eight(s[0]);
+            a = eight(s[1]);
+            break;
+        }
+        default: {
+            r = eight(s[0]);
+            g = eight(s[1]);
+            b = eight(s[2]);
+            a = eight(s[3]);
+            break;
+        }
+    }
+    r = _premultiply(r, a);
+    g = _premultiply(g, a);
+    b = _premultiply(b, a);
+    if (abgr) return (a << 24) | (b << 16) | (g << 8) | r;
+    return (a << 24) | (r << 16) | (g << 8) | b;
+}
+
+
+//smooth gradients with noise, the filters and the matches have something to do
+static Image _image(uint8_t type, uint8_t depth, uint32_t w, uint32_t h, uint64_t& state)
+{
+    Image img;
+    img.w = w;
+    img.h = h;
+    img.type = type;
+    img.depth = depth;
+    img.interlace = _rand(state) % 2;
+
+    auto channels = _channels(type);
+    auto max = (type == 3) ? std::min(255u, (1u << depth) - 1) : (1u << depth) - 1;
+    if (type == 3) {
+        auto size = 1 + uint32_t(_rand(state) % (max + 1));
+        for (uint32_t i = 0; i < size * 3; ++i) img.palette.push_back(uint8_t(_rand(state)));
+        auto alphas = uint32_t(_rand(state) % (size + 1));
+        for (uint32_t i = 0; i < alphas; ++i) img.alphas.push_back(uint8_t(_rand(state) % 3 == 0 ? 255 : _rand(state)));
+        max = size - 1;
+    }
+
+    auto noise = 1 + uint32_t(_rand(state) % (max + 1));
+    img.samples.resize(size_t(w) * h * channels);
+    for (uint32_t y = 0; y < h; ++y) {
+        for (uint32_t x = 0; x < w; ++x) {
+            for (uint32_t c = 0; c < channels; ++c) {
+                auto v = (uint64_t(x) * (c + 1) * max / std::max(w, 1u) + uint64_t(y) * max / std::max(h, 1u) + _rand(state) % noise) % (uint64_t(max) + 1);
+                //the transparent and the opaque areas
+                if (c == channels - 1 && (type == 4 || type == 6) && x % 7 < 2) v = (x % 7) ? max : 0;
+                img.samples[(size_t(y) * w + x) * channels + c] = uint16_t(v);
+            }
+        }
+    }
+
+    //the color key of some pixels
+    if ((type == 0 || type == 2) && _rand(state) % 2) {
+        img.keyed = true;
+        for (uint32_t c = 0; c < 3; ++c) img.key[c] = uint16_t(_rand(state) % (uint64_t(max) + 1));
+        for (uint32_t i = 0; i < w * h / 5; ++i) {
+            auto p = _rand(state) % (uint64_t(w) * h);
+            for (uint32_t c = 0; c < channels; ++c) img.samples[p * channels + c] = img.key[c];
+        }
+    }
+    return img;
+}
+
+
+static bool _verify(const Image& img, const std::vector<uint8_t>& png, const char* name)
+{
+    uint32_t w, h;
+    auto decoder = pngdHeader((const char*)png.data(), uint32_t(png.size()), &w, &h);
+    if (!decoder || w != img.w || h != img.h) {
+        fprintf(stderr, "%s: the header isn't read\n", name);
+        pngdDelete(decoder);
+        return false;
+    }
+
+    //the pixels out of the stride are kept
+    auto stride = w + 3;
+    std::vector<uint32_t> dst(size_t(stride) * h);
+    auto ret = true;
+    for (auto abgr : {true, false}) {
+        std::fill(dst.begin(), dst.end(), 0xdeadbeef);
+        if (!pngdDecompress(decoder, dst.data(), stride, abgr)) {
+            fprintf(stderr, "%s: not decoded\n", name);
+            ret = false;
+            break;
+        }
+        for (uint32_t y = 0; y < h && ret; ++y) {
+            for (uint32_t x = 0; x < stride; ++x) {
+                auto expected = (x < w) ? _expected(img, x, y, abgr) : 0xdeadbeef;
+                if (dst[size_t(y) * stride + x] != expected) {
+                    fprintf(stderr, "%s: the pixel (%u, %u) is %08x, not %08x (%s)\n", name, x, y, dst[size_t(y) * stride + x], expected, abgr ? "abgr" : "argb");
+                    ret = false;
+                    break;
+                }
+            }
+        }
+    }
+    pngdDelete(decoder);
+    return ret;
+}
+
+
+//broken data is rejected without reading out of it
+static bool _truncated(const std::vector<uint8_t>& png)
+{
+    for (size_t size = 0; size < png.size(); size += 1 + size / 4) {
+        std::vector<uint8_t> copy(png.begin(), png.begin() + size);
+        uint32_t w, h;
+        auto decoder = pngdHeader((const char*)copy.data(), uint32_t(copy.size()), &w, &h);
+        if (!decoder) continue;
+        std::vector<uint32_t> dst(size_t(w) * h);
+        pngdDecompress(decoder, dst.data(), w, true);
+        pngdDelete(decoder);
+    }
+    return true;
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    static const uint8_t FORMATS[][2] = {{0, 1}, {0, 2}, {0, 4}, {0, 8}, {0, 16}, {2, 8}, {2, 16}, {3, 1}, {3, 2}, {3, 4}, {3, 8}, {4, 8}, {4, 16}, {6, 8}, {6, 16}};
+    static const char* MODES[] = {"stored", "fixed", "dynamic", "mixed"};
+
+    auto cnt = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 300UL;
+    uint64_t state = 0x504e474445434f44ULL;
+    auto failures = 0;
+    char name[128];
+
+    //every format with every filter and every deflate block
+    for (auto& format : FORMATS) {
+        for (uint8_t filter = 0; filter < 6; ++filter) {
+            for (int mode = 0; mode < 4; ++mode) {
+                auto img = _image(format[0], format[1], 1 + _rand(state) % 40, 1 + _rand(state) % 40, state);
+                auto png = _encode(img, filter, Deflate(mode), state);
+                snprintf(name, sizeof(name), "type %u, depth %u, filter %u, %s, %ux%u%s", format[0], format[1], filter, MODES[mode], img.w, img.h, img.interlace ? ", interlaced" : "");
+                if (!_verify(img, png, name)) ++failures;
+            }
+        }
+    }
+
+    //random ones of the larger sizes
+    for (unsigned long i = 0; i < cnt; ++i) {
+        auto& format = FORMATS[_rand(state) % (sizeof(FORMATS) / sizeof(FORMATS[0]))];
+        auto img = _image(format[0], format[1], 1 + _rand(state) % 300, 1 + _rand(state) % 200, state);
+        auto mode = int(_rand(state) % 4);
+        auto png = _encode(img, 5, Deflate(mode), state);
+        snprintf(name, sizeof(name), "type %u, depth %u, %s, %ux%u%s", format[0], format[1], MODES[mode], img.w, img.h, img.interlace ? ", interlaced" : "");
+        if (!_verify(img, png, name)) ++failures;
+        if (i < 20) _truncated(png);
+    }
+
+    //the decoding speed of the common rgba image
+    auto img = _image(6, 8, 1024, 1024, state);
+    img.interlace = false;
+    auto png = _encode(img, 5, Deflate::Dynamic, state);
+    uint32_t w, h;
+    auto decoder = pngdHeader((const char*)png.data(), uint32_t(png.size()), &w, &h);
+    std::vector<uint32_t> dst(size_t(w) * h);
+    auto best = 1e9;
+    for (int r = 0; r < 8; ++r) {
+        auto begin = std::chrono::steady_clock::now();
+        pngdDecompress(decoder, dst.data(), w, true);
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        if (ms < best) best = ms;
+    }
+    pngdDelete(decoder);
+    printf("1024x1024 rgba, %zu bytes: %.2f ms (%.1f Mpixels/s)\n", png.size(), best, double(w) * h / best / 1000.0);
+
+    printf("failures: %d\n", failures);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Rounding test of the plain decimals in strToFloat() against the C library's strtof(),
+ * on the random decimals and on the float midpoints with their neighbors, all of them in the range
+ * of the fast conversion (no exponent, a mantissa up to 2^53, up to 22 decimals).
+ *
+ * usage: tvgStrToFloat [iterations]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <string>
+#include "tvgStr.h"
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+static uint64_t _rand(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+static bool _fast(std::string str)
+{
+    auto dot = str.find('.');
+    auto scale = (dot == std::string::npos) ? 0 : str.size() - dot - 1;
+    if (dot != std::string::npos) str.erase(dot, 1);
+    return str.size() <= 19 && scale <= 22 && strtoull(str.c_str(), nullptr, 10) <= (1ULL << 53);
+}
+
+
+static bool _check(const char* str)
+{
+    auto a = tvg::strToFloat(str, nullptr);
+    auto b = strtof(str, nullptr);
+    if (!memcmp(&a, &b, sizeof(float))) return true;
+    fprintf(stderr, "%s: %.9g, expected %.9g\n", str, a, b);
+    return false;
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    auto iterations = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 100000UL;
+    uint64_t state = 0x5354524e554d31ULL;
+    auto failures = 0UL;
+    char buf[64];
+
+    for (unsigned long i = 0; i < iterations && failures < 10; ++i) {
+        //a random decimal
+        std::string str;
+        auto digits = 1 + _rand(state) % 17;
+        auto scale = (_rand(state) % 4) ? _rand(state) % (digits + 1) : _rand(state) % 23;
+        for (uint64_t k = 0; k < digits; ++k) str += char('0' + _rand(state) % 10);
+        if (scale > 0) {
+            while (str.size() < scale) str = "0" + str;
+            str.insert(str.size() - scale, ".");
+        }
+        if (_fast(str) && !_check(str.c_str())) ++failures;
+
+        //the midpoint of two floats and its neighbors, in their shortest forms
+        auto f = float(_rand(state) % 100000000) / float(1 + _rand(state) % 1000);
+        auto h = (double(f) + double(nextafterf(f, INFINITY))) * 0.5;
+        double values[] = {nextafter(h, -INFINITY), h, nextafter(h, INFINITY)};
+        for (auto v : values) {
+            for (int prec = 1; prec <= 17; ++prec) {
+                snprintf(buf, sizeof(buf), "%.*f", prec, v);
+                if (strtod(buf, nullptr) == v) break;
+            }
+            if (_fast(buf) && !_check(buf)) ++failures;
+        }
+    }
+
+    printf("iterations: %lu, failures: %lu\n", iterations, failures);
+    return failures ? 1 : 0;
+}
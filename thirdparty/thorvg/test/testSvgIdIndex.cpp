@@ -0,0 +1,188 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*
+ * Benchmark of the id references of the SVG loader.
+ * A sprite document refers its shapes by thousands of <use> elements, some of them before the definitions,
+ * and clips the shapes by url(). The load time must scale linearly with the references, and the sprite must be
+ * rendered identically to the document with the references expanded in place. A duplicated id refers the first node.
+ *
+ * usage: tvgSvgIdIndex [references]
+ */
+
+#include <chrono>
+#include <cstdarg>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thorvg.h>
+
+using namespace tvg;
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+#define WIDTH 256
+#define HEIGHT 256
+
+static const char* COLORS[] = {"#e03050", "#30a0ff", "#20c060", "#ffa020", "#8040e0"};
+
+
+static void _append(std::string& svg, const char* fmt, ...)
+{
+    char buf[256];
+    va_list args;
+    va_start(args, fmt);
+    vsnprintf(buf, sizeof(buf), fmt, args);
+    va_end(args);
+    svg += buf;
+}
+
+
+static void _shape(std::string& svg, uint32_t i, const char* id)
+{
+    if (id) _append(svg, "<path id=\"%s\" d=\"M0 0h%u v6 h-%u Z\" fill=\"%s\"/>", id, 3 + i % 5, 3 + i % 5, COLORS[i % 5]);
+    else _append(svg, "<path d=\"M0 0h%u v6 h-%u Z\" fill=\"%s\"/>", 3 + i % 5, 3 + i % 5, COLORS[i % 5]);
+}
+
+
+//the sprite of n references, or the same drawing with the references expanded
+static std::string _sprite(uint32_t n, bool expanded)
+{
+    auto shapes = n / 10 + 1;
+    auto clips = n / 100 + 1;
+
+    std::string svg = "<svg xmlns=\"http://www.w3.org/2000/svg\" xmlns:xlink=\"http://www.w3.org/1999/xlink\" viewBox=\"0 0 256 256\" width=\"256\" height=\"256\">";
+
+    auto uses = [&](uint32_t from, uint32_t to) {
+        for (auto i = from; i < to; ++i) {
+            auto s = (i * 7) % shapes;
+            auto x = (i * 37) % 250, y = (i * 91) % 250;
+            if (expanded) {
+                _append(svg, "<g transform=\"translate(%u %u)\">", x, y);
+                _shape(svg, s, nullptr);
+                svg += "</g>";
+            } else _append(svg, "<use xlink:href=\"#s%u\" x=\"%u\" y=\"%u\"/>", s, x, y);
+        }
+    };
+
+    //the first references come before the definitions
+    uses(0, n / 4);
+
+    svg += "<defs>";
+    char id[32];
+    for (uint32_t i = 0; i < shapes; ++i) {
+        snprintf(id, sizeof(id), "s%u", i);
+        _shape(svg, i, id);
+    }
+    //the duplicated id, the first definition is referred
+    if (!expanded) _append(svg, "<path id=\"s0\" d=\"M0 0h20 v20 h-20 Z\" fill=\"#000000\"/>");
+    for (uint32_t i = 0; i < clips; ++i) {
+        _append(svg, "<clipPath id=\"c%u\"><circle cx=\"%u\" cy=\"%u\" r=\"%u\"/></clipPath>", i, (i * 53) % 256, (i * 29) % 256, 10 + i % 20);
+    }
+    svg += "</defs>";
+
+    uses(n / 4, n);
+
+    for (uint32_t i = 0; i < clips; ++i) {
+        _append(svg, "<rect x=\"%d\" y=\"%d\" width=\"40\" height=\"40\" fill=\"%s\" opacity=\"0.7\" clip-path=\"url(#c%u)\"/>",
+                int((i * 53) % 256) - 20, int((i * 29) % 256) - 20, COLORS[i % 5], i);
+    }
+
+    svg += "</svg>";
+    return svg;
+}
+
+
+//the document is parsed and its scene is built
+static double _load(const std::string& svg)
+{
+    auto best = 1e9;
+    for (int i = 0; i < 3; ++i) {
+        auto begin = std::chrono::steady_clock::now();
+        auto picture = Picture::gen();
+        if (picture->load(svg.data(), uint32_t(svg.size()), "svg", true) != Result::Success) return -1.0;
+        picture->paint(0);
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+
+static bool _render(const std::string& svg, std::vector<uint32_t>& pixels)
+{
+    auto canvas = SwCanvas::gen();
+    pixels.assign(WIDTH * HEIGHT, 0);
+    canvas->target(pixels.data(), WIDTH, WIDTH, HEIGHT, SwCanvas::ARGB8888);
+    auto picture = Picture::gen();
+    if (picture->load(svg.data(), uint32_t(svg.size()), "svg", true) != Result::Success) return false;
+    canvas->push(std::move(picture));
+    canvas->draw();
+    canvas->sync();
+    return true;
+}
+
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    auto n = (argc > 1) ? uint32_t(strtoul(argv[1], nullptr, 10)) : 10000U;
+    if (n < 100) n = 100;
+
+    if (Initializer::init(CanvasEngine::Sw, 0) != Result::Success) return 1;
+
+    auto failures = 0;
+
+    std::vector<uint32_t> sprite, expanded;
+    if (!_render(_sprite(1000, false), sprite) || !_render(_sprite(1000, true), expanded)) {
+        fprintf(stderr, "failed to load the sprite\n");
+        return 1;
+    }
+    if (sprite != expanded) {
+        fprintf(stderr, "the references are rendered differently from the expanded ones\n");
+        ++failures;
+    }
+
+    //a quadratic resolution takes 16 times longer for 4 times the references
+    auto quarter = _load(_sprite(n / 4, false));
+    auto full = _load(_sprite(n, false));
+    if (quarter < 0.0 || full < 0.0) {
+        fprintf(stderr, "failed to load the sprite\n");
+        ++failures;
+    } else {
+        printf("references: %u in %.1f ms, %u in %.1f ms\n", n / 4, quarter, n, full);
+        if (full > quarter * 8.0 + 10.0) {
+            fprintf(stderr, "the load time grows faster than the references: x%.1f\n", full / quarter);
+            ++failures;
+        }
+    }
+
+    Initializer::term(CanvasEngine::Sw);
+
+    printf("failures: %d\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+/*
+ * Path data micro-benchmark: parses random path data with svgPathToShape() and with the original parser
+ * vendored in baseline/, then reports the per-number costs and checks that both give the same path.
+ * The number scanners are measured separately: the original strToFloat(), the current one and an 8-digit
+ * SWAR variant of the current fast path, on the typical coordinates and on the long decimals.
+ *
+ * usage: tvgSvgPath [paths]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstring>
+#include <ctype.h>
+#include <cmath>
+#include <memory.h>
+#include "config.h"
+#include "tvgMath.h"
+#include "tvgShape.h"
+#include "tvgSvgLoaderCommon.h"
+#include "tvgSvgPath.h"
+#include "tvgStr.h"
+
+namespace baseline {
+    namespace str {
+        #include "baseline/tvgStr.cpp"
+    }
+    using str::tvg::strToFloat;
+    #include "baseline/tvgSvgPath.cpp"
+}
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+#define ROUNDS 8
+#define PADDING 16      //the SWAR scanner reads 8 bytes at once
+
+static uint64_t _rand(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+
+//a coordinate of 0 to 3 decimals in the drawing scale, the most of the exported drawings
+static void _number(std::string& str, uint64_t& state, bool lead, bool positive = false)
+{
+    static const uint64_t SCALES[] = {1, 10, 100, 1000};
+
+    char buf[32];
+    auto decimals = int(_rand(state) % 4);
+    auto val = double(_rand(state) % (1000 * SCALES[decimals])) / double(SCALES[decimals]);
+    if (!positive && _rand(state) % 3 == 0) val = -val;
+    snprintf(buf, sizeof(buf), "%.*f", decimals, val);
+    if (lead && buf[0] != '-') str += (_rand(state) % 2) ? " " : ",";
+    str += buf;
+}
+
+
+static std::string _path(uint64_t& state, bool arcs)
+{
+    static const char CMDS[] = "MmLlHhVvCcSsQqTtAaZz";
+    static const int COUNTS[] = {2, 2, 2, 2, 1, 1, 1, 1, 6, 6, 4, 4, 4, 4, 2, 2, 7, 7, 0, 0};
+
+    std::string str;
+    _number(str = "M", state, false);
+    _number(str, state, true);
+
+    auto cnt = 4 + _rand(state) % 60;
+    for (uint64_t i = 0; i < cnt; ++i) {
+        auto c = _rand(state) % (arcs ? 20 : 18);
+        if (!arcs && c >= 16) c += 2;
+        str += CMDS[c];
+        for (int k = 0; k < COUNTS[c]; ++k) {
+            //the arc flags are single digits
+            if (c >= 16 && (k == 3 || k == 4)) str += (_rand(state) % 2) ? " 1" : " 0";
+            else _number(str, state, k > 0, c >= 16 && k < 2);
+        }
+    }
+    return str;
+}
+
+
+static inline bool _isDigit(char c)
+{
+    return static_cast<unsigned char>(c - '0') < 10;
+}
+
+
+//the eight bytes are all digits
+static inline bool _eightDigits(uint64_t val)
+{
+    return (((val & 0xF0F0F0F0F0F0F0F0ULL) | (((val + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL);
+}
+
+
+//the little endian digits to the number
+static inline uint32_t _parseEight(uint64_t val)
+{
+    val = (val & 0x0F0F0F0F0F0F0F0FULL) * 2561 >> 8;
+    val = (val & 0x00FF00FF00FF00FFULL) * 6553601 >> 16;
+    return uint32_t((val & 0x0000FFFF0000FFFFULL) * 42949672960001ULL >> 32);
+}
+
+
+static inline uint64_t _digits(const char*& p, uint64_t mantissa, int& cnt)
+{
+    uint64_t val;
+    memcpy(&val, p, sizeof(val));
+    while (_eightDigits(val)) {
+        mantissa = mantissa * 100000000 + _parseEight(val);
+        p += 8;
+        cnt += 8;
+        memcpy(&val, p, sizeof(val));
+    }
+    for (; _isDigit(*p); ++p, ++cnt) mantissa = mantissa * 10 + (*p - '0');
+    return mantissa;
+}
+
+
+//the fast path of strToFloat() with the SWAR digits, the others go to the generic path
+static float _swarToFloat(const char* str, char** end)
+{
+    static constexpr float POW10F[] = {1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f};
+
+    auto p = str;
+    auto minus = 1.0f;
+    if (*p == '-') {
+        minus = -1.0f;
+        ++p;
+    } else if (*p == '+') ++p;
+
+    int digits = 0, scale = 0;
+    auto mantissa = _digits(p, 0, digits);
+    if (*p == '.') {
+        ++p;
+        mantissa = _digits(p, mantissa, scale);
+        digits += scale;
+    }
+    if (digits == 0 || digits > 19 || scale > 10 || *p == 'e' || *p == 'E' || mantissa > (1 << 24)) return tvg::strToFloat(str, end);
+    if (end) *end = (char*)p;
+    return minus * (static_cast<float>(mantissa) / POW10F[scale]);
+}
+
+
+template<typename Func>
+static double _measureNumbers(const std::vector<const char*>& numbers, size_t cnt, Func func, float& sum)
+{
+    auto best = 1e9;
+    for (int r = 0; r < ROUNDS; ++r) {
+        auto begin = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < cnt; ++i) sum += func(numbers[i], nullptr);
+        auto ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count() / double(cnt);
+        if (ns < best) best = ns;
+    }
+    return best;
+}
+
+
+template<typename Func>
+static double _measurePaths(const std::vector<std::string>& paths, Func func)
+{
+    auto shape = tvg::Shape::gen();
+    auto best = 1e9;
+    for (int r = 0; r < ROUNDS; ++r) {
+        auto begin = std::chrono::steady_clock::now();
+        for (auto& path : paths) {
+            shape->reset();
+            func(path.c_str(), shape.get());
+        }
+        auto ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin).count();
+        if (ms < best) best = ms;
+    }
+    return best;
+}
+
+
+static bool _compare(const std::string& path, float precision)
+{
+    auto a = tvg::Shape::gen();
+    auto b = tvg::Shape::gen();
+    auto ra = svgPathToShape(path.c_str(), a.get());
+    auto rb = baseline::svgPathToShape(path.c_str(), b.get());
+
+    const tvg::PathCommand *ca, *cb;
+    const tvg::Point *pa, *pb;
+    auto cmdsCnt = a->pathCommands(&ca);
+    auto ptsCnt = a->pathCoords(&pa);
+    if (ra != rb || cmdsCnt != b->pathCommands(&cb) || ptsCnt != b->pathCoords(&pb) || memcmp(ca, cb, sizeof(tvg::PathCommand) * cmdsCnt)) {
+        fprintf(stderr, "the commands differ: %s\n", path.c_str());
+        return false;
+    }
+    //the decimals are correctly rounded now, and the relative and the smooth commands carry the difference along
+    auto extent = 1.0f;
+    for (uint32_t i = 0; i < ptsCnt; ++i) extent = std::max(extent, std::max(fabsf(pb[i].x), fabsf(pb[i].y)));
+    auto tolerance = precision * extent;
+    for (uint32_t i = 0; i < ptsCnt; ++i) {
+        if (fabsf(pa[i].x - pb[i].x) > tolerance || fabsf(pa[i].y - pb[i].y) > tolerance) {
+            fprintf(stderr, "the point %u differs: (%g, %g), (%g, %g) in %s\n", i, pa[i].x, pa[i].y, pb[i].x, pb[i].y, path.c_str());
+            return false;
+        }
+    }
+    return true;
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    auto cnt = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 5000UL;
+    uint64_t state = 0x5356475041544831ULL;
+
+    std::vector<std::string> paths;
+    size_t numbers = 0;
+    for (unsigned long i = 0; i < cnt; ++i) {
+        paths.push_back(_path(state, true));
+        for (auto c : paths.back()) {
+            if (c == '.' || c == ' ' || c == ',' || c == '-') ++numbers;
+        }
+    }
+
+    //a segment of an arc can flip at the quarter boundaries, the arcs are compared one by one from the start
+    char buf[128];
+    auto failures = 0UL;
+    for (unsigned long i = 0; i < cnt && failures < 10; ++i) {
+        if (!_compare(_path(state, false), 1e-5f)) ++failures;
+        //the radii are in the proportion of the usual drawings and large enough, no half ellipse on the boundary
+        double pts[4];
+        for (auto& pt : pts) pt = double(int64_t(_rand(state) % 200000) - 100000) / 100.0;
+        auto rx = sqrt((pts[2] - pts[0]) * (pts[2] - pts[0]) + (pts[3] - pts[1]) * (pts[3] - pts[1])) * (0.6 + double(_rand(state) % 400) / 100.0);
+        auto ry = rx * (1.0 + double(_rand(state) % 100) / 100.0);
+        snprintf(buf, sizeof(buf), "M%.2f,%.2f A%.2f %.2f %d %d %d %.2f %.2f", pts[0], pts[1], rx, ry, int(_rand(state) % 360), int(_rand(state) % 2), int(_rand(state) % 2), pts[2], pts[3]);
+        std::string arc = buf;
+        if (!_compare(arc, 1e-4f)) ++failures;
+    }
+
+    auto original = _measurePaths(paths, [](const char* str, tvg::Shape* shape) { baseline::svgPathToShape(str, shape); });
+    auto current = _measurePaths(paths, [](const char* str, tvg::Shape* shape) { svgPathToShape(str, shape); });
+
+    printf("paths: %zu, numbers: ~%zu\n", paths.size(), numbers);
+    printf("path data: original %.2f ms, current %.2f ms (x%.2f)\n", original, current, original / current);
+
+    //the typical coordinates and the long decimals, padded for the SWAR reads
+    std::vector<std::string> storage;
+    std::vector<const char*> shorts, longs;
+    for (int i = 0; i < 100000; ++i) {
+        std::string str;
+        _number(str, state, false);
+        storage.push_back(str + std::string(PADDING, '\0'));
+        snprintf(buf, sizeof(buf), "%llu.%llu", (unsigned long long)(_rand(state) % 100000000ULL), (unsigned long long)(_rand(state) % 100ULL));
+        storage.push_back(std::string(buf) + std::string(PADDING, '\0'));
+    }
+    for (size_t i = 0; i < storage.size(); i += 2) {
+        shorts.push_back(storage[i].c_str());
+        longs.push_back(storage[i + 1].c_str());
+    }
+
+    auto sum = 0.0f;
+    for (auto set : {&shorts, &longs}) {
+        auto o = _measureNumbers(*set, set->size(), baseline::strToFloat, sum);
+        auto c = _measureNumbers(*set, set->size(), tvg::strToFloat, sum);
+        auto s = _measureNumbers(*set, set->size(), _swarToFloat, sum);
+        for (auto str : *set) {
+            auto a = tvg::strToFloat(str, nullptr), b = _swarToFloat(str, nullptr);
+            if (memcmp(&a, &b, sizeof(float))) {
+                fprintf(stderr, "the SWAR scanner differs: %s %.9g %.9g\n", str, a, b);
+                ++failures;
+                break;
+            }
+        }
+        printf("%s: original %.2f ns, current %.2f ns, swar %.2f ns\n", (set == &shorts) ? "coordinates" : "long decimals", o, c, s);
+    }
+    printf("failures: %lu (checksum %g)\n", failures, sum);
+
+    return failures ? 1 : 0;
+}
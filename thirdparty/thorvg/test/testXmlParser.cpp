@@ -0,0 +1,265 @@
+/*
+ * Copyright (c) 2024 the ThorVG project. All rights reserved.
+
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+
+/*
+ * Equivalence test of the XML tokenizer against the original one.
+ * The original tokenizer is vendored in baseline/ and built in its own namespace, so is the scalar scan
+ * of the current source with XML_SCALAR_SCAN. They tokenize the random markups and the mutations of a svg,
+ * every token must match. The attributes are parsed by the original and the current ones likewise.
+ *
+ * usage: tvgXmlParser [iterations] [seed]
+ */
+
+#include <cstring>
+#include <ctype.h>
+#include <string>
+#include <utility>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+#ifdef _WIN32
+    #include <malloc.h>
+#elif defined(__linux__)
+    #include <alloca.h>
+#endif
+#ifdef _MSC_VER
+    #include <intrin.h>
+#endif
+#include "tvgXmlParser.h"
+#include "tvgStr.h"
+
+namespace baseline {
+    #include "baseline/tvgXmlParser.cpp"
+}
+
+namespace scalar {
+    #define XML_SCALAR_SCAN
+    #include "tvgXmlParser.cpp"
+}
+
+/************************************************************************/
+/* Internal Class Implementation                                        */
+/************************************************************************/
+
+struct Token
+{
+    SimpleXMLType type;
+    size_t offset, length;
+
+    bool operator==(const Token& rhs) const
+    {
+        return type == rhs.type && offset == rhs.offset && length == rhs.length;
+    }
+};
+
+struct Tokens
+{
+    const char* buf;
+    std::vector<Token> tokens;
+    unsigned parsed = 0;
+    bool ret;
+};
+
+
+struct Attributes
+{
+    std::vector<std::pair<std::string, std::string>> pairs;
+    bool ret;
+};
+
+
+static bool _record(void* data, SimpleXMLType type, const char* content, unsigned int length)
+{
+    auto tokens = static_cast<Tokens*>(data);
+    tokens->tokens.push_back({type, size_t(content - tokens->buf), length});
+    return true;
+}
+
+
+static bool _recordAttribute(void* data, const char* key, const char* value)
+{
+    static_cast<Attributes*>(data)->pairs.emplace_back(key, value);
+    return true;
+}
+
+
+static uint32_t _rand(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+
+//the markup pieces, most of them have the structural characters
+static void _markup(std::string& out, uint32_t& state)
+{
+    static const char* pieces[] = {
+        "<", ">", "\"", "'", "/", "/>", "</", "<?", "?>", "<!--", "-->", "<![CDATA[", "]]>", "<!DOCTYPE", "<!ENTITY",
+        "[", "]", "=", " ", "\n", "\t", "&amp;", "&#x20;", "svg", "path", "d=\"M0 0L10 10\"", "fill='#f00'", "<g>", "</g>"
+    };
+    auto count = _rand(state) % 48;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (_rand(state) % 4 == 0) {
+            //the runs of the plain characters move the structural ones across the 32 bytes steps
+            auto run = _rand(state) % 70;
+            for (uint32_t j = 0; j < run; ++j) out += char('a' + _rand(state) % 26);
+        } else out += pieces[_rand(state) % (sizeof(pieces) / sizeof(pieces[0]))];
+    }
+}
+
+
+static const char* SVG =
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<!DOCTYPE svg [ <!ENTITY ns \"http://www.w3.org/2000/svg\"> ]>\n"
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\" viewBox=\"0 0 100 100\">\n"
+    "  <!-- a comment with <brackets> and \"quotes\" -->\n"
+    "  <style><![CDATA[ .a { fill: #ff0000; } /* > */ ]]></style>\n"
+    "  <defs><linearGradient id=\"g\"><stop offset=\"0\" stop-color=\"#000\"/><stop offset='1' stop-color='#fff'/></linearGradient></defs>\n"
+    "  <g transform=\"translate(10, 10)\" data-label=\"a > b\">\n"
+    "    <path class=\"a\" d=\"M 10 10 L 90 10 L 90 90 Z\" title='it&apos;s <not> a tag'/>\n"
+    "    <text x=\"10\" y=\"50\">Hello &amp; welcome</text>\n"
+    "  </g>\n"
+    "</svg>\n";
+
+
+static void _mutate(std::string& out, uint32_t& state)
+{
+    static const char structural[] = "<>\"'/!?-[]= ";
+    out = SVG;
+    auto count = 1 + _rand(state) % 8;
+    for (uint32_t i = 0; i < count && !out.empty(); ++i) {
+        auto pos = _rand(state) % out.size();
+        switch (_rand(state) % 3) {
+            case 0: out[pos] = structural[_rand(state) % (sizeof(structural) - 1)]; break;
+            case 1: out.insert(pos, 1, structural[_rand(state) % (sizeof(structural) - 1)]); break;
+            default: out.erase(pos, 1 + _rand(state) % 16); break;
+        }
+    }
+    //cut the tail to stop in the middle of a markup
+    if (_rand(state) % 2) out.resize(_rand(state) % (out.size() + 1));
+}
+
+
+//the attribute pieces, the values have the entities and the quotes
+static void _attributes(std::string& out, uint32_t& state)
+{
+    static const char* pieces[] = {
+        "id", "fill", "stroke-width", "xlink:href", "d", "=", " = ", "\"", "'", " ", "\n", "\t", "&amp;", "&lt;", "&gt;",
+        "&quot;", "&apos;", "&#x20;", "&#38;", "&", ";", "#ff0000", "M0 0L10 10", "url(#a)", "x=\"1\"", "y='2'", "a=b"
+    };
+    auto count = _rand(state) % 24;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (_rand(state) % 5 == 0) {
+            auto run = _rand(state) % 40;
+            for (uint32_t j = 0; j < run; ++j) out += char('a' + _rand(state) % 26);
+        } else out += pieces[_rand(state) % (sizeof(pieces) / sizeof(pieces[0]))];
+    }
+}
+
+
+static bool _compare(const std::string& input, bool strip, bool partial)
+{
+    //a tight copy, the scan must not read past the end
+    std::vector<char> buf(input.begin(), input.end());
+    auto data = buf.empty() ? nullptr : buf.data();
+    auto size = unsigned(buf.size());
+
+    Tokens simd, scan;
+    simd.buf = scan.buf = data;
+    simd.ret = simpleXmlParse(data, size, strip, _record, &simd, partial ? &simd.parsed : nullptr);
+    scan.ret = scalar::simpleXmlParse(data, size, strip, _record, &scan, partial ? &scan.parsed : nullptr);
+
+    if (simd.ret != scan.ret || simd.parsed != scan.parsed || simd.tokens != scan.tokens) {
+        fprintf(stderr, "scalar mismatch (strip: %d, partial: %d): ret %d/%d, parsed %u/%u, tokens %zu/%zu\n%s\n",
+                strip, partial, simd.ret, scan.ret, simd.parsed, scan.parsed, simd.tokens.size(), scan.tokens.size(), input.c_str());
+        return false;
+    }
+
+    //the original one doesn't parse partially
+    if (partial) return true;
+
+    //the original one may read a byte past the end, it has its own terminated copy
+    std::string terminated = input;
+    Tokens original;
+    original.buf = data ? terminated.c_str() : nullptr;
+    original.ret = baseline::simpleXmlParse(original.buf, size, strip, _record, &original);
+
+    //the offsets are relative to each buffer
+    if (simd.ret == original.ret && simd.tokens == original.tokens) return true;
+
+    fprintf(stderr, "original mismatch (strip: %d): ret %d/%d, tokens %zu/%zu\n%s\n",
+            strip, simd.ret, original.ret, simd.tokens.size(), original.tokens.size(), input.c_str());
+    return false;
+}
+
+
+static bool _compareAttributes(const std::string& input)
+{
+    std::vector<char> buf(input.begin(), input.end());
+    auto data = buf.empty() ? nullptr : buf.data();
+    std::string terminated = input;
+
+    Attributes current, original;
+    current.ret = simpleXmlParseAttributes(data, unsigned(buf.size()), _recordAttribute, &current);
+    original.ret = baseline::simpleXmlParseAttributes(data ? terminated.c_str() : nullptr, unsigned(terminated.size()), _recordAttribute, &original);
+
+    if (current.ret == original.ret && current.pairs == original.pairs) return true;
+
+    fprintf(stderr, "attributes mismatch: ret %d/%d, pairs %zu/%zu\n%s\n", current.ret, original.ret, current.pairs.size(), original.pairs.size(), input.c_str());
+    return false;
+}
+
+/************************************************************************/
+/* External Class Implementation                                        */
+/************************************************************************/
+
+int main(int argc, char** argv)
+{
+    auto iterations = (argc > 1) ? strtoul(argv[1], nullptr, 10) : 20000UL;
+    uint32_t state = (argc > 2) ? uint32_t(strtoul(argv[2], nullptr, 10)) : 0x584d4c31;
+    if (state == 0) state = 1;
+
+    std::string input;
+    auto failures = 0UL;
+
+    for (unsigned long i = 0; i < iterations; ++i) {
+        input.clear();
+        if (i % 2) _mutate(input, state);
+        else _markup(input, state);
+
+        for (int mode = 0; mode < 4; ++mode) {
+            if (!_compare(input, mode & 1, mode & 2)) ++failures;
+        }
+
+        input.clear();
+        _attributes(input, state);
+        if (!_compareAttributes(input)) ++failures;
+
+        if (failures > 10) break;
+    }
+
+    printf("iterations: %lu, failures: %lu\n", iterations, failures);
+    return failures ? 1 : 0;
+}
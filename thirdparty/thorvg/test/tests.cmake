@@ -0,0 +1,95 @@
+# ThorVG benchmarks and tests, run them with ctest.
+
+set(THORVG_TEST_DIR ${CMAKE_CURRENT_LIST_DIR})
+set(THORVG_TEST_INCLUDES ${THORVG_INCLUDES})
+
+# the vectorized xml tokenizer against the original and the scalar ones
+add_executable(tvgXmlParser ${THORVG_TEST_DIR}/testXmlParser.cpp
+                            ${THORVG_TEST_DIR}/../src/loaders/svg/tvgXmlParser.cpp
+                            ${THORVG_TEST_DIR}/../src/common/tvgStr.cpp)
+target_include_directories(tvgXmlParser PRIVATE ${THORVG_TEST_INCLUDES})
+target_compile_definitions(tvgXmlParser PRIVATE TVG_STATIC)
+add_test(NAME tvgXmlParser COMMAND tvgXmlParser)
+
+# the rounding of the decimals
+add_executable(tvgStrToFloat ${THORVG_TEST_DIR}/testStrToFloat.cpp
+                             ${THORVG_TEST_DIR}/../src/common/tvgStr.cpp)
+target_include_directories(tvgStrToFloat PRIVATE ${THORVG_TEST_INCLUDES})
+target_compile_definitions(tvgStrToFloat PRIVATE TVG_STATIC)
+add_test(NAME tvgStrToFloat COMMAND tvgStrToFloat)
+
+if(LOTTIE_ENABLED)
+    # the easing benchmark with the exact solver and with the baked table
+    foreach(table 0 1024)
+        add_executable(tvgLottieEasing${table} ${THORVG_TEST_DIR}/testLottieEasing.cpp
+                                               ${THORVG_TEST_DIR}/../src/loaders/lottie/tvgLottieInterpolator.cpp
+                                               ${THORVG_TEST_DIR}/../src/common/tvgMath.cpp)
+        target_include_directories(tvgLottieEasing${table} PRIVATE ${THORVG_TEST_INCLUDES} ${THORVG_LOTTIE_INCLUDES})
+        target_compile_definitions(tvgLottieEasing${table} PRIVATE EASING_TABLE_SIZE=${table} TVG_STATIC)
+        add_test(NAME tvgLottieEasing${table} COMMAND tvgLottieEasing${table})
+    endforeach()
+endif()
+
+# the whole engine for the tests rendering the pictures
+find_package(Threads REQUIRED)
+add_library(tvgTestEngine STATIC ${THORVG_SRCS} ${THORVG_LOTTIE_SRCS})
+target_include_directories(tvgTestEngine PUBLIC ${THORVG_TEST_INCLUDES} ${THORVG_LOTTIE_INCLUDES})
+target_compile_definitions(tvgTestEngine PUBLIC TVG_STATIC $<$<BOOL:${LOTTIE_ENABLED}>:LOTTIE_ENABLED>)
+target_link_libraries(tvgTestEngine PUBLIC Threads::Threads)
+
+if(LOTTIE_ENABLED)
+    # the round trip of the precompiled binary format
+    add_executable(tvgLottieBinary ${THORVG_TEST_DIR}/testLottieBinary.cpp)
+    target_link_libraries(tvgLottieBinary PRIVATE tvgTestEngine)
+    add_test(NAME tvgLottieBinary COMMAND tvgLottieBinary)
+endif()
+
+# the progressive loading against the loading at once
+add_executable(tvgPictureStream ${THORVG_TEST_DIR}/testPictureStream.cpp)
+target_link_libraries(tvgPictureStream PRIVATE tvgTestEngine)
+add_test(NAME tvgPictureStream COMMAND tvgPictureStream)
+
+# the raw images loaded once and replaced frame by frame
+add_executable(tvgPictureRaw ${THORVG_TEST_DIR}/testPictureRaw.cpp)
+target_link_libraries(tvgPictureRaw PRIVATE tvgTestEngine)
+add_test(NAME tvgPictureRaw COMMAND tvgPictureRaw)
+
+# the load time of the id references
+add_executable(tvgSvgIdIndex ${THORVG_TEST_DIR}/testSvgIdIndex.cpp)
+target_link_libraries(tvgSvgIdIndex PRIVATE tvgTestEngine)
+add_test(NAME tvgSvgIdIndex COMMAND tvgSvgIdIndex)
+
+# the path data benchmark against the original parser
+add_executable(tvgSvgPath ${THORVG_TEST_DIR}/testSvgPath.cpp)
+target_link_libraries(tvgSvgPath PRIVATE tvgTestEngine)
+add_test(NAME tvgSvgPath COMMAND tvgSvgPath)
+
+# the png decoder against the pixels of the images it's given
+add_executable(tvgPngDecoder ${THORVG_TEST_DIR}/testPngDecoder.cpp)
+target_link_libraries(tvgPngDecoder PRIVATE tvgTestEngine)
+add_test(NAME tvgPngDecoder COMMAND tvgPngDecoder)
+
+# the gif decoder against the indices of the frames it's given
+add_executable(tvgGifDecoder ${THORVG_TEST_DIR}/testGifDecoder.cpp)
+target_link_libraries(tvgGifDecoder PRIVATE tvgTestEngine)
+add_test(NAME tvgGifDecoder COMMAND tvgGifDecoder)
+
+# the disposals of the animated images, seeking forward and back
+add_executable(tvgImageFrames ${THORVG_TEST_DIR}/testImageFrames.cpp)
+target_link_libraries(tvgImageFrames PRIVATE tvgTestEngine)
+add_test(NAME tvgImageFrames COMMAND tvgImageFrames)
+
+# the nearest image drawing against the generic nearest sampling
+add_executable(tvgNearestImage ${THORVG_TEST_DIR}/testNearestImage.cpp)
+target_link_libraries(tvgNearestImage PRIVATE tvgTestEngine)
+add_test(NAME tvgNearestImage COMMAND tvgNearestImage)
+
+# the jpeg decoder against the one before the scaled, vectorized and threaded decoding
+add_executable(tvgJpgDecoder ${THORVG_TEST_DIR}/testJpgDecoder.cpp)
+target_link_libraries(tvgJpgDecoder PRIVATE tvgTestEngine)
+add_test(NAME tvgJpgDecoder COMMAND tvgJpgDecoder)
+
+# the image pattern fills and the nine-slice pictures against the image pixels
+add_executable(tvgImagePattern ${THORVG_TEST_DIR}/testImagePattern.cpp)
+target_link_libraries(tvgImagePattern PRIVATE tvgTestEngine)
+add_test(NAME tvgImagePattern COMMAND tvgImagePattern)
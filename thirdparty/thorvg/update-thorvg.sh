@@ -3,6 +3,33 @@
 VERSION=0.15.3
 
 cd thirdparty/thorvg/ || true
+
+# In-tree files the release doesn't have, they're kept over the update.
+# The local changes of the upstream files are not kept, reapply them on the release.
+KEEP=(
+    src/common/tvgFile.cpp
+    src/common/tvgFile.h
+    src/loaders/lottie/tvgLottieBinary.cpp
+    src/loaders/lottie/tvgLottieBinary.h
+    src/loaders/lottie/tvgLottiePlayer.cpp
+    src/loaders/svg/tvgSvgLookup.h
+    src/patches
+    src/renderer/tvgImageCache.cpp
+    src/renderer/tvgImageCache.h
+    src/renderer/tvgImageFrames.cpp
+    src/renderer/tvgImageFrames.h
+    src/renderer/tvgTiles.cpp
+    src/renderer/tvgTiles.h
+    # Built-in decoders, in directories upstream doesn't use.
+    src/loaders/gifd
+    src/loaders/pngd
+)
+
+rm -rf keep/ && mkdir keep/
+for path in "${KEEP[@]}"; do
+    cp -rv --parents $path keep/
+done
+
 rm -rf AUTHORS LICENSE inc/ src/ *.zip *.tar.gz tmp/
 
 mkdir tmp/ && pushd tmp/
@@ -20,7 +47,7 @@ rm *.tar.gz
 #d="../../../../thorvg-git"
 #cp -r ${d}/AUTHORS ${d}/inc ${d}/LICENSE ${d}/src .
 
-find2 . -type f -name 'meson.build' -delete
+find . -type f -name 'meson.build' -delete
 
 # Fix newline at end of file.
 for source in $(find ./ -type f \( -iname \*.h -o -iname \*.cpp \)); do
@@ -37,6 +64,8 @@ cat << EOF > ../inc/config.h
 #define THORVG_SW_RASTER_SUPPORT
 #define THORVG_SVG_LOADER_SUPPORT
 #define THORVG_JPG_LOADER_SUPPORT
+#define THORVG_PNG_LOADER_SUPPORT
+#define THORVG_GIF_LOADER_SUPPORT
 #ifdef LOTTIE_ENABLED
 #define THORVG_LOTTIE_LOADER_SUPPORT
 #endif //LOTTIE_ENABLED
@@ -60,7 +89,7 @@ cp -rv src/renderer ../src/
 rm -rfv ../src/renderer/gl_engine
 rm -rfv ../src/renderer/wg_engine
 
-# Enabled embedded loaders: raw, JPEG
+# Enabled embedded loaders: raw, JPEG (PNG and GIF from the kept pngd and gifd)
 mkdir ../src/loaders
 cp -rv src/loaders/svg src/loaders/raw  ../src/loaders/
 cp -rv src/loaders/lottie ../src/loaders/
@@ -70,3 +99,6 @@ cp -rv src/loaders/jpg ../src/loaders/
 popd
 rm -rf tmp
 
+cp -rv keep/src .
+rm -rf keep
+